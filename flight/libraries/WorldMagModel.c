@@ -52,11 +52,6 @@
 #include "WorldMagModel.h"
 #include "WMMInternal.h"
 
-#define MALLOC(x) pios_malloc(x)
-#define FREE(x)   vPortFree(x)
-// #define MALLOC(x) malloc(x)
-// #define FREE(x) free(x)
-
 // http://reviews.openpilot.org/cru/OPReview-436#c6476 :
 // first column not used but it will be optimized out by compiler
 static const float CoeffFile[91][6] = {
@@ -153,48 +148,66 @@ static const float CoeffFile[91][6] = {
     { 12.0f, 12.0f, -0.0f,     0.8f,     -0.1f,  -0.1f  }
 };
 
-static WMMtype_Ellipsoid *Ellip = NULL;
-static WMMtype_MagneticModel *MagneticModel = NULL;
+static WMMtype_Ellipsoid Ellip;
+static WMMtype_MagneticModel MagneticModel;
 static float decimal_date;
+static bool initialized = false;
+
+// Scratch space of the field evaluation, static to keep it off the task stacks
+static WMMtype_LegendreFunction LegendreFunction;
+static WMMtype_SphericalHarmonicVariables SphVariables;
+
+// Field grid around the last location asked for, see WMM_GetGridMagVector()
+static struct {
+    float   B[WMM_GRID_NODES][WMM_GRID_NODES][3]; // ring buffer, see WMM_GridNode()
+    float   centerLat;
+    float   centerLon;
+    float   alt;
+    float   date;
+    uint8_t rowOffset; // storage row of the southernmost node row
+    uint8_t colOffset; // storage column of the westernmost node column
+    bool    valid;
+} grid;
+
+static int WMM_FieldAt(float Lat, float Lon, float AltEllipsoid, float B[3]);
 
 /**************************************************************************************
-*   Example use - very simple - only two exposed functions
+*   Example use - very simple - only a few exposed functions
 *
-*	WMM_Initialize(); // Set default values and constants
+*	WMM_Initialize(); // Set default values and constants, optional
 *
 *	WMM_GetMagVector(float Lat, float Lon, float Alt, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
 *	e.g. Iceland in may of 2012 = WMM_GetMagVector(65.0, -20.0, 0.0, 5, 5, 2012, B);
 *	Alt is above the WGS-84 Ellipsoid
 *	B is the NED (XYZ) magnetic vector in nTesla
+*
+*	WMM_GetGridMagVector() takes the same arguments and interpolates a small grid of
+*	field values around the location instead, for callers asking repeatedly while moving.
 **************************************************************************************/
 
 int WMM_Initialize()
 // Sets default values for WMM subroutines.
 // UPDATES : Ellip and MagneticModel
 {
-    if (!Ellip) {
-        return -1; // invalid pointer
-    }
-    if (!MagneticModel) {
-        return -2; // invalid pointer
-    }
     // Sets WGS-84 parameters
-    Ellip->a     = 6378.137f;   // semi-major axis of the ellipsoid in km
-    Ellip->b     = 6356.7523142f;       // semi-minor axis of the ellipsoid in km
-    Ellip->fla   = 1.0f / 298.257223563f;     // flattening
-    Ellip->eps   = sqrt(1 - (Ellip->b * Ellip->b) / (Ellip->a * Ellip->a));   // first eccentricity
-    Ellip->epssq = (Ellip->eps * Ellip->eps); // first eccentricity squared
-    Ellip->re    = 6371.2f;    // Earth's radius in km
+    Ellip.a     = 6378.137f;   // semi-major axis of the ellipsoid in km
+    Ellip.b     = 6356.7523142f;       // semi-minor axis of the ellipsoid in km
+    Ellip.fla   = 1.0f / 298.257223563f;     // flattening
+    Ellip.eps   = sqrt(1 - (Ellip.b * Ellip.b) / (Ellip.a * Ellip.a));   // first eccentricity
+    Ellip.epssq = (Ellip.eps * Ellip.eps); // first eccentricity squared
+    Ellip.re    = 6371.2f;    // Earth's radius in km
 
     // Sets Magnetic Model parameters
-    MagneticModel->nMax = WMM_MAX_MODEL_DEGREES;
-    MagneticModel->nMaxSecVar = WMM_MAX_SECULAR_VARIATION_MODEL_DEGREES;
-    MagneticModel->SecularVariationUsed = 0;
+    MagneticModel.nMax = WMM_MAX_MODEL_DEGREES;
+    MagneticModel.nMaxSecVar = WMM_MAX_SECULAR_VARIATION_MODEL_DEGREES;
+    MagneticModel.SecularVariationUsed = 0;
 
     // Really, Really needs to be read from a file - out of date in 2020 at latest
-    MagneticModel->EditionDate = 0.0f; /* OP change. Originally 5.7863328170559505e-307, truncates to 0.0f */
-    MagneticModel->epoch = 2015.0f;
-    sprintf(MagneticModel->ModelName, "WMM-2015v2");
+    MagneticModel.EditionDate = 0.0f; /* OP change. Originally 5.7863328170559505e-307, truncates to 0.0f */
+    MagneticModel.epoch = 2015.0f;
+    sprintf(MagneticModel.ModelName, "WMM-2015v2");
+
+    initialized = true;
 
     return 0; // OK
 }
@@ -204,8 +217,6 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     // return '0' if all appears to be OK
     // return < 0 if error
 
-    int returned = 0; // default to OK
-
     // ***********
     // range check supplied params
 
@@ -221,93 +232,193 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     if (Lon > 180.0f) {
         return -4; // error
     }
-    // ***********
-    // allocated required memory
+    if (WMM_DateToYear(Month, Day, Year) < 0) {
+        return -8; // error
+    }
 
-// Ellip = NULL;
-// MagneticModel = NULL;
+    return WMM_FieldAt(Lat, Lon, AltEllipsoid, B);
+}
 
-// MagneticModel = NULL;
-// CoordGeodetic = NULL;
-// GeoMagneticElements = NULL;
+/**
+ * Evaluates the main field at a location for the date last set by WMM_DateToYear().
+ * Unlike WMM_Geomag() the secular variation is not computed, it is not needed for B.
+ */
+static int WMM_FieldAt(float Lat, float Lon, float AltEllipsoid, float B[3])
+{
+    WMMtype_CoordGeodetic CoordGeodetic;
+    WMMtype_CoordSpherical CoordSpherical;
+    WMMtype_MagneticResults MagneticResultsSph;
+    WMMtype_MagneticResults MagneticResultsGeo;
 
-    Ellip = (WMMtype_Ellipsoid *)MALLOC(sizeof(WMMtype_Ellipsoid));
-    MagneticModel = (WMMtype_MagneticModel *)MALLOC(sizeof(WMMtype_MagneticModel));
+    if (!initialized) {
+        WMM_Initialize();
+    }
 
-    WMMtype_CoordSpherical *CoordSpherical = (WMMtype_CoordSpherical *)MALLOC(sizeof(WMMtype_CoordSpherical));
-    WMMtype_CoordGeodetic *CoordGeodetic   = (WMMtype_CoordGeodetic *)MALLOC(sizeof(WMMtype_CoordGeodetic));
-    WMMtype_GeoMagneticElements *GeoMagneticElements = (WMMtype_GeoMagneticElements *)MALLOC(sizeof(WMMtype_GeoMagneticElements));
+    CoordGeodetic.lambda = Lon;
+    CoordGeodetic.phi    = Lat;
+    CoordGeodetic.HeightAboveEllipsoid = AltEllipsoid / 1000.0f; // convert to km
 
-    if (!Ellip || !MagneticModel || !CoordSpherical || !CoordGeodetic || !GeoMagneticElements) {
-        returned = -5; // error
+    // Convert from geodetic to Spherical Equations: 17-18, WMM Technical report
+    if (WMM_GeodeticToSpherical(&CoordGeodetic, &CoordSpherical) < 0) {
+        return -7; // error
     }
-    // ***********
-
-    if (returned >= 0) {
-        if (WMM_Initialize() < 0) {
-            returned = -6; // error
-        }
+    if (WMM_ComputeSphericalHarmonicVariables(&CoordSpherical, MagneticModel.nMax, &SphVariables) < 0) {
+        return -9; // error
+    }
+    if (WMM_AssociatedLegendreFunction(&CoordSpherical, MagneticModel.nMax, &LegendreFunction) < 0) {
+        return -9; // error
+    }
+    if (WMM_Summation(&LegendreFunction, &SphVariables, &CoordSpherical, &MagneticResultsSph) < 0) {
+        return -9; // error
+    }
+    if (WMM_RotateMagneticVector(&CoordSpherical, &CoordGeodetic, &MagneticResultsSph, &MagneticResultsGeo) < 0) {
+        return -9; // error
     }
 
-    if (returned >= 0) {
-        CoordGeodetic->lambda = Lon;
-        CoordGeodetic->phi    = Lat;
-        CoordGeodetic->HeightAboveEllipsoid = AltEllipsoid / 1000.0f; // convert to km
+    B[0] = MagneticResultsGeo.Bx * 1e-2f;
+    B[1] = MagneticResultsGeo.By * 1e-2f;
+    B[2] = MagneticResultsGeo.Bz * 1e-2f;
 
-        // Convert from geodetic to Spherical Equations: 17-18, WMM Technical report
-        if (WMM_GeodeticToSpherical(CoordGeodetic, CoordSpherical) < 0) {
-            returned = -7; // error
-        }
+    return 0; // OK
+}
+
+static float WMM_WrapLon(float lon)
+{
+    if (lon > 180.0f) {
+        return lon - 360.0f;
+    } else if (lon < -180.0f) {
+        return lon + 360.0f;
     }
+    return lon;
+}
+
+// Node i, j of the grid, counted from its south west corner
+static float *WMM_GridNode(int8_t i, int8_t j)
+{
+    return grid.B[(i + grid.rowOffset) % WMM_GRID_NODES][(j + grid.colOffset) % WMM_GRID_NODES];
+}
 
+static int WMM_GridFillNode(int8_t i, int8_t j)
+{
+    float lat = grid.centerLat + (i - WMM_GRID_NODES / 2) * WMM_GRID_SPACING;
+    float lon = WMM_WrapLon(grid.centerLon + (j - WMM_GRID_NODES / 2) * WMM_GRID_SPACING);
 
-    if (returned >= 0) {
-        if (WMM_DateToYear(Month, Day, Year) < 0) {
-            returned = -8; // error
+    return WMM_FieldAt(lat, lon, grid.alt, WMM_GridNode(i, j));
+}
+
+/**
+ * Moves the grid by di node rows north and dj node columns east.
+ * Nodes that were already part of the grid keep their place in the ring buffer,
+ * only the rows and columns that are new get evaluated.
+ */
+static int WMM_GridShift(int8_t di, int8_t dj)
+{
+    int8_t i, j;
+
+    grid.centerLat += di * WMM_GRID_SPACING;
+    grid.centerLon  = WMM_WrapLon(grid.centerLon + dj * WMM_GRID_SPACING);
+    grid.rowOffset  = (grid.rowOffset + di + WMM_GRID_NODES) % WMM_GRID_NODES;
+    grid.colOffset  = (grid.colOffset + dj + WMM_GRID_NODES) % WMM_GRID_NODES;
+
+    for (i = 0; i < WMM_GRID_NODES; i++) {
+        for (j = 0; j < WMM_GRID_NODES; j++) {
+            if (i + di < 0 || i + di >= WMM_GRID_NODES || j + dj < 0 || j + dj >= WMM_GRID_NODES) {
+                if (WMM_GridFillNode(i, j) < 0) {
+                    grid.valid = false;
+                    return -9; // error
+                }
+            }
         }
     }
+    return 0; // OK
+}
 
-    if (returned >= 0) {
-        // Compute the geoMagnetic field elements and their time change
-        if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
-            returned = -9; // error
-        } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+static int WMM_GridBuild(float Lat, float Lon, float AltEllipsoid)
+{
+    int8_t i, j;
+
+    // centered on the lattice so that shifted and rebuilt grids have the same nodes
+    grid.centerLat = roundf(Lat / WMM_GRID_SPACING) * WMM_GRID_SPACING;
+    grid.centerLon = WMM_WrapLon(roundf(Lon / WMM_GRID_SPACING) * WMM_GRID_SPACING);
+    grid.alt       = AltEllipsoid;
+    grid.date      = decimal_date;
+    grid.rowOffset = 0;
+    grid.colOffset = 0;
+    grid.valid     = false;
+
+    for (i = 0; i < WMM_GRID_NODES; i++) {
+        for (j = 0; j < WMM_GRID_NODES; j++) {
+            if (WMM_GridFillNode(i, j) < 0) {
+                return -9; // error
+            }
         }
     }
+    grid.valid = true;
 
-    // ***********
-    // free allocated memory
+    return 0; // OK
+}
 
-    if (GeoMagneticElements) {
-        FREE(GeoMagneticElements);
-    }
+int WMM_GetGridMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3])
+{
+    // return '0' if all appears to be OK
+    // return < 0 if error
 
-    if (CoordGeodetic) {
-        FREE(CoordGeodetic);
+    if (Lat < -90.0f) {
+        return -1; // error
     }
-
-    if (CoordSpherical) {
-        FREE(CoordSpherical);
+    if (Lat > 90.0f) {
+        return -2; // error
+    }
+    if (Lon < -180.0f) {
+        return -3; // error
+    }
+    if (Lon > 180.0f) {
+        return -4; // error
+    }
+    if (WMM_DateToYear(Month, Day, Year) < 0) {
+        return -8; // error
     }
 
-    if (MagneticModel) {
-        FREE(MagneticModel);
-        MagneticModel = NULL;
+    // close to the poles the grid cells degenerate, use the model directly
+    if (fabsf(Lat) > 90.0f - WMM_GRID_NODES * WMM_GRID_SPACING) {
+        return WMM_FieldAt(Lat, Lon, AltEllipsoid, B);
     }
 
-    if (Ellip) {
-        FREE(Ellip);
-        Ellip = NULL;
+    if (!grid.valid || grid.date != decimal_date || fabsf(AltEllipsoid - grid.alt) > WMM_GRID_ALT_TOLERANCE) {
+        if (WMM_GridBuild(Lat, Lon, AltEllipsoid) < 0) {
+            return -9; // error
+        }
+    } else if (fabsf(Lat - grid.centerLat) > WMM_GRID_SPACING || fabsf(WMM_WrapLon(Lon - grid.centerLon)) > WMM_GRID_SPACING) {
+        // left the central cells, recenter on the nearest node
+        int di = (int)roundf((Lat - grid.centerLat) / WMM_GRID_SPACING);
+        int dj = (int)roundf(WMM_WrapLon(Lon - grid.centerLon) / WMM_GRID_SPACING);
+        if (abs(di) >= WMM_GRID_NODES || abs(dj) >= WMM_GRID_NODES) {
+            if (WMM_GridBuild(Lat, Lon, AltEllipsoid) < 0) {
+                return -9; // error
+            }
+        } else if (WMM_GridShift(di, dj) < 0) {
+            return -9; // error
+        }
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
+    // bilinear interpolation within the cell holding the location
+    float y  = (Lat - grid.centerLat) / WMM_GRID_SPACING + WMM_GRID_NODES / 2;
+    float x  = WMM_WrapLon(Lon - grid.centerLon) / WMM_GRID_SPACING + WMM_GRID_NODES / 2;
+    int8_t i = (int8_t)fminf(fmaxf(floorf(y), 0.0f), WMM_GRID_NODES - 2);
+    int8_t j = (int8_t)fminf(fmaxf(floorf(x), 0.0f), WMM_GRID_NODES - 2);
+    float ty = y - i;
+    float tx = x - j;
+
+    const float *sw = WMM_GridNode(i, j);
+    const float *se = WMM_GridNode(i, j + 1);
+    const float *nw = WMM_GridNode(i + 1, j);
+    const float *ne = WMM_GridNode(i + 1, j + 1);
+
+    for (uint8_t k = 0; k < 3; k++) {
+        B[k] = (1.0f - ty) * ((1.0f - tx) * sw[k] + tx * se[k]) + ty * ((1.0f - tx) * nw[k] + tx * ne[k]);
+    }
 
-    return returned;
+    return 0; // OK
 }
 
 int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements)
@@ -324,8 +435,8 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
 
    OUTPUT : GeoMagneticElements
 
-   CALLS:    WMM_ComputeSphericalHarmonicVariables( Ellip, CoordSpherical, TimedMagneticModel->nMax, &SphVariables); (Compute Spherical Harmonic variables  )
-   WMM_AssociatedLegendreFunction(CoordSpherical, TimedMagneticModel->nMax, LegendreFunction);       Compute ALF
+   CALLS:    WMM_ComputeSphericalHarmonicVariables( Ellip, CoordSpherical, TimedMagneticModel.nMax, &SphVariables); (Compute Spherical Harmonic variables  )
+   WMM_AssociatedLegendreFunction(CoordSpherical, TimedMagneticModel.nMax, LegendreFunction);       Compute ALF
    WMM_Summation(LegendreFunction, TimedMagneticModel, SphVariables, CoordSpherical, &MagneticResultsSph);  Accumulate the spherical harmonic coefficients
    WMM_SecVarSummation(LegendreFunction, TimedMagneticModel, SphVariables, CoordSpherical, &MagneticResultsSphVar); Sum the Secular Variation Coefficients
    WMM_RotateMagneticVector(CoordSpherical, CoordGeodetic, MagneticResultsSph, &MagneticResultsGeo); Map the computed Magnetic fields to Geodeitic coordinates
@@ -342,37 +453,26 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
     WMMtype_MagneticResults MagneticResultsSphVar;
     WMMtype_MagneticResults MagneticResultsGeoVar;
 
-    // ********
-    // allocate required memory
-
-    WMMtype_LegendreFunction *LegendreFunction = (WMMtype_LegendreFunction *)MALLOC(sizeof(WMMtype_LegendreFunction));
-    WMMtype_SphericalHarmonicVariables *SphVariables = (WMMtype_SphericalHarmonicVariables *)MALLOC(sizeof(WMMtype_SphericalHarmonicVariables));
-
-    if (!LegendreFunction || !SphVariables) {
-        returned = -1; // memory allocation error
-    }
-    // ********
-
     if (returned >= 0) { // Compute Spherical Harmonic variables
-        if (WMM_ComputeSphericalHarmonicVariables(CoordSpherical, MagneticModel->nMax, SphVariables) < 0) {
+        if (WMM_ComputeSphericalHarmonicVariables(CoordSpherical, MagneticModel.nMax, &SphVariables) < 0) {
             returned = -2; // error
         }
     }
 
     if (returned >= 0) { // Compute ALF
-        if (WMM_AssociatedLegendreFunction(CoordSpherical, MagneticModel->nMax, LegendreFunction) < 0) {
+        if (WMM_AssociatedLegendreFunction(CoordSpherical, MagneticModel.nMax, &LegendreFunction) < 0) {
             returned = -3; // error
         }
     }
 
     if (returned >= 0) { // Accumulate the spherical harmonic coefficients
-        if (WMM_Summation(LegendreFunction, SphVariables, CoordSpherical, &MagneticResultsSph) < 0) {
+        if (WMM_Summation(&LegendreFunction, &SphVariables, CoordSpherical, &MagneticResultsSph) < 0) {
             returned = -4; // error
         }
     }
 
     if (returned >= 0) { // Sum the Secular Variation Coefficients
-        if (WMM_SecVarSummation(LegendreFunction, SphVariables, CoordSpherical, &MagneticResultsSphVar) < 0) {
+        if (WMM_SecVarSummation(&LegendreFunction, &SphVariables, CoordSpherical, &MagneticResultsSphVar) < 0) {
             returned = -5; // error
         }
     }
@@ -401,19 +501,6 @@ int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *Co
         }
     }
 
-    // ********
-    // free allocated memory
-
-    if (SphVariables) {
-        FREE(SphVariables);
-    }
-
-    if (LegendreFunction) {
-        FREE(LegendreFunction);
-    }
-
-    // ********
-
     return returned;
 }
 
@@ -450,9 +537,9 @@ int WMM_ComputeSphericalHarmonicVariables(WMMtype_CoordSpherical *CoordSpherical
     /* for n = 0 ... model_order, compute (Radius of Earth / Spherica radius r)^(n+2)
        for n  1..nMax-1 (this is much faster than calling pow MAX_N+1 times).      */
 
-    SphVariables->RelativeRadiusPower[0] = (Ellip->re / CoordSpherical->r) * (Ellip->re / CoordSpherical->r);
+    SphVariables->RelativeRadiusPower[0] = (Ellip.re / CoordSpherical->r) * (Ellip.re / CoordSpherical->r);
     for (n = 1; n <= nMax; n++) {
-        SphVariables->RelativeRadiusPower[n] = SphVariables->RelativeRadiusPower[n - 1] * (Ellip->re / CoordSpherical->r);
+        SphVariables->RelativeRadiusPower[n] = SphVariables->RelativeRadiusPower[n - 1] * (Ellip.re / CoordSpherical->r);
     }
 
     /*
@@ -531,24 +618,25 @@ int WMM_Summation(WMMtype_LegendreFunction *LegendreFunction,
      */
 
     uint16_t m, n, index;
-    float cos_phi;
+    float cos_phi, g, h, gh;
 
     MagneticResults->Bz = 0.0f;
     MagneticResults->By = 0.0f;
     MagneticResults->Bx = 0.0f;
 
-    for (n = 1; n <= MagneticModel->nMax; n++) {
+    for (n = 1; n <= MagneticModel.nMax; n++) {
         for (m = 0; m <= n; m++) {
             index = (n * (n + 1) / 2 + m);
+            g     = WMM_get_main_field_coeff_g(index);
+            h     = WMM_get_main_field_coeff_h(index);
+            gh    = g * SphVariables->cos_mlambda[m] + h * SphVariables->sin_mlambda[m];
 
 /*		    nMax        (n+2)     n     m            m           m
         Bz =   -SUM (a/r)   (n+1) SUM  [g cosf(m p) + h sinf(m p)] P (sinf(phi))
                         n=1                   m=0   n            n           n  */
 /* Equation 12 in the WMM Technical report.  Derivative with respect to radius.*/
             MagneticResults->Bz -=
-                SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_main_field_coeff_g(index) *
-                 SphVariables->cos_mlambda[m] + WMM_get_main_field_coeff_h(index) * SphVariables->sin_mlambda[m])
+                SphVariables->RelativeRadiusPower[n] * gh
                 * (float)(n + 1) * LegendreFunction->Pcup[index];
 
 /*		  1 nMax  (n+2)    n     m            m           m
@@ -557,8 +645,7 @@ int WMM_Summation(WMMtype_LegendreFunction *LegendreFunction,
 /* Equation 11 in the WMM Technical report. Derivative with respect to longitude, divided by radius. */
             MagneticResults->By +=
                 SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_main_field_coeff_g(index) *
-                 SphVariables->sin_mlambda[m] - WMM_get_main_field_coeff_h(index) * SphVariables->cos_mlambda[m])
+                (g * SphVariables->sin_mlambda[m] - h * SphVariables->cos_mlambda[m])
                 * (float)(m) * LegendreFunction->Pcup[index];
 /*		   nMax  (n+2) n     m            m           m
         Bx = - SUM (a/r)   SUM  [g cosf(m p) + h sinf(m p)] dP (sinf(phi))
@@ -566,9 +653,7 @@ int WMM_Summation(WMMtype_LegendreFunction *LegendreFunction,
 /* Equation 10  in the WMM Technical report. Derivative with respect to latitude, divided by radius. */
 
             MagneticResults->Bx -=
-                SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_main_field_coeff_g(index) *
-                 SphVariables->cos_mlambda[m] + WMM_get_main_field_coeff_h(index) * SphVariables->sin_mlambda[m])
+                SphVariables->RelativeRadiusPower[n] * gh
                 * LegendreFunction->dPcup[index];
         }
     }
@@ -606,26 +691,27 @@ int WMM_SecVarSummation(WMMtype_LegendreFunction *LegendreFunction,
      */
 
     uint16_t m, n, index;
-    float cos_phi;
+    float cos_phi, g, h, gh;
 
-    MagneticModel->SecularVariationUsed = TRUE;
+    MagneticModel.SecularVariationUsed = TRUE;
 
     MagneticResults->Bz = 0.0f;
     MagneticResults->By = 0.0f;
     MagneticResults->Bx = 0.0f;
 
-    for (n = 1; n <= MagneticModel->nMaxSecVar; n++) {
+    for (n = 1; n <= MagneticModel.nMaxSecVar; n++) {
         for (m = 0; m <= n; m++) {
             index = (n * (n + 1) / 2 + m);
+            g     = WMM_get_secular_var_coeff_g(index);
+            h     = WMM_get_secular_var_coeff_h(index);
+            gh    = g * SphVariables->cos_mlambda[m] + h * SphVariables->sin_mlambda[m];
 
 /*		    nMax        (n+2)     n     m            m           m
         Bz =   -SUM (a/r)   (n+1) SUM  [g cosf(m p) + h sinf(m p)] P (sinf(phi))
                         n=1                   m=0   n            n           n  */
 /*  Derivative with respect to radius.*/
             MagneticResults->Bz -=
-                SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_secular_var_coeff_g(index) *
-                 SphVariables->cos_mlambda[m] + WMM_get_secular_var_coeff_h(index) * SphVariables->sin_mlambda[m])
+                SphVariables->RelativeRadiusPower[n] * gh
                 * (float)(n + 1) * LegendreFunction->Pcup[index];
 
 /*		  1 nMax  (n+2)    n     m            m           m
@@ -634,8 +720,7 @@ int WMM_SecVarSummation(WMMtype_LegendreFunction *LegendreFunction,
 /* Derivative with respect to longitude, divided by radius. */
             MagneticResults->By +=
                 SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_secular_var_coeff_g(index) *
-                 SphVariables->sin_mlambda[m] - WMM_get_secular_var_coeff_h(index) * SphVariables->cos_mlambda[m])
+                (g * SphVariables->sin_mlambda[m] - h * SphVariables->cos_mlambda[m])
                 * (float)(m) * LegendreFunction->Pcup[index];
 /*		   nMax  (n+2) n     m            m           m
         Bx = - SUM (a/r)   SUM  [g cosf(m p) + h sinf(m p)] dP (sinf(phi))
@@ -643,9 +728,7 @@ int WMM_SecVarSummation(WMMtype_LegendreFunction *LegendreFunction,
 /* Derivative with respect to latitude, divided by radius. */
 
             MagneticResults->Bx -=
-                SphVariables->RelativeRadiusPower[n] *
-                (WMM_get_secular_var_coeff_g(index) *
-                 SphVariables->cos_mlambda[m] + WMM_get_secular_var_coeff_h(index) * SphVariables->sin_mlambda[m])
+                SphVariables->RelativeRadiusPower[n] * gh
                 * LegendreFunction->dPcup[index];
         }
     }
@@ -814,21 +897,13 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     uint16_t k, kstart, m, n;
     float pm2, pm1, pmm, plm, rescalem, z, scalef;
 
-    float *f1     = (float *)MALLOC(sizeof(float) * NUMPCUP);
-    float *f2     = (float *)MALLOC(sizeof(float) * NUMPCUP);
-    float *PreSqr = (float *)MALLOC(sizeof(float) * NUMPCUP);
-
-    if (!PreSqr || !f2 || !f1) { // memory allocation error
-        if (PreSqr) {
-            FREE(PreSqr);
-        }
-        if (f2) {
-            FREE(f2);
-        }
-        if (f1) {
-            FREE(f1);
-        }
+    // only depend on nMax, computed on first use
+    static float f1[NUMPCUP];
+    static float f2[NUMPCUP];
+    static float PreSqr[NUMPCUP];
+    static uint16_t factorsMax = 0;
 
+    if (2 * nMax + 1 >= NUMPCUP) {
         return -1;
     }
 
@@ -837,10 +912,6 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
      * Was: if (fabs(x) == 1.0)
      */
     if (fabsf(x) - 1.0f < 1e-9f) {
-        FREE(PreSqr);
-        FREE(f2);
-        FREE(f1);
-
         // printf("Error in PcupHigh: derivative cannot be calculated at poles\n");
         return -2;
     }
@@ -849,22 +920,25 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
      * it to 0.0f, which is bad as the code below divides by scalef. */
     scalef = 1.0e-20f;
 
-    for (n = 0; n <= 2 * nMax + 1; ++n) {
-        PreSqr[n] = sqrtf((float)(n));
-    }
+    if (factorsMax != nMax) {
+        for (n = 0; n <= 2 * nMax + 1; ++n) {
+            PreSqr[n] = sqrtf((float)(n));
+        }
 
-    k = 2;
+        k = 2;
 
-    for (n = 2; n <= nMax; n++) {
-        k     = k + 1;
-        f1[k] = (float)(2 * n - 1) / (float)(n);
-        f2[k] = (float)(n - 1) / (float)(n);
-        for (m = 1; m <= n - 2; m++) {
+        for (n = 2; n <= nMax; n++) {
             k     = k + 1;
-            f1[k] = (float)(2 * n - 1) / PreSqr[n + m] / PreSqr[n - m];
-            f2[k] = PreSqr[n - m - 1] * PreSqr[n + m - 1] / PreSqr[n + m] / PreSqr[n - m];
+            f1[k] = (float)(2 * n - 1) / (float)(n);
+            f2[k] = (float)(n - 1) / (float)(n);
+            for (m = 1; m <= n - 2; m++) {
+                k     = k + 1;
+                f1[k] = (float)(2 * n - 1) / PreSqr[n + m] / PreSqr[n - m];
+                f2[k] = PreSqr[n - m - 1] * PreSqr[n + m - 1] / PreSqr[n + m] / PreSqr[n - m];
+            }
+            k = k + 2;
         }
-        k = k + 2;
+        factorsMax = nMax;
     }
 
     /*z = sinf (geocentric latitude) */
@@ -873,9 +947,6 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     Pcup[0]  = 1.0f;
     dPcup[0] = 0.0f;
     if (nMax == 0) {
-        FREE(PreSqr);
-        FREE(f2);
-        FREE(f1);
         return -3;
     }
     pm1      = x;
@@ -928,15 +999,6 @@ int WMM_PcupHigh(float *Pcup, float *dPcup, float x, uint16_t nMax)
     Pcup[kstart]  = pmm * rescalem;
     dPcup[kstart] = -(float)(nMax) * x * Pcup[kstart] / z;
 
-    // *********
-    // free allocated memory
-
-    FREE(PreSqr);
-    FREE(f2);
-    FREE(f1);
-
-    // *********
-
     return 0; // OK
 }
 
@@ -968,9 +1030,11 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
     uint16_t n, m, index, index1, index2;
     float k, z;
 
-    float *schmidtQuasiNorm = (float *)MALLOC(sizeof(float) * NUMPCUP);
+    // only depends on nMax, computed on first use
+    static float schmidtQuasiNorm[NUMPCUP];
+    static uint16_t normMax = 0;
 
-    if (!schmidtQuasiNorm) { // memory allocation error
+    if (nMax * (nMax + 3) / 2 >= NUMPCUP) {
         return -1;
     }
 
@@ -1011,18 +1075,21 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
    functions and the Schmidt quasi-normalized version. This is equivalent to
    sqrt((m==0?1:2)*(n-m)!/(n+m!))*(2n-1)!!/(n-m)!  */
 
-    schmidtQuasiNorm[0] = 1.0f;
-    for (n = 1; n <= nMax; n++) {
-        index  = (n * (n + 1) / 2);
-        index1 = (n - 1) * n / 2;
-        /* for m = 0 */
-        schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * (float)(2 * n - 1) / (float)n;
-
-        for (m = 1; m <= n; m++) {
-            index  = (n * (n + 1) / 2 + m);
-            index1 = (n * (n + 1) / 2 + m - 1);
-            schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * sqrtf((float)((n - m + 1) * (m == 1 ? 2 : 1)) / (float)(n + m));
+    if (normMax != nMax) {
+        schmidtQuasiNorm[0] = 1.0f;
+        for (n = 1; n <= nMax; n++) {
+            index  = (n * (n + 1) / 2);
+            index1 = (n - 1) * n / 2;
+            /* for m = 0 */
+            schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * (float)(2 * n - 1) / (float)n;
+
+            for (m = 1; m <= n; m++) {
+                index  = (n * (n + 1) / 2 + m);
+                index1 = (n * (n + 1) / 2 + m - 1);
+                schmidtQuasiNorm[index] = schmidtQuasiNorm[index1] * sqrtf((float)((n - m + 1) * (m == 1 ? 2 : 1)) / (float)(n + m));
+            }
         }
+        normMax = nMax;
     }
 
 /* Converts the  Gauss-normalized associated Legendre
@@ -1039,8 +1106,6 @@ int WMM_PcupLow(float *Pcup, float *dPcup, float x, uint16_t nMax)
         }
     }
 
-    FREE(schmidtQuasiNorm);
-
     return 0; // OK
 }
 
@@ -1063,18 +1128,15 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
+    float PcupS[NUMPCUPS];
 
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
     MagneticResults->By = 0.0f;
     sin_phi = sinf(DEG2RAD(CoordSpherical->phig));
 
-    for (n = 1; n <= MagneticModel->nMax; n++) {
+    for (n = 1; n <= MagneticModel.nMax; n++) {
         /*Compute the ration between the Gauss-normalized associated Legendre
            functions and the Schmidt quasi-normalized version. This is equivalent to
            sqrt((m==0?1:2)*(n-m)!/(n+m!))*(2n-1)!!/(n-m)!  */
@@ -1102,8 +1164,6 @@ int WMM_SummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
@@ -1125,18 +1185,15 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
     float schmidtQuasiNorm2;
     float schmidtQuasiNorm3;
 
-    float *PcupS = (float *)MALLOC(sizeof(float) * NUMPCUPS);
+    float PcupS[NUMPCUPS];
 
-    if (!PcupS) {
-        return -1; // memory allocation error
-    }
     PcupS[0] = 1;
     schmidtQuasiNorm1   = 1.0f;
 
     MagneticResults->By = 0.0f;
     sin_phi = sinf(DEG2RAD(CoordSpherical->phig));
 
-    for (n = 1; n <= MagneticModel->nMaxSecVar; n++) {
+    for (n = 1; n <= MagneticModel.nMaxSecVar; n++) {
         index = (n * (n + 1) / 2 + 1);
         schmidtQuasiNorm2 = schmidtQuasiNorm1 * (float)(2 * n - 1) / (float)n;
         schmidtQuasiNorm3 = schmidtQuasiNorm2 * sqrtf((float)(n * 2) / (float)(n + 1));
@@ -1160,13 +1217,22 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
             * PcupS[n] * schmidtQuasiNorm3;
     }
 
-    FREE(PcupS);
-
     return 0; // OK
 }
 
 /**
- * @brief Comput the MainFieldCoeffH accounting for the date
+ * @brief Index range of the main field coefficients that get the secular variation applied
+ */
+static bool WMM_has_secular_var(uint16_t index)
+{
+    uint16_t a = MagneticModel.nMaxSecVar;
+    uint16_t b = (a * (a + 1) / 2 + a);
+
+    return index > 0 && index <= MagneticModel.nMax * (MagneticModel.nMax + 3) / 2 && index <= b;
+}
+
+/**
+ * @brief Comput the MainFieldCoeffG accounting for the date
  */
 float WMM_get_main_field_coeff_g(uint16_t index)
 {
@@ -1174,54 +1240,28 @@ float WMM_get_main_field_coeff_g(uint16_t index)
         return 0;
     }
 
-    uint16_t n, m, sum_index, a, b;
-
     float coeff = CoeffFile[index][2];
 
-    a = MagneticModel->nMaxSecVar;
-    b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_g(sum_index);
-            }
-        }
+    if (WMM_has_secular_var(index)) {
+        coeff += (decimal_date - MagneticModel.epoch) * WMM_get_secular_var_coeff_g(index);
     }
 
     return coeff;
 }
 
+/**
+ * @brief Comput the MainFieldCoeffH accounting for the date
+ */
 float WMM_get_main_field_coeff_h(uint16_t index)
 {
     if (index >= NUMTERMS) {
         return 0;
     }
 
-    uint16_t n, m, sum_index, a, b;
     float coeff = CoeffFile[index][3];
 
-    a = MagneticModel->nMaxSecVar;
-    b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_h(sum_index);
-            }
-        }
+    if (WMM_has_secular_var(index)) {
+        coeff += (decimal_date - MagneticModel.epoch) * WMM_get_secular_var_coeff_h(index);
     }
 
     return coeff;
@@ -1289,12 +1329,12 @@ int WMM_GeodeticToSpherical(WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_CoordS
     SinLat = sinf(DEG2RAD(CoordGeodetic->phi));
 
     // compute the local radius of curvature on the WGS-84 reference ellipsoid
-    rc     = Ellip->a / sqrtf(1.0f - Ellip->epssq * SinLat * SinLat);
+    rc     = Ellip.a / sqrtf(1.0f - Ellip.epssq * SinLat * SinLat);
 
     // compute ECEF Cartesian coordinates of specified point (for longitude=0)
 
     xp = (rc + CoordGeodetic->HeightAboveEllipsoid) * CosLat;
-    zp = (rc * (1.0f - Ellip->epssq) + CoordGeodetic->HeightAboveEllipsoid) * SinLat;
+    zp = (rc * (1.0f - Ellip.epssq) + CoordGeodetic->HeightAboveEllipsoid) * SinLat;
 
     // compute spherical radius and angle lambda and phi of specified point
 
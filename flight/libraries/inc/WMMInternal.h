@@ -37,6 +37,11 @@
 #define NUMPCUP                                 92              // NUMTERMS +1
 #define NUMPCUPS                                13             // WMM_MAX_MODEL_DEGREES +1
 
+// field grid of WMM_GetGridMagVector()
+#define WMM_GRID_NODES                          5              // nodes per side, odd so the center is a node
+#define WMM_GRID_SPACING                        0.5f           // degrees between nodes
+#define WMM_GRID_ALT_TOLERANCE                  1000.0f        // meters the altitude may change before the grid is rebuilt
+
 // internal structure definitions
 typedef struct {
     float EditionDate;
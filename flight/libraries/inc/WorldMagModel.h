@@ -30,5 +30,8 @@
 // Exposed Function Prototypes
 int WMM_Initialize();
 int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+// Interpolated from a small grid of field values kept around the last location, which is
+// moved along incrementally. Cheaper than WMM_GetMagVector() for repeated calls nearby.
+int WMM_GetGridMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
 
 #endif /* WORLDMAGMODEL_H_ */
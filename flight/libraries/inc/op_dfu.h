@@ -70,8 +70,11 @@ typedef enum {
     Download_Req, // 9
     Download, // 10
     Status_Request, // 11
-    Status_Rep
-// 12
+    Status_Rep, // 12
+    Req_SectorCrc, // 13
+    Rep_SectorCrc, // 14
+    Erase_Sector
+// 15
 } DFUCommands;
 
 typedef enum {
@@ -82,7 +85,8 @@ typedef enum {
 /**************************************************/
 typedef enum {
     FW, // 0
-    Descript
+    Descript, // 1
+    FW_Differential
 // 2
 } DFUTransfer;
 /**************************************************/
@@ -112,6 +116,12 @@ typedef enum {
 #define MAX_DEL_RETRYS 3
 #define MAX_WRI_RETRYS 3
 
+/* Capability flags sent with the device capabilities */
+#define DFU_CAPABILITY_DIFFERENTIAL 0x01
+
+/* Sectors reported per Rep_SectorCrc packet */
+#define SECTOR_CRC_ENTRIES          6
+
 typedef struct {
     uint8_t    programmingType;
     uint8_t    readWriteFlags;
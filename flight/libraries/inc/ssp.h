@@ -37,6 +37,11 @@
 #define SSP_RX_ACK        6
 #define SSP_RX_SYNCH      7
 
+// selective repeat window, negotiated during ssp_Synchronise()
+#define SSP_WINDOW_MAX    8 // upper limit on packets in flight, must stay well below half the sequence space
+// bytes of window storage needed for 'window' packets with up to 'bufSize' data bytes each
+#define SSP_WINDOW_BUF_SIZE(window, bufSize) ((window) * ((bufSize) + 4))
+
 typedef enum decodeState_ {
     decode_len1_e = 0,
     decode_seqNo_e,
@@ -57,6 +62,12 @@ typedef struct {
     uint8_t  seqNo;
 } Packet_t;
 
+typedef struct {
+    uint32_t timeout; // when this slot times out
+    uint8_t  retryCount; // how many times the slot has been sent
+    uint8_t  full; // tx: sent and not yet acked, rx: received out of order and not yet delivered
+} WindowSlot_t;
+
 typedef struct {
     uint8_t  *rxBuf; // Buffer used to store rcv data
     uint16_t rxBufSize; // rcv buffer size.
@@ -68,6 +79,9 @@ typedef struct {
     int16_t (*pfSerialRead)(void); // function to call to read a byte from serial hardware
     void (*pfSerialWrite)(uint8_t); // function used to write a byte to serial hardware for transmission
     uint32_t (*pfGetTime)(void); // function returns time in number of seconds that has elapsed from a given reference point
+    uint8_t  windowSize; // packets that may be in flight, 0 = never offer a window (plain stop and wait)
+    uint8_t  *txWindowBuf; // SSP_WINDOW_BUF_SIZE(windowSize, txBufSize) bytes, NULL = send stop and wait
+    uint8_t  *rxWindowBuf; // SSP_WINDOW_BUF_SIZE(windowSize, rxBufSize) bytes, NULL = receive stop and wait
 } PortConfig_t;
 
 typedef struct Port_tag {
@@ -99,6 +113,17 @@ typedef struct Port_tag {
     uint32_t RxError;
     uint32_t TxError;
     uint16_t flags;
+    // selective repeat state, only used when both ends offered a window during synchronisation
+    uint8_t  windowSize; // configured number of window slots
+    uint8_t  *txWindowBuf; // packet copies kept for retransmission
+    uint8_t  *rxWindowBuf; // packets received ahead of a missing one
+    uint8_t  txWindow; // negotiated send window, 1 = stop and wait
+    uint8_t  rxWindow; // active receive window, 1 = stop and wait
+    uint8_t  txCount; // packets in flight
+    uint8_t  txBaseSlot; // slot of the oldest packet in flight
+    uint8_t  rxBaseSlot; // slot of the next packet to deliver
+    WindowSlot_t txSlots[SSP_WINDOW_MAX];
+    WindowSlot_t rxSlots[SSP_WINDOW_MAX];
 } Port_t;
 
 /** Public Data **/
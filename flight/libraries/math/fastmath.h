@@ -0,0 +1,193 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilot Math Utilities
+ * @{
+ * @addtogroup Reuseable math functions
+ * @{
+ *
+ * @file       fastmath.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Polynomial trigonometric functions for the control loops
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#include <math.h>
+#include <stdint.h>
+#include <pios_math.h>
+
+/*
+ * Minimax polynomials in place of the newlib functions, which work in double
+ * precision internally and cost several microseconds each on the F4.
+ * The polynomial coefficients were fitted with the Remez algorithm, the error
+ * bounds below include float rounding and are checked by flight/tests/math.
+ *
+ *   fast_sinf, fast_cosf, fast_sincosf   |error| < 3e-7           for |x| < 1e4 rad
+ *   fast_atan2f                           |error| < 6e-7 rad       finite x, y
+ *   fast_asinf                            |error| < 6e-7 rad       x clamped to [-1, 1]
+ */
+
+// sin(x) ~ x * P(x^2) on [-pi/2, pi/2], polynomial error 3.4e-9.
+// C1 is one ulp below 1.0f so that the result never exceeds +-1 (acosf() of it stays defined)
+#define FASTMATH_SIN_C1 0.99999994f
+#define FASTMATH_SIN_C3 -0.166666476f
+#define FASTMATH_SIN_C5 0.00833289982f
+#define FASTMATH_SIN_C7 -0.000198008978f
+#define FASTMATH_SIN_C9 2.5904885e-06f
+
+// atan(x) ~ x * P(x^2) on [-1, 1], polynomial error 2.5e-7
+#define FASTMATH_ATAN_C1  0.999996112f
+#define FASTMATH_ATAN_C3  -0.333173681f
+#define FASTMATH_ATAN_C5  0.198078156f
+#define FASTMATH_ATAN_C7  -0.132333421f
+#define FASTMATH_ATAN_C9  0.0796236724f
+#define FASTMATH_ATAN_C11 -0.0336042206f
+#define FASTMATH_ATAN_C13 0.00681179329f
+
+// 2pi split in an exactly representable part and the rest, for the range reduction
+#define FASTMATH_2PI_HI   6.28125f
+#define FASTMATH_2PI_LO   0.0019353071795864769f
+// past this the turn count would not fit the int32 conversion, float has no fraction of a turn left there anyway
+#define FASTMATH_REDUCE_MAX 1e9f
+
+// sin(x) for x in [-pi/2, pi/2]
+static inline float fast_sinf_core(float x)
+{
+    float x2 = x * x;
+
+    return x * (FASTMATH_SIN_C1 + x2 * (FASTMATH_SIN_C3 + x2 * (FASTMATH_SIN_C5 + x2 * (FASTMATH_SIN_C7 + x2 * FASTMATH_SIN_C9))));
+}
+
+// atan(x) for x in [-1, 1]
+static inline float fast_atanf_core(float x)
+{
+    float x2 = x * x;
+
+    return x * (FASTMATH_ATAN_C1 + x2 * (FASTMATH_ATAN_C3 + x2 * (FASTMATH_ATAN_C5 + x2 * (FASTMATH_ATAN_C7
+                                                                                          + x2 * (FASTMATH_ATAN_C9 + x2 * (FASTMATH_ATAN_C11 + x2 * FASTMATH_ATAN_C13))))));
+}
+
+// x reduced to [-pi, pi], NaN for NaN or infinite x
+static inline float fast_reduce_angle(float x)
+{
+    // the int32 conversion is undefined for NaN and huge angles, fmodf takes those
+    if (!(fabsf(x) < FASTMATH_REDUCE_MAX)) {
+        x = fmodf(x, M_2PI_F);
+        if (isnan(x)) {
+            return x;
+        }
+    }
+
+    float k = (float)(int32_t)(x * (1.0f / M_2PI_F) + (x >= 0.0f ? 0.5f : -0.5f));
+
+    return (x - k * FASTMATH_2PI_HI) - k * FASTMATH_2PI_LO;
+}
+
+/**
+ * Sine and cosine of the same angle, cheaper than calling both
+ * @param[in] x Angle in radians
+ * @param[out] s sin(x)
+ * @param[out] c cos(x)
+ */
+static inline void fast_sincosf(float x, float *s, float *c)
+{
+    float r = fast_reduce_angle(x);
+
+    // cos(r) = sin(pi/2 - |r|), which is within [-pi/2, pi/2] already
+    *c = fast_sinf_core(M_PI_2_F - fabsf(r));
+
+    // fold into [-pi/2, pi/2], sin(r) = sin(pi - r)
+    if (r > M_PI_2_F) {
+        r = M_PI_F - r;
+    } else if (r < -M_PI_2_F) {
+        r = -M_PI_F - r;
+    }
+    *s = fast_sinf_core(r);
+}
+
+/**
+ * @param[in] x Angle in radians
+ * @returns sin(x)
+ */
+static inline float fast_sinf(float x)
+{
+    float r = fast_reduce_angle(x);
+
+    if (r > M_PI_2_F) {
+        r = M_PI_F - r;
+    } else if (r < -M_PI_2_F) {
+        r = -M_PI_F - r;
+    }
+    return fast_sinf_core(r);
+}
+
+/**
+ * @param[in] x Angle in radians
+ * @returns cos(x)
+ */
+static inline float fast_cosf(float x)
+{
+    return fast_sinf_core(M_PI_2_F - fabsf(fast_reduce_angle(x)));
+}
+
+/**
+ * Four quadrant arc tangent, like atan2f(). Returns 0 for (0, 0).
+ * @returns angle of (x, y) in radians, in [-pi, pi]
+ */
+static inline float fast_atan2f(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float a;
+
+    if (ax == 0.0f && ay == 0.0f) {
+        return 0.0f;
+    }
+
+    // keep the polynomial argument within [-1, 1]
+    if (ay > ax) {
+        a = M_PI_2_F - fast_atanf_core(ax / ay);
+    } else {
+        a = fast_atanf_core(ay / ax);
+    }
+    if (x < 0.0f) {
+        a = M_PI_F - a;
+    }
+    return (y < 0.0f) ? -a : a;
+}
+
+/**
+ * Arc sine, with the argument clamped to [-1, 1] instead of returning NaN
+ * for values just outside due to rounding.
+ * @returns asin(x) in radians
+ */
+static inline float fast_asinf(float x)
+{
+    if (x > 1.0f) {
+        x = 1.0f;
+    } else if (x < -1.0f) {
+        x = -1.0f;
+    }
+    return fast_atan2f(x, sqrtf((1.0f - x) * (1.0f + x)));
+}
+
+#endif /* FASTMATH_H */
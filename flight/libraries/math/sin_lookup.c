@@ -6,8 +6,9 @@
  * @{
  *
  * @file       sin_lookup.c
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
- * @brief      Sine lookup table from flash with 1 degree resolution
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ *             The OpenPilot Team, http://www.openpilot.org Copyright (C) 2012.
+ * @brief      Sine and cosine, from a lookup table with 1 degree resolution without FPU
  *
  * @see        The GNU Public License (GPL) Version 3
  *
@@ -33,10 +34,15 @@
 #include "stdbool.h"
 #include "stdint.h"
 #include <pios_math.h>
+#include "fastmath.h"
 
-#define FLASH_TABLE
-#ifdef FLASH_TABLE
-/** Version of the code which precomputes the lookup table in flash **/
+/*
+ * On the FPU targets the polynomials of fastmath.h are about as fast as the
+ * table, need no flash for it and are accurate to 3e-7. The targets without
+ * FPU (CC3D) keep the table, a software float polynomial costs far more
+ * than rounding to whole degrees and one load.
+ */
+#ifdef __SOFTFP__
 
 // This is a precomputed sin lookup table over 90 degrees that
 const float sin_table[] = {
@@ -65,33 +71,6 @@ int sin_lookup_initalize()
     return 0;
 }
 
-#else /* ifdef FLASH_TABLE */
-/** Version of the code which allocates the lookup table in heap **/
-
-const int SIN_RESOLUTION = 180;
-
-static float *sin_table;
-int sin_lookup_initalize()
-{
-    // Previously initialized
-    if (sin_table) {
-        return 0;
-    }
-
-    sin_table = (float *)pios_malloc(sizeof(float) * SIN_RESOLUTION);
-    if (sin_table == NULL) {
-        return -1;
-    }
-
-    for (uint32_t i = 0; i < 180; i++) {
-        sin_table[i] = sinf(DEG2RAD((float)i));
-    }
-
-    return 0;
-}
-
-#endif /* ifdef FLASH_TABLE */
-
 /**
  * Use the lookup table to return sine(angle) where angle is in radians
  * to save flash this cheats and uses trig functions to only save
@@ -101,25 +80,23 @@ int sin_lookup_initalize()
  */
 float sin_lookup_deg(float angle)
 {
-    if (sin_table == NULL) {
-        return 0;
+    // the int32 conversion below is undefined for NaN and huge angles
+    if (!(fabsf(angle) < 1e9f)) {
+        angle = fmodf(angle, 360.0f);
+        if (isnan(angle)) {
+            return angle;
+        }
     }
 
-    // <bug, was> int i_ang = ((int32_t)angle) % 360;
     // 1073741760 is a multiple of 360 that is close to 0x3fffffff
     // so angle can be a very large number of positive or negative rotations
-    // this is the fastest fix (no tests, one integer addition)
-    // and has the largest range since float mantissas are 23-4 bit
-    // we could halve the lookup table size
-    // we could interpolate for greater accuracy
     int i_ang = ((int32_t)(angle + 0.5f) + (int32_t)1073741760) % 360;
+
     if (i_ang >= 180) { // for 180 to 360 deg
         return -sin_table[i_ang - 180];
     } else { // for 0 to 179 deg
         return sin_table[i_ang];
     }
-
-    return 0;
 }
 
 /**
@@ -155,3 +132,48 @@ float cos_lookup_rad(float angle)
 
     return cos_lookup_deg(degrees);
 }
+
+#else /* ifdef __SOFTFP__ */
+
+int sin_lookup_initalize()
+{
+    return 0;
+}
+
+/**
+ * @param[in] angle Angle in degrees
+ * @returns sin(angle)
+ */
+float sin_lookup_deg(float angle)
+{
+    return fast_sinf(DEG2RAD(angle));
+}
+
+/**
+ * @param[in] angle Angle in degrees
+ * @returns cos(angle)
+ */
+float cos_lookup_deg(float angle)
+{
+    return fast_cosf(DEG2RAD(angle));
+}
+
+/**
+ * @param[in] angle Angle in radians
+ * @returns sin(angle)
+ */
+float sin_lookup_rad(float angle)
+{
+    return fast_sinf(angle);
+}
+
+/**
+ * @param[in] angle Angle in radians
+ * @returns cos(angle)
+ */
+float cos_lookup_rad(float angle)
+{
+    return fast_cosf(angle);
+}
+
+#endif /* ifdef __SOFTFP__ */
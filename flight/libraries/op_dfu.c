@@ -75,6 +75,7 @@ extern int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len);
 static uint32_t baseOfAdressType(uint8_t type);
 static uint8_t isBiggerThanAvailable(uint8_t type, uint32_t size);
 static void OPDfuIni(uint8_t discover);
+static void sectorCrcReply(uint32_t offset, uint8_t *reply);
 bool flash_read(uint8_t *buffer, uint32_t adr, DFUProgType type);
 /* Private functions ---------------------------------------------------------*/
 void sendData(uint8_t *buf, uint16_t size);
@@ -201,6 +202,7 @@ void processComand(uint8_t *xReceive_Buffer)
                     Aditionals  = (uint32_t)Command;
                 } else {
                     uint8_t result = 1;
+                    // a differential transfer erases the sectors it rewrites with Erase_Sector
                     if (TransferType == FW) {
                         switch (currentProgrammingDestination) {
                         case Self_flash:
@@ -221,10 +223,12 @@ void processComand(uint8_t *xReceive_Buffer)
                     }
                 }
             } else if ((StartFlag != 1) && (Next_Packet != 0)) {
-                if (Count > SizeOfTransfer) {
+                if (Count >= SizeOfTransfer) {
                     DeviceState = too_many_packets;
                     Aditionals  = Count;
-                } else if (Count == Next_Packet - 1) {
+                } else if ((Count == Next_Packet - 1)
+                           || ((TransferType == FW_Differential) && (Count > Next_Packet - 1))) {
+                    // a differential transfer skips the packets of unchanged sectors
                     uint8_t numberOfWords = 14;
                     if (Count == SizeOfTransfer - 1) { // is this the last packet?
                         numberOfWords = SizeOfLastPacket;
@@ -240,6 +244,12 @@ void processComand(uint8_t *xReceive_Buffer)
                             aux    = baseOfAdressType(TransferType) + (uint32_t)(
                                 Count * 14 * 4 + x * 4);
                             result = 0;
+                            // packets crossing into an unchanged sector, and the 0xFF words of an erased one
+                            if ((TransferType == FW_Differential)
+                                && (*(uint32_t *)PIOS_BL_HELPER_FLASH_If_Read(aux) == Data)) {
+                                result = 1;
+                                continue;
+                            }
                             for (int retry = 0; retry < MAX_WRI_RETRYS; ++retry) {
                                 if (result == 0) {
                                     result = (FLASH_ProgramWord(aux, Data)
@@ -260,7 +270,7 @@ void processComand(uint8_t *xReceive_Buffer)
                         Aditionals  = (uint32_t)Command;
                     }
 
-                    ++Next_Packet;
+                    Next_Packet = Count + 2;
                 } else {
                     DeviceState = wrong_packet_received;
                     Aditionals  = Count;
@@ -298,9 +308,25 @@ void processComand(uint8_t *xReceive_Buffer)
             pack_uint32(devicesTable[Data0 - 1].FW_Crc, &Buffer[10]);
             Buffer[14] = devicesTable[Data0 - 1].devID >> 8;
             Buffer[15] = devicesTable[Data0 - 1].devID;
+            Buffer[16] = DFU_CAPABILITY_DIFFERENTIAL;
         }
         sendData(Buffer + 1, 63);
         break;
+    case Req_SectorCrc:
+        Buffer[0] = 0x01;
+        Buffer[1] = Rep_SectorCrc;
+        sectorCrcReply(Count, &Buffer[2]);
+        sendData(Buffer + 1, 63);
+        break;
+    case Erase_Sector:
+        // only while a differential transfer is running, Count is the offset in the partition
+        if ((DeviceState != uploading) || (TransferType != FW_Differential)
+            || (Count >= currentDevice.sizeOfCode + currentDevice.sizeOfDescription)
+            || (PIOS_BL_HELPER_FLASH_Erase_Sector(baseOfAdressType(FW) + Count) != 1)) {
+            DeviceState = Last_operation_failed;
+            Aditionals  = (uint32_t)Command;
+        }
+        break;
     case JumpFW:
         if (Data == 0x5AFE) {
             /* Force board into safe mode */
@@ -324,9 +350,10 @@ void processComand(uint8_t *xReceive_Buffer)
 
     case Op_END:
         if (DeviceState == uploading) {
-            if (Next_Packet - 1 == SizeOfTransfer) {
+            // a differential transfer may leave out trailing packets, the CRC tells if it is complete
+            if ((Next_Packet - 1 == SizeOfTransfer) || (TransferType == FW_Differential)) {
                 Next_Packet = 0;
-                if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
+                if (((TransferType != FW) && (TransferType != FW_Differential)) || (Expected_CRC == CalcFirmCRC())) {
                     DeviceState = Last_operation_Success;
                 } else {
                     DeviceState = CRC_Fail;
@@ -410,6 +437,7 @@ uint32_t baseOfAdressType(DFUTransfer type)
 {
     switch (type) {
     case FW:
+    case FW_Differential:
         return currentDevice.startOfUserCode;
 
         break;
@@ -426,6 +454,7 @@ uint8_t isBiggerThanAvailable(DFUTransfer type, uint32_t size)
 {
     switch (type) {
     case FW:
+    case FW_Differential:
         return (size > currentDevice.sizeOfCode) ? 1 : 0;
 
         break;
@@ -438,6 +467,39 @@ uint8_t isBiggerThanAvailable(DFUTransfer type, uint32_t size)
     }
 }
 
+/**
+ * Fill a Rep_SectorCrc reply with the CRCs of the sectors from offset on
+ *
+ * The sectors cover the firmware and description partition, the last one is
+ * cut at its end. Reply layout: offset of the first sector, the number of
+ * sectors, then size and CRC of each sector. No sectors past the end.
+ */
+static void sectorCrcReply(uint32_t offset, uint8_t *reply)
+{
+    uint32_t base = baseOfAdressType(FW);
+    uint32_t end  = currentDevice.sizeOfCode + currentDevice.sizeOfDescription;
+    uint32_t sectorStart;
+    uint32_t sectorSize;
+    uint8_t entries = 0;
+
+    if ((offset < end) && PIOS_BL_HELPER_FLASH_Sector_Info(base + offset, &sectorStart, &sectorSize)) {
+        offset = sectorStart - base;
+    }
+    pack_uint32(offset, &reply[0]);
+    while ((entries < SECTOR_CRC_ENTRIES) && (offset < end)
+           && PIOS_BL_HELPER_FLASH_Sector_Info(base + offset, &sectorStart, &sectorSize)) {
+        uint32_t size = sectorStart + sectorSize - (base + offset);
+        if (size > end - offset) {
+            size = end - offset;
+        }
+        pack_uint32(size, &reply[5 + entries * 8]);
+        pack_uint32(PIOS_BL_HELPER_CRC_Block_Calc(base + offset, size), &reply[9 + entries * 8]);
+        offset += size;
+        ++entries;
+    }
+    reply[4] = entries;
+}
+
 uint32_t CalcFirmCRC()
 {
     switch (currentProgrammingDestination) {
@@ -74,6 +74,18 @@ int check_syndrome (void);
 void decode_data (unsigned char data[], int nbytes);
 void encode_data (unsigned char msg[], int nbytes, unsigned char dst[]);
 
+/* Encoder generator polynomial */
+extern int genPoly[MAXDEG*2];
+
+/* Table driven encoder and error check, see rstable.c */
+#define RS_DECODE_OK        0  /* no errors */
+#define RS_DECODE_CORRECTED 1  /* errors were found and corrected */
+#define RS_DECODE_FAILED    -1 /* errors were found and could not be corrected */
+
+void init_rs_tables (void);
+void rs_encode_packet (unsigned char data[], int nbytes);
+int rs_decode_packet (unsigned char codeword[], int csize);
+
 /* CRC-CCITT checksum generator */
 BIT16 crc_ccitt(unsigned char *msg, int len);
 
@@ -3,7 +3,7 @@
 #
 
 RSCODE_DIR	:=	$(dir $(lastword $(MAKEFILE_LIST)))
-RSCODE_SRC	:=	berlekamp.c crcgen.c galois.c rs.c
+RSCODE_SRC	:=	berlekamp.c crcgen.c galois.c rs.c rstable.c
 
 SRC		+=	$(addprefix $(RSCODE_DIR),$(RSCODE_SRC))
 EXTRAINCDIRS	+=	$(RSCODE_DIR)
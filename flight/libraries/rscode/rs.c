@@ -52,6 +52,9 @@ initialize_ecc ()
 
     /* Compute the encoder generator polynomial */
     compute_genpoly(RS_ECC_NPARITY, genPoly);
+
+    /* And the tables of the table driven encoder */
+    init_rs_tables();
 }
 
 void
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rstable.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Table driven Reed Solomon encoder and error check.
+ *
+ *             Produces the same codewords as encode_data(), and only falls
+ *             back to the generic decoder when a packet has errors.
+ *
+ *             The RS_ECC_NPARITY (at most 4) parity bytes of the encoder
+ *             shift register are kept in a single 32 bit word, so each data
+ *             byte costs one table lookup, a shift and an xor. Checking a
+ *             received packet is done by encoding its data again: the
+ *             remainder is zero for a valid codeword, and otherwise gives the
+ *             syndromes with a few multiplies instead of a pass over the
+ *             packet for each of them.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ecc.h"
+
+#if RS_ECC_NPARITY > 4
+#error The table driven encoder supports up to 4 parity bytes
+#endif
+
+#define RS_PARITY_MASK ((uint32_t)(((uint64_t)1 << (8 * RS_ECC_NPARITY)) - 1))
+#define RS_TOP_SHIFT   (8 * (RS_ECC_NPARITY - 1))
+
+/* genPoly[j] * d for all d, byte j of each entry is the term of shift register cell j */
+static uint32_t encTable[256];
+
+void init_rs_tables(void)
+{
+    for (int d = 0; d < 256; d++) {
+        uint32_t entry = 0;
+        for (int j = 0; j < RS_ECC_NPARITY; j++) {
+            entry |= (uint32_t)gmult(genPoly[j], d) << (8 * j);
+        }
+        encTable[d] = entry;
+    }
+}
+
+/* Shift register of the encoder after nbytes of data, cell j in byte j */
+static uint32_t rs_remainder(const unsigned char data[], int nbytes)
+{
+    uint32_t lfsr = 0;
+
+    for (int i = 0; i < nbytes; i++) {
+        lfsr = ((lfsr << 8) & RS_PARITY_MASK) ^ encTable[data[i] ^ (lfsr >> RS_TOP_SHIFT)];
+    }
+    return lfsr;
+}
+
+void rs_encode_packet(unsigned char data[], int nbytes)
+{
+    uint32_t lfsr = rs_remainder(data, nbytes);
+
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        data[nbytes + i] = lfsr >> (8 * (RS_ECC_NPARITY - 1 - i));
+    }
+}
+
+int rs_decode_packet(unsigned char codeword[], int csize)
+{
+    int nbytes   = csize - RS_ECC_NPARITY;
+    uint32_t rem = rs_remainder(codeword, nbytes);
+
+    for (int i = 0; i < RS_ECC_NPARITY; i++) {
+        rem ^= (uint32_t)codeword[nbytes + i] << (8 * (RS_ECC_NPARITY - 1 - i));
+    }
+    if (rem == 0) {
+        return RS_DECODE_OK;
+    }
+
+    /*
+     * The generator has roots a^1 .. a^RS_ECC_NPARITY, so the syndromes of
+     * the codeword are the ones of the remainder, a polynomial with
+     * byte k as the coefficient of z^k.
+     */
+    for (int j = 0; j < RS_ECC_NPARITY; j++) {
+        int sum = 0;
+        for (int k = 0; k < RS_ECC_NPARITY; k++) {
+            sum ^= gmult((rem >> (8 * k)) & 0xff, gexp[((j + 1) * k) % 255]);
+        }
+        synBytes[j] = sum;
+    }
+    for (int j = RS_ECC_NPARITY; j < MAXDEG; j++) {
+        synBytes[j] = 0;
+    }
+
+    return correct_errors_erasures(codeword, csize, 0, 0) ? RS_DECODE_CORRECTED : RS_DECODE_FAILED;
+}
@@ -37,6 +37,15 @@
 * This protocol is best used in cases where one device is the master and the other is the slave, or a don't
 * speak unless spoken to type of approach.
 *
+* Selective repeat window:
+* A port configured with a windowSize puts one data byte in its synch request, the number of packets it can
+* receive ahead of a missing one (1 if it has no rxWindowBuf). A port that understands this resets its tx
+* sequence number and answers with its own receive window in the synch ACK. Each side then keeps up to
+* min(own tx window, peer rx window) packets in flight, each ACKed, timed out and resent on its own, and the
+* receiver holds packets that arrive after a lost one until the gap is filled so the callback still sees
+* them in order. Old implementations ignore the extra byte in either direction, both ends then fall back
+* to stop and wait.
+*
 * The following are items are required to initialize a port for communications:
 * 1. The number attempts for each packet
 * 2. time to wait for an ack.
@@ -115,11 +124,22 @@ static int16_t sf_DecodeState(Port_t *thisport, uint8_t c);
 static int16_t sf_ReceiveState(Port_t *thisport, uint8_t c);
 
 static void sf_SendPacket(Port_t *thisport);
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber);
+static void sf_WritePacket(Port_t *thisport, const uint8_t *packet);
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber, const uint8_t *data, uint16_t length);
 static void sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length,
                           uint8_t seqNo);
 static int16_t sf_ReceivePacket(Port_t *thisport);
 
+static uint8_t sf_NextSeqNo(uint8_t seqNo);
+static uint8_t sf_SeqDistance(uint8_t from, uint8_t to);
+static uint8_t sf_OfferedWindow(Port_t *thisport);
+static void sf_StartWindow(Port_t *thisport, uint8_t peerWindow);
+static void sf_StopWindow(Port_t *thisport);
+static int16_t sf_WindowSendData(Port_t *thisport, const uint8_t *data, uint16_t length);
+static int16_t sf_WindowSendProcess(Port_t *thisport);
+static void sf_WindowAck(Port_t *thisport, uint8_t seqNo);
+static int16_t sf_WindowReceive(Port_t *thisport);
+
 /* Flag bit masks...*/
 #define SENT_SYNCH       (0x01)
 #define ACK_RECEIVED     (0x02)
@@ -129,6 +149,10 @@ static int16_t sf_ReceivePacket(Port_t *thisport);
 #define SSP_ACKED        1
 #define SSP_IDLE         2
 
+// start of the storage for one window slot
+#define TX_SLOT_BUF(p, slot)  (&(p)->txWindowBuf[(slot) * ((p)->txBufSize + 4)])
+#define RX_SLOT_BUF(p, slot)  (&(p)->rxWindowBuf[(slot) * ((p)->rxBufSize + 4)])
+
 /** PRIVATE DATA **/
 static const uint16_t CRC_TABLE[] = { 0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301,
                                       0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0,0x0780,  0xC741, 0x0500, 0xC5C1,
@@ -196,6 +220,10 @@ void ssp_Init(Port_t *thisport, const PortConfig_t *const info)
     thisport->rxSeqNo = 255;
     thisport->txSeqNo = 255;
     thisport->SendState     = SSP_IDLE;
+    thisport->windowSize    = (info->windowSize > SSP_WINDOW_MAX) ? SSP_WINDOW_MAX : info->windowSize;
+    thisport->txWindowBuf   = info->txWindowBuf;
+    thisport->rxWindowBuf   = info->rxWindowBuf;
+    sf_StopWindow(thisport); // stop and wait until a synchronisation says otherwise
 }
 
 /*!
@@ -213,7 +241,9 @@ int16_t ssp_SendProcess(Port_t *thisport)
 {
     int16_t value = SSP_TX_WAITING;
 
-    if (thisport->SendState == SSP_AWAITING_ACK) {
+    if (thisport->txWindow > 1 && thisport->SendState == SSP_AWAITING_ACK) {
+        value = sf_WindowSendProcess(thisport);
+    } else if (thisport->SendState == SSP_AWAITING_ACK) {
         if (sf_CheckTimeout(thisport) == TRUE) {
             if (thisport->retryCount < thisport->maxRetryCount) {
                 // Try again
@@ -317,7 +347,7 @@ uint16_t ssp_SendDataBlock(Port_t *thisport, uint8_t *data, uint16_t length)
  * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
  *
  * \note
- *
+ * With a negotiated window SSP_TX_BUSY is only returned once the window is full.
  */
 int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
                      const uint16_t length)
@@ -327,6 +357,8 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
+    } else if (thisport->txWindow > 1) {
+        value = sf_WindowSendData(thisport, data, length);
     } else if (thisport->SendState == SSP_IDLE) {
 #ifdef ACTIVE_SYNCH
         if (thisport->sendSynch == TRUE) {
@@ -387,16 +419,21 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
  *              increment try counter
  *              if number of tries exceed maximum try limit then exit
  * C. goto A
+ *
+ * A port with a windowSize offers its receive window in the synch packet, the window is used from
+ * here on if the ACK answers with the other end's receive window.
  */
 uint16_t ssp_Synchronise(Port_t *thisport)
 {
     int16_t packet_status;
+    uint8_t offer = sf_OfferedWindow(thisport);
 
+    sf_StopWindow(thisport); // stop and wait until the other end has answered
 #ifndef USE_SENDPACKET_DATA
     thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
     SETBIT(thisport->flags, SENT_SYNCH);
     // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
+    sf_MakePacket(thisport->txBuf, &offer, (thisport->windowSize > 0) ? 1 : 0, thisport->txSeqNo); // construct the packet
     sf_SendPacket(thisport);
     sf_SetSendTimeout(thisport);
     thisport->SendState = SSP_AWAITING_ACK;
@@ -421,16 +458,27 @@ uint16_t ssp_Synchronise(Port_t *thisport)
  * Packet should be formed through the use of sf_MakePacket before calling this function.
  */
 static void sf_SendPacket(Port_t *thisport)
+{
+    sf_WritePacket(thisport, thisport->txBuf);
+    thisport->retryCount++;
+}
+
+/*!
+ * \brief   writes a preformatted packet out the serial port
+ * \param   thisport = which port to use.
+ * \param	packet = packet formed by sf_MakePacket
+ * \return  none.
+ */
+static void sf_WritePacket(Port_t *thisport, const uint8_t *packet)
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = packet[LENGTH] + 3;
 
     // use the raw serial write function so the SYNC byte does not get 'escaped'
     thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport, thisport->txBuf[x]);
+    for (uint16_t x = 0; x < packetLen; x++) {
+        sf_write_byte(thisport, packet[x]);
     }
-    thisport->retryCount++;
 }
 
 /*!
@@ -475,19 +523,22 @@ void sf_MakePacket(uint8_t *txBuf, const uint8_t *pdata, uint16_t length,
  * \brief   sends out an ack packet to given sequence number
  * \param   thisport = which port to use
  * \param	seqNumber = sequence number of the packet we would like to ack
+ * \param	data = payload, only used to answer a synch request with our window
+ * \param	length = number of payload bytes, 0 or 1
  * \return  none.
  *
  * \note
- *
+ * The ACK is built on the stack so a data packet in txBuf waiting to be resent is left alone.
  */
 
-static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber)
+static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber, const uint8_t *data, uint16_t length)
 {
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
+    uint8_t ackBuf[1 + 1 + 1 + 2]; // length, seq. no., window, CRC
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket(thisport);
+    sf_MakePacket(ackBuf, data, length, AckSeqNumber);
+    sf_WritePacket(thisport, ackBuf);
     // we don't set the timeout for an ACK because we don't ACK our ACKs in this protocol
 }
 
@@ -754,8 +805,17 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
         // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
+        if (thisport->txWindow > 1 && (thisport->rxBuf[SEQNUM] & 0x7F) != 0) {
+            sf_WindowAck(thisport, thisport->rxBuf[SEQNUM] & 0x7F);
+        } else if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
             // It matches the last packet sent by us
+            if ((thisport->txSeqNo & 0x7F) == 0 && ISBITSET(thisport->flags, SENT_SYNCH)) {
+                // answer to our synch request, it carries the other end's window if it has one
+                CLEARBIT(thisport->flags, SENT_SYNCH);
+                if (thisport->windowSize > 0 && thisport->rxBufLen > 0) {
+                    sf_StartWindow(thisport, thisport->rxBuf[DATA]);
+                }
+            }
             SETBIT(thisport->txSeqNo, ACK_BIT);
             thisport->SendState = SSP_ACKED;
 
@@ -769,12 +829,22 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            if (thisport->windowSize > 0 && thisport->rxBufLen > 0) {
+                // the other end offered a window, answer with ours
+                uint8_t offer = sf_OfferedWindow(thisport);
+                sf_StartWindow(thisport, thisport->rxBuf[DATA]);
+                sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], &offer, 1);
+            } else {
+                sf_StopWindow(thisport);
+                sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
+            }
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (thisport->rxWindow > 1) {
+            value = sf_WindowReceive(thisport);
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
             value = FALSE;
         } else {
             // New Packet
@@ -787,9 +857,215 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
             // after we send the ACK, it is possible for the host to send a new packet.
             // Thus the application needs to copy the data and reset the receive buffer
             // inside of thisport->pfCallBack()
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM], NULL, 0);
             value = TRUE;
         }
     }
     return value;
 }
+
+/*!
+ * \brief   next data packet sequence number, 1..127
+ */
+static uint8_t sf_NextSeqNo(uint8_t seqNo)
+{
+    return (seqNo >= 0x7F) ? 1 : seqNo + 1;
+}
+
+/*!
+ * \brief   number of sequence numbers from 'from' to 'to', both 1..127 (or 0 right after a synchronisation)
+ */
+static uint8_t sf_SeqDistance(uint8_t from, uint8_t to)
+{
+    return (uint8_t)((to + 0x7F - from) % 0x7F);
+}
+
+/*!
+ * \brief   the receive window this port offers to the other end
+ */
+static uint8_t sf_OfferedWindow(Port_t *thisport)
+{
+    return (thisport->rxWindowBuf != NULL && thisport->windowSize > 1) ? thisport->windowSize : 1;
+}
+
+/*!
+ * \brief   starts the selective repeat window after a synchronisation with a windowed peer
+ * \param   thisport = which port to use
+ * \param	peerWindow = receive window offered by the other end
+ * \return  none.
+ *
+ * \note
+ * Both ends restart their tx sequence numbers, packets still in flight are dropped.
+ */
+static void sf_StartWindow(Port_t *thisport, uint8_t peerWindow)
+{
+    sf_StopWindow(thisport);
+    if (thisport->txWindowBuf != NULL) {
+        thisport->txWindow = (peerWindow < thisport->windowSize) ? peerWindow : thisport->windowSize;
+        if (thisport->txWindow < 1) {
+            thisport->txWindow = 1;
+        }
+    }
+    thisport->rxWindow = sf_OfferedWindow(thisport);
+    thisport->txSeqNo  = 0;
+    thisport->rxSeqNo  = 0;
+}
+
+/*!
+ * \brief   back to stop and wait, forgets everything in the window
+ */
+static void sf_StopWindow(Port_t *thisport)
+{
+    if (thisport->txCount > 0) {
+        thisport->SendState = SSP_IDLE;
+    }
+    thisport->txWindow   = 1;
+    thisport->rxWindow   = 1;
+    thisport->txCount    = 0;
+    thisport->txBaseSlot = 0;
+    thisport->rxBaseSlot = 0;
+    memset(thisport->txSlots, 0, sizeof(thisport->txSlots));
+    memset(thisport->rxSlots, 0, sizeof(thisport->rxSlots));
+}
+
+/*!
+ * \brief   queues a data packet in the send window and sends it
+ * \param   thisport = which port to use
+ * \param	data = pointer to data to send
+ * \param	length = number of bytes to send
+ * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
+ * \return	SSP_TX_BUSY = the window is full
+ */
+static int16_t sf_WindowSendData(Port_t *thisport, const uint8_t *data, uint16_t length)
+{
+    uint8_t slot;
+    uint8_t *packet;
+
+    if (thisport->txCount >= thisport->txWindow) {
+        // every slot is waiting for its ACK
+        return SSP_TX_BUSY;
+    }
+    slot   = (thisport->txBaseSlot + thisport->txCount) % thisport->windowSize;
+    packet = TX_SLOT_BUF(thisport, slot);
+    CLEARBIT(thisport->txSeqNo, ACK_BIT);
+    thisport->txSeqNo = sf_NextSeqNo(thisport->txSeqNo);
+    sf_MakePacket(packet, data, length, thisport->txSeqNo);
+    sf_WritePacket(thisport, packet);
+
+    thisport->txSlots[slot].retryCount = 1;
+    thisport->txSlots[slot].timeout    = thisport->pfGetTime() + thisport->timeoutLen;
+    thisport->txSlots[slot].full = TRUE;
+    thisport->txCount++;
+    CLEARBIT(thisport->flags, ACK_RECEIVED);
+    thisport->SendState = SSP_AWAITING_ACK;
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   resends every packet in the window whose ACK timed out
+ * \param   thisport = which port to use
+ * \return  SSP_TX_WAITING - packets still in flight
+ * \return  SSP_TX_TIMEOUT - a packet was not ACKed after retrying, the window was dropped
+ */
+static int16_t sf_WindowSendProcess(Port_t *thisport)
+{
+    int16_t value = SSP_TX_WAITING;
+    uint32_t current_time = thisport->pfGetTime();
+
+    for (uint8_t x = 0; x < thisport->txCount; x++) {
+        uint8_t slot = (thisport->txBaseSlot + x) % thisport->windowSize;
+        WindowSlot_t *txSlot = &thisport->txSlots[slot];
+        if (txSlot->full && current_time > txSlot->timeout) {
+            if (txSlot->retryCount < thisport->maxRetryCount) {
+                sf_WritePacket(thisport, TX_SLOT_BUF(thisport, slot));
+                txSlot->retryCount++;
+                txSlot->timeout = current_time + thisport->timeoutLen;
+            } else {
+                // Give up, the rest of the window can not be delivered in order either
+                value = SSP_TX_TIMEOUT;
+                break;
+            }
+        }
+    }
+    if (value == SSP_TX_TIMEOUT) {
+        thisport->TxError++;
+        thisport->txCount    = 0;
+        thisport->txBaseSlot = 0;
+        memset(thisport->txSlots, 0, sizeof(thisport->txSlots));
+        CLEARBIT(thisport->flags, ACK_RECEIVED);
+        thisport->SendState  = SSP_IDLE;
+    }
+    return value;
+}
+
+/*!
+ * \brief   marks a packet in the send window as ACKed and slides the window past ACKed packets
+ * \param   thisport = which port to use
+ * \param	seqNo = sequence number of the ACKed packet
+ * \return  none.
+ */
+static void sf_WindowAck(Port_t *thisport, uint8_t seqNo)
+{
+    // how far the ACKed packet is behind the newest one sent
+    uint8_t behind = sf_SeqDistance(seqNo, thisport->txSeqNo & 0x7F);
+
+    if (behind < thisport->txCount) {
+        thisport->txSlots[(thisport->txBaseSlot + thisport->txCount - 1 - behind) % thisport->windowSize].full = FALSE;
+        while (thisport->txCount > 0 && !thisport->txSlots[thisport->txBaseSlot].full) {
+            thisport->txBaseSlot = (thisport->txBaseSlot + 1) % thisport->windowSize;
+            thisport->txCount--;
+        }
+        if (thisport->txCount == 0) {
+            thisport->SendState = SSP_ACKED;
+        }
+    }
+    // else not in flight (anymore), ignore the ACK
+}
+
+/*!
+ * \brief   receives a data packet within the receive window
+ * \param   thisport = which port to use
+ * \return  true = new data was handed to the callback
+ * \return	false = otherwise
+ *
+ * \note
+ * The next packet in sequence is handed to the callback along with any packets held behind it, a packet
+ * ahead of a missing one is held until the gap is filled. Both are ACKed, as is a packet already
+ * delivered whose ACK got lost. Anything else is outside the window and dropped.
+ */
+static int16_t sf_WindowReceive(Port_t *thisport)
+{
+    int16_t value = FALSE;
+    uint8_t seqNo = thisport->rxBuf[SEQNUM];
+    uint8_t ahead = sf_SeqDistance(sf_NextSeqNo(thisport->rxSeqNo), seqNo);
+
+    if (ahead == 0) {
+        thisport->rxSeqNo = seqNo;
+        if (thisport->pfCallBack != NULL) {
+            thisport->pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+        }
+        thisport->rxBaseSlot = (thisport->rxBaseSlot + 1) % thisport->windowSize;
+        while (thisport->rxSlots[thisport->rxBaseSlot].full) {
+            uint8_t *packet = RX_SLOT_BUF(thisport, thisport->rxBaseSlot);
+            thisport->rxSeqNo = packet[SEQNUM];
+            if (thisport->pfCallBack != NULL) {
+                thisport->pfCallBack(&packet[DATA], packet[LENGTH] - 1);
+            }
+            thisport->rxSlots[thisport->rxBaseSlot].full = FALSE;
+            thisport->rxBaseSlot = (thisport->rxBaseSlot + 1) % thisport->windowSize;
+        }
+        sf_SendAckPacket(thisport, seqNo, NULL, 0);
+        value = TRUE;
+    } else if (ahead < thisport->rxWindow) {
+        uint8_t slot = (thisport->rxBaseSlot + ahead) % thisport->windowSize;
+        if (!thisport->rxSlots[slot].full) {
+            memcpy(RX_SLOT_BUF(thisport, slot), thisport->rxBuf, thisport->rxBufLen + 2);
+            thisport->rxSlots[slot].full = TRUE;
+        }
+        sf_SendAckPacket(thisport, seqNo, NULL, 0);
+    } else if (sf_SeqDistance(seqNo, thisport->rxSeqNo) < thisport->rxWindow) {
+        // Already delivered, the ACK got lost
+        sf_SendAckPacket(thisport, seqNo, NULL, 0);
+    }
+    return value;
+}
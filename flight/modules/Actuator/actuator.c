@@ -86,6 +86,12 @@ static int8_t counter;
 static xQueueHandle queue;
 static xTaskHandle taskHandle;
 static FrameType_t frameType = FRAME_TYPE_MULTIROTOR;
+#ifdef ACTUATOR_FASTPATH
+// snapshots, so that the fast path does not look up settings from the stabilization callback
+static bool frameIsMultirotor = true;
+static bool frameIsFixedwing  = false;
+static bool alwaysArmed;
+#endif
 static SystemSettingsThrustControlOptions thrustType = SYSTEMSETTINGS_THRUSTCONTROL_THROTTLE;
 static bool camStabEnabled;
 static bool camControlEnabled;
@@ -99,6 +105,23 @@ static bool spinWhileArmed;
 static MixerSettingsData mixerSettings;
 static int mixer_settings_count = 2;
 
+static portTickType lastSysTime;
+
+#ifdef ACTUATOR_FASTPATH
+// taken while mixing, the stabilization callback and the actuator task can both do it
+static xSemaphoreHandle mixerLock;
+// set once the actuator task has configured the outputs, fast path calls are ignored until then
+static volatile bool actuatorReady;
+// incremented each time the fast path sends an update to the outputs, along with the update it mixed
+static uint32_t fastPathSequence;
+static ActuatorDesiredData fastPathDesired;
+#define MIXER_LOCK()   xSemaphoreTake(mixerLock, portMAX_DELAY)
+#define MIXER_UNLOCK() xSemaphoreGive(mixerLock)
+#else
+#define MIXER_LOCK()
+#define MIXER_UNLOCK()
+#endif
+
 // Private functions
 static void actuatorTask(void *parameters);
 static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
@@ -111,6 +134,10 @@ static void actuator_update_rate_if_changed(bool force_update);
 static void MixerSettingsUpdatedCb(UAVObjEvent *ev);
 static void ActuatorSettingsUpdatedCb(UAVObjEvent *ev);
 static void SettingsUpdatedCb(UAVObjEvent *ev);
+#ifdef ACTUATOR_FASTPATH
+static void FlightModeSettingsUpdatedCb(UAVObjEvent *ev);
+#endif
+static void actuatorUpdate(ActuatorDesiredData *desired);
 float ProcessMixer(const int index, const float curve1, const float curve2,
                    ActuatorDesiredData *desired,
                    bool multirotor, bool fixedwing);
@@ -134,6 +161,9 @@ int32_t ActuatorStart()
     PIOS_WDG_RegisterFlag(PIOS_WDG_ACTUATOR);
 #endif
     SettingsUpdatedCb(NULL);
+#ifdef ACTUATOR_FASTPATH
+    FlightModeSettingsUpdatedCb(NULL);
+#endif
     MixerSettingsUpdatedCb(NULL);
     ActuatorSettingsUpdatedCb(NULL);
     return 0;
@@ -155,6 +185,9 @@ int32_t ActuatorInitialize()
     ActuatorDesiredInitialize();
     queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
     ActuatorDesiredConnectQueue(queue);
+#ifdef ACTUATOR_FASTPATH
+    mixerLock = xSemaphoreCreateMutex();
+#endif
 
     // Register AccessoryDesired (Secondary input to this module)
     AccessoryDesiredInitialize();
@@ -167,6 +200,10 @@ int32_t ActuatorInitialize()
     // Primary output of this module
     ActuatorCommandInitialize();
 
+#ifdef PIOS_INCLUDE_INSTRUMENTATION
+    counter = PIOS_Instrumentation_CreateCounter(0xAC700001);
+#endif
+
 #ifdef DIAG_MIXERSTATUS
     // UAVO only used for inspecting the internal status of the mixer during debug
     MixerStatusInitialize();
@@ -176,6 +213,9 @@ int32_t ActuatorInitialize()
     VtolPathFollowerSettingsConnectCallback(&SettingsUpdatedCb);
 #endif
     SystemSettingsConnectCallback(&SettingsUpdatedCb);
+#ifdef ACTUATOR_FASTPATH
+    FlightModeSettingsConnectCallback(&FlightModeSettingsUpdatedCb);
+#endif
 
     return 0;
 }
@@ -197,21 +237,12 @@ MODULE_INITCALL(ActuatorInitialize, ActuatorStart);
 static void actuatorTask(__attribute__((unused)) void *parameters)
 {
     UAVObjEvent ev;
-    portTickType lastSysTime;
-    portTickType thisSysTime;
-    uint32_t dTMilliseconds;
-
-    ActuatorCommandData command;
     ActuatorDesiredData desired;
-    MixerStatusData mixerStatus;
-    FlightModeSettingsData settings;
-    FlightStatusData flightStatus;
-    float throttleDesired;
-    float collectiveDesired;
 
-#ifdef PIOS_INCLUDE_INSTRUMENTATION
-    counter = PIOS_Instrumentation_CreateCounter(0xAC700001);
+#ifdef ACTUATOR_FASTPATH
+    uint32_t taskSequence = 0;
 #endif
+
     /* Read initial values of ActuatorSettings */
 
     ActuatorSettingsGet(&actuatorSettings);
@@ -225,6 +256,10 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
     // Go to the neutral (failsafe) values until an ActuatorDesired update is received
     setFailsafe();
 
+#ifdef ACTUATOR_FASTPATH
+    actuatorReady = true;
+#endif
+
     // Main task loop
     lastSysTime = xTaskGetTickCount();
     while (1) {
@@ -234,332 +269,403 @@ static void actuatorTask(__attribute__((unused)) void *parameters)
 
         // Wait until the ActuatorDesired object is updated
         uint8_t rc = xQueueReceive(queue, &ev, FAILSAFE_TIMEOUT_MS / portTICK_RATE_MS);
-#ifdef PIOS_INCLUDE_INSTRUMENTATION
-        PIOS_Instrumentation_TimeStart(counter);
-#endif
 
         if (rc != pdTRUE) {
             /* Update of ActuatorDesired timed out.  Go to failsafe */
+            MIXER_LOCK();
             setFailsafe();
+            MIXER_UNLOCK();
             continue;
         }
 
-        // Check how long since last update
-        thisSysTime    = xTaskGetTickCount();
-        dTMilliseconds = (thisSysTime == lastSysTime) ? 1 : (thisSysTime - lastSysTime) * portTICK_RATE_MS;
-        lastSysTime    = thisSysTime;
-
-        FlightStatusGet(&flightStatus);
-        FlightModeSettingsGet(&settings);
         ActuatorDesiredGet(&desired);
-        ActuatorCommandGet(&command);
 
-        // read in throttle and collective -demultiplex thrust
-        switch (thrustType) {
-        case SYSTEMSETTINGS_THRUSTCONTROL_THROTTLE:
-            throttleDesired = desired.Thrust;
-            ManualControlCommandCollectiveGet(&collectiveDesired);
-            break;
-        case SYSTEMSETTINGS_THRUSTCONTROL_COLLECTIVE:
-            ManualControlCommandThrottleGet(&throttleDesired);
-            collectiveDesired = desired.Thrust;
-            break;
-        default:
-            ManualControlCommandThrottleGet(&throttleDesired);
-            ManualControlCommandCollectiveGet(&collectiveDesired);
+        MIXER_LOCK();
+#ifdef ACTUATOR_FASTPATH
+        // Skip the update if ActuatorFastPathUpdate() has sent it to the outputs
+        // since the last one seen here. The data is compared as well, so that an
+        // update from elsewhere is still mixed when a fast path event was dropped.
+        bool alreadySent = (fastPathSequence != taskSequence) &&
+                           !memcmp(&desired, &fastPathDesired, sizeof(desired));
+        taskSequence = fastPathSequence;
+        if (!alreadySent) {
+            actuatorUpdate(&desired);
         }
+#else
+        actuatorUpdate(&desired);
+#endif
+        MIXER_UNLOCK();
+    }
+}
+
+#ifdef ACTUATOR_FASTPATH
+/**
+ * @brief Mix an ActuatorDesired update and send it to the outputs right away
+ *
+ * Called by the stabilization inner loop before it sets ActuatorDesired, so
+ * the outputs are updated from the rate loop's own context. The actuator task
+ * is still woken by the ActuatorDesired update, for the failsafe timeout, but
+ * skips mixing it again. Updates before the actuator task has configured the
+ * outputs are left to the task.
+ */
+void ActuatorFastPathUpdate(const ActuatorDesiredData *desired)
+{
+    if (!actuatorReady) {
+        return;
+    }
 
-        bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
-        bool activeThrottle   = (throttleDesired < -0.001f || throttleDesired > 0.001f); // for ground and reversible motors
-        bool positiveThrottle = (throttleDesired > 0.00f);
-        bool multirotor  = (GetCurrentFrameType() == FRAME_TYPE_MULTIROTOR); // check if frame is a multirotor.
-        bool fixedwing   = (GetCurrentFrameType() == FRAME_TYPE_FIXED_WING); // check if frame is a fixedwing.
-        bool alwaysArmed = settings.Arming == FLIGHTMODESETTINGS_ARMING_ALWAYSARMED;
-        bool alwaysStabilizeWhenArmed = flightStatus.AlwaysStabilizeWhenArmed == FLIGHTSTATUS_ALWAYSSTABILIZEWHENARMED_TRUE;
+    // the mixer changes the axes at low throttle, the caller still sets the original
+    ActuatorDesiredData mixed = *desired;
 
-        if (alwaysArmed) {
-            alwaysStabilizeWhenArmed = false; // Do not allow always stabilize when alwaysArmed is active. This is dangerous.
-        }
-        // safety settings
-        if (!armed) {
-            throttleDesired = 0.00f; // this also happens in scaleMotors as a per axis check
-        }
+    MIXER_LOCK();
+    actuatorUpdate(&mixed);
+    fastPathDesired = *desired;
+    fastPathSequence++;
+    MIXER_UNLOCK();
+}
+#endif /* ACTUATOR_FASTPATH */
 
-        if ((frameType == FRAME_TYPE_GROUND && !activeThrottle) || (frameType != FRAME_TYPE_GROUND && throttleDesired <= 0.00f) || !armed) {
-            // throttleDesired should never be 0 or go below 0.
-            // force set all other controls to zero if throttle is cut (previously set in Stabilization)
-            // todo: can probably remove this
-            if (!(multirotor && alwaysStabilizeWhenArmed && armed)) { // we don't do this if this is a multirotor AND AlwaysStabilizeWhenArmed is true and the model is armed
-                if (actuatorSettings.LowThrottleZeroAxis.Roll == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
-                    desired.Roll = 0.00f;
-                }
-                if (actuatorSettings.LowThrottleZeroAxis.Pitch == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
-                    desired.Pitch = 0.00f;
-                }
-                if (actuatorSettings.LowThrottleZeroAxis.Yaw == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
-                    desired.Yaw = 0.00f;
-                }
-            }
-        }
+/**
+ * @brief Mix one ActuatorDesired update and send it to the outputs
+ *
+ * The settings are snapshots kept up to date by the settings callbacks, only
+ * the objects that change with every update are read here.
+ */
+static void actuatorUpdate(ActuatorDesiredData *desired)
+{
+    portTickType thisSysTime;
+    uint32_t dTMilliseconds;
 
-#ifdef DIAG_MIXERSTATUS
-        MixerStatusGet(&mixerStatus);
-#endif
+    ActuatorCommandData command;
+    MixerStatusData mixerStatus;
+    FlightStatusData flightStatus;
+    float throttleDesired;
+    float collectiveDesired;
 
-        if ((mixer_settings_count < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
-            setFailsafe();
-            continue;
-        }
+#ifdef PIOS_INCLUDE_INSTRUMENTATION
+    PIOS_Instrumentation_TimeStart(counter);
+#endif
 
-        AlarmsClear(SYSTEMALARMS_ALARM_ACTUATOR);
+    // Check how long since last update
+    thisSysTime    = xTaskGetTickCount();
+    dTMilliseconds = (thisSysTime == lastSysTime) ? 1 : (thisSysTime - lastSysTime) * portTICK_RATE_MS;
+    lastSysTime    = thisSysTime;
+
+    FlightStatusGet(&flightStatus);
+    ActuatorCommandGet(&command);
+
+    // read in throttle and collective -demultiplex thrust
+    switch (thrustType) {
+    case SYSTEMSETTINGS_THRUSTCONTROL_THROTTLE:
+        throttleDesired = desired->Thrust;
+        ManualControlCommandCollectiveGet(&collectiveDesired);
+        break;
+    case SYSTEMSETTINGS_THRUSTCONTROL_COLLECTIVE:
+        ManualControlCommandThrottleGet(&throttleDesired);
+        collectiveDesired = desired->Thrust;
+        break;
+    default:
+        ManualControlCommandThrottleGet(&throttleDesired);
+        ManualControlCommandCollectiveGet(&collectiveDesired);
+    }
 
-        float curve1 = 0.0f; // curve 1 is the throttle curve applied to all motors.
-        float curve2 = 0.0f;
+    bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
+    bool activeThrottle   = (throttleDesired < -0.001f || throttleDesired > 0.001f); // for ground and reversible motors
+    bool positiveThrottle = (throttleDesired > 0.00f);
+#ifdef ACTUATOR_FASTPATH
+    bool multirotor  = frameIsMultirotor; // check if frame is a multirotor.
+    bool fixedwing   = frameIsFixedwing; // check if frame is a fixedwing.
+#else
+    FlightModeSettingsArmingOptions arming;
+    FlightModeSettingsArmingGet(&arming);
+    bool multirotor  = (GetCurrentFrameType() == FRAME_TYPE_MULTIROTOR); // check if frame is a multirotor.
+    bool fixedwing   = (GetCurrentFrameType() == FRAME_TYPE_FIXED_WING); // check if frame is a fixedwing.
+    bool alwaysArmed = arming == FLIGHTMODESETTINGS_ARMING_ALWAYSARMED;
+#endif
+    bool alwaysStabilizeWhenArmed = flightStatus.AlwaysStabilizeWhenArmed == FLIGHTSTATUS_ALWAYSSTABILIZEWHENARMED_TRUE;
 
-        // Interpolate curve 1 from throttleDesired as input.
-        // assume reversible motor/mixer initially. We can later reverse this. The difference is simply that -ve throttleDesired values
-        // map differently
-        curve1 = MixerCurveFullRangeProportional(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM, multirotor);
+    if (alwaysArmed) {
+        alwaysStabilizeWhenArmed = false; // Do not allow always stabilize when alwaysArmed is active. This is dangerous.
+    }
+    // safety settings
+    if (!armed) {
+        throttleDesired = 0.00f; // this also happens in scaleMotors as a per axis check
+    }
 
-        // The source for the secondary curve is selectable
-        AccessoryDesiredData accessory;
-        uint8_t curve2Source = mixerSettings.Curve2Source;
-        switch (curve2Source) {
-        case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-            // assume reversible motor/mixer initially
-            curve2 = MixerCurveFullRangeProportional(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            break;
-        case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-            // Throttle curve contribution the same for +ve vs -ve roll
-            if (multirotor) {
-                curve2 = MixerCurveFullRangeProportional(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            } else {
-                curve2 = MixerCurveFullRangeAbsolute(desired.Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+    if ((frameType == FRAME_TYPE_GROUND && !activeThrottle) || (frameType != FRAME_TYPE_GROUND && throttleDesired <= 0.00f) || !armed) {
+        // throttleDesired should never be 0 or go below 0.
+        // force set all other controls to zero if throttle is cut (previously set in Stabilization)
+        // todo: can probably remove this
+        if (!(multirotor && alwaysStabilizeWhenArmed && armed)) { // we don't do this if this is a multirotor AND AlwaysStabilizeWhenArmed is true and the model is armed
+            if (actuatorSettings.LowThrottleZeroAxis.Roll == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
+                desired->Roll = 0.00f;
             }
-            break;
-        case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-            // Throttle curve contribution the same for +ve vs -ve pitch
-            if (multirotor) {
-                curve2 = MixerCurveFullRangeProportional(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                                         MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            } else {
-                curve2 = MixerCurveFullRangeAbsolute(desired.Pitch, mixerSettings.ThrottleCurve2,
-                                                     MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+            if (actuatorSettings.LowThrottleZeroAxis.Pitch == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
+                desired->Pitch = 0.00f;
             }
-            break;
-        case MIXERSETTINGS_CURVE2SOURCE_YAW:
-            // Throttle curve contribution the same for +ve vs -ve yaw
-            if (multirotor) {
-                curve2 = MixerCurveFullRangeProportional(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            } else {
-                curve2 = MixerCurveFullRangeAbsolute(desired.Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+            if (actuatorSettings.LowThrottleZeroAxis.Yaw == ACTUATORSETTINGS_LOWTHROTTLEZEROAXIS_TRUE) {
+                desired->Yaw = 0.00f;
             }
-            break;
-        case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
-            // assume reversible motor/mixer initially
-            curve2 = MixerCurveFullRangeProportional(collectiveDesired, mixerSettings.ThrottleCurve2,
+        }
+    }
+
+#ifdef DIAG_MIXERSTATUS
+    MixerStatusGet(&mixerStatus);
+#endif
+
+    if ((mixer_settings_count < 2) && !ActuatorCommandReadOnly()) { // Nothing can fly with less than two mixers.
+        setFailsafe();
+        return;
+    }
+
+    AlarmsClear(SYSTEMALARMS_ALARM_ACTUATOR);
+
+    float curve1 = 0.0f; // curve 1 is the throttle curve applied to all motors.
+    float curve2 = 0.0f;
+
+    // Interpolate curve 1 from throttleDesired as input.
+    // assume reversible motor/mixer initially. We can later reverse this. The difference is simply that -ve throttleDesired values
+    // map differently
+    curve1 = MixerCurveFullRangeProportional(throttleDesired, mixerSettings.ThrottleCurve1, MIXERSETTINGS_THROTTLECURVE1_NUMELEM, multirotor);
+
+    // The source for the secondary curve is selectable
+    AccessoryDesiredData accessory;
+    uint8_t curve2Source = mixerSettings.Curve2Source;
+    switch (curve2Source) {
+    case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
+        // assume reversible motor/mixer initially
+        curve2 = MixerCurveFullRangeProportional(throttleDesired, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        break;
+    case MIXERSETTINGS_CURVE2SOURCE_ROLL:
+        // Throttle curve contribution the same for +ve vs -ve roll
+        if (multirotor) {
+            curve2 = MixerCurveFullRangeProportional(desired->Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        } else {
+            curve2 = MixerCurveFullRangeAbsolute(desired->Roll, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        }
+        break;
+    case MIXERSETTINGS_CURVE2SOURCE_PITCH:
+        // Throttle curve contribution the same for +ve vs -ve pitch
+        if (multirotor) {
+            curve2 = MixerCurveFullRangeProportional(desired->Pitch, mixerSettings.ThrottleCurve2,
                                                      MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            break;
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY2:
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY3:
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
-        case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
-            if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
-                // Throttle curve contribution the same for +ve vs -ve accessory....maybe not want we want.
-                curve2 = MixerCurveFullRangeAbsolute(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
-            } else {
-                curve2 = 0.0f;
-            }
-            break;
-        default:
+        } else {
+            curve2 = MixerCurveFullRangeAbsolute(desired->Pitch, mixerSettings.ThrottleCurve2,
+                                                 MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        }
+        break;
+    case MIXERSETTINGS_CURVE2SOURCE_YAW:
+        // Throttle curve contribution the same for +ve vs -ve yaw
+        if (multirotor) {
+            curve2 = MixerCurveFullRangeProportional(desired->Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        } else {
+            curve2 = MixerCurveFullRangeAbsolute(desired->Yaw, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        }
+        break;
+    case MIXERSETTINGS_CURVE2SOURCE_COLLECTIVE:
+        // assume reversible motor/mixer initially
+        curve2 = MixerCurveFullRangeProportional(collectiveDesired, mixerSettings.ThrottleCurve2,
+                                                 MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        break;
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY2:
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY3:
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
+    case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
+        if (AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0, &accessory) == 0) {
+            // Throttle curve contribution the same for +ve vs -ve accessory....maybe not want we want.
+            curve2 = MixerCurveFullRangeAbsolute(accessory.AccessoryVal, mixerSettings.ThrottleCurve2, MIXERSETTINGS_THROTTLECURVE2_NUMELEM, multirotor);
+        } else {
             curve2 = 0.0f;
-            break;
         }
+        break;
+    default:
+        curve2 = 0.0f;
+        break;
+    }
 
-        float *status   = (float *)&mixerStatus; // access status objects as an array of floats
-        Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-        float maxMotor  = -1.0f; // highest motor value. Addition method needs this to be -1.0f, division method needs this to be 1.0f
-        float minMotor  = 1.0f; // lowest motor value Addition method needs this to be 1.0f, division method needs this to be -1.0f
+    float *status   = (float *)&mixerStatus; // access status objects as an array of floats
+    Mixer_t *mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
+    float maxMotor  = -1.0f; // highest motor value. Addition method needs this to be -1.0f, division method needs this to be 1.0f
+    float minMotor  = 1.0f; // lowest motor value Addition method needs this to be 1.0f, division method needs this to be -1.0f
 
-        for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
-            // During boot all camera actuators should be completely disabled (PWM pulse = 0).
-            // command.Channel[i] is reused below as a channel PWM activity flag:
-            // 0 - PWM disabled, >0 - PWM set to real mixer value using scaleChannel() later.
-            // Setting it to 1 by default means "Rescale this channel and enable PWM on its output".
-            command.Channel[ct] = 1;
+    for (int ct = 0; ct < MAX_MIX_ACTUATORS; ct++) {
+        // During boot all camera actuators should be completely disabled (PWM pulse = 0).
+        // command.Channel[i] is reused below as a channel PWM activity flag:
+        // 0 - PWM disabled, >0 - PWM set to real mixer value using scaleChannel() later.
+        // Setting it to 1 by default means "Rescale this channel and enable PWM on its output".
+        command.Channel[ct] = 1;
 
-            uint8_t mixer_type = mixers[ct].type;
+        uint8_t mixer_type = mixers[ct].type;
 
-            if (mixer_type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
-                // Set to minimum if disabled.  This is not the same as saying PWM pulse = 0 us
-                status[ct] = -1;
-                continue;
-            }
+        if (mixer_type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
+            // Set to minimum if disabled.  This is not the same as saying PWM pulse = 0 us
+            status[ct] = -1;
+            continue;
+        }
 
-            if ((mixer_type == MIXERSETTINGS_MIXER1TYPE_MOTOR)) {
-                float nonreversible_curve1 = curve1;
-                float nonreversible_curve2 = curve2;
-                if (nonreversible_curve1 < 0.0f) {
-                    nonreversible_curve1 = 0.0f;
-                }
-                if (nonreversible_curve2 < 0.0f) {
-                    if (!multirotor) { // allow negative throttle if multirotor. function scaleMotors handles the sanity checks.
-                        nonreversible_curve2 = 0.0f;
-                    }
-                }
-                status[ct] = ProcessMixer(ct, nonreversible_curve1, nonreversible_curve2, &desired, multirotor, fixedwing);
-                // If not armed or motors aren't meant to spin all the time
-                if (!armed ||
-                    (!spinWhileArmed && !positiveThrottle)) {
-                    status[ct] = -1; // force min throttle
-                }
-                // If armed meant to keep spinning,
-                else if ((spinWhileArmed && !positiveThrottle) ||
-                         (status[ct] < 0)) {
-                    if (!multirotor) {
-                        status[ct] = 0;
-                        // allow throttle values lower than 0 if multirotor.
-                        // Values will be scaled to 0 if they need to be in the scaleMotor function
-                    }
+        if ((mixer_type == MIXERSETTINGS_MIXER1TYPE_MOTOR)) {
+            float nonreversible_curve1 = curve1;
+            float nonreversible_curve2 = curve2;
+            if (nonreversible_curve1 < 0.0f) {
+                nonreversible_curve1 = 0.0f;
+            }
+            if (nonreversible_curve2 < 0.0f) {
+                if (!multirotor) { // allow negative throttle if multirotor. function scaleMotors handles the sanity checks.
+                    nonreversible_curve2 = 0.0f;
                 }
-            } else if (mixer_type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &desired, multirotor, fixedwing);
-                // Reversable Motors are like Motors but go to neutral instead of minimum
-                // If not armed or motor is inactive - no "spinwhilearmed" for this engine type
-                if (!armed || !activeThrottle) {
-                    status[ct] = 0; // force neutral throttle
+            }
+            status[ct] = ProcessMixer(ct, nonreversible_curve1, nonreversible_curve2, desired, multirotor, fixedwing);
+            // If not armed or motors aren't meant to spin all the time
+            if (!armed ||
+                (!spinWhileArmed && !positiveThrottle)) {
+                status[ct] = -1; // force min throttle
+            }
+            // If armed meant to keep spinning,
+            else if ((spinWhileArmed && !positiveThrottle) ||
+                     (status[ct] < 0)) {
+                if (!multirotor) {
+                    status[ct] = 0;
+                    // allow throttle values lower than 0 if multirotor.
+                    // Values will be scaled to 0 if they need to be in the scaleMotor function
                 }
-            } else if (mixer_type == MIXERSETTINGS_MIXER1TYPE_SERVO) {
-                status[ct] = ProcessMixer(ct, curve1, curve2, &desired, multirotor, fixedwing);
-            } else {
-                status[ct] = -1;
-
-                // If an accessory channel is selected for direct bypass mode
-                // In this configuration the accessory channel is scaled and mapped
-                // directly to output.  Note: THERE IS NO SAFETY CHECK HERE FOR ARMING
-                // these also will not be updated in failsafe mode.  I'm not sure what
-                // the correct behavior is since it seems domain specific.  I don't love
-                // this code
-                if ((mixer_type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
-                    (mixer_type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
-                    if (AccessoryDesiredInstGet(mixer_type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
-                        status[ct] = accessory.AccessoryVal;
-                    } else {
-                        status[ct] = -1;
-                    }
+            }
+        } else if (mixer_type == MIXERSETTINGS_MIXER1TYPE_REVERSABLEMOTOR) {
+            status[ct] = ProcessMixer(ct, curve1, curve2, desired, multirotor, fixedwing);
+            // Reversable Motors are like Motors but go to neutral instead of minimum
+            // If not armed or motor is inactive - no "spinwhilearmed" for this engine type
+            if (!armed || !activeThrottle) {
+                status[ct] = 0; // force neutral throttle
+            }
+        } else if (mixer_type == MIXERSETTINGS_MIXER1TYPE_SERVO) {
+            status[ct] = ProcessMixer(ct, curve1, curve2, desired, multirotor, fixedwing);
+        } else {
+            status[ct] = -1;
+
+            // If an accessory channel is selected for direct bypass mode
+            // In this configuration the accessory channel is scaled and mapped
+            // directly to output.  Note: THERE IS NO SAFETY CHECK HERE FOR ARMING
+            // these also will not be updated in failsafe mode.  I'm not sure what
+            // the correct behavior is since it seems domain specific.  I don't love
+            // this code
+            if ((mixer_type >= MIXERSETTINGS_MIXER1TYPE_ACCESSORY0) &&
+                (mixer_type <= MIXERSETTINGS_MIXER1TYPE_ACCESSORY5)) {
+                if (AccessoryDesiredInstGet(mixer_type - MIXERSETTINGS_MIXER1TYPE_ACCESSORY0, &accessory) == 0) {
+                    status[ct] = accessory.AccessoryVal;
+                } else {
+                    status[ct] = -1;
                 }
+            }
 
-                if ((mixer_type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
-                    (mixer_type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
-                    if (camStabEnabled) {
-                        CameraDesiredData cameraDesired;
-                        CameraDesiredGet(&cameraDesired);
-                        switch (mixer_type) {
-                        case MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1:
-                            status[ct] = cameraDesired.RollOrServo1;
-                            break;
-                        case MIXERSETTINGS_MIXER1TYPE_CAMERAPITCHORSERVO2:
-                            status[ct] = cameraDesired.PitchOrServo2;
-                            break;
-                        case MIXERSETTINGS_MIXER1TYPE_CAMERAYAW:
-                            status[ct] = cameraDesired.Yaw;
-                            break;
-                        default:
-                            break;
-                        }
-                    } else {
-                        status[ct] = -1;
-                    }
-
-                    // Disable camera actuators for CAMERA_BOOT_DELAY_MS after boot
-                    if (thisSysTime < (CAMERA_BOOT_DELAY_MS / portTICK_RATE_MS)) {
-                        command.Channel[ct] = 0;
+            if ((mixer_type >= MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1) &&
+                (mixer_type <= MIXERSETTINGS_MIXER1TYPE_CAMERAYAW)) {
+                if (camStabEnabled) {
+                    CameraDesiredData cameraDesired;
+                    CameraDesiredGet(&cameraDesired);
+                    switch (mixer_type) {
+                    case MIXERSETTINGS_MIXER1TYPE_CAMERAROLLORSERVO1:
+                        status[ct] = cameraDesired.RollOrServo1;
+                        break;
+                    case MIXERSETTINGS_MIXER1TYPE_CAMERAPITCHORSERVO2:
+                        status[ct] = cameraDesired.PitchOrServo2;
+                        break;
+                    case MIXERSETTINGS_MIXER1TYPE_CAMERAYAW:
+                        status[ct] = cameraDesired.Yaw;
+                        break;
+                    default:
+                        break;
                     }
+                } else {
+                    status[ct] = -1;
                 }
 
-                if (mixer_type == MIXERSETTINGS_MIXER1TYPE_CAMERATRIGGER) {
-                    if (camControlEnabled) {
-                        CameraDesiredTriggerGet(&status[ct]);
-                    } else {
-                        status[ct] = 0;
-                    }
+                // Disable camera actuators for CAMERA_BOOT_DELAY_MS after boot
+                if (thisSysTime < (CAMERA_BOOT_DELAY_MS / portTICK_RATE_MS)) {
+                    command.Channel[ct] = 0;
                 }
             }
 
-            // If mixer type is motor we need to find which motor has the highest value and which motor has the lowest value.
-            // For use in function scaleMotor
-            if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
-                if (maxMotor < status[ct]) {
-                    maxMotor = status[ct];
-                }
-                if (minMotor > status[ct]) {
-                    minMotor = status[ct];
+            if (mixer_type == MIXERSETTINGS_MIXER1TYPE_CAMERATRIGGER) {
+                if (camControlEnabled) {
+                    CameraDesiredTriggerGet(&status[ct]);
+                } else {
+                    status[ct] = 0;
                 }
             }
         }
 
-        // Set real actuator output values scaling them from mixers. All channels
-        // will be set except explicitly disabled (which will have PWM pulse = 0).
-        for (int i = 0; i < MAX_MIX_ACTUATORS; i++) {
-            if (command.Channel[i]) {
-                if (mixers[i].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) { // If mixer is for a motor we need to find the highest value of all motors
-                    command.Channel[i] = scaleMotor(status[i],
-                                                    actuatorSettings.ChannelMax[i],
-                                                    actuatorSettings.ChannelMin[i],
-                                                    actuatorSettings.ChannelNeutral[i],
-                                                    maxMotor,
-                                                    minMotor,
-                                                    armed,
-                                                    alwaysStabilizeWhenArmed,
-                                                    throttleDesired);
-                } else { // else we scale the channel
-                    command.Channel[i] = scaleChannel(status[i],
-                                                      actuatorSettings.ChannelMax[i],
-                                                      actuatorSettings.ChannelMin[i],
-                                                      actuatorSettings.ChannelNeutral[i]);
-                }
+        // If mixer type is motor we need to find which motor has the highest value and which motor has the lowest value.
+        // For use in function scaleMotor
+        if (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) {
+            if (maxMotor < status[ct]) {
+                maxMotor = status[ct];
+            }
+            if (minMotor > status[ct]) {
+                minMotor = status[ct];
             }
         }
+    }
 
-        // Store update time
-        command.UpdateTime = dTMilliseconds;
-        if (command.UpdateTime > command.MaxUpdateTime) {
-            command.MaxUpdateTime = command.UpdateTime;
+    // Set real actuator output values scaling them from mixers. All channels
+    // will be set except explicitly disabled (which will have PWM pulse = 0).
+    for (int i = 0; i < MAX_MIX_ACTUATORS; i++) {
+        if (command.Channel[i]) {
+            if (mixers[i].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) { // If mixer is for a motor we need to find the highest value of all motors
+                command.Channel[i] = scaleMotor(status[i],
+                                                actuatorSettings.ChannelMax[i],
+                                                actuatorSettings.ChannelMin[i],
+                                                actuatorSettings.ChannelNeutral[i],
+                                                maxMotor,
+                                                minMotor,
+                                                armed,
+                                                alwaysStabilizeWhenArmed,
+                                                throttleDesired);
+            } else { // else we scale the channel
+                command.Channel[i] = scaleChannel(status[i],
+                                                  actuatorSettings.ChannelMax[i],
+                                                  actuatorSettings.ChannelMin[i],
+                                                  actuatorSettings.ChannelNeutral[i]);
+            }
         }
-        // Update output object
-        ActuatorCommandSet(&command);
-        // Update in case read only (eg. during servo configuration)
-        ActuatorCommandGet(&command);
+    }
+
+    // Store update time
+    command.UpdateTime = dTMilliseconds;
+    if (command.UpdateTime > command.MaxUpdateTime) {
+        command.MaxUpdateTime = command.UpdateTime;
+    }
+    // Update output object
+    ActuatorCommandSet(&command);
+    // Update in case read only (eg. during servo configuration)
+    ActuatorCommandGet(&command);
 
 #ifdef DIAG_MIXERSTATUS
-        MixerStatusSet(&mixerStatus);
+    MixerStatusSet(&mixerStatus);
 #endif
 
 
-        // Update servo outputs
-        bool success = true;
+    // Update servo outputs
+    bool success = true;
 
-        for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
-            int32_t result = set_channel(n, command.Channel[n]);
-            if (result < 0) {
-                command.Channel[n] = result;
-                success = false;
-            }
+    for (int n = 0; n < ACTUATORCOMMAND_CHANNEL_NUMELEM; ++n) {
+        int32_t result = set_channel(n, command.Channel[n]);
+        if (result < 0) {
+            command.Channel[n] = result;
+            success = false;
         }
+    }
 
-        PIOS_Servo_Update();
+    PIOS_Servo_Update();
 
-        if (!success) {
-            command.NumFailedUpdates++;
-            ActuatorCommandSet(&command);
-            AlarmsSet(SYSTEMALARMS_ALARM_ACTUATOR, SYSTEMALARMS_ALARM_CRITICAL);
-        }
+    if (!success) {
+        command.NumFailedUpdates++;
+        ActuatorCommandSet(&command);
+        AlarmsSet(SYSTEMALARMS_ALARM_ACTUATOR, SYSTEMALARMS_ALARM_CRITICAL);
+    }
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
-        PIOS_Instrumentation_TimeEnd(counter);
+    PIOS_Instrumentation_TimeEnd(counter);
 #endif
-    }
 }
 
 
@@ -1105,6 +1211,10 @@ static void MixerSettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     frameType = GetCurrentFrameType();
+#ifdef ACTUATOR_FASTPATH
+    frameIsMultirotor = (frameType == FRAME_TYPE_MULTIROTOR);
+    frameIsFixedwing  = (frameType == FRAME_TYPE_FIXED_WING);
+#endif
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
     uint8_t TreatCustomCraftAs;
     VtolPathFollowerSettingsTreatCustomCraftAsGet(&TreatCustomCraftAs);
@@ -1127,6 +1237,16 @@ static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     SystemSettingsThrustControlGet(&thrustType);
 }
 
+#ifdef ACTUATOR_FASTPATH
+static void FlightModeSettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    FlightModeSettingsArmingOptions arming;
+
+    FlightModeSettingsArmingGet(&arming);
+    alwaysArmed = (arming == FLIGHTMODESETTINGS_ARMING_ALWAYSARMED);
+}
+#endif
+
 /**
  * @}
  * @}
@@ -8,7 +8,8 @@
  * @{
  *
  * @file       actuator.h
- * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ *             The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
  * @brief      Actuator module. Drives the actuators (servos, motors etc).
  *
  * @see        The GNU Public License (GPL) Version 3
@@ -36,6 +37,17 @@
 
 int32_t ActuatorInitialize();
 
+#ifdef ACTUATOR_FASTPATH
+#include <actuatordesired.h>
+
+/**
+ * Mix and output an ActuatorDesired update from the caller's context, for the
+ * stabilization inner loop. Build option, define ACTUATOR_FASTPATH in the
+ * board's pios_config.h to use it.
+ */
+void ActuatorFastPathUpdate(const ActuatorDesiredData *desired);
+#endif
+
 #endif // ACTUATOR_H
 
 /**
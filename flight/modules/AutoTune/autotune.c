@@ -75,8 +75,8 @@
 #define AF_NUMX                   13
 #define AF_NUMP                   43
 
-#if !defined(AT_QUEUE_NUMELEM)
-#define AT_QUEUE_NUMELEM          18
+#if !defined(AT_RING_NUMELEM)
+#define AT_RING_NUMELEM           32 /* must be a power of 2 */
 #endif
 
 #define TASK_STARTUP_DELAY_MS     250                                           /* delay task startup this much, waiting on accessory valid */
@@ -85,11 +85,10 @@
 #define SMOOTH_QUICK_FLUSH_DELAY  0.5f                                          /* wait this long after last change to flush to permanent storage */
 #define SMOOTH_QUICK_FLUSH_TICKS  (SMOOTH_QUICK_FLUSH_DELAY * NOT_AT_MODE_RATE) /* this many ticks after last change to flush to permanent storage */
 
-#define MAX_PTS_PER_CYCLE         4    /* max gyro updates to process per loop see YIELD_MS and consider gyro rate */
 #define INIT_TIME_DELAY_MS        100  /* delay to allow stab bank, etc. to be populated after flight mode switch change detection */
 #define SYSTEMIDENT_TIME_DELAY_MS 2000 /* delay before starting systemident (shaking) flight mode */
 #define INIT_TIME_DELAY2_MS       2500 /* delay before starting to capture data */
-#define YIELD_MS                  2    /* delay this long between processing sessions see MAX_PTS_PER_CYCLE and consider gyro rate */
+#define YIELD_MS                  2    /* delay this long between processing sessions see AT_RING_NUMELEM and consider gyro rate */
 
 // CheckSettings() returned error bits
 #define TAU_NAN                   1
@@ -124,7 +123,11 @@ static union {
 } u;
 static StabilizationBankManualRateData manualRate;
 static xTaskHandle taskHandle;
-static xQueueHandle atQueue;
+// gyro samples, single producer (AtNewGyroData) and single consumer (AutoTuneTask)
+// each side only writes its own index, the indexes are free running
+static struct at_queued_data atRing[AT_RING_NUMELEM];
+static volatile uint32_t atRingHead;
+static volatile uint32_t atRingTail;
 static float gX[AF_NUMX] = { 0 };
 static float gP[AF_NUMP] = { 0 };
 static float gyroReadTimeAverage;
@@ -134,6 +137,8 @@ static float alpha;
 static float smoothQuickValue;
 static float flightModeSwitchToggleStepValue;
 static volatile uint32_t atPointsSpilled;
+static volatile uint32_t atMaxQueuedPoints;
+static uint32_t atPredictTime;
 static uint32_t throttleAccumulator;
 static uint8_t rollMax, pitchMax;
 static int8_t accessoryToUse;
@@ -194,11 +199,6 @@ int32_t AutoTuneInitialize(void)
         ManualControlCommandInitialize();
         StabilizationBankInitialize();
         SystemIdentStateInitialize();
-
-        atQueue = xQueueCreate(AT_QUEUE_NUMELEM, sizeof(struct at_queued_data));
-        if (!atQueue) {
-            moduleEnabled = false;
-        }
     }
     if (!moduleEnabled) {
         // only need to watch for enabling AutoTune in FMS if AutoTune module is _not_ running
@@ -461,11 +461,13 @@ static void AutoTuneTask(__attribute__((unused)) void *parameters)
                 measureTime   = (uint32_t)systemIdentSettings.TuningDuration * (uint32_t)1000;
                 // init the "previous packet timestamp"
                 lastTime = PIOS_DELAY_GetRaw();
-                /* Drain the queue of all current data */
-                xQueueReset(atQueue);
+                /* Drain the ring of all current data */
+                atRingTail = atRingHead;
                 /* And reset the point spill counter */
                 updateCounter       = 0;
                 atPointsSpilled     = 0;
+                atMaxQueuedPoints   = 0;
+                atPredictTime       = 0;
                 throttleAccumulator = 0;
                 alpha = 0.0f;
                 state = AT_RUN;
@@ -474,41 +476,39 @@ static void AutoTuneTask(__attribute__((unused)) void *parameters)
             break;
 
         case AT_RUN:
+        {
             diffTime   = xTaskGetTickCount() - lastUpdateTime;
             doingIdent = true;
-            canSleep   = false;
-            // 4 gyro samples per cycle
-            // 2ms cycle time
-            // that is 500 gyro samples per second if it sleeps each time
-            // actually less than 500 because it cycle time is processing time + 2ms
-            for (int i = 0; i < MAX_PTS_PER_CYCLE; i++) {
-                struct at_queued_data pt;
-                /* Grab an autotune point */
-                if (xQueueReceive(atQueue, &pt, 0) != pdTRUE) {
-                    /* We've drained the buffer fully */
-                    canSleep = true;
-                    break;
-                }
+            // process all the gyro samples queued since the last cycle in one batch
+            // 2ms cycle time, the ring holds AT_RING_NUMELEM samples
+            // that is enough for a 16kHz gyro rate if the cycle time stays below 2ms
+            uint32_t head = atRingHead;
+            // read the samples only after the index that published them
+            __sync_synchronize();
+            uint32_t tail = atRingTail;
+            uint32_t batchStart = PIOS_DELAY_GetRaw();
+            for (; tail != head; tail++) {
+                const struct at_queued_data *pt = &atRing[tail & (AT_RING_NUMELEM - 1)];
                 /* calculate time between successive points */
-                dT_s = PIOS_DELAY_DiffuS2(lastTime, pt.gyroStateCallbackTimestamp) * 1.0e-6f;
+                dT_s = PIOS_DELAY_DiffuS2(lastTime, pt->gyroStateCallbackTimestamp) * 1.0e-6f;
                 /* This is for the first point, but
                 * also if we have extended drops */
                 if (dT_s > 5.0f / PIOS_SENSOR_RATE) {
                     dT_s = 5.0f / PIOS_SENSOR_RATE;
                 }
-                lastTime = pt.gyroStateCallbackTimestamp;
+                lastTime = pt->gyroStateCallbackTimestamp;
                 // original algorithm handles time from GyroStateGet() to detected motion
                 // this algorithm also includes the time from raw gyro read to GyroStateGet()
                 gyroReadTimeAverage = gyroReadTimeAverage * alpha
-                                      + PIOS_DELAY_DiffuS2(pt.sensorReadTimestamp, pt.gyroStateCallbackTimestamp) * 1.0e-6f * (1.0f - alpha);
+                                      + PIOS_DELAY_DiffuS2(pt->sensorReadTimestamp, pt->gyroStateCallbackTimestamp) * 1.0e-6f * (1.0f - alpha);
                 alpha = alpha * gyroReadTimeAverageAlphaAlpha + gyroReadTimeAverageAlpha * (1.0f - gyroReadTimeAverageAlphaAlpha);
-                AfPredict(gX, gP, pt.u, pt.y, dT_s, pt.throttle);
+                AfPredict(gX, gP, pt->u, pt->y, dT_s, pt->throttle);
                 for (int j = 0; j < 3; ++j) {
                     const float NOISE_ALPHA = 0.9997f; // 10 second time constant at 300 Hz
-                    noise[j] = NOISE_ALPHA * noise[j] + (1 - NOISE_ALPHA) * (pt.y[j] - gX[j]) * (pt.y[j] - gX[j]);
+                    noise[j] = NOISE_ALPHA * noise[j] + (1 - NOISE_ALPHA) * (pt->y[j] - gX[j]) * (pt->y[j] - gX[j]);
                 }
                 // This will work up to 8kHz with an 89% throttle position before overflow
-                throttleAccumulator += 10000 * pt.throttle;
+                throttleAccumulator += 10000 * pt->throttle;
                 // Update uavo every 256 cycles to avoid
                 // telemetry spam
                 if (((++updateCounter) & 0xff) == 0) {
@@ -516,11 +516,17 @@ static void AutoTuneTask(__attribute__((unused)) void *parameters)
                     UpdateSystemIdentState(gX, noise, dT_s, updateCounter, atPointsSpilled, hoverThrottle);
                 }
             }
+            atPredictTime += PIOS_DELAY_DiffuS(batchStart);
+            // hand the slots back to AtNewGyroData only once they have been processed
+            atRingTail = tail;
+            // the ring has been drained fully
+            canSleep   = true;
             if (diffTime > measureTime) { // Move on to next state
                 // permanent flag that AT is complete and PIDs can be calculated
                 state = AT_FINISHED;
             }
             break;
+        }
 
         case AT_FINISHED:
             // update with info from the last few data points
@@ -596,11 +602,10 @@ static bool AutoTuneFoundInFMS()
 
 // gyro sensor callback
 // get gyro data and actuatordesired into a packet
-// and put it in the queue for later processing
+// and put it in the ring for later processing
 static void AtNewGyroData(UAVObjEvent *ev)
 {
-    static struct at_queued_data q_item;
-    static bool last_sample_unpushed = false;
+    static float y[3];
     GyroStateData gyro;
     ActuatorDesiredData actuators;
     uint32_t timestamp;
@@ -615,29 +620,35 @@ static void AtNewGyroData(UAVObjEvent *ev)
     GyroStateGet(&gyro);
     ActuatorDesiredGet(&actuators);
 
-    if (last_sample_unpushed) {
-        /* Last time we were unable to queue up the gyro data.
-         * Try again, last chance! */
-        if (xQueueSend(atQueue, &q_item, 0) != pdTRUE) {
-            atPointsSpilled++;
-        }
-    }
+    y[0] = y[0] * stabSettings.gyro_alpha + gyro.x * (1 - stabSettings.gyro_alpha);
+    y[1] = y[1] * stabSettings.gyro_alpha + gyro.y * (1 - stabSettings.gyro_alpha);
+    y[2] = y[2] * stabSettings.gyro_alpha + gyro.z * (1 - stabSettings.gyro_alpha);
 
-    q_item.gyroStateCallbackTimestamp = timestamp;
-    q_item.y[0]     = q_item.y[0] * stabSettings.gyro_alpha + gyro.x * (1 - stabSettings.gyro_alpha);
-    q_item.y[1]     = q_item.y[1] * stabSettings.gyro_alpha + gyro.y * (1 - stabSettings.gyro_alpha);
-    q_item.y[2]     = q_item.y[2] * stabSettings.gyro_alpha + gyro.z * (1 - stabSettings.gyro_alpha);
-    q_item.u[0]     = actuators.Roll;
-    q_item.u[1]     = actuators.Pitch;
-    q_item.u[2]     = actuators.Yaw;
-    q_item.throttle = actuators.Thrust;
-    q_item.sensorReadTimestamp = gyro.SensorReadTimestamp;
-
-    if (xQueueSend(atQueue, &q_item, 0) != pdTRUE) {
-        last_sample_unpushed = true;
-    } else {
-        last_sample_unpushed = false;
+    uint32_t head   = atRingHead;
+    uint32_t queued = head - atRingTail;
+    if (queued >= AT_RING_NUMELEM) {
+        // the task fell behind, drop this sample
+        atPointsSpilled++;
+        return;
     }
+    if (queued >= atMaxQueuedPoints) {
+        atMaxQueuedPoints = queued + 1;
+    }
+
+    struct at_queued_data *q_item = &atRing[head & (AT_RING_NUMELEM - 1)];
+    q_item->gyroStateCallbackTimestamp = timestamp;
+    q_item->y[0]     = y[0];
+    q_item->y[1]     = y[1];
+    q_item->y[2]     = y[2];
+    q_item->u[0]     = actuators.Roll;
+    q_item->u[1]     = actuators.Pitch;
+    q_item->u[2]     = actuators.Yaw;
+    q_item->throttle = actuators.Thrust;
+    q_item->sensorReadTimestamp = gyro.SensorReadTimestamp;
+
+    // the sample must be complete before the task can see it
+    __sync_synchronize();
+    atRingHead = head + 1;
 }
 
 
@@ -799,6 +810,8 @@ static void UpdateSystemIdentState(const float *X, const float *noise,
     u.systemIdentState.Period = dT_s * 1000.0f;
     u.systemIdentState.NumAfPredicts = predicts;
     u.systemIdentState.NumSpilledPts = spills;
+    u.systemIdentState.MaxQueuedPts  = atMaxQueuedPoints;
+    u.systemIdentState.AfPredictRate = (atPredictTime > 0) ? predicts * 1.0e6f / atPredictTime : 0.0f;
     u.systemIdentState.HoverThrottle = hover_throttle;
     u.systemIdentState.GyroReadTimeAverage = gyroReadTimeAverage;
 
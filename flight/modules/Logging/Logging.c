@@ -37,6 +37,11 @@
 #include "debuglogentry.h"
 #include "flightstatus.h"
 
+// Maximum number of entries streamed back to back for a single RetrieveRange request.
+// Each entry in the window is sent from its own DebugLogEntry instance so that
+// updates still queued for telemetry are not overwritten by the next entry.
+#define RETRIEVE_WINDOW_SIZE 8
+
 // private variables
 static DebugLogSettingsData settings;
 static DebugLogControlData control;
@@ -49,6 +54,7 @@ static void SettingsUpdatedCb(UAVObjEvent *ev);
 static void ControlUpdatedCb(UAVObjEvent *ev);
 static void StatusUpdatedCb(UAVObjEvent *ev);
 static void FlightStatusUpdatedCb(UAVObjEvent *ev);
+static void RetrieveRange(uint16_t flight, uint16_t firstEntry, uint16_t count);
 
 int32_t LoggingInitialize(void)
 {
@@ -109,6 +115,7 @@ static void FlightStatusUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 static void SettingsUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     DebugLogSettingsGet(&settings);
+    PIOS_DEBUGLOG_EnableHighRate(settings.LoggingMode == DEBUGLOGSETTINGS_LOGGINGMODE_HIGHRATE);
     if (settings.LoggingEnabled == DEBUGLOGSETTINGS_LOGGINGENABLED_ALWAYS) {
         PIOS_DEBUGLOG_Enable(1);
         PIOS_DEBUGLOG_Printf("On board logging enabled.");
@@ -132,6 +139,8 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
             entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
         }
         DebugLogEntrySet(entry);
+    } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_RETRIEVERANGE) {
+        RetrieveRange(control.Flight, control.Entry, control.Count);
     } else if (control.Operation == DEBUGLOGCONTROL_OPERATION_FORMATFLASH) {
         FlightStatusArmedOptions armed;
         FlightStatusArmedGet(&armed);
@@ -142,6 +151,49 @@ static void ControlUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
     StatusUpdatedCb(ev);
 }
 
+/**
+ * Stream up to count entries of a flight starting at firstEntry.
+ * Entries are pushed to the GCS without waiting for individual requests,
+ * the transfer stops after the first missing entry, which is sent as an
+ * empty entry to mark the end of the flight.
+ */
+static void RetrieveRange(uint16_t flight, uint16_t firstEntry, uint16_t count)
+{
+    uint16_t instances = UAVObjGetNumInstances(DebugLogEntryHandle());
+
+    if (count > RETRIEVE_WINDOW_SIZE) {
+        count = RETRIEVE_WINDOW_SIZE;
+    }
+
+    // Instances are only created on the first streamed download
+    while (instances < count) {
+        DebugLogEntryCreateInstance();
+        if (UAVObjGetNumInstances(DebugLogEntryHandle()) == instances) {
+            break;
+        }
+        instances++;
+    }
+    if (count > instances) {
+        count = instances;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        bool last = false;
+        memset(entry, 0, sizeof(DebugLogEntryData));
+        if (PIOS_DEBUGLOG_Read(entry, flight, firstEntry + i) != 0) {
+            entry->Flight = flight;
+            entry->Entry  = firstEntry + i;
+            entry->Type   = DEBUGLOGENTRY_TYPE_EMPTY;
+            last = true;
+        }
+        DebugLogEntryInstSet(i, entry);
+        DebugLogEntryInstUpdated(i);
+        if (last) {
+            break;
+        }
+    }
+}
+
 
 /**
  * @}
@@ -33,9 +33,17 @@
 
 #include "openpilot.h"
 #include "pios.h"
+#include "fonts.h"
+#include "osdrender.h"
 
 int32_t osdgenInitialize(void);
 
+// Frame buffers, swapped by the video driver
+extern uint8_t *draw_buffer_level;
+extern uint8_t *draw_buffer_mask;
+extern uint8_t *disp_buffer_level;
+extern uint8_t *disp_buffer_mask;
+
 // Size of an array (num items.)
 #define SIZEOF_ARRAY(x) (sizeof(x) / sizeof((x)[0]))
 
@@ -196,11 +204,12 @@ void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsi
 void write_word_misaligned_NAND(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff);
 void write_word_misaligned_OR(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff);
 void write_word_misaligned_lm(uint16_t wordl, uint16_t wordm, unsigned int addr, unsigned int xoff, int lmode, int mmode);
-// int fetch_font_info(char ch, int font, struct FontEntry *font_info, char *lookup);
+int fetch_font_info(uint8_t ch, int font, struct FontEntry *font_info, char *lookup);
 void write_char(char ch, unsigned int x, unsigned int y, int flags, int font);
-// void calc_text_dimensions(char *str, struct FontEntry font, int xs, int ys, struct FontDimensions *dim);
+void calc_text_dimensions(char *str, struct FontEntry font, int xs, int ys, struct FontDimensions *dim);
 void write_string(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys, int va, int ha, int flags, int font);
 void write_string_formatted(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys, int va, int ha, int flags);
+void write_string_widget(uint8_t id, char *str, unsigned int x, unsigned int y, int va, int ha, int font);
 
 void updateOnceEveryFrame();
 
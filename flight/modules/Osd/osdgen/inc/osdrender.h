@@ -0,0 +1,76 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup OSDgenModule osdgen Module
+ * @{
+ *
+ * @file       osdrender.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Retained mode layer of the OSD renderer
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OSDRENDER_H_
+#define OSDRENDER_H_
+
+/*
+ * Instead of clearing and redrawing the whole frame buffer every frame, the
+ * renderer keeps track of what was drawn in each of the two (swapped) frame
+ * buffers, with a resolution of one row by one 32 bit word.
+ *
+ * - Everything drawn outside a widget is cleared again the next time the
+ *   same buffer is drawn, only where something was drawn.
+ * - Content drawn between osd_render_widget_begin() and osd_render_widget_end()
+ *   is retained: as long as the key passed by the caller (a hash of what the
+ *   widget shows and where) does not change, the widget is not redrawn.
+ *   Widgets that are not drawn anymore are cleared on the next frame.
+ *
+ * Widgets are expected not to overlap each other. If they do, the renderer
+ * falls back to a full clear of that buffer the next time it is drawn.
+ */
+
+#define OSD_RENDER_LINE_BYTES       (GRAPHICS_WIDTH_REAL / 8)
+#define OSD_RENDER_LINE_WORDS       ((OSD_RENDER_LINE_BYTES + 3) / 4)
+#define OSD_RENDER_MAX_WIDGETS      32
+#define OSD_RENDER_GLYPH_CACHE_SIZE 32
+
+struct osd_render_stats {
+    uint32_t frames; // frames drawn since reset
+    uint32_t fullClears; // frames that had to clear the whole buffer
+    uint32_t bytesCleared; // bytes cleared per buffer
+    uint32_t widgetsDrawn;
+    uint32_t widgetsRetained; // widgets left untouched because their key did not change
+    uint32_t glyphCacheMisses;
+};
+
+void osd_render_reset(void);
+void osd_render_begin_frame(void);
+void osd_render_end_frame(void);
+bool osd_render_widget_begin(uint8_t id, uint32_t key);
+bool osd_render_widget_begin_values(uint8_t id, const int32_t *values, uint32_t count);
+void osd_render_widget_end(void);
+uint32_t osd_render_hash(uint32_t hash, const void *data, uint32_t length);
+void osd_render_mark(unsigned int y0, unsigned int y1, unsigned int b0, unsigned int b1);
+void osd_render_fill_bytes(uint8_t *buff, unsigned int addr, unsigned int count, int mode);
+void osd_render_get_stats(struct osd_render_stats *stats);
+
+#define OSD_RENDER_HASH_INIT 2166136261u
+
+#endif /* OSDRENDER_H_ */
@@ -44,9 +44,6 @@
 #include "taskinfo.h"
 #include "flightstatus.h"
 
-#include "fonts.h"
-#include "font12x18.h"
-#include "font8x10.h"
 #include "WMMInternal.h"
 
 #include "splash.h"
@@ -68,11 +65,6 @@
    static float m_gpsAlt=0;
    static float m_gpsSpd=0;*/
 
-extern uint8_t *draw_buffer_level;
-extern uint8_t *draw_buffer_mask;
-extern uint8_t *disp_buffer_level;
-extern uint8_t *disp_buffer_mask;
-
 TTime timex;
 
 // ****************
@@ -90,6 +82,13 @@ xSemaphoreHandle osdSemaphore = NULL;
 #define TASK_PRIORITY    (tskIDLE_PRIORITY + 4)
 #define UPDATE_PERIOD    100
 
+// Retained widgets, see osdrender.h
+#define OSD_WIDGET_ATTITUDE 0
+#define OSD_WIDGET_SPEED    1
+#define OSD_WIDGET_ALTITUDE 2
+#define OSD_WIDGET_HEADING  3
+#define OSD_WIDGET_TEXT     4 // one per line of text
+
 // ****************
 // Private variables
 
@@ -128,8 +127,7 @@ uint16_t mirror(uint16_t source)
 
 void clearGraphics()
 {
-    memset((uint8_t *)draw_buffer_mask, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
-    memset((uint8_t *)draw_buffer_level, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+    osd_render_reset();
 }
 
 void copyimage(uint16_t offsetx, uint16_t offsety, int image)
@@ -154,6 +152,7 @@ void copyimage(uint16_t offsetx, uint16_t offsety, int image)
             x1 += 2;
         }
     }
+    osd_render_mark(offsety, offsety + splash_info.height - 1, offsetx, offsetx + splash_info.width / 8 - 1);
 }
 
 uint8_t validPos(uint16_t x, uint16_t y)
@@ -335,1140 +334,7 @@ void drawBox(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
 
 // simple routines
 
-// SUPEROSD routines, modified
-
-/**
- * write_pixel: Write a pixel at an x,y position to a given surface.
- *
- * @param       buff    pointer to buffer to write in
- * @param       x               x coordinate
- * @param       y               y coordinate
- * @param       mode    0 = clear bit, 1 = set bit, 2 = toggle bit
- */
-void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
-{
-    CHECK_COORDS(x, y);
-    // Determine the bit in the word to be set and the word
-    // index to set it in.
-    int bitnum    = CALC_BIT_IN_WORD(x);
-    int wordnum   = CALC_BUFF_ADDR(x, y);
-    // Apply a mask.
-    uint16_t mask = 1 << (7 - bitnum);
-    WRITE_WORD_MODE(buff, wordnum, mask, mode);
-}
-
-/**
- * write_pixel_lm: write the pixel on both surfaces (level and mask.)
- * Uses current draw buffer.
- *
- * @param       x               x coordinate
- * @param       y               y coordinate
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- * @param       lmode   0 = black, 1 = white, 2 = toggle
- */
-void write_pixel_lm(unsigned int x, unsigned int y, int mmode, int lmode)
-{
-    CHECK_COORDS(x, y);
-    // Determine the bit in the word to be set and the word
-    // index to set it in.
-    int bitnum    = CALC_BIT_IN_WORD(x);
-    int wordnum   = CALC_BUFF_ADDR(x, y);
-    // Apply the masks.
-    uint16_t mask = 1 << (7 - bitnum);
-    WRITE_WORD_MODE(draw_buffer_mask, wordnum, mask, mmode);
-    WRITE_WORD_MODE(draw_buffer_level, wordnum, mask, lmode);
-}
-
-/**
- * write_hline: optimised horizontal line writing algorithm
- *
- * @param       buff    pointer to buffer to write in
- * @param       x0              x0 coordinate
- * @param       x1              x1 coordinate
- * @param       y               y coordinate
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y, int mode)
-{
-    CLIP_COORDS(x0, y);
-    CLIP_COORDS(x1, y);
-    if (x0 > x1) {
-        SWAP(x0, x1);
-    }
-    if (x0 == x1) {
-        return;
-    }
-    /* This is an optimised algorithm for writing horizontal lines.
-    * We begin by finding the addresses of the x0 and x1 points. */
-    int addr0     = CALC_BUFF_ADDR(x0, y);
-    int addr1     = CALC_BUFF_ADDR(x1, y);
-    int addr0_bit = CALC_BIT_IN_WORD(x0);
-    int addr1_bit = CALC_BIT_IN_WORD(x1);
-    int mask, mask_l, mask_r, i;
-    /* If the addresses are equal, we only need to write one word
-     * which is an island. */
-    if (addr0 == addr1) {
-        mask = COMPUTE_HLINE_ISLAND_MASK(addr0_bit, addr1_bit);
-        WRITE_WORD_MODE(buff, addr0, mask, mode);
-    } else {
-        /* Otherwise we need to write the edges and then the middle. */
-        mask_l = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
-        mask_r = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
-        WRITE_WORD_MODE(buff, addr0, mask_l, mode);
-        WRITE_WORD_MODE(buff, addr1, mask_r, mode);
-        // Now write 0xffff words from start+1 to end-1.
-        for (i = addr0 + 1; i <= addr1 - 1; i++) {
-            uint8_t m = 0xff;
-            WRITE_WORD_MODE(buff, i, m, mode);
-        }
-    }
-}
-
-/**
- * write_hline_lm: write both level and mask buffers.
- *
- * @param       x0              x0 coordinate
- * @param       x1              x1 coordinate
- * @param       y               y coordinate
- * @param       lmode   0 = clear, 1 = set, 2 = toggle
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_hline_lm(unsigned int x0, unsigned int x1, unsigned int y, int lmode, int mmode)
-{
-    // TODO: an optimisation would compute the masks and apply to
-    // both buffers simultaneously.
-    write_hline(draw_buffer_level, x0, x1, y, lmode);
-    write_hline(draw_buffer_mask, x0, x1, y, mmode);
-}
-
-/**
- * write_hline_outlined: outlined horizontal line with varying endcaps
- * Always uses draw buffer.
- *
- * @param       x0                      x0 coordinate
- * @param       x1                      x1 coordinate
- * @param       y                       y coordinate
- * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
- * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
- * @param       mode            0 = black outline, white body, 1 = white outline, black body
- * @param       mmode           0 = clear, 1 = set, 2 = toggle
- */
-void write_hline_outlined(unsigned int x0, unsigned int x1, unsigned int y, int endcap0, int endcap1, int mode, int mmode)
-{
-    int stroke, fill;
-
-    SETUP_STROKE_FILL(stroke, fill, mode)
-    if (x0 > x1) {
-        SWAP(x0, x1);
-    }
-    // Draw the main body of the line.
-    write_hline_lm(x0 + 1, x1 - 1, y - 1, stroke, mmode);
-    write_hline_lm(x0 + 1, x1 - 1, y + 1, stroke, mmode);
-    write_hline_lm(x0 + 1, x1 - 1, y, fill, mmode);
-    // Draw the endcaps, if any.
-    DRAW_ENDCAP_HLINE(endcap0, x0, y, stroke, fill, mmode);
-    DRAW_ENDCAP_HLINE(endcap1, x1, y, stroke, fill, mmode);
-}
-
-/**
- * write_vline: optimised vertical line writing algorithm
- *
- * @param       buff    pointer to buffer to write in
- * @param       x               x coordinate
- * @param       y0              y0 coordinate
- * @param       y1              y1 coordinate
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_vline(uint8_t *buff, unsigned int x, unsigned int y0, unsigned int y1, int mode)
-{
-    unsigned int a;
-
-    CLIP_COORDS(x, y0);
-    CLIP_COORDS(x, y1);
-    if (y0 > y1) {
-        SWAP(y0, y1);
-    }
-    if (y0 == y1) {
-        return;
-    }
-    /* This is an optimised algorithm for writing vertical lines.
-     * We begin by finding the addresses of the x,y0 and x,y1 points. */
-    unsigned int addr0  = CALC_BUFF_ADDR(x, y0);
-    unsigned int addr1  = CALC_BUFF_ADDR(x, y1);
-    /* Then we calculate the pixel data to be written. */
-    unsigned int bitnum = CALC_BIT_IN_WORD(x);
-    uint16_t mask = 1 << (7 - bitnum);
-    /* Run from addr0 to addr1 placing pixels. Increment by the number
-     * of words n each graphics line. */
-    for (a = addr0; a <= addr1; a += GRAPHICS_WIDTH_REAL / 8) {
-        WRITE_WORD_MODE(buff, a, mask, mode);
-    }
-}
-
-/**
- * write_vline_lm: write both level and mask buffers.
- *
- * @param       x               x coordinate
- * @param       y0              y0 coordinate
- * @param       y1              y1 coordinate
- * @param       lmode   0 = clear, 1 = set, 2 = toggle
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_vline_lm(unsigned int x, unsigned int y0, unsigned int y1, int lmode, int mmode)
-{
-    // TODO: an optimisation would compute the masks and apply to
-    // both buffers simultaneously.
-    write_vline(draw_buffer_level, x, y0, y1, lmode);
-    write_vline(draw_buffer_mask, x, y0, y1, mmode);
-}
-
-/**
- * write_vline_outlined: outlined vertical line with varying endcaps
- * Always uses draw buffer.
- *
- * @param       x                       x coordinate
- * @param       y0                      y0 coordinate
- * @param       y1                      y1 coordinate
- * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
- * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
- * @param       mode            0 = black outline, white body, 1 = white outline, black body
- * @param       mmode           0 = clear, 1 = set, 2 = toggle
- */
-void write_vline_outlined(unsigned int x, unsigned int y0, unsigned int y1, int endcap0, int endcap1, int mode, int mmode)
-{
-    int stroke, fill;
-
-    if (y0 > y1) {
-        SWAP(y0, y1);
-    }
-    SETUP_STROKE_FILL(stroke, fill, mode);
-    // Draw the main body of the line.
-    write_vline_lm(x - 1, y0 + 1, y1 - 1, stroke, mmode);
-    write_vline_lm(x + 1, y0 + 1, y1 - 1, stroke, mmode);
-    write_vline_lm(x, y0 + 1, y1 - 1, fill, mmode);
-    // Draw the endcaps, if any.
-    DRAW_ENDCAP_VLINE(endcap0, x, y0, stroke, fill, mmode);
-    DRAW_ENDCAP_VLINE(endcap1, x, y1, stroke, fill, mmode);
-}
-
-/**
- * write_filled_rectangle: draw a filled rectangle.
- *
- * Uses an optimised algorithm which is similar to the horizontal
- * line writing algorithm, but optimised for writing the lines
- * multiple times without recalculating lots of stuff.
- *
- * @param       buff    pointer to buffer to write in
- * @param       x               x coordinate (left)
- * @param       y               y coordinate (top)
- * @param       width   rectangle width
- * @param       height  rectangle height
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsigned int width, unsigned int height, int mode)
-{
-    unsigned int yy, addr0_old, addr1_old;
-
-    CHECK_COORDS(x, y);
-    CHECK_COORD_X(x + width);
-    CHECK_COORD_Y(y + height);
-    if (width <= 0 || height <= 0) {
-        return;
-    }
-    // Calculate as if the rectangle was only a horizontal line. We then
-    // step these addresses through each row until we iterate `height` times.
-    unsigned int addr0     = CALC_BUFF_ADDR(x, y);
-    unsigned int addr1     = CALC_BUFF_ADDR(x + width, y);
-    unsigned int addr0_bit = CALC_BIT_IN_WORD(x);
-    unsigned int addr1_bit = CALC_BIT_IN_WORD(x + width);
-    unsigned int mask, mask_l, mask_r, i;
-    // If the addresses are equal, we need to write one word vertically.
-    if (addr0 == addr1) {
-        mask = COMPUTE_HLINE_ISLAND_MASK(addr0_bit, addr1_bit);
-        while (height--) {
-            WRITE_WORD_MODE(buff, addr0, mask, mode);
-            addr0 += GRAPHICS_WIDTH_REAL / 8;
-        }
-    } else {
-        // Otherwise we need to write the edges and then the middle repeatedly.
-        mask_l    = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
-        mask_r    = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
-        // Write edges first.
-        yy        = 0;
-        addr0_old = addr0;
-        addr1_old = addr1;
-        while (yy < height) {
-            WRITE_WORD_MODE(buff, addr0, mask_l, mode);
-            WRITE_WORD_MODE(buff, addr1, mask_r, mode);
-            addr0 += GRAPHICS_WIDTH_REAL / 8;
-            addr1 += GRAPHICS_WIDTH_REAL / 8;
-            yy++;
-        }
-        // Now write 0xffff words from start+1 to end-1 for each row.
-        yy    = 0;
-        addr0 = addr0_old;
-        addr1 = addr1_old;
-        while (yy < height) {
-            for (i = addr0 + 1; i <= addr1 - 1; i++) {
-                uint8_t m = 0xff;
-                WRITE_WORD_MODE(buff, i, m, mode);
-            }
-            addr0 += GRAPHICS_WIDTH_REAL / 8;
-            addr1 += GRAPHICS_WIDTH_REAL / 8;
-            yy++;
-        }
-    }
-}
-
-/**
- * write_filled_rectangle_lm: draw a filled rectangle on both draw buffers.
- *
- * @param       x               x coordinate (left)
- * @param       y               y coordinate (top)
- * @param       width   rectangle width
- * @param       height  rectangle height
- * @param       lmode   0 = clear, 1 = set, 2 = toggle
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_filled_rectangle_lm(unsigned int x, unsigned int y, unsigned int width, unsigned int height, int lmode, int mmode)
-{
-    write_filled_rectangle(draw_buffer_mask, x, y, width, height, mmode);
-    write_filled_rectangle(draw_buffer_level, x, y, width, height, lmode);
-}
-
-/**
- * write_rectangle_outlined: draw an outline of a rectangle. Essentially
- * a convenience wrapper for draw_hline_outlined and draw_vline_outlined.
- *
- * @param       x               x coordinate (left)
- * @param       y               y coordinate (top)
- * @param       width   rectangle width
- * @param       height  rectangle height
- * @param       mode    0 = black outline, white body, 1 = white outline, black body
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_rectangle_outlined(unsigned int x, unsigned int y, int width, int height, int mode, int mmode)
-{
-    // CHECK_COORDS(x, y);
-    // CHECK_COORDS(x + width, y + height);
-    // if((x + width) > DISP_WIDTH) width = DISP_WIDTH - x;
-    // if((y + height) > DISP_HEIGHT) height = DISP_HEIGHT - y;
-    write_hline_outlined(x, x + width, y, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
-    write_hline_outlined(x, x + width, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
-    write_vline_outlined(x, y, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
-    write_vline_outlined(x + width, y, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
-}
-
-/**
- * write_circle: draw the outline of a circle on a given buffer,
- * with an optional dash pattern for the line instead of a normal line.
- *
- * @param       buff    pointer to buffer to write in
- * @param       cx              origin x coordinate
- * @param       cy              origin y coordinate
- * @param       r               radius
- * @param       dashp   dash period (pixels) - zero for no dash
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_circle(uint8_t *buff, unsigned int cx, unsigned int cy, unsigned int r, unsigned int dashp, int mode)
-{
-    CHECK_COORDS(cx, cy);
-    int error = -r, x = r, y = 0;
-    while (x >= y) {
-        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
-            CIRCLE_PLOT_8(buff, cx, cy, x, y, mode);
-        }
-        error += (y * 2) + 1;
-        y++;
-        if (error >= 0) {
-            --x;
-            error -= x * 2;
-        }
-    }
-}
-
-/**
- * write_circle_outlined: draw an outlined circle on the draw buffer.
- *
- * @param       cx              origin x coordinate
- * @param       cy              origin y coordinate
- * @param       r               radius
- * @param       dashp   dash period (pixels) - zero for no dash
- * @param       bmode   0 = 4-neighbour border, 1 = 8-neighbour border
- * @param       mode    0 = black outline, white body, 1 = white outline, black body
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_circle_outlined(unsigned int cx, unsigned int cy, unsigned int r, unsigned int dashp, int bmode, int mode, int mmode)
-{
-    int stroke, fill;
-
-    CHECK_COORDS(cx, cy);
-    SETUP_STROKE_FILL(stroke, fill, mode);
-    // This is a two step procedure. First, we draw the outline of the
-    // circle, then we draw the inner part.
-    int error = -r, x = r, y = 0;
-    while (x >= y) {
-        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
-            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x + 1, y, mmode);
-            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x + 1, y, stroke);
-            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y + 1, mmode);
-            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y + 1, stroke);
-            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x - 1, y, mmode);
-            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x - 1, y, stroke);
-            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y - 1, mmode);
-            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y - 1, stroke);
-            if (bmode == 1) {
-                CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x + 1, y + 1, mmode);
-                CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x + 1, y + 1, stroke);
-                CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x - 1, y - 1, mmode);
-                CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x - 1, y - 1, stroke);
-            }
-        }
-        error += (y * 2) + 1;
-        y++;
-        if (error >= 0) {
-            --x;
-            error -= x * 2;
-        }
-    }
-    error = -r;
-    x     = r;
-    y     = 0;
-    while (x >= y) {
-        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
-            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y, mmode);
-            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y, fill);
-        }
-        error += (y * 2) + 1;
-        y++;
-        if (error >= 0) {
-            --x;
-            error -= x * 2;
-        }
-    }
-}
-
-/**
- * write_circle_filled: fill a circle on a given buffer.
- *
- * @param       buff    pointer to buffer to write in
- * @param       cx              origin x coordinate
- * @param       cy              origin y coordinate
- * @param       r               radius
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_circle_filled(uint8_t *buff, unsigned int cx, unsigned int cy, unsigned int r, int mode)
-{
-    CHECK_COORDS(cx, cy);
-    int error = -r, x = r, y = 0, xch = 0;
-    // It turns out that filled circles can take advantage of the midpoint
-    // circle algorithm. We simply draw very fast horizontal lines across each
-    // pair of X,Y coordinates. In some cases, this can even be faster than
-    // drawing an outlined circle!
-    //
-    // Due to multiple writes to each set of pixels, we have a special exception
-    // for when using the toggling draw mode.
-    while (x >= y) {
-        if (y != 0) {
-            write_hline(buff, cx - x, cx + x, cy + y, mode);
-            write_hline(buff, cx - x, cx + x, cy - y, mode);
-            if (mode != 2 || (mode == 2 && xch && (cx - x) != (cx - y))) {
-                write_hline(buff, cx - y, cx + y, cy + x, mode);
-                write_hline(buff, cx - y, cx + y, cy - x, mode);
-                xch = 0;
-            }
-        }
-        error += (y * 2) + 1;
-        y++;
-        if (error >= 0) {
-            --x;
-            xch    = 1;
-            error -= x * 2;
-        }
-    }
-    // Handle toggle mode.
-    if (mode == 2) {
-        write_hline(buff, cx - r, cx + r, cy, mode);
-    }
-}
-
-/**
- * write_line: Draw a line of arbitrary angle.
- *
- * @param       buff    pointer to buffer to write in
- * @param       x0              first x coordinate
- * @param       y0              first y coordinate
- * @param       x1              second x coordinate
- * @param       y1              second y coordinate
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_line(uint8_t *buff, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, int mode)
-{
-    // Based on http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
-    unsigned int steep = abs(y1 - y0) > abs(x1 - x0);
-
-    if (steep) {
-        SWAP(x0, y0);
-        SWAP(x1, y1);
-    }
-    if (x0 > x1) {
-        SWAP(x0, x1);
-        SWAP(y0, y1);
-    }
-    int deltax     = x1 - x0;
-    unsigned int deltay = abs(y1 - y0);
-    int error      = deltax / 2;
-    int ystep;
-    unsigned int y = y0;
-    unsigned int x; // , lasty = y, stox = 0;
-    if (y0 < y1) {
-        ystep = 1;
-    } else {
-        ystep = -1;
-    }
-    for (x = x0; x < x1; x++) {
-        if (steep) {
-            write_pixel(buff, y, x, mode);
-        } else {
-            write_pixel(buff, x, y, mode);
-        }
-        error -= deltay;
-        if (error < 0) {
-            y     += ystep;
-            error += deltax;
-        }
-    }
-}
-
-/**
- * write_line_lm: Draw a line of arbitrary angle.
- *
- * @param       x0              first x coordinate
- * @param       y0              first y coordinate
- * @param       x1              second x coordinate
- * @param       y1              second y coordinate
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- * @param       lmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_line_lm(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, int mmode, int lmode)
-{
-    write_line(draw_buffer_mask, x0, y0, x1, y1, mmode);
-    write_line(draw_buffer_level, x0, y0, x1, y1, lmode);
-}
-
-/**
- * write_line_outlined: Draw a line of arbitrary angle, with an outline.
- *
- * @param       buff            pointer to buffer to write in
- * @param       x0                      first x coordinate
- * @param       y0                      first y coordinate
- * @param       x1                      second x coordinate
- * @param       y1                      second y coordinate
- * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
- * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
- * @param       mode            0 = black outline, white body, 1 = white outline, black body
- * @param       mmode           0 = clear, 1 = set, 2 = toggle
- */
-void write_line_outlined(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
-                         __attribute__((unused)) int endcap0, __attribute__((unused)) int endcap1,
-                         int mode, int mmode)
-{
-    // Based on http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
-    // This could be improved for speed.
-    int omode, imode;
-
-    if (mode == 0) {
-        omode = 0;
-        imode = 1;
-    } else {
-        omode = 1;
-        imode = 0;
-    }
-    int steep = abs(y1 - y0) > abs(x1 - x0);
-    if (steep) {
-        SWAP(x0, y0);
-        SWAP(x1, y1);
-    }
-    if (x0 > x1) {
-        SWAP(x0, x1);
-        SWAP(y0, y1);
-    }
-    int deltax     = x1 - x0;
-    unsigned int deltay = abs(y1 - y0);
-    int error      = deltax / 2;
-    int ystep;
-    unsigned int y = y0;
-    unsigned int x;
-    if (y0 < y1) {
-        ystep = 1;
-    } else {
-        ystep = -1;
-    }
-    // Draw the outline.
-    for (x = x0; x < x1; x++) {
-        if (steep) {
-            write_pixel_lm(y - 1, x, mmode, omode);
-            write_pixel_lm(y + 1, x, mmode, omode);
-            write_pixel_lm(y, x - 1, mmode, omode);
-            write_pixel_lm(y, x + 1, mmode, omode);
-        } else {
-            write_pixel_lm(x - 1, y, mmode, omode);
-            write_pixel_lm(x + 1, y, mmode, omode);
-            write_pixel_lm(x, y - 1, mmode, omode);
-            write_pixel_lm(x, y + 1, mmode, omode);
-        }
-        error -= deltay;
-        if (error < 0) {
-            y     += ystep;
-            error += deltax;
-        }
-    }
-    // Now draw the innards.
-    error = deltax / 2;
-    y     = y0;
-    for (x = x0; x < x1; x++) {
-        if (steep) {
-            write_pixel_lm(y, x, mmode, imode);
-        } else {
-            write_pixel_lm(x, y, mmode, imode);
-        }
-        error -= deltay;
-        if (error < 0) {
-            y     += ystep;
-            error += deltax;
-        }
-    }
-}
-
-/**
- * write_word_misaligned: Write a misaligned word across two addresses
- * with an x offset.
- *
- * This allows for many pixels to be set in one write.
- *
- * @param       buff    buffer to write in
- * @param       word    word to write (16 bits)
- * @param       addr    address of first word
- * @param       xoff    x offset (0-15)
- * @param       mode    0 = clear, 1 = set, 2 = toggle
- */
-void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff, int mode)
-{
-    int16_t firstmask = word >> xoff;
-    int16_t lastmask  = word << (16 - xoff);
-
-    WRITE_WORD_MODE(buff, addr + 1, firstmask && 0x00ff, mode);
-    WRITE_WORD_MODE(buff, addr, (firstmask & 0xff00) >> 8, mode);
-    if (xoff > 0) {
-        WRITE_WORD_MODE(buff, addr + 2, (lastmask & 0xff00) >> 8, mode);
-    }
-}
-
-/**
- * write_word_misaligned_NAND: Write a misaligned word across two addresses
- * with an x offset, using a NAND mask.
- *
- * This allows for many pixels to be set in one write.
- *
- * @param       buff    buffer to write in
- * @param       word    word to write (16 bits)
- * @param       addr    address of first word
- * @param       xoff    x offset (0-15)
- *
- * This is identical to calling write_word_misaligned with a mode of 0 but
- * it doesn't go through a lot of switch logic which slows down text writing
- * a lot.
- */
-void write_word_misaligned_NAND(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff)
-{
-    uint16_t firstmask = word >> xoff;
-    uint16_t lastmask  = word << (16 - xoff);
-
-    WRITE_WORD_NAND(buff, addr + 1, firstmask & 0x00ff);
-    WRITE_WORD_NAND(buff, addr, (firstmask & 0xff00) >> 8);
-    if (xoff > 0) {
-        WRITE_WORD_NAND(buff, addr + 2, (lastmask & 0xff00) >> 8);
-    }
-}
-
-/**
- * write_word_misaligned_OR: Write a misaligned word across two addresses
- * with an x offset, using an OR mask.
- *
- * This allows for many pixels to be set in one write.
- *
- * @param       buff    buffer to write in
- * @param       word    word to write (16 bits)
- * @param       addr    address of first word
- * @param       xoff    x offset (0-15)
- *
- * This is identical to calling write_word_misaligned with a mode of 1 but
- * it doesn't go through a lot of switch logic which slows down text writing
- * a lot.
- */
-void write_word_misaligned_OR(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff)
-{
-    uint16_t firstmask = word >> xoff;
-    uint16_t lastmask  = word << (16 - xoff);
-
-    WRITE_WORD_OR(buff, addr + 1, firstmask & 0x00ff);
-    WRITE_WORD_OR(buff, addr, (firstmask & 0xff00) >> 8);
-    if (xoff > 0) {
-        WRITE_WORD_OR(buff, addr + 2, (lastmask & 0xff00) >> 8);
-    }
-}
-
-/**
- * write_word_misaligned_lm: Write a misaligned word across two
- * words, in both level and mask buffers. This is core to the text
- * writing routines.
- *
- * @param       buff    buffer to write in
- * @param       word    word to write (16 bits)
- * @param       addr    address of first word
- * @param       xoff    x offset (0-15)
- * @param       lmode   0 = clear, 1 = set, 2 = toggle
- * @param       mmode   0 = clear, 1 = set, 2 = toggle
- */
-void write_word_misaligned_lm(uint16_t wordl, uint16_t wordm, unsigned int addr, unsigned int xoff, int lmode, int mmode)
-{
-    write_word_misaligned(draw_buffer_level, wordl, addr, xoff, lmode);
-    write_word_misaligned(draw_buffer_mask, wordm, addr, xoff, mmode);
-}
-
-/**
- * fetch_font_info: Fetch font info structs.
- *
- * @param       ch              character
- * @param       font    font id
- */
-int fetch_font_info(uint8_t ch, int font, struct FontEntry *font_info, char *lookup)
-{
-    // First locate the font struct.
-    if ((unsigned int)font > SIZEOF_ARRAY(fonts)) {
-        return 0; // font does not exist, exit.
-    }
-    // Load the font info; IDs are always sequential.
-    *font_info = fonts[font];
-    // Locate character in font lookup table. (If required.)
-    if (lookup != NULL) {
-        *lookup = font_info->lookup[ch];
-        if (*lookup == 0xff) {
-            return 0; // character doesn't exist, don't bother writing it.
-        }
-    }
-    return 1;
-}
-
-/**
- * write_char16: Draw a character on the current draw buffer.
- * Currently supports outlined characters and characters with
- * a width of up to 8 pixels.
- *
- * @param       ch              character to write
- * @param       x               x coordinate (left)
- * @param       y               y coordinate (top)
- * @param       flags   flags to write with (see gfx.h)
- * @param       font    font to use
- */
-void write_char16(char ch, unsigned int x, unsigned int y, int font)
-{
-    unsigned int yy, addr_temp, row, row_temp, xshift;
-    uint16_t and_mask, or_mask, levels;
-    struct FontEntry font_info;
-
-    // char lookup = 0;
-    fetch_font_info(0, font, &font_info, NULL);
-
-    // Compute starting address (for x,y) of character.
-    int addr = CALC_BUFF_ADDR(x, y);
-    int wbit = CALC_BIT_IN_WORD(x);
-    // If font only supports lowercase or uppercase, make the letter
-    // lowercase or uppercase.
-    // How big is the character? We handle characters up to 8 pixels
-    // wide for now. Support for large characters may be added in future.
-    {
-        // Ensure we don't overflow.
-        if (x + wbit > GRAPHICS_WIDTH_REAL) {
-            return;
-        }
-        // Load data pointer.
-        row       = ch * font_info.height;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
-        for (yy = y; yy < y + font_info.height; yy++) {
-            if (font == 3) {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask12x18[row] << xshift, addr, wbit);
-            } else {
-                write_word_misaligned_OR(draw_buffer_mask, font_mask8x10[row] << xshift, addr, wbit);
-            }
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
-        for (yy = y; yy < y + font_info.height; yy++) {
-            if (font == 3) {
-                levels   = font_frame12x18[row];
-                // if(!(flags & FONT_INVERT)) // data is normally inverted
-                levels   = ~levels;
-                or_mask  = font_mask12x18[row] << xshift;
-                and_mask = (font_mask12x18[row] & levels) << xshift;
-            } else {
-                levels   = font_frame8x10[row];
-                // if(!(flags & FONT_INVERT)) // data is normally inverted
-                levels   = ~levels;
-                or_mask  = font_mask8x10[row] << xshift;
-                and_mask = (font_mask8x10[row] & levels) << xshift;
-            }
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
-            // If we're not bold write the AND mask.
-            // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-    }
-}
-
-/**
- * write_char: Draw a character on the current draw buffer.
- * Currently supports outlined characters and characters with
- * a width of up to 8 pixels.
- *
- * @param       ch              character to write
- * @param       x               x coordinate (left)
- * @param       y               y coordinate (top)
- * @param       flags   flags to write with (see gfx.h)
- * @param       font    font to use
- */
-void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
-{
-    unsigned int yy, addr_temp, row, row_temp, xshift;
-    uint16_t and_mask, or_mask, levels;
-    struct FontEntry font_info;
-    char lookup = 0;
-
-    fetch_font_info(ch, font, &font_info, &lookup);
-    // Compute starting address (for x,y) of character.
-    unsigned int addr = CALC_BUFF_ADDR(x, y);
-    unsigned int wbit = CALC_BIT_IN_WORD(x);
-    // If font only supports lowercase or uppercase, make the letter
-    // lowercase or uppercase.
-    /*if(font_info.flags & FONT_LOWERCASE_ONLY)
-       ch = tolower(ch);
-       if(font_info.flags & FONT_UPPERCASE_ONLY)
-       ch = toupper(ch);*/
-    fetch_font_info(ch, font, &font_info, &lookup);
-    // How big is the character? We handle characters up to 8 pixels
-    // wide for now. Support for large characters may be added in future.
-    if (font_info.width <= 8) {
-        // Ensure we don't overflow.
-        if (x + wbit > GRAPHICS_WIDTH_REAL) {
-            return;
-        }
-        // Load data pointer.
-        row       = lookup * font_info.height * 2;
-        row_temp  = row;
-        addr_temp = addr;
-        xshift    = 16 - font_info.width;
-        // We can write mask words easily.
-        for (yy = y; yy < y + font_info.height; yy++) {
-            write_word_misaligned_OR(draw_buffer_mask, font_info.data[row] << xshift, addr, wbit);
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-        // Level bits are more complicated. We need to set or clear
-        // level bits, but only where the mask bit is set; otherwise,
-        // we need to leave them alone. To do this, for each word, we
-        // construct an AND mask and an OR mask, and apply each individually.
-        row  = row_temp;
-        addr = addr_temp;
-        for (yy = y; yy < y + font_info.height; yy++) {
-            levels = font_info.data[row + font_info.height];
-            if (!(flags & FONT_INVERT)) {
-                // data is normally inverted
-                levels = ~levels;
-            }
-            or_mask  = font_info.data[row] << xshift;
-            and_mask = (font_info.data[row] & levels) << xshift;
-            write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
-            // If we're not bold write the AND mask.
-            // if(!(flags & FONT_BOLD))
-            write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
-            addr += GRAPHICS_WIDTH_REAL / 8;
-            row++;
-        }
-    }
-}
-
-/**
- * calc_text_dimensions: Calculate the dimensions of a
- * string in a given font. Supports new lines and
- * carriage returns in text.
- *
- * @param       str                     string to calculate dimensions of
- * @param       font_info       font info structure
- * @param       xs                      horizontal spacing
- * @param       ys                      vertical spacing
- * @param       dim                     return result: struct FontDimensions
- */
-void calc_text_dimensions(char *str, struct FontEntry font, int xs, int ys, struct FontDimensions *dim)
-{
-    int max_length = 0, line_length = 0, lines = 1;
-
-    while (*str != 0) {
-        line_length++;
-        if (*str == '\n' || *str == '\r') {
-            if (line_length > max_length) {
-                max_length = line_length;
-            }
-            line_length = 0;
-            lines++;
-        }
-        str++;
-    }
-    if (line_length > max_length) {
-        max_length = line_length;
-    }
-    dim->width  = max_length * (font.width + xs);
-    dim->height = lines * (font.height + ys);
-}
-
-/**
- * write_string: Draw a string on the screen with certain
- * alignment parameters.
- *
- * @param       str             string to write
- * @param       x               x coordinate
- * @param       y               y coordinate
- * @param       xs              horizontal spacing
- * @param       ys              horizontal spacing
- * @param       va              vertical align
- * @param       ha              horizontal align
- * @param       flags   flags (passed to write_char)
- * @param       font    font
- */
-void write_string(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys, int va, int ha, int flags, int font)
-{
-    int xx = 0, yy = 0, xx_original = 0;
-    struct FontEntry font_info;
-    struct FontDimensions dim;
-
-    // Determine font info and dimensions/position of the string.
-    fetch_font_info(0, font, &font_info, NULL);
-    calc_text_dimensions(str, font_info, xs, ys, &dim);
-    switch (va) {
-    case TEXT_VA_TOP:
-        yy = y;
-        break;
-    case TEXT_VA_MIDDLE:
-        yy = y - (dim.height / 2);
-        break;
-    case TEXT_VA_BOTTOM:
-        yy = y - dim.height;
-        break;
-    }
-    switch (ha) {
-    case TEXT_HA_LEFT:
-        xx = x;
-        break;
-    case TEXT_HA_CENTER:
-        xx = x - (dim.width / 2);
-        break;
-    case TEXT_HA_RIGHT:
-        xx = x - dim.width;
-        break;
-    }
-    // Then write each character.
-    xx_original = xx;
-    while (*str != 0) {
-        if (*str == '\n' || *str == '\r') {
-            yy += ys + font_info.height;
-            xx  = xx_original;
-        } else {
-            if (xx >= 0 && xx < GRAPHICS_WIDTH_REAL) {
-                if (font_info.id < 2) {
-                    write_char(*str, xx, yy, flags, font);
-                } else {
-                    write_char16(*str, xx, yy, font);
-                }
-            }
-            xx += font_info.width + xs;
-        }
-        str++;
-    }
-}
-
-/**
- * write_string_formatted: Draw a string with format escape
- * sequences in it. Allows for complex text effects.
- *
- * @param       str             string to write (with format data)
- * @param       x               x coordinate
- * @param       y               y coordinate
- * @param       xs              default horizontal spacing
- * @param       ys              default horizontal spacing
- * @param       va              vertical align
- * @param       ha              horizontal align
- * @param       flags   flags (passed to write_char)
- */
-void write_string_formatted(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys,
-                            __attribute__((unused)) int va, __attribute__((unused)) int ha, int flags)
-{
-    int fcode = 0, fptr = 0, font = 0, fwidth = 0, fheight = 0, xx = x, yy = y, max_xx = 0, max_height = 0;
-    struct FontEntry font_info;
-
-    // Retrieve sizes of the fonts: bigfont and smallfont.
-    fetch_font_info(0, 0, &font_info, NULL);
-    int smallfontwidth = font_info.width, smallfontheight = font_info.height;
-    fetch_font_info(0, 1, &font_info, NULL);
-    int bigfontwidth   = font_info.width, bigfontheight = font_info.height;
-    // 11 byte stack with last byte as NUL.
-    char fstack[11];
-    fstack[10] = '\0';
-    // First, we need to parse the string for format characters and
-    // work out a bounding box. We'll parse again for the final output.
-    // This is a simple state machine parser.
-    char *ostr = str;
-    while (*str) {
-        if (*str == '<' && fcode == 1) {
-            // escape code: skip
-            fcode = 0;
-        }
-        if (*str == '<' && fcode == 0) {
-            // begin format code?
-            fcode = 1;
-            fptr  = 0;
-        }
-        if (*str == '>' && fcode == 1) {
-            fcode = 0;
-            if (strcmp(fstack, "B")) {
-                // switch to "big" font (font #1)
-                fwidth  = bigfontwidth;
-                fheight = bigfontheight;
-            } else if (strcmp(fstack, "S")) {
-                // switch to "small" font (font #0)
-                fwidth  = smallfontwidth;
-                fheight = smallfontheight;
-            }
-            if (fheight > max_height) {
-                max_height = fheight;
-            }
-            // Skip over this byte. Go to next byte.
-            str++;
-            continue;
-        }
-        if (*str != '<' && *str != '>' && fcode == 1) {
-            // Add to the format stack (up to 10 bytes.)
-            if (fptr > 10) {
-                // stop adding bytes
-                str++; // go to next byte
-                continue;
-            }
-            fstack[fptr++] = *str;
-            fstack[fptr]   = '\0'; // clear next byte (ready for next char or to terminate string.)
-        }
-        if (fcode == 0) {
-            // Not a format code, raw text.
-            xx += fwidth + xs;
-            if (*str == '\n') {
-                if (xx > max_xx) {
-                    max_xx = xx;
-                }
-                xx  = x;
-                yy += fheight + ys;
-            }
-        }
-        str++;
-    }
-    // Reset string pointer.
-    str = ostr;
-    // Now we've parsed it and got a bbox, we need to work out the dimensions of it
-    // and how to align it.
-    /*int width = max_xx - x;
-       int height = yy - y;
-       int ay, ax;
-       switch(va)
-       {
-       case TEXT_VA_TOP:               ay = yy; break;
-       case TEXT_VA_MIDDLE:    ay = yy - (height / 2); break;
-       case TEXT_VA_BOTTOM:    ay = yy - height; break;
-       }
-       switch(ha)
-       {
-       case TEXT_HA_LEFT:              ax = x; break;
-       case TEXT_HA_CENTER:    ax = x - (width / 2); break;
-       case TEXT_HA_RIGHT:             ax = x - width; break;
-       }*/
-    // So ax,ay is our new text origin. Parse the text format again and paint
-    // the text on the display.
-    fcode = 0;
-    fptr  = 0;
-    font  = 0;
-    xx    = 0;
-    yy    = 0;
-    while (*str) {
-        if (*str == '<' && fcode == 1) {
-            // escape code: skip
-            fcode = 0;
-        }
-        if (*str == '<' && fcode == 0) {
-            // begin format code?
-            fcode = 1;
-            fptr  = 0;
-        }
-        if (*str == '>' && fcode == 1) {
-            fcode = 0;
-            if (strcmp(fstack, "B")) {
-                // switch to "big" font (font #1)
-                fwidth  = bigfontwidth;
-                fheight = bigfontheight;
-                font    = 1;
-            } else if (strcmp(fstack, "S")) {
-                // switch to "small" font (font #0)
-                fwidth  = smallfontwidth;
-                fheight = smallfontheight;
-                font    = 0;
-            }
-            // Skip over this byte. Go to next byte.
-            str++;
-            continue;
-        }
-        if (*str != '<' && *str != '>' && fcode == 1) {
-            // Add to the format stack (up to 10 bytes.)
-            if (fptr > 10) {
-                // stop adding bytes
-                str++; // go to next byte
-                continue;
-            }
-            fstack[fptr++] = *str;
-            fstack[fptr]   = '\0'; // clear next byte (ready for next char or to terminate string.)
-        }
-        if (fcode == 0) {
-            // Not a format code, raw text. So we draw it.
-            // TODO - different font sizes.
-            write_char(*str, xx, yy + (max_height - fheight), flags, font);
-            xx += fwidth + xs;
-            if (*str == '\n') {
-                if (xx > max_xx) {
-                    max_xx = xx;
-                }
-                xx  = x;
-                yy += fheight + ys;
-            }
-        }
-        str++;
-    }
-}
-
-// SUPEROSD-
+// SUPEROSD routines, modified: see osdrender.c
 
 // graphics
 
@@ -2159,7 +1025,7 @@ void updateGraphics()
             { 0 };
             sprintf(temps, "HOME NOT SET");
             // printTextFB(x,y,temp);
-            write_string(temps, APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), (GRAPHICS_BOTTOM / 2), 0, 0, TEXT_VA_TOP, TEXT_HA_CENTER, 0, 3);
+            write_string_widget(OSD_WIDGET_TEXT + 0, temps, APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), (GRAPHICS_BOTTOM / 2), TEXT_VA_TOP, TEXT_HA_CENTER, 3);
         }
 
         char temp[50] =
@@ -2168,15 +1034,15 @@ void updateGraphics()
         // Note: cast to double required due to -Wdouble-promotion compiler option is
         // being used, and there is no way in C to pass a float to a variadic function like sprintf()
         sprintf(temp, "Lat:%11.7f", (double)(gpsData.Latitude / 10000000.0f));
-        write_string(temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(GRAPHICS_BOTTOM - 30), 0, 0, TEXT_VA_BOTTOM, TEXT_HA_LEFT, 0, 3);
+        write_string_widget(OSD_WIDGET_TEXT + 1, temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(GRAPHICS_BOTTOM - 30), TEXT_VA_BOTTOM, TEXT_HA_LEFT, 3);
         sprintf(temp, "Lon:%11.7f", (double)(gpsData.Longitude / 10000000.0f));
-        write_string(temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(GRAPHICS_BOTTOM - 10), 0, 0, TEXT_VA_BOTTOM, TEXT_HA_LEFT, 0, 3);
+        write_string_widget(OSD_WIDGET_TEXT + 2, temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(GRAPHICS_BOTTOM - 10), TEXT_VA_BOTTOM, TEXT_HA_LEFT, 3);
         sprintf(temp, "Sat:%d", (int)gpsData.Satellites);
-        write_string(temp, APPLY_HDEADBAND(GRAPHICS_RIGHT - 40), APPLY_VDEADBAND(30), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 3, temp, APPLY_HDEADBAND(GRAPHICS_RIGHT - 40), APPLY_VDEADBAND(30), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print ADC voltage FLIGHT*/
         sprintf(temp, "V:%5.2fV", (double)(PIOS_ADC_PinGet(2) * 3 * 6.1f / 4096));
-        write_string(temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(20), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 3);
+        write_string_widget(OSD_WIDGET_TEXT + 4, temp, APPLY_HDEADBAND(20), APPLY_VDEADBAND(20), TEXT_VA_TOP, TEXT_HA_LEFT, 3);
 
         if (gpsData.Heading > 180) {
             calcHomeArrow((int16_t)(gpsData.Heading - 360));
@@ -2219,8 +1085,12 @@ void updateGraphics()
 
         /* Draw Attitude Indicator */
         if (OsdSettings.Attitude == OSDSETTINGS_ATTITUDE_ENABLED) {
-            drawAttitude(APPLY_HDEADBAND(OsdSettings.AttitudeSetup.X),
-                         APPLY_VDEADBAND(OsdSettings.AttitudeSetup.Y), attitude.Pitch, attitude.Roll, 96);
+            int32_t key[] = { OsdSettings.AttitudeSetup.X, OsdSettings.AttitudeSetup.Y, (int16_t)attitude.Pitch, (int16_t)attitude.Roll };
+            if (osd_render_widget_begin_values(OSD_WIDGET_ATTITUDE, key, SIZEOF_ARRAY(key))) {
+                drawAttitude(APPLY_HDEADBAND(OsdSettings.AttitudeSetup.X),
+                             APPLY_VDEADBAND(OsdSettings.AttitudeSetup.Y), attitude.Pitch, attitude.Roll, 96);
+            }
+            osd_render_widget_end();
         }
         // write_string("Hello OP-OSD", 60, 12, 1, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 0);
         // printText16( 60, 12,"Hello OP-OSD");
@@ -2229,13 +1099,13 @@ void updateGraphics()
         { 0 };
         memset(temp, ' ', 40);
         sprintf(temp, "Lat:%11.7f", (double)(gpsData.Latitude / 10000000.0f));
-        write_string(temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(5), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 0, temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(5), TEXT_VA_TOP, TEXT_HA_LEFT, 2);
         sprintf(temp, "Lon:%11.7f", (double)(gpsData.Longitude / 10000000.0f));
-        write_string(temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(15), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 1, temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(15), TEXT_VA_TOP, TEXT_HA_LEFT, 2);
         sprintf(temp, "Fix:%d", (int)gpsData.Status);
-        write_string(temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(25), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 2, temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(25), TEXT_VA_TOP, TEXT_HA_LEFT, 2);
         sprintf(temp, "Sat:%d", (int)gpsData.Satellites);
-        write_string(temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(35), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 3, temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(35), TEXT_VA_TOP, TEXT_HA_LEFT, 2);
 
         /* Print RTC time */
         if (OsdSettings.Time == OSDSETTINGS_TIME_ENABLED) {
@@ -2244,25 +1114,25 @@ void updateGraphics()
 
         /* Print Number of detected video Lines */
         sprintf(temp, "Lines:%4d", PIOS_Video_GetOSDLines());
-        write_string(temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(5), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 4, temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(5), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print ADC voltage */
         // sprintf(temp,"Rssi:%4dV",(int)(PIOS_ADC_PinGet(4)*3000/4096));
         // write_string(temp, (GRAPHICS_WIDTH_REAL - 2),15, 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
         sprintf(temp, "Rssi:%4.2fV", (double)(PIOS_ADC_PinGet(5) * 3.0f / 4096.0f));
-        write_string(temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(15), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 5, temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(15), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print CPU temperature */
         sprintf(temp, "Temp:%4.2fC", (double)(PIOS_ADC_PinGet(3) * 0.29296875f - 264));
-        write_string(temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(25), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 6, temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(25), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print ADC voltage FLIGHT*/
         sprintf(temp, "FltV:%4.2fV", (double)(PIOS_ADC_PinGet(2) * 3.0f * 6.1f / 4096.0f));
-        write_string(temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(35), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 7, temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(35), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print ADC voltage VIDEO*/
         sprintf(temp, "VidV:%4.2fV", (double)(PIOS_ADC_PinGet(4) * 3.0f * 6.1f / 4096.0f));
-        write_string(temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(45), 0, 0, TEXT_VA_TOP, TEXT_HA_RIGHT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 8, temp, APPLY_HDEADBAND((GRAPHICS_RIGHT - 8)), APPLY_VDEADBAND(45), TEXT_VA_TOP, TEXT_HA_RIGHT, 2);
 
         /* Print ADC voltage RSSI */
         // sprintf(temp,"Curr:%4dA",(int)(PIOS_ADC_PinGet(0)*300*61/4096));
@@ -2292,23 +1162,31 @@ void updateGraphics()
         // drawArrow(96,GRAPHICS_HEIGHT_REAL/2,angleB,32);
         // Draw airspeed (left side.)
         if (OsdSettings.Speed == OSDSETTINGS_SPEED_ENABLED) {
-            hud_draw_vertical_scale((int)gpsData.Groundspeed, 100, -1, APPLY_HDEADBAND(OsdSettings.SpeedSetup.X),
-                                    APPLY_VDEADBAND(OsdSettings.SpeedSetup.Y), 100, 10, 20, 7, 12, 15, 1000, HUD_VSCALE_FLAG_NO_NEGATIVE);
+            int32_t key[] = { OsdSettings.SpeedSetup.X, OsdSettings.SpeedSetup.Y, (int)gpsData.Groundspeed };
+            if (osd_render_widget_begin_values(OSD_WIDGET_SPEED, key, SIZEOF_ARRAY(key))) {
+                hud_draw_vertical_scale((int)gpsData.Groundspeed, 100, -1, APPLY_HDEADBAND(OsdSettings.SpeedSetup.X),
+                                        APPLY_VDEADBAND(OsdSettings.SpeedSetup.Y), 100, 10, 20, 7, 12, 15, 1000, HUD_VSCALE_FLAG_NO_NEGATIVE);
+            }
+            osd_render_widget_end();
         }
         // Draw altimeter (right side.)
         if (OsdSettings.Altitude == OSDSETTINGS_ALTITUDE_ENABLED) {
-            hud_draw_vertical_scale((int)gpsData.Altitude, 200, +1, APPLY_HDEADBAND(OsdSettings.AltitudeSetup.X),
-                                    APPLY_VDEADBAND(OsdSettings.AltitudeSetup.Y), 100, 20, 100, 7, 12, 15, 500, 0);
+            int32_t key[] = { OsdSettings.AltitudeSetup.X, OsdSettings.AltitudeSetup.Y, (int)gpsData.Altitude };
+            if (osd_render_widget_begin_values(OSD_WIDGET_ALTITUDE, key, SIZEOF_ARRAY(key))) {
+                hud_draw_vertical_scale((int)gpsData.Altitude, 200, +1, APPLY_HDEADBAND(OsdSettings.AltitudeSetup.X),
+                                        APPLY_VDEADBAND(OsdSettings.AltitudeSetup.Y), 100, 20, 100, 7, 12, 15, 500, 0);
+            }
+            osd_render_widget_end();
         }
         // Draw compass.
         if (OsdSettings.Heading == OSDSETTINGS_HEADING_ENABLED) {
-            if (attitude.Yaw < 0) {
-                hud_draw_linear_compass(360 + attitude.Yaw, 150, 120, APPLY_HDEADBAND(OsdSettings.HeadingSetup.X),
-                                        APPLY_VDEADBAND(OsdSettings.HeadingSetup.Y), 15, 30, 7, 12, 0);
-            } else {
-                hud_draw_linear_compass(attitude.Yaw, 150, 120, APPLY_HDEADBAND(OsdSettings.HeadingSetup.X),
+            int heading   = (attitude.Yaw < 0) ? 360 + attitude.Yaw : attitude.Yaw;
+            int32_t key[] = { OsdSettings.HeadingSetup.X, OsdSettings.HeadingSetup.Y, heading };
+            if (osd_render_widget_begin_values(OSD_WIDGET_HEADING, key, SIZEOF_ARRAY(key))) {
+                hud_draw_linear_compass(heading, 150, 120, APPLY_HDEADBAND(OsdSettings.HeadingSetup.X),
                                         APPLY_VDEADBAND(OsdSettings.HeadingSetup.Y), 15, 30, 7, 12, 0);
             }
+            osd_render_widget_end();
         }
     }
     break;
@@ -2317,14 +1195,18 @@ void updateGraphics()
         int size = 64;
         int x    = ((GRAPHICS_RIGHT / 2) - (size / 2)), y = (GRAPHICS_BOTTOM - size - 2);
         draw_artificial_horizon(-attitude.Roll, attitude.Pitch, APPLY_HDEADBAND(x), APPLY_VDEADBAND(y), size);
-        hud_draw_vertical_scale((int)gpsData.Groundspeed, 20, +1, APPLY_HDEADBAND(GRAPHICS_RIGHT - (x - 1)), APPLY_VDEADBAND(y + (size / 2)), size, 5, 10, 4, 7,
-                                10, 100, HUD_VSCALE_FLAG_NO_NEGATIVE);
-        if (OsdSettings.AltitudeSource == OSDSETTINGS_ALTITUDESOURCE_BARO) {
-            hud_draw_vertical_scale((int)baro.Altitude, 50, -1, APPLY_HDEADBAND((x + size + 1)), APPLY_VDEADBAND(y + (size / 2)), size, 10, 20, 4, 7, 10, 500, 0);
-        } else {
-            hud_draw_vertical_scale((int)gpsData.Altitude, 50, -1, APPLY_HDEADBAND((x + size + 1)), APPLY_VDEADBAND(y + (size / 2)), size, 10, 20, 4, 7, 10, 500,
-                                    0);
+        int32_t speedKey[] = { (int)gpsData.Groundspeed };
+        if (osd_render_widget_begin_values(OSD_WIDGET_SPEED, speedKey, SIZEOF_ARRAY(speedKey))) {
+            hud_draw_vertical_scale((int)gpsData.Groundspeed, 20, +1, APPLY_HDEADBAND(GRAPHICS_RIGHT - (x - 1)), APPLY_VDEADBAND(y + (size / 2)), size, 5, 10, 4, 7,
+                                    10, 100, HUD_VSCALE_FLAG_NO_NEGATIVE);
+        }
+        osd_render_widget_end();
+        int altitude = (OsdSettings.AltitudeSource == OSDSETTINGS_ALTITUDESOURCE_BARO) ? (int)baro.Altitude : (int)gpsData.Altitude;
+        int32_t altitudeKey[] = { altitude };
+        if (osd_render_widget_begin_values(OSD_WIDGET_ALTITUDE, altitudeKey, SIZEOF_ARRAY(altitudeKey))) {
+            hud_draw_vertical_scale(altitude, 50, -1, APPLY_HDEADBAND((x + size + 1)), APPLY_VDEADBAND(y + (size / 2)), size, 10, 20, 4, 7, 10, 500, 0);
         }
+        osd_render_widget_end();
 
         char temp[50] =
         { 0 };
@@ -2355,7 +1237,7 @@ void updateGraphics()
             sprintf(temp, "Mode: %d", status.FlightMode);
             break;
         }
-        write_string(temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(5), 0, 0, TEXT_VA_TOP, TEXT_HA_LEFT, 0, 2);
+        write_string_widget(OSD_WIDGET_TEXT + 0, temp, APPLY_HDEADBAND(5), APPLY_VDEADBAND(5), TEXT_VA_TOP, TEXT_HA_LEFT, 2);
     }
     break;
     case 3:
@@ -2389,8 +1271,11 @@ void updateGraphics()
 
 void updateOnceEveryFrame()
 {
-    clearGraphics();
+    // Only what was drawn in this buffer before is cleared, unchanged
+    // widgets are kept as they are
+    osd_render_begin_frame();
     updateGraphics();
+    osd_render_end_frame();
 }
 
 // ****************
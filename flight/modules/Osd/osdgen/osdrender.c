@@ -0,0 +1,1608 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup OSDgenModule osdgen Module
+ * @{
+ *
+ * @file       osdrender.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ *             The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      OSD drawing primitives and retained mode frame buffer tracking.
+ *             Parts from CL-OSD and SUPEROSD projects
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+
+#include "osdgen.h"
+
+#include "font12x18.h"
+#include "font8x10.h"
+
+#if OSD_RENDER_LINE_WORDS > 16
+#error "Dirty word maps are 16 bits wide"
+#endif
+
+// Widget flags
+#define WIDGET_HAS_CONTENT 0x01 // something is drawn in the widget box
+#define WIDGET_VALID       0x02 // the drawn content matches the key
+#define WIDGET_SEEN        0x04 // drawn or retained in the current frame
+
+struct osd_render_widget {
+    uint32_t key;
+    uint16_t y0, y1;
+    uint16_t words;
+    uint8_t  flags;
+};
+
+// Tracking state of one of the two frame buffers
+struct osd_render_slot {
+    uint8_t  *level;
+    uint8_t  *mask;
+    bool     fullClear;
+    uint16_t dirty[GRAPHICS_HEIGHT_REAL]; // words drawn outside widgets
+    struct osd_render_widget widgets[OSD_RENDER_MAX_WIDGETS];
+};
+
+// Glyph rows shifted to their position in the frame buffer: bits 23..16 go
+// to the first byte, 15..8 to the second and 7..0 to the third
+struct osd_render_glyph {
+    uint8_t  font;
+    uint8_t  ch;
+    uint8_t  shift;
+    uint8_t  flags;
+    bool     valid;
+    uint32_t set[18]; // mask bits and level bits to set
+    uint32_t clear[18]; // level bits to clear afterwards
+};
+
+typedef uint32_t __attribute__((__may_alias__)) osd_render_word_t;
+
+static struct osd_render_slot slots[2];
+static struct osd_render_slot *slot;
+static struct osd_render_widget *widget;
+static uint16_t frame[GRAPHICS_HEIGHT_REAL]; // words drawn or retained in the current frame
+static struct osd_render_glyph glyphs[OSD_RENDER_GLYPH_CACHE_SIZE];
+static struct osd_render_stats stats;
+static uint8_t markSuspended;
+
+static inline uint16_t word_mask(unsigned int b0, unsigned int b1)
+{
+    return ((2u << (b1 / 4)) - 1) & ~((1u << (b0 / 4)) - 1);
+}
+
+static void clear_words(unsigned int y, uint16_t words)
+{
+    while (words) {
+        unsigned int first = __builtin_ctz(words);
+        unsigned int run   = __builtin_ctz(~(words >> first));
+        unsigned int addr  = first * 4;
+        unsigned int count = MIN(run * 4, OSD_RENDER_LINE_BYTES - addr);
+
+        addr += y * OSD_RENDER_LINE_BYTES;
+        memset(slot->level + addr, 0, count);
+        memset(slot->mask + addr, 0, count);
+        stats.bytesCleared += count;
+        words &= ~(((1u << run) - 1) << first);
+    }
+}
+
+static bool widgets_overlap(const struct osd_render_widget *a, const struct osd_render_widget *b)
+{
+    return a->y0 <= b->y1 && b->y0 <= a->y1 && (a->words & b->words);
+}
+
+/**
+ * Clear the content of a widget. Words drawn in the current frame are left
+ * alone, if there are any the buffer will be cleared completely next time.
+ * Other widgets overlapping this one which are not drawn yet lose part of
+ * their content and have to be redrawn.
+ */
+static void clear_widget(struct osd_render_widget *w)
+{
+    for (unsigned int y = w->y0; y <= w->y1; y++) {
+        if (frame[y] & w->words) {
+            slot->fullClear = true;
+        }
+        clear_words(y, w->words & ~frame[y]);
+    }
+    w->flags &= ~(WIDGET_HAS_CONTENT | WIDGET_VALID);
+
+    for (int n = 0; n < OSD_RENDER_MAX_WIDGETS; n++) {
+        struct osd_render_widget *other = &slot->widgets[n];
+        if (other != w && (other->flags & WIDGET_HAS_CONTENT) && !(other->flags & WIDGET_SEEN) && widgets_overlap(w, other)) {
+            other->flags &= ~WIDGET_VALID;
+        }
+    }
+}
+
+/**
+ * osd_render_reset: clear the current draw buffer and forget about all
+ * retained content. Both buffers are cleared completely when they are
+ * drawn next.
+ */
+void osd_render_reset(void)
+{
+    memset(draw_buffer_mask, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+    memset(draw_buffer_level, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+    stats.bytesCleared += GRAPHICS_WIDTH * GRAPHICS_HEIGHT;
+    slots[0].fullClear = true;
+    slots[1].fullClear = true;
+    slot   = NULL;
+    widget = NULL;
+}
+
+/**
+ * osd_render_begin_frame: start drawing a frame in the current draw buffer.
+ * Clears what was drawn outside widgets the last time this buffer was drawn
+ * and the widgets that are not valid anymore.
+ */
+void osd_render_begin_frame(void)
+{
+    // Find the tracking state of the buffer, they are swapped every frame
+    if (slots[0].level == draw_buffer_level && slots[0].mask == draw_buffer_mask) {
+        slot = &slots[0];
+    } else if (slots[1].level == draw_buffer_level && slots[1].mask == draw_buffer_mask) {
+        slot = &slots[1];
+    } else {
+        slot = (slots[0].level == NULL || slot == &slots[1]) ? &slots[0] : &slots[1];
+        slot->level     = draw_buffer_level;
+        slot->mask      = draw_buffer_mask;
+        slot->fullClear = true;
+    }
+    widget = NULL;
+    memset(frame, 0, sizeof(frame));
+    stats.frames++;
+
+    if (slot->fullClear) {
+        memset(slot->mask, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+        memset(slot->level, 0, GRAPHICS_WIDTH * GRAPHICS_HEIGHT);
+        memset(slot->dirty, 0, sizeof(slot->dirty));
+        memset(slot->widgets, 0, sizeof(slot->widgets));
+        slot->fullClear     = false;
+        stats.bytesCleared += GRAPHICS_WIDTH * GRAPHICS_HEIGHT;
+        stats.fullClears++;
+        return;
+    }
+
+    for (unsigned int y = 0; y < GRAPHICS_HEIGHT_REAL; y++) {
+        if (slot->dirty[y]) {
+            clear_words(y, slot->dirty[y]);
+        }
+    }
+    for (int n = 0; n < OSD_RENDER_MAX_WIDGETS; n++) {
+        slot->widgets[n].flags &= ~WIDGET_SEEN;
+    }
+    // Widgets which lost part of their content have to be redrawn. Clearing
+    // them can damage others, repeat until nothing changes.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int n = 0; n < OSD_RENDER_MAX_WIDGETS; n++) {
+            struct osd_render_widget *w = &slot->widgets[n];
+            if (!(w->flags & WIDGET_HAS_CONTENT)) {
+                continue;
+            }
+            bool damaged = !(w->flags & WIDGET_VALID);
+            for (unsigned int y = w->y0; y <= w->y1 && !damaged; y++) {
+                damaged = (slot->dirty[y] & w->words) != 0;
+            }
+            if (damaged) {
+                clear_widget(w);
+                changed = true;
+            }
+        }
+    }
+    memset(slot->dirty, 0, sizeof(slot->dirty));
+}
+
+/**
+ * osd_render_end_frame: finish the current frame, clearing the widgets
+ * which were not drawn in this frame.
+ */
+void osd_render_end_frame(void)
+{
+    if (!slot) {
+        return;
+    }
+    osd_render_widget_end();
+    for (int n = 0; n < OSD_RENDER_MAX_WIDGETS; n++) {
+        struct osd_render_widget *w = &slot->widgets[n];
+        if ((w->flags & (WIDGET_HAS_CONTENT | WIDGET_SEEN)) == WIDGET_HAS_CONTENT) {
+            clear_widget(w);
+        }
+    }
+}
+
+/**
+ * osd_render_widget_begin: start drawing a retained widget.
+ *
+ * @param       id              widget id, less than OSD_RENDER_MAX_WIDGETS
+ * @param       key             hash of everything the widget content depends on
+ * @return      true if the widget has to be drawn, false if the content
+ *              in the buffer is still valid
+ */
+bool osd_render_widget_begin(uint8_t id, uint32_t key)
+{
+    osd_render_widget_end();
+    if (!slot || id >= OSD_RENDER_MAX_WIDGETS) {
+        // Not tracking, immediate mode
+        return true;
+    }
+
+    struct osd_render_widget *w = &slot->widgets[id];
+    if ((w->flags & WIDGET_VALID) && w->key == key) {
+        w->flags |= WIDGET_SEEN;
+        for (unsigned int y = w->y0; y <= w->y1; y++) {
+            frame[y] |= w->words;
+        }
+        stats.widgetsRetained++;
+        return false;
+    }
+    if (w->flags & WIDGET_HAS_CONTENT) {
+        clear_widget(w);
+    }
+    w->key   = key;
+    w->y0    = GRAPHICS_HEIGHT_REAL;
+    w->y1    = 0;
+    w->words = 0;
+    w->flags = WIDGET_SEEN;
+    widget   = w;
+    stats.widgetsDrawn++;
+    return true;
+}
+
+/**
+ * osd_render_widget_end: finish drawing the current widget, if any.
+ */
+void osd_render_widget_end(void)
+{
+    if (widget) {
+        widget->flags |= WIDGET_VALID;
+        if (widget->words) {
+            widget->flags |= WIDGET_HAS_CONTENT;
+        }
+        widget = NULL;
+    }
+}
+
+/**
+ * osd_render_widget_begin_values: start drawing a widget keyed on the
+ * values it shows, see osd_render_widget_begin().
+ *
+ * @param       id              widget id, less than OSD_RENDER_MAX_WIDGETS
+ * @param       values          everything the widget content depends on
+ * @param       count           number of values
+ * @return      true if the widget has to be drawn
+ */
+bool osd_render_widget_begin_values(uint8_t id, const int32_t *values, uint32_t count)
+{
+    return osd_render_widget_begin(id, osd_render_hash(OSD_RENDER_HASH_INIT, values, count * sizeof(int32_t)));
+}
+
+/**
+ * osd_render_hash: FNV-1a hash, used to build widget keys.
+ *
+ * @param       hash    previous hash value or OSD_RENDER_HASH_INIT
+ * @param       data    data to add to the hash
+ * @param       length  length of the data
+ */
+uint32_t osd_render_hash(uint32_t hash, const void *data, uint32_t length)
+{
+    const uint8_t *p = data;
+
+    while (length--) {
+        hash ^= *p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * osd_render_mark: record that something was drawn. Only needed for writes
+ * which set or toggle bits, clearing never leaves anything to clean up.
+ *
+ * @param       y0              first row
+ * @param       y1              last row
+ * @param       b0              first byte in the rows
+ * @param       b1              last byte in the rows
+ */
+void osd_render_mark(unsigned int y0, unsigned int y1, unsigned int b0, unsigned int b1)
+{
+    if (!slot || markSuspended) {
+        return;
+    }
+    y1 = MIN(y1, GRAPHICS_HEIGHT_REAL - 1);
+    b1 = MIN(b1, OSD_RENDER_LINE_BYTES - 1);
+    if (y0 > y1 || b0 > b1) {
+        return;
+    }
+    uint16_t words = word_mask(b0, b1);
+    for (unsigned int y = y0; y <= y1; y++) {
+        frame[y] |= words;
+    }
+    if (widget) {
+        widget->y0     = MIN(widget->y0, y0);
+        widget->y1     = MAX(widget->y1, y1);
+        widget->words |= words;
+    } else {
+        for (unsigned int y = y0; y <= y1; y++) {
+            slot->dirty[y] |= words;
+        }
+    }
+}
+
+/**
+ * mark_shape_begin: mark the bounding box of a shape drawn pixel by pixel
+ * once, instead of marking every pixel. Call mark_shape_end() when done.
+ */
+static void mark_shape_begin(int x0, int y0, int x1, int y1, int margin)
+{
+    if (x0 > x1) {
+        SWAP(x0, x1);
+    }
+    if (y0 > y1) {
+        SWAP(y0, y1);
+    }
+    x0 -= margin;
+    y0 -= margin;
+    x1 += margin;
+    y1 += margin;
+    if (x1 >= 0 && y1 >= 0) {
+        osd_render_mark(MAX(y0, 0), y1, MAX(x0, 0) / 8, x1 / 8);
+    }
+    markSuspended++;
+}
+
+static void mark_shape_end(void)
+{
+    markSuspended--;
+}
+
+/**
+ * osd_render_fill_bytes: fill whole bytes of a buffer, 32 bits at a time
+ * where the buffer is word aligned.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       addr    address of the first byte
+ * @param       count   number of bytes
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void osd_render_fill_bytes(uint8_t *buff, unsigned int addr, unsigned int count, int mode)
+{
+    uint8_t *p = buff + addr;
+    uint8_t m  = 0xff;
+
+    while (count && ((uintptr_t)p & 3)) {
+        WRITE_WORD_MODE(p, 0, m, mode);
+        p++;
+        count--;
+    }
+    osd_render_word_t *w = (osd_render_word_t *)p;
+    osd_render_word_t *end = w + count / 4;
+    switch (mode) {
+    case 0:
+        while (w < end) {
+            *w++ = 0;
+        }
+        break;
+    case 1:
+        while (w < end) {
+            *w++ = 0xffffffff;
+        }
+        break;
+    case 2:
+        while (w < end) {
+            *w++ ^= 0xffffffff;
+        }
+        break;
+    }
+    p = (uint8_t *)w;
+    for (count &= 3; count; count--) {
+        WRITE_WORD_MODE(p, 0, m, mode);
+        p++;
+    }
+}
+
+/**
+ * osd_render_get_stats: renderer statistics since the last call.
+ */
+void osd_render_get_stats(struct osd_render_stats *s)
+{
+    *s = stats;
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * fetch_glyph: get the rows of a character shifted to a bit position,
+ * from the glyph cache or computed from the font data.
+ *
+ * @param       ch              character (font 0 and 1: lookup index)
+ * @param       font    font id
+ * @param       font_info       font info
+ * @param       shift   bit position of the left edge of the character
+ * @param       flags   FONT_INVERT
+ */
+static const struct osd_render_glyph *fetch_glyph(uint8_t ch, int font, const struct FontEntry *font_info, unsigned int shift, int flags)
+{
+    struct osd_render_glyph *g = &glyphs[(ch * 8 + font * 3 + shift) % OSD_RENDER_GLYPH_CACHE_SIZE];
+
+    flags &= FONT_INVERT;
+    if (g->valid && g->ch == ch && g->font == font && g->shift == shift && g->flags == flags) {
+        return g;
+    }
+    stats.glyphCacheMisses++;
+
+    unsigned int xshift = 16 - font_info->width;
+    for (unsigned int yy = 0; yy < font_info->height && yy < SIZEOF_ARRAY(g->set); yy++) {
+        uint16_t set, clear, levels;
+        if (font == 3) {
+            unsigned int row = ch * font_info->height + yy;
+            levels = ~font_frame12x18[row];
+            set    = font_mask12x18[row] << xshift;
+            clear  = (font_mask12x18[row] & levels) << xshift;
+        } else if (font == 2) {
+            unsigned int row = ch * font_info->height + yy;
+            levels = ~font_frame8x10[row];
+            set    = font_mask8x10[row] << xshift;
+            clear  = (font_mask8x10[row] & levels) << xshift;
+        } else {
+            unsigned int row = ch * font_info->height * 2 + yy;
+            levels = font_info->data[row + font_info->height];
+            if (!flags) {
+                // data is normally inverted
+                levels = ~levels;
+            }
+            set   = font_info->data[row] << xshift;
+            clear = (font_info->data[row] & levels) << xshift;
+        }
+        g->set[yy]   = ((uint32_t)set << 8) >> shift;
+        g->clear[yy] = ((uint32_t)clear << 8) >> shift;
+    }
+    g->ch    = ch;
+    g->font  = font;
+    g->shift = shift;
+    g->flags = flags;
+    g->valid = true;
+    return g;
+}
+
+/**
+ * write_glyph: draw pre-shifted glyph rows in both buffers. The mask bits
+ * are set, the level bits are set and then cleared where needed.
+ */
+static void write_glyph(const struct osd_render_glyph *g, unsigned int addr, unsigned int height)
+{
+    uint8_t *level = draw_buffer_level + addr;
+    uint8_t *mask  = draw_buffer_mask + addr;
+
+    height = MIN(height, SIZEOF_ARRAY(g->set));
+    for (unsigned int yy = 0; yy < height; yy++) {
+        uint32_t set = g->set[yy], clear = ~g->clear[yy];
+        mask[0]  |= set >> 16;
+        mask[1]  |= set >> 8;
+        level[0]  = (level[0] | (set >> 16)) & (clear >> 16);
+        level[1]  = (level[1] | (set >> 8)) & (clear >> 8);
+        if (g->shift > 0) {
+            mask[2]  |= set;
+            level[2]  = (level[2] | set) & clear;
+        }
+        level += GRAPHICS_WIDTH_REAL / 8;
+        mask  += GRAPHICS_WIDTH_REAL / 8;
+    }
+}
+
+/**
+ * write_pixel: Write a pixel at an x,y position to a given surface.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       x               x coordinate
+ * @param       y               y coordinate
+ * @param       mode    0 = clear bit, 1 = set bit, 2 = toggle bit
+ */
+void write_pixel(uint8_t *buff, unsigned int x, unsigned int y, int mode)
+{
+    CHECK_COORDS(x, y);
+    // Determine the bit in the word to be set and the word
+    // index to set it in.
+    int bitnum    = CALC_BIT_IN_WORD(x);
+    int wordnum   = CALC_BUFF_ADDR(x, y);
+    // Apply a mask.
+    uint16_t mask = 1 << (7 - bitnum);
+    WRITE_WORD_MODE(buff, wordnum, mask, mode);
+    if (mode) {
+        osd_render_mark(y, y, x / 8, x / 8);
+    }
+}
+
+/**
+ * write_pixel_lm: write the pixel on both surfaces (level and mask.)
+ * Uses current draw buffer.
+ *
+ * @param       x               x coordinate
+ * @param       y               y coordinate
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ * @param       lmode   0 = black, 1 = white, 2 = toggle
+ */
+void write_pixel_lm(unsigned int x, unsigned int y, int mmode, int lmode)
+{
+    CHECK_COORDS(x, y);
+    // Determine the bit in the word to be set and the word
+    // index to set it in.
+    int bitnum    = CALC_BIT_IN_WORD(x);
+    int wordnum   = CALC_BUFF_ADDR(x, y);
+    // Apply the masks.
+    uint16_t mask = 1 << (7 - bitnum);
+    WRITE_WORD_MODE(draw_buffer_mask, wordnum, mask, mmode);
+    WRITE_WORD_MODE(draw_buffer_level, wordnum, mask, lmode);
+    if (mmode || lmode) {
+        osd_render_mark(y, y, x / 8, x / 8);
+    }
+}
+
+/**
+ * write_hline: optimised horizontal line writing algorithm
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       x0              x0 coordinate
+ * @param       x1              x1 coordinate
+ * @param       y               y coordinate
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_hline(uint8_t *buff, unsigned int x0, unsigned int x1, unsigned int y, int mode)
+{
+    CLIP_COORDS(x0, y);
+    CLIP_COORDS(x1, y);
+    if (x0 > x1) {
+        SWAP(x0, x1);
+    }
+    if (x0 == x1) {
+        return;
+    }
+    /* This is an optimised algorithm for writing horizontal lines.
+    * We begin by finding the addresses of the x0 and x1 points. */
+    int addr0     = CALC_BUFF_ADDR(x0, y);
+    int addr1     = CALC_BUFF_ADDR(x1, y);
+    int addr0_bit = CALC_BIT_IN_WORD(x0);
+    int addr1_bit = CALC_BIT_IN_WORD(x1);
+    int mask, mask_l, mask_r;
+    /* If the addresses are equal, we only need to write one word
+     * which is an island. */
+    if (addr0 == addr1) {
+        mask = COMPUTE_HLINE_ISLAND_MASK(addr0_bit, addr1_bit);
+        WRITE_WORD_MODE(buff, addr0, mask, mode);
+    } else {
+        /* Otherwise we need to write the edges and then the middle. */
+        mask_l = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
+        mask_r = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
+        WRITE_WORD_MODE(buff, addr0, mask_l, mode);
+        WRITE_WORD_MODE(buff, addr1, mask_r, mode);
+        // Now write whole bytes from start+1 to end-1.
+        osd_render_fill_bytes(buff, addr0 + 1, addr1 - addr0 - 1, mode);
+    }
+    if (mode) {
+        osd_render_mark(y, y, x0 / 8, x1 / 8);
+    }
+}
+
+/**
+ * write_hline_lm: write both level and mask buffers.
+ *
+ * @param       x0              x0 coordinate
+ * @param       x1              x1 coordinate
+ * @param       y               y coordinate
+ * @param       lmode   0 = clear, 1 = set, 2 = toggle
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_hline_lm(unsigned int x0, unsigned int x1, unsigned int y, int lmode, int mmode)
+{
+    // TODO: an optimisation would compute the masks and apply to
+    // both buffers simultaneously.
+    write_hline(draw_buffer_level, x0, x1, y, lmode);
+    write_hline(draw_buffer_mask, x0, x1, y, mmode);
+}
+
+/**
+ * write_hline_outlined: outlined horizontal line with varying endcaps
+ * Always uses draw buffer.
+ *
+ * @param       x0                      x0 coordinate
+ * @param       x1                      x1 coordinate
+ * @param       y                       y coordinate
+ * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
+ * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
+ * @param       mode            0 = black outline, white body, 1 = white outline, black body
+ * @param       mmode           0 = clear, 1 = set, 2 = toggle
+ */
+void write_hline_outlined(unsigned int x0, unsigned int x1, unsigned int y, int endcap0, int endcap1, int mode, int mmode)
+{
+    int stroke, fill;
+
+    SETUP_STROKE_FILL(stroke, fill, mode)
+    if (x0 > x1) {
+        SWAP(x0, x1);
+    }
+    // Draw the main body of the line.
+    write_hline_lm(x0 + 1, x1 - 1, y - 1, stroke, mmode);
+    write_hline_lm(x0 + 1, x1 - 1, y + 1, stroke, mmode);
+    write_hline_lm(x0 + 1, x1 - 1, y, fill, mmode);
+    // Draw the endcaps, if any.
+    DRAW_ENDCAP_HLINE(endcap0, x0, y, stroke, fill, mmode);
+    DRAW_ENDCAP_HLINE(endcap1, x1, y, stroke, fill, mmode);
+}
+
+/**
+ * write_vline: optimised vertical line writing algorithm
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       x               x coordinate
+ * @param       y0              y0 coordinate
+ * @param       y1              y1 coordinate
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_vline(uint8_t *buff, unsigned int x, unsigned int y0, unsigned int y1, int mode)
+{
+    unsigned int a;
+
+    CLIP_COORDS(x, y0);
+    CLIP_COORDS(x, y1);
+    if (y0 > y1) {
+        SWAP(y0, y1);
+    }
+    if (y0 == y1) {
+        return;
+    }
+    /* This is an optimised algorithm for writing vertical lines.
+     * We begin by finding the addresses of the x,y0 and x,y1 points. */
+    unsigned int addr0  = CALC_BUFF_ADDR(x, y0);
+    unsigned int addr1  = CALC_BUFF_ADDR(x, y1);
+    /* Then we calculate the pixel data to be written. */
+    unsigned int bitnum = CALC_BIT_IN_WORD(x);
+    uint16_t mask = 1 << (7 - bitnum);
+    /* Run from addr0 to addr1 placing pixels. Increment by the number
+     * of words n each graphics line. */
+    for (a = addr0; a <= addr1; a += GRAPHICS_WIDTH_REAL / 8) {
+        WRITE_WORD_MODE(buff, a, mask, mode);
+    }
+    if (mode) {
+        osd_render_mark(y0, y1, x / 8, x / 8);
+    }
+}
+
+/**
+ * write_vline_lm: write both level and mask buffers.
+ *
+ * @param       x               x coordinate
+ * @param       y0              y0 coordinate
+ * @param       y1              y1 coordinate
+ * @param       lmode   0 = clear, 1 = set, 2 = toggle
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_vline_lm(unsigned int x, unsigned int y0, unsigned int y1, int lmode, int mmode)
+{
+    // TODO: an optimisation would compute the masks and apply to
+    // both buffers simultaneously.
+    write_vline(draw_buffer_level, x, y0, y1, lmode);
+    write_vline(draw_buffer_mask, x, y0, y1, mmode);
+}
+
+/**
+ * write_vline_outlined: outlined vertical line with varying endcaps
+ * Always uses draw buffer.
+ *
+ * @param       x                       x coordinate
+ * @param       y0                      y0 coordinate
+ * @param       y1                      y1 coordinate
+ * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
+ * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
+ * @param       mode            0 = black outline, white body, 1 = white outline, black body
+ * @param       mmode           0 = clear, 1 = set, 2 = toggle
+ */
+void write_vline_outlined(unsigned int x, unsigned int y0, unsigned int y1, int endcap0, int endcap1, int mode, int mmode)
+{
+    int stroke, fill;
+
+    if (y0 > y1) {
+        SWAP(y0, y1);
+    }
+    SETUP_STROKE_FILL(stroke, fill, mode);
+    // Draw the main body of the line.
+    write_vline_lm(x - 1, y0 + 1, y1 - 1, stroke, mmode);
+    write_vline_lm(x + 1, y0 + 1, y1 - 1, stroke, mmode);
+    write_vline_lm(x, y0 + 1, y1 - 1, fill, mmode);
+    // Draw the endcaps, if any.
+    DRAW_ENDCAP_VLINE(endcap0, x, y0, stroke, fill, mmode);
+    DRAW_ENDCAP_VLINE(endcap1, x, y1, stroke, fill, mmode);
+}
+
+/**
+ * write_filled_rectangle: draw a filled rectangle.
+ *
+ * Uses an optimised algorithm which is similar to the horizontal
+ * line writing algorithm, but optimised for writing the lines
+ * multiple times without recalculating lots of stuff.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       x               x coordinate (left)
+ * @param       y               y coordinate (top)
+ * @param       width   rectangle width
+ * @param       height  rectangle height
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_filled_rectangle(uint8_t *buff, unsigned int x, unsigned int y, unsigned int width, unsigned int height, int mode)
+{
+    unsigned int yy, addr0_old, addr1_old;
+
+    CHECK_COORDS(x, y);
+    CHECK_COORD_X(x + width);
+    CHECK_COORD_Y(y + height);
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    // Calculate as if the rectangle was only a horizontal line. We then
+    // step these addresses through each row until we iterate `height` times.
+    unsigned int addr0     = CALC_BUFF_ADDR(x, y);
+    unsigned int addr1     = CALC_BUFF_ADDR(x + width, y);
+    unsigned int addr0_bit = CALC_BIT_IN_WORD(x);
+    unsigned int addr1_bit = CALC_BIT_IN_WORD(x + width);
+    unsigned int mask, mask_l, mask_r;
+
+    if (mode) {
+        osd_render_mark(y, y + height - 1, x / 8, (x + width) / 8);
+    }
+    // If the addresses are equal, we need to write one word vertically.
+    if (addr0 == addr1) {
+        mask = COMPUTE_HLINE_ISLAND_MASK(addr0_bit, addr1_bit);
+        while (height--) {
+            WRITE_WORD_MODE(buff, addr0, mask, mode);
+            addr0 += GRAPHICS_WIDTH_REAL / 8;
+        }
+    } else {
+        // Otherwise we need to write the edges and then the middle repeatedly.
+        mask_l    = COMPUTE_HLINE_EDGE_L_MASK(addr0_bit);
+        mask_r    = COMPUTE_HLINE_EDGE_R_MASK(addr1_bit);
+        // Write edges first.
+        yy        = 0;
+        addr0_old = addr0;
+        addr1_old = addr1;
+        while (yy < height) {
+            WRITE_WORD_MODE(buff, addr0, mask_l, mode);
+            WRITE_WORD_MODE(buff, addr1, mask_r, mode);
+            addr0 += GRAPHICS_WIDTH_REAL / 8;
+            addr1 += GRAPHICS_WIDTH_REAL / 8;
+            yy++;
+        }
+        // Now write whole bytes from start+1 to end-1 for each row.
+        yy    = 0;
+        addr0 = addr0_old;
+        addr1 = addr1_old;
+        while (yy < height) {
+            osd_render_fill_bytes(buff, addr0 + 1, addr1 - addr0 - 1, mode);
+            addr0 += GRAPHICS_WIDTH_REAL / 8;
+            addr1 += GRAPHICS_WIDTH_REAL / 8;
+            yy++;
+        }
+    }
+}
+
+/**
+ * write_filled_rectangle_lm: draw a filled rectangle on both draw buffers.
+ *
+ * @param       x               x coordinate (left)
+ * @param       y               y coordinate (top)
+ * @param       width   rectangle width
+ * @param       height  rectangle height
+ * @param       lmode   0 = clear, 1 = set, 2 = toggle
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_filled_rectangle_lm(unsigned int x, unsigned int y, unsigned int width, unsigned int height, int lmode, int mmode)
+{
+    write_filled_rectangle(draw_buffer_mask, x, y, width, height, mmode);
+    write_filled_rectangle(draw_buffer_level, x, y, width, height, lmode);
+}
+
+/**
+ * write_rectangle_outlined: draw an outline of a rectangle. Essentially
+ * a convenience wrapper for draw_hline_outlined and draw_vline_outlined.
+ *
+ * @param       x               x coordinate (left)
+ * @param       y               y coordinate (top)
+ * @param       width   rectangle width
+ * @param       height  rectangle height
+ * @param       mode    0 = black outline, white body, 1 = white outline, black body
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_rectangle_outlined(unsigned int x, unsigned int y, int width, int height, int mode, int mmode)
+{
+    // CHECK_COORDS(x, y);
+    // CHECK_COORDS(x + width, y + height);
+    // if((x + width) > DISP_WIDTH) width = DISP_WIDTH - x;
+    // if((y + height) > DISP_HEIGHT) height = DISP_HEIGHT - y;
+    write_hline_outlined(x, x + width, y, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
+    write_hline_outlined(x, x + width, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
+    write_vline_outlined(x, y, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
+    write_vline_outlined(x + width, y, y + height, ENDCAP_ROUND, ENDCAP_ROUND, mode, mmode);
+}
+
+/**
+ * write_circle: draw the outline of a circle on a given buffer,
+ * with an optional dash pattern for the line instead of a normal line.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       cx              origin x coordinate
+ * @param       cy              origin y coordinate
+ * @param       r               radius
+ * @param       dashp   dash period (pixels) - zero for no dash
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_circle(uint8_t *buff, unsigned int cx, unsigned int cy, unsigned int r, unsigned int dashp, int mode)
+{
+    CHECK_COORDS(cx, cy);
+    int error = -r, x = r, y = 0;
+    mark_shape_begin(cx - r, cy - r, cx + r, cy + r, 0);
+    while (x >= y) {
+        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
+            CIRCLE_PLOT_8(buff, cx, cy, x, y, mode);
+        }
+        error += (y * 2) + 1;
+        y++;
+        if (error >= 0) {
+            --x;
+            error -= x * 2;
+        }
+    }
+    mark_shape_end();
+}
+
+/**
+ * write_circle_outlined: draw an outlined circle on the draw buffer.
+ *
+ * @param       cx              origin x coordinate
+ * @param       cy              origin y coordinate
+ * @param       r               radius
+ * @param       dashp   dash period (pixels) - zero for no dash
+ * @param       bmode   0 = 4-neighbour border, 1 = 8-neighbour border
+ * @param       mode    0 = black outline, white body, 1 = white outline, black body
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_circle_outlined(unsigned int cx, unsigned int cy, unsigned int r, unsigned int dashp, int bmode, int mode, int mmode)
+{
+    int stroke, fill;
+
+    CHECK_COORDS(cx, cy);
+    SETUP_STROKE_FILL(stroke, fill, mode);
+    // This is a two step procedure. First, we draw the outline of the
+    // circle, then we draw the inner part.
+    int error = -r, x = r, y = 0;
+    mark_shape_begin(cx - r, cy - r, cx + r, cy + r, 1);
+    while (x >= y) {
+        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
+            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x + 1, y, mmode);
+            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x + 1, y, stroke);
+            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y + 1, mmode);
+            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y + 1, stroke);
+            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x - 1, y, mmode);
+            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x - 1, y, stroke);
+            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y - 1, mmode);
+            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y - 1, stroke);
+            if (bmode == 1) {
+                CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x + 1, y + 1, mmode);
+                CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x + 1, y + 1, stroke);
+                CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x - 1, y - 1, mmode);
+                CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x - 1, y - 1, stroke);
+            }
+        }
+        error += (y * 2) + 1;
+        y++;
+        if (error >= 0) {
+            --x;
+            error -= x * 2;
+        }
+    }
+    error = -r;
+    x     = r;
+    y     = 0;
+    while (x >= y) {
+        if (dashp == 0 || (y % dashp) < (dashp / 2)) {
+            CIRCLE_PLOT_8(draw_buffer_mask, cx, cy, x, y, mmode);
+            CIRCLE_PLOT_8(draw_buffer_level, cx, cy, x, y, fill);
+        }
+        error += (y * 2) + 1;
+        y++;
+        if (error >= 0) {
+            --x;
+            error -= x * 2;
+        }
+    }
+    mark_shape_end();
+}
+
+/**
+ * write_circle_filled: fill a circle on a given buffer.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       cx              origin x coordinate
+ * @param       cy              origin y coordinate
+ * @param       r               radius
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_circle_filled(uint8_t *buff, unsigned int cx, unsigned int cy, unsigned int r, int mode)
+{
+    CHECK_COORDS(cx, cy);
+    int error = -r, x = r, y = 0, xch = 0;
+    // It turns out that filled circles can take advantage of the midpoint
+    // circle algorithm. We simply draw very fast horizontal lines across each
+    // pair of X,Y coordinates. In some cases, this can even be faster than
+    // drawing an outlined circle!
+    //
+    // Due to multiple writes to each set of pixels, we have a special exception
+    // for when using the toggling draw mode.
+    while (x >= y) {
+        if (y != 0) {
+            write_hline(buff, cx - x, cx + x, cy + y, mode);
+            write_hline(buff, cx - x, cx + x, cy - y, mode);
+            if (mode != 2 || (mode == 2 && xch && (cx - x) != (cx - y))) {
+                write_hline(buff, cx - y, cx + y, cy + x, mode);
+                write_hline(buff, cx - y, cx + y, cy - x, mode);
+                xch = 0;
+            }
+        }
+        error += (y * 2) + 1;
+        y++;
+        if (error >= 0) {
+            --x;
+            xch    = 1;
+            error -= x * 2;
+        }
+    }
+    // Handle toggle mode.
+    if (mode == 2) {
+        write_hline(buff, cx - r, cx + r, cy, mode);
+    }
+}
+
+/**
+ * write_line: Draw a line of arbitrary angle.
+ *
+ * @param       buff    pointer to buffer to write in
+ * @param       x0              first x coordinate
+ * @param       y0              first y coordinate
+ * @param       x1              second x coordinate
+ * @param       y1              second y coordinate
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_line(uint8_t *buff, unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, int mode)
+{
+    // Based on http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
+    unsigned int steep = abs(y1 - y0) > abs(x1 - x0);
+
+    mark_shape_begin(x0, y0, x1, y1, 0);
+
+    if (steep) {
+        SWAP(x0, y0);
+        SWAP(x1, y1);
+    }
+    if (x0 > x1) {
+        SWAP(x0, x1);
+        SWAP(y0, y1);
+    }
+    int deltax     = x1 - x0;
+    unsigned int deltay = abs(y1 - y0);
+    int error      = deltax / 2;
+    int ystep;
+    unsigned int y = y0;
+    unsigned int x; // , lasty = y, stox = 0;
+    if (y0 < y1) {
+        ystep = 1;
+    } else {
+        ystep = -1;
+    }
+    for (x = x0; x < x1; x++) {
+        if (steep) {
+            write_pixel(buff, y, x, mode);
+        } else {
+            write_pixel(buff, x, y, mode);
+        }
+        error -= deltay;
+        if (error < 0) {
+            y     += ystep;
+            error += deltax;
+        }
+    }
+    mark_shape_end();
+}
+
+/**
+ * write_line_lm: Draw a line of arbitrary angle.
+ *
+ * @param       x0              first x coordinate
+ * @param       y0              first y coordinate
+ * @param       x1              second x coordinate
+ * @param       y1              second y coordinate
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ * @param       lmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_line_lm(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1, int mmode, int lmode)
+{
+    write_line(draw_buffer_mask, x0, y0, x1, y1, mmode);
+    write_line(draw_buffer_level, x0, y0, x1, y1, lmode);
+}
+
+/**
+ * write_line_outlined: Draw a line of arbitrary angle, with an outline.
+ *
+ * @param       buff            pointer to buffer to write in
+ * @param       x0                      first x coordinate
+ * @param       y0                      first y coordinate
+ * @param       x1                      second x coordinate
+ * @param       y1                      second y coordinate
+ * @param       endcap0         0 = none, 1 = single pixel, 2 = full cap
+ * @param       endcap1         0 = none, 1 = single pixel, 2 = full cap
+ * @param       mode            0 = black outline, white body, 1 = white outline, black body
+ * @param       mmode           0 = clear, 1 = set, 2 = toggle
+ */
+void write_line_outlined(unsigned int x0, unsigned int y0, unsigned int x1, unsigned int y1,
+                         __attribute__((unused)) int endcap0, __attribute__((unused)) int endcap1,
+                         int mode, int mmode)
+{
+    // Based on http://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm
+    // This could be improved for speed.
+    int omode, imode;
+
+    if (mode == 0) {
+        omode = 0;
+        imode = 1;
+    } else {
+        omode = 1;
+        imode = 0;
+    }
+    int steep = abs(y1 - y0) > abs(x1 - x0);
+    mark_shape_begin(x0, y0, x1, y1, 1);
+    if (steep) {
+        SWAP(x0, y0);
+        SWAP(x1, y1);
+    }
+    if (x0 > x1) {
+        SWAP(x0, x1);
+        SWAP(y0, y1);
+    }
+    int deltax     = x1 - x0;
+    unsigned int deltay = abs(y1 - y0);
+    int error      = deltax / 2;
+    int ystep;
+    unsigned int y = y0;
+    unsigned int x;
+    if (y0 < y1) {
+        ystep = 1;
+    } else {
+        ystep = -1;
+    }
+    // Draw the outline.
+    for (x = x0; x < x1; x++) {
+        if (steep) {
+            write_pixel_lm(y - 1, x, mmode, omode);
+            write_pixel_lm(y + 1, x, mmode, omode);
+            write_pixel_lm(y, x - 1, mmode, omode);
+            write_pixel_lm(y, x + 1, mmode, omode);
+        } else {
+            write_pixel_lm(x - 1, y, mmode, omode);
+            write_pixel_lm(x + 1, y, mmode, omode);
+            write_pixel_lm(x, y - 1, mmode, omode);
+            write_pixel_lm(x, y + 1, mmode, omode);
+        }
+        error -= deltay;
+        if (error < 0) {
+            y     += ystep;
+            error += deltax;
+        }
+    }
+    // Now draw the innards.
+    error = deltax / 2;
+    y     = y0;
+    for (x = x0; x < x1; x++) {
+        if (steep) {
+            write_pixel_lm(y, x, mmode, imode);
+        } else {
+            write_pixel_lm(x, y, mmode, imode);
+        }
+        error -= deltay;
+        if (error < 0) {
+            y     += ystep;
+            error += deltax;
+        }
+    }
+    mark_shape_end();
+}
+
+/**
+ * write_word_misaligned: Write a misaligned word across two addresses
+ * with an x offset.
+ *
+ * This allows for many pixels to be set in one write.
+ *
+ * @param       buff    buffer to write in
+ * @param       word    word to write (16 bits)
+ * @param       addr    address of first word
+ * @param       xoff    x offset (0-15)
+ * @param       mode    0 = clear, 1 = set, 2 = toggle
+ */
+void write_word_misaligned(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff, int mode)
+{
+    uint16_t firstmask = word >> xoff;
+    uint16_t lastmask  = word << (16 - xoff);
+
+    WRITE_WORD_MODE(buff, addr + 1, firstmask & 0x00ff, mode);
+    WRITE_WORD_MODE(buff, addr, (firstmask & 0xff00) >> 8, mode);
+    if (xoff > 0) {
+        WRITE_WORD_MODE(buff, addr + 2, (lastmask & 0xff00) >> 8, mode);
+    }
+    if (mode) {
+        osd_render_mark(addr / OSD_RENDER_LINE_BYTES, addr / OSD_RENDER_LINE_BYTES, addr % OSD_RENDER_LINE_BYTES, addr % OSD_RENDER_LINE_BYTES + 2);
+    }
+}
+
+/**
+ * write_word_misaligned_NAND: Write a misaligned word across two addresses
+ * with an x offset, using a NAND mask.
+ *
+ * This allows for many pixels to be set in one write.
+ *
+ * @param       buff    buffer to write in
+ * @param       word    word to write (16 bits)
+ * @param       addr    address of first word
+ * @param       xoff    x offset (0-15)
+ *
+ * This is identical to calling write_word_misaligned with a mode of 0 but
+ * it doesn't go through a lot of switch logic which slows down text writing
+ * a lot.
+ */
+void write_word_misaligned_NAND(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff)
+{
+    uint16_t firstmask = word >> xoff;
+    uint16_t lastmask  = word << (16 - xoff);
+
+    WRITE_WORD_NAND(buff, addr + 1, firstmask & 0x00ff);
+    WRITE_WORD_NAND(buff, addr, (firstmask & 0xff00) >> 8);
+    if (xoff > 0) {
+        WRITE_WORD_NAND(buff, addr + 2, (lastmask & 0xff00) >> 8);
+    }
+}
+
+/**
+ * write_word_misaligned_OR: Write a misaligned word across two addresses
+ * with an x offset, using an OR mask.
+ *
+ * This allows for many pixels to be set in one write.
+ *
+ * @param       buff    buffer to write in
+ * @param       word    word to write (16 bits)
+ * @param       addr    address of first word
+ * @param       xoff    x offset (0-15)
+ *
+ * This is identical to calling write_word_misaligned with a mode of 1 but
+ * it doesn't go through a lot of switch logic which slows down text writing
+ * a lot.
+ */
+void write_word_misaligned_OR(uint8_t *buff, uint16_t word, unsigned int addr, unsigned int xoff)
+{
+    uint16_t firstmask = word >> xoff;
+    uint16_t lastmask  = word << (16 - xoff);
+
+    WRITE_WORD_OR(buff, addr + 1, firstmask & 0x00ff);
+    WRITE_WORD_OR(buff, addr, (firstmask & 0xff00) >> 8);
+    if (xoff > 0) {
+        WRITE_WORD_OR(buff, addr + 2, (lastmask & 0xff00) >> 8);
+    }
+    osd_render_mark(addr / OSD_RENDER_LINE_BYTES, addr / OSD_RENDER_LINE_BYTES, addr % OSD_RENDER_LINE_BYTES, addr % OSD_RENDER_LINE_BYTES + 2);
+}
+
+/**
+ * write_word_misaligned_lm: Write a misaligned word across two
+ * words, in both level and mask buffers. This is core to the text
+ * writing routines.
+ *
+ * @param       buff    buffer to write in
+ * @param       word    word to write (16 bits)
+ * @param       addr    address of first word
+ * @param       xoff    x offset (0-15)
+ * @param       lmode   0 = clear, 1 = set, 2 = toggle
+ * @param       mmode   0 = clear, 1 = set, 2 = toggle
+ */
+void write_word_misaligned_lm(uint16_t wordl, uint16_t wordm, unsigned int addr, unsigned int xoff, int lmode, int mmode)
+{
+    write_word_misaligned(draw_buffer_level, wordl, addr, xoff, lmode);
+    write_word_misaligned(draw_buffer_mask, wordm, addr, xoff, mmode);
+}
+
+/**
+ * fetch_font_info: Fetch font info structs.
+ *
+ * @param       ch              character
+ * @param       font    font id
+ */
+int fetch_font_info(uint8_t ch, int font, struct FontEntry *font_info, char *lookup)
+{
+    // First locate the font struct.
+    if ((unsigned int)font > SIZEOF_ARRAY(fonts)) {
+        return 0; // font does not exist, exit.
+    }
+    // Load the font info; IDs are always sequential.
+    *font_info = fonts[font];
+    // Locate character in font lookup table. (If required.)
+    if (lookup != NULL) {
+        *lookup = font_info->lookup[ch];
+        if ((uint8_t)*lookup == 0xff) {
+            return 0; // character doesn't exist, don't bother writing it.
+        }
+    }
+    return 1;
+}
+
+/**
+ * write_char16: Draw a character on the current draw buffer, for the
+ * 8x10 and 12x18 fonts.
+ *
+ * @param       ch              character to write
+ * @param       x               x coordinate (left)
+ * @param       y               y coordinate (top)
+ * @param       font    font to use
+ */
+void write_char16(char ch, unsigned int x, unsigned int y, int font)
+{
+    struct FontEntry font_info;
+
+    fetch_font_info(0, font, &font_info, NULL);
+
+    // Compute starting address (for x,y) of character.
+    unsigned int addr = CALC_BUFF_ADDR(x, y);
+    unsigned int wbit = CALC_BIT_IN_WORD(x);
+
+    // Ensure we don't overflow.
+    if (x + wbit > GRAPHICS_WIDTH_REAL) {
+        return;
+    }
+    // The glyph rows are shifted once and cached, each row is then
+    // written to both buffers in a single pass.
+    write_glyph(fetch_glyph((uint8_t)ch, font, &font_info, wbit, 0), addr, font_info.height);
+    osd_render_mark(y, y + font_info.height - 1, x / 8, x / 8 + 2);
+}
+
+/**
+ * write_char: Draw a character on the current draw buffer.
+ * Currently supports outlined characters and characters with
+ * a width of up to 8 pixels.
+ *
+ * @param       ch              character to write
+ * @param       x               x coordinate (left)
+ * @param       y               y coordinate (top)
+ * @param       flags   flags to write with (see gfx.h)
+ * @param       font    font to use
+ */
+void write_char(char ch, unsigned int x, unsigned int y, int flags, int font)
+{
+    struct FontEntry font_info;
+    char lookup = 0;
+
+    // Locate the character, skip it if it is not in the font.
+    if (!fetch_font_info(ch, font, &font_info, &lookup)) {
+        return;
+    }
+    // Compute starting address (for x,y) of character.
+    unsigned int addr = CALC_BUFF_ADDR(x, y);
+    unsigned int wbit = CALC_BIT_IN_WORD(x);
+    // How big is the character? We handle characters up to 8 pixels
+    // wide for now. Support for large characters may be added in future.
+    if (font_info.width <= 8) {
+        // Ensure we don't overflow.
+        if (x + wbit > GRAPHICS_WIDTH_REAL) {
+            return;
+        }
+        write_glyph(fetch_glyph((uint8_t)lookup, font, &font_info, wbit, flags), addr, font_info.height);
+        osd_render_mark(y, y + font_info.height - 1, x / 8, x / 8 + 2);
+    }
+}
+
+/**
+ * calc_text_dimensions: Calculate the dimensions of a
+ * string in a given font. Supports new lines and
+ * carriage returns in text.
+ *
+ * @param       str                     string to calculate dimensions of
+ * @param       font_info       font info structure
+ * @param       xs                      horizontal spacing
+ * @param       ys                      vertical spacing
+ * @param       dim                     return result: struct FontDimensions
+ */
+void calc_text_dimensions(char *str, struct FontEntry font, int xs, int ys, struct FontDimensions *dim)
+{
+    int max_length = 0, line_length = 0, lines = 1;
+
+    while (*str != 0) {
+        line_length++;
+        if (*str == '\n' || *str == '\r') {
+            if (line_length > max_length) {
+                max_length = line_length;
+            }
+            line_length = 0;
+            lines++;
+        }
+        str++;
+    }
+    if (line_length > max_length) {
+        max_length = line_length;
+    }
+    dim->width  = max_length * (font.width + xs);
+    dim->height = lines * (font.height + ys);
+}
+
+/**
+ * write_string: Draw a string on the screen with certain
+ * alignment parameters.
+ *
+ * @param       str             string to write
+ * @param       x               x coordinate
+ * @param       y               y coordinate
+ * @param       xs              horizontal spacing
+ * @param       ys              horizontal spacing
+ * @param       va              vertical align
+ * @param       ha              horizontal align
+ * @param       flags   flags (passed to write_char)
+ * @param       font    font
+ */
+void write_string(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys, int va, int ha, int flags, int font)
+{
+    int xx = 0, yy = 0, xx_original = 0;
+    struct FontEntry font_info;
+    struct FontDimensions dim;
+
+    // Determine font info and dimensions/position of the string.
+    fetch_font_info(0, font, &font_info, NULL);
+    calc_text_dimensions(str, font_info, xs, ys, &dim);
+    switch (va) {
+    case TEXT_VA_TOP:
+        yy = y;
+        break;
+    case TEXT_VA_MIDDLE:
+        yy = y - (dim.height / 2);
+        break;
+    case TEXT_VA_BOTTOM:
+        yy = y - dim.height;
+        break;
+    }
+    switch (ha) {
+    case TEXT_HA_LEFT:
+        xx = x;
+        break;
+    case TEXT_HA_CENTER:
+        xx = x - (dim.width / 2);
+        break;
+    case TEXT_HA_RIGHT:
+        xx = x - dim.width;
+        break;
+    }
+    // Then write each character.
+    xx_original = xx;
+    while (*str != 0) {
+        if (*str == '\n' || *str == '\r') {
+            yy += ys + font_info.height;
+            xx  = xx_original;
+        } else {
+            if (xx >= 0 && xx < GRAPHICS_WIDTH_REAL) {
+                if (font_info.id < 2) {
+                    write_char(*str, xx, yy, flags, font);
+                } else {
+                    write_char16(*str, xx, yy, font);
+                }
+            }
+            xx += font_info.width + xs;
+        }
+        str++;
+    }
+}
+
+/**
+ * write_string_widget: Draw a string as a retained widget, only redrawn
+ * when the string or its position changes.
+ *
+ * @param       id              widget id
+ * @param       str             string to write
+ * @param       x               x coordinate
+ * @param       y               y coordinate
+ * @param       va              vertical align
+ * @param       ha              horizontal align
+ * @param       font    font
+ */
+void write_string_widget(uint8_t id, char *str, unsigned int x, unsigned int y, int va, int ha, int font)
+{
+    int32_t key[] = { x, y, va, ha, font };
+
+    if (osd_render_widget_begin(id, osd_render_hash(osd_render_hash(OSD_RENDER_HASH_INIT, key, sizeof(key)), str, strlen(str)))) {
+        write_string(str, x, y, 0, 0, va, ha, 0, font);
+    }
+    osd_render_widget_end();
+}
+
+/**
+ * write_string_formatted: Draw a string with format escape
+ * sequences in it. Allows for complex text effects.
+ *
+ * @param       str             string to write (with format data)
+ * @param       x               x coordinate
+ * @param       y               y coordinate
+ * @param       xs              default horizontal spacing
+ * @param       ys              default horizontal spacing
+ * @param       va              vertical align
+ * @param       ha              horizontal align
+ * @param       flags   flags (passed to write_char)
+ */
+void write_string_formatted(char *str, unsigned int x, unsigned int y, unsigned int xs, unsigned int ys,
+                            __attribute__((unused)) int va, __attribute__((unused)) int ha, int flags)
+{
+    int fcode = 0, fptr = 0, font = 0, fwidth = 0, fheight = 0, xx = x, yy = y, max_xx = 0, max_height = 0;
+    struct FontEntry font_info;
+
+    // Retrieve sizes of the fonts: bigfont and smallfont.
+    fetch_font_info(0, 0, &font_info, NULL);
+    int smallfontwidth = font_info.width, smallfontheight = font_info.height;
+    fetch_font_info(0, 1, &font_info, NULL);
+    int bigfontwidth   = font_info.width, bigfontheight = font_info.height;
+    // 11 byte stack with last byte as NUL.
+    char fstack[11];
+    fstack[10] = '\0';
+    // First, we need to parse the string for format characters and
+    // work out a bounding box. We'll parse again for the final output.
+    // This is a simple state machine parser.
+    char *ostr = str;
+    while (*str) {
+        if (*str == '<' && fcode == 1) {
+            // escape code: skip
+            fcode = 0;
+        }
+        if (*str == '<' && fcode == 0) {
+            // begin format code?
+            fcode = 1;
+            fptr  = 0;
+        }
+        if (*str == '>' && fcode == 1) {
+            fcode = 0;
+            if (strcmp(fstack, "B")) {
+                // switch to "big" font (font #1)
+                fwidth  = bigfontwidth;
+                fheight = bigfontheight;
+            } else if (strcmp(fstack, "S")) {
+                // switch to "small" font (font #0)
+                fwidth  = smallfontwidth;
+                fheight = smallfontheight;
+            }
+            if (fheight > max_height) {
+                max_height = fheight;
+            }
+            // Skip over this byte. Go to next byte.
+            str++;
+            continue;
+        }
+        if (*str != '<' && *str != '>' && fcode == 1) {
+            // Add to the format stack (up to 10 bytes.)
+            if (fptr > 10) {
+                // stop adding bytes
+                str++; // go to next byte
+                continue;
+            }
+            fstack[fptr++] = *str;
+            fstack[fptr]   = '\0'; // clear next byte (ready for next char or to terminate string.)
+        }
+        if (fcode == 0) {
+            // Not a format code, raw text.
+            xx += fwidth + xs;
+            if (*str == '\n') {
+                if (xx > max_xx) {
+                    max_xx = xx;
+                }
+                xx  = x;
+                yy += fheight + ys;
+            }
+        }
+        str++;
+    }
+    // Reset string pointer.
+    str = ostr;
+    // Now we've parsed it and got a bbox, we need to work out the dimensions of it
+    // and how to align it.
+    /*int width = max_xx - x;
+       int height = yy - y;
+       int ay, ax;
+       switch(va)
+       {
+       case TEXT_VA_TOP:               ay = yy; break;
+       case TEXT_VA_MIDDLE:    ay = yy - (height / 2); break;
+       case TEXT_VA_BOTTOM:    ay = yy - height; break;
+       }
+       switch(ha)
+       {
+       case TEXT_HA_LEFT:              ax = x; break;
+       case TEXT_HA_CENTER:    ax = x - (width / 2); break;
+       case TEXT_HA_RIGHT:             ax = x - width; break;
+       }*/
+    // So ax,ay is our new text origin. Parse the text format again and paint
+    // the text on the display.
+    fcode = 0;
+    fptr  = 0;
+    font  = 0;
+    xx    = 0;
+    yy    = 0;
+    while (*str) {
+        if (*str == '<' && fcode == 1) {
+            // escape code: skip
+            fcode = 0;
+        }
+        if (*str == '<' && fcode == 0) {
+            // begin format code?
+            fcode = 1;
+            fptr  = 0;
+        }
+        if (*str == '>' && fcode == 1) {
+            fcode = 0;
+            if (strcmp(fstack, "B")) {
+                // switch to "big" font (font #1)
+                fwidth  = bigfontwidth;
+                fheight = bigfontheight;
+                font    = 1;
+            } else if (strcmp(fstack, "S")) {
+                // switch to "small" font (font #0)
+                fwidth  = smallfontwidth;
+                fheight = smallfontheight;
+                font    = 0;
+            }
+            // Skip over this byte. Go to next byte.
+            str++;
+            continue;
+        }
+        if (*str != '<' && *str != '>' && fcode == 1) {
+            // Add to the format stack (up to 10 bytes.)
+            if (fptr > 10) {
+                // stop adding bytes
+                str++; // go to next byte
+                continue;
+            }
+            fstack[fptr++] = *str;
+            fstack[fptr]   = '\0'; // clear next byte (ready for next char or to terminate string.)
+        }
+        if (fcode == 0) {
+            // Not a format code, raw text. So we draw it.
+            // TODO - different font sizes.
+            write_char(*str, xx, yy + (max_height - fheight), flags, font);
+            xx += fwidth + xs;
+            if (*str == '\n') {
+                if (xx > max_xx) {
+                    max_xx = xx;
+                }
+                xx  = x;
+                yy += fheight + ys;
+            }
+        }
+        str++;
+    }
+}
+
+
+/**
+ * @}
+ * @}
+ */
@@ -31,6 +31,7 @@ extern "C" {
 
 #include <pid.h>
 #include <sin_lookup.h>
+#include <fastmath.h>
 #include <pathdesired.h>
 #include <paths.h>
 #include <fixedwingpathfollowersettings.h>
@@ -478,10 +479,10 @@ uint8_t FixedWingFlyController::updateFixedDesiredAttitude()
      * Compute desired roll command
      */
     if (hasAirspeed) {
-        courseError = RAD2DEG(atan2f(courseComponent[1], courseComponent[0])) - attitudeState.Yaw;
+        courseError = RAD2DEG(fast_atan2f(courseComponent[1], courseComponent[0])) - attitudeState.Yaw;
     } else {
         // fallback based on effective movement direction when in fallback mode, hope that airspeed > wind velocity, or we will never get home
-        courseError = RAD2DEG(atan2f(velocityDesired.East, velocityDesired.North)) - RAD2DEG(atan2f(velocityState.East, velocityState.North));
+        courseError = RAD2DEG(fast_atan2f(velocityDesired.East, velocityDesired.North)) - RAD2DEG(fast_atan2f(velocityState.East, velocityState.North));
     }
 
     if (courseError < -180.0f) {
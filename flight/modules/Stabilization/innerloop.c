@@ -9,7 +9,7 @@
  * @{
  *
  * @file       innerloop.c
- * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2015-2016.
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2015-2018.
  *             The OpenPilot Team, http://www.openpilot.org Copyright (C) 2014.
  * @brief      Attitude stabilization module.
  *
@@ -35,6 +35,7 @@
 #include <openpilot.h>
 #include <pid.h>
 #include <sin_lookup.h>
+#include <fastmath.h>
 #include <callbackinfo.h>
 #include <ratedesired.h>
 #include <actuatordesired.h>
@@ -54,6 +55,13 @@
 #if !defined(PIOS_EXCLUDE_ADVANCED_FEATURES)
 #include <systemidentstate.h>
 #endif /* !defined(PIOS_EXCLUDE_ADVANCED_FEATURES) */
+#ifdef ACTUATOR_FASTPATH
+#include <actuator.h>
+#endif
+#if defined(PIOS_INCLUDE_INSTRUMENTATION) && defined(ACTUATOR_FASTPATH_COUNTERS)
+#include <pios_instrumentation.h>
+#define LATENCY_COUNTERS
+#endif
 
 // Private constants
 
@@ -66,6 +74,13 @@
 
 #define SYSTEM_IDENT_PERIOD ((uint32_t)75)
 
+#ifdef ACTUATOR_FASTPATH
+// the mixer runs on the stack of this callback
+#define CALLBACK_STACK_SIZE (STACK_SIZE_BYTES + 512)
+#else
+#define CALLBACK_STACK_SIZE STACK_SIZE_BYTES
+#endif
+
 #if defined(PIOS_EXCLUDE_ADVANCED_FEATURES)
 #define powapprox           fastpow
 #define expapprox           fastexp
@@ -86,6 +101,13 @@ static bool measuredDterm_enabled;
 #if !defined(PIOS_EXCLUDE_ADVANCED_FEATURES)
 static uint32_t systemIdentTimeVal = 0;
 #endif /* !defined(PIOS_EXCLUDE_ADVANCED_FEATURES) */
+#ifdef LATENCY_COUNTERS
+static uint32_t gyroUpdateTime;
+// Counter 0x5AB00001 gyro update to actuator outputs, in us
+static pios_counter_t latencyCounter;
+// Counter 0x5AB00002 inner loop execution time, including the actuator task when not using the fast path
+static pios_counter_t loopCounter;
+#endif
 
 // Private functions
 static void stabilizationInnerloopTask();
@@ -113,8 +135,12 @@ void stabilizationInnerloopInit()
 #endif
     PIOS_DELTATIME_Init(&timeval, UPDATE_EXPECTED, UPDATE_MIN, UPDATE_MAX, UPDATE_ALPHA);
 
-    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, STACK_SIZE_BYTES);
+    callbackHandle = PIOS_CALLBACKSCHEDULER_Create(&stabilizationInnerloopTask, CALLBACK_PRIORITY, CBTASK_PRIORITY, CALLBACKINFO_RUNNING_STABILIZATION1, CALLBACK_STACK_SIZE);
     GyroStateConnectCallback(GyroStateUpdatedCb);
+#ifdef LATENCY_COUNTERS
+    latencyCounter = PIOS_Instrumentation_CreateCounter(0x5AB00001);
+    loopCounter    = PIOS_Instrumentation_CreateCounter(0x5AB00002);
+#endif
 
     // schedule dead calls every FAILSAFE_TIMEOUT_MS to have the watchdog cleared
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
@@ -209,6 +235,9 @@ static pid_scaler create_pid_scaler(int axis)
  */
 static void stabilizationInnerloopTask()
 {
+#ifdef LATENCY_COUNTERS
+    PIOS_Instrumentation_TimeStart(loopCounter);
+#endif
     // watchdog and error handling
     {
 #ifdef PIOS_INCLUDE_WDG
@@ -257,13 +286,17 @@ static void stabilizationInnerloopTask()
 
     RateDesiredData rateDesired;
     ActuatorDesiredData actuator;
-    StabilizationStatusInnerLoopData enabled;
-    FlightStatusControlChainData cchain;
+    StabilizationStatusData stabStatus;
+    FlightStatusData flightStatus;
 
+    // one get per object, the fields needed are taken from the copies
     RateDesiredGet(&rateDesired);
     ActuatorDesiredGet(&actuator);
-    StabilizationStatusInnerLoopGet(&enabled);
-    FlightStatusControlChainGet(&cchain);
+    StabilizationStatusGet(&stabStatus);
+    FlightStatusGet(&flightStatus);
+    StabilizationStatusInnerLoopData enabled   = stabStatus.InnerLoop;
+    StabilizationStatusOuterLoopData outerLoop = stabStatus.OuterLoop;
+    FlightStatusControlChainData cchain = flightStatus.ControlChain;
     float *rate = &rateDesired.Roll;
     float *actuatorDesiredAxis = &actuator.Roll;
     int t;
@@ -271,8 +304,6 @@ static void stabilizationInnerloopTask()
     bool multirotor = (GetCurrentFrameType() == FRAME_TYPE_MULTIROTOR); // check if frame is a multirotor
     dT = PIOS_DELTATIME_GetAverageSeconds(&timeval);
 
-    StabilizationStatusOuterLoopData outerLoop;
-    StabilizationStatusOuterLoopGet(&outerLoop);
     bool allowPiroComp = true;
 
 
@@ -427,7 +458,18 @@ static void stabilizationInnerloopTask()
     actuator.UpdateTime = dT * 1000;
 
     if (cchain.Stabilization == FLIGHTSTATUS_CONTROLCHAIN_TRUE) {
+#ifdef ACTUATOR_FASTPATH
+        // mix and update the outputs right here instead of in the actuator task,
+        // unless ActuatorDesiredSet() is going to be refused (object overridden)
+        if (!ActuatorDesiredReadOnly()) {
+            ActuatorFastPathUpdate(&actuator);
+        }
+#endif
         ActuatorDesiredSet(&actuator);
+#ifdef LATENCY_COUNTERS
+        // without the fast path the higher priority actuator task has updated the outputs by now
+        PIOS_Instrumentation_updateCounter(latencyCounter, PIOS_DELAY_DiffuS(gyroUpdateTime));
+#endif
     } else {
         // Force all axes to reinitialize when engaged
         for (t = 0; t < AXES; t++) {
@@ -438,8 +480,8 @@ static void stabilizationInnerloopTask()
     if (allowPiroComp && stabSettings.stabBank.EnablePiroComp == STABILIZATIONBANK_ENABLEPIROCOMP_TRUE && stabSettings.innerPids[0].iLim > 1e-3f && stabSettings.innerPids[1].iLim > 1e-3f) {
         // attempted piro compensation - rotate pitch and yaw integrals (experimental)
         float angleYaw = DEG2RAD(gyro_filtered[2] * dT);
-        float sinYaw   = sinf(angleYaw);
-        float cosYaw   = cosf(angleYaw);
+        float sinYaw, cosYaw;
+        fast_sincosf(angleYaw, &sinYaw, &cosYaw);
         float rollAcc  = stabSettings.innerPids[0].iAccumulator / stabSettings.innerPids[0].iLim;
         float pitchAcc = stabSettings.innerPids[1].iAccumulator / stabSettings.innerPids[1].iLim;
         stabSettings.innerPids[0].iAccumulator = stabSettings.innerPids[0].iLim * (cosYaw * rollAcc + sinYaw * pitchAcc);
@@ -447,17 +489,12 @@ static void stabilizationInnerloopTask()
     }
 
     {
-        FlightStatusArmedOptions armed;
-        FlightStatusArmedGet(&armed);
-        FlightStatusAlwaysStabilizeWhenArmedOptions alwaysStabilizeWhenArmed;
-        FlightStatusAlwaysStabilizeWhenArmedGet(&alwaysStabilizeWhenArmed);
-
         float throttleDesired;
         ManualControlCommandThrottleGet(&throttleDesired);
-        if (armed != FLIGHTSTATUS_ARMED_ARMED ||
+        if (flightStatus.Armed != FLIGHTSTATUS_ARMED_ARMED ||
             ((stabSettings.settings.LowThrottleZeroIntegral == STABILIZATIONSETTINGS_LOWTHROTTLEZEROINTEGRAL_TRUE) &&
              (throttleDesired < 0) &&
-             (alwaysStabilizeWhenArmed != FLIGHTSTATUS_ALWAYSSTABILIZEWHENARMED_TRUE))) {
+             (flightStatus.AlwaysStabilizeWhenArmed != FLIGHTSTATUS_ALWAYSSTABILIZEWHENARMED_TRUE))) {
             // Force all axes to reinitialize when engaged
             for (t = 0; t < AXES; t++) {
                 previous_mode[t] = 255;
@@ -465,6 +502,9 @@ static void stabilizationInnerloopTask()
         }
     }
     PIOS_CALLBACKSCHEDULER_Schedule(callbackHandle, FAILSAFE_TIMEOUT_MS, CALLBACK_UPDATEMODE_LATER);
+#ifdef LATENCY_COUNTERS
+    PIOS_Instrumentation_TimeEnd(loopCounter);
+#endif
 }
 
 
@@ -472,6 +512,9 @@ static void GyroStateUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
 {
     GyroStateData gyroState;
 
+#ifdef LATENCY_COUNTERS
+    gyroUpdateTime = PIOS_DELAY_GetRaw();
+#endif
     GyroStateGet(&gyroState);
 
     gyro_filtered[0] = gyro_filtered[0] * stabSettings.gyro_alpha + gyroState.x * (1 - stabSettings.gyro_alpha);
@@ -39,6 +39,7 @@
 #include <auxmagsettings.h>
 #include <CoordinateConversions.h>
 #include <mathmisc.h>
+#include <fastmath.h>
 
 // Private constants
 //
@@ -270,8 +271,8 @@ void magOffsetEstimation(struct data *this, float mag[3])
     B_e[1] = Rot[0][1] * mag[0] + Rot[1][1] * mag[1] + Rot[2][1] * mag[2];
     B_e[2] = Rot[0][2] * mag[0] + Rot[1][2] * mag[1] + Rot[2][2] * mag[2];
 
-    float cy = cosf(DEG2RAD(attitude.Yaw));
-    float sy = sinf(DEG2RAD(attitude.Yaw));
+    float cy, sy;
+    fast_sincosf(DEG2RAD(attitude.Yaw), &sy, &cy);
 
     xy[0] = cy * B_e[0] + sy * B_e[1];
     xy[1] = -sy * B_e[0] + cy * B_e[1];
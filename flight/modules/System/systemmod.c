@@ -59,6 +59,9 @@
 #include <callbackinfo.h>
 #include <hwsettings.h>
 #include <pios_flashfs.h>
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+#include <pios_flashfs_logfs_priv.h>
+#endif
 #include <pios_notify.h>
 #include <pios_task_monitor.h>
 #include <pios_board_init.h>
@@ -209,6 +212,13 @@ static void systemTask(__attribute__((unused)) void *parameters)
     /* create all modules thread */
     MODULE_TASKCREATE_ALL;
 
+#if !defined(ARCH_POSIX) && !defined(ARCH_WIN32) && defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS) && defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+    /* garbage collect the settings partition in the background, not in UAVObjSave() */
+    if (pios_uavo_settings_fs_id) {
+        PIOS_FLASHFS_Logfs_EnableCompaction(pios_uavo_settings_fs_id);
+    }
+#endif
+
     /* start the delayed callback scheduler */
     PIOS_CALLBACKSCHEDULER_Start();
 
@@ -371,6 +381,11 @@ static void objectUpdatedCb(UAVObjEvent *ev)
             return;
         }
 
+        // A plain save or load ends a settings transaction that was left open
+        if (objper.Operation == OBJECTPERSISTENCE_OPERATION_LOAD || objper.Operation == OBJECTPERSISTENCE_OPERATION_SAVE) {
+            UAVObjAbortSettingsTransaction();
+        }
+
         // Execute action if disarmed
         if (flightStatus.Armed != FLIGHTSTATUS_ARMED_DISARMED) {
             retval = -1;
@@ -424,6 +439,13 @@ static void objectUpdatedCb(UAVObjEvent *ev)
             } else if (objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLMETAOBJECTS || objper.Selection == OBJECTPERSISTENCE_SELECTION_ALLOBJECTS) {
                 retval = UAVObjDeleteMetaobjects();
             }
+        } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_BEGINTRANSACTION) {
+            // Settings received from now on are staged until the commit
+            UAVObjBeginSettingsTransaction();
+            retval = 0;
+        } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_COMMITTRANSACTION) {
+            // Save everything staged in one go
+            retval = UAVObjCommitSettingsTransaction();
         } else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_FULLERASE) {
 #if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
             retval = PIOS_FLASHFS_Format(0);
@@ -628,6 +650,12 @@ static void updateStats()
     stats.HeapRemaining = xPortGetFreeHeapSize();
     stats.SystemModStackRemaining = uxTaskGetStackHighWaterMark(NULL) * 4;
 #endif
+    struct pios_mem_stats memStats;
+    pios_mem_get_stats(&memStats);
+    stats.HeapLargestFree   = memStats.heapLargestFree;
+    stats.HeapPoolReserved  = memStats.poolReserved;
+    stats.HeapPoolUsed      = memStats.poolUsed;
+    stats.HeapPoolHighWater = memStats.poolHighWater;
 
     // Get Irq stack status
     stats.IRQStackRemaining = GetFreeIrqStackSize();
@@ -136,6 +136,7 @@ static void updateSettings(channelContext *channel);
 static channelContext radioChannel;
 static int32_t transmitRadioData(uint8_t *data, int32_t length);
 static void registerRadioObject(UAVObjHandle obj);
+static void registerDeclaredObject(UAVObjHandle obj);
 static uint32_t radioPort();
 static uint32_t radio_port;
 
@@ -172,6 +173,10 @@ static void gcsTelemetryStatsUpdated();
  */
 int32_t TelemetryStart(void)
 {
+    // Objects registered on demand after this point are set up as they appear,
+    // connecting one twice only updates its settings
+    UAVObjSetRegisteredCallback(&registerDeclaredObject);
+
 #ifdef HAS_RADIO
     // Only start the local telemetry tasks if needed
     if (localPort()) {
@@ -366,6 +371,20 @@ static void registerRadioObject(UAVObjHandle obj)
     }
 }
 
+/**
+ * Register an object declared at startup but registered on first access
+ * \param[in] obj Object to connect
+ */
+static void registerDeclaredObject(UAVObjHandle obj)
+{
+#ifdef HAS_RADIO
+    if (localPort()) {
+        registerLocalObject(obj);
+    }
+#endif
+    registerRadioObject(obj);
+}
+
 /**
  * Update object's queue connections and timer, depending on object's settings
  * \param[in] telemetry channel context
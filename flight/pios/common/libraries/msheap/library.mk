@@ -5,3 +5,4 @@
 MSHEAP_DIR	:= $(dir $(lastword $(MAKEFILE_LIST)))
 SRC		+= $(sort $(wildcard $(MSHEAP_DIR)*.c))
 EXTRAINCDIRS	+= $(MSHEAP_DIR)
+CDEFS		+= -DPIOS_INCLUDE_MSHEAP
@@ -388,6 +388,21 @@ msheap_free_space(heap_handle_t *heap)
     return heap->heap_free * marker_size;
 }
 
+uint32_t
+msheap_largest_free(heap_handle_t *heap)
+{
+    marker_t    cursor;
+    uint32_t    largest = 0;
+
+    for (cursor = heap->heap_base; cursor != heap->heap_limit; cursor += cursor->next.size) {
+        if (cursor->next.free && (cursor->next.size > largest))
+            largest = cursor->next.size;
+    }
+
+    /* the region size includes its marker */
+    return largest ? (largest - 1) * marker_size : 0;
+}
+
 void
 msheap_extend(heap_handle_t *heap, uint32_t size)
 {
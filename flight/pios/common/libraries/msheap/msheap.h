@@ -34,6 +34,9 @@
  * SUCH DAMAGE.
  */
 
+#ifndef MSHEAP_H
+#define MSHEAP_H
+
 #include <stdint.h>
 
 /*
@@ -150,9 +153,21 @@ extern void msheap_walk(heap_handle_t *heap, void (* callback)(void *ptr, uint32
  */
 extern uint32_t msheap_free_space(heap_handle_t *heap);
 
+/**
+ * Return the size of the largest free region in the heap.
+ *
+ * Compared with msheap_free_space() this tells how fragmented
+ * the free space is.  Walks the whole heap.
+ *
+ * @return              The largest number of bytes that can be allocated at once.
+ */
+extern uint32_t msheap_largest_free(heap_handle_t *heap);
+
 /**
  * Extend the heap.
  *
  * @param   size        The size of the extension in bytes.
  */
 extern void msheap_extend(heap_handle_t *heap, uint32_t size);
+
+#endif /* MSHEAP_H */
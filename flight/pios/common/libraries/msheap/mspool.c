@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mspool.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Size class pools in front of the msheap allocator
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <stddef.h>
+#include "mspool.h"
+
+#define ALIGN_UP(x) (((x) + MSPOOL_ALIGN - 1) & ~(uintptr_t)(MSPOOL_ALIGN - 1))
+
+// Payload sizes, multiples of MSPOOL_ALIGN to keep the blocks aligned
+static const uint16_t class_sizes[MSPOOL_NUM_CLASSES] = { 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128 };
+
+void mspool_init(mspool_handle_t *pool, heap_handle_t *heap)
+{
+    pool->heap = heap;
+    for (int i = 0; i < MSPOOL_NUM_CLASSES; i++) {
+        pool->classes[i].free_list  = NULL;
+        pool->classes[i].size       = class_sizes[i];
+        pool->classes[i].used       = 0;
+        pool->classes[i].total      = 0;
+        pool->classes[i].high_water = 0;
+    }
+    pool->reserved   = 0;
+    pool->used       = 0;
+    pool->high_water = 0;
+}
+
+/**
+ * Carve a new slab into blocks of class index and put them on its free list
+ * @return 0 if the heap has no room for the slab
+ */
+static int refill(mspool_handle_t *pool, uint8_t index)
+{
+    struct mspool_class *sclass = &pool->classes[index];
+    uint32_t block = ALIGN_UP(sizeof(struct marker) + sclass->size);
+    uint32_t count = MSPOOL_SLAB_SIZE / block;
+
+    if (count == 0) {
+        count = 1;
+    }
+
+    // The heap only aligns to its marker size, with compact markers the
+    // first block may have to start one marker further in the slab
+    uint32_t pad  = ALIGN_UP(sizeof(struct marker)) - sizeof(struct marker);
+    uint8_t *slab = msheap_alloc(pool->heap, NULL, count * block + pad);
+    if (!slab) {
+        return 0;
+    }
+    slab = (uint8_t *)(ALIGN_UP((uintptr_t)slab + sizeof(struct marker)) - sizeof(struct marker));
+
+    for (uint32_t i = 0; i < count; i++) {
+        marker_t header = (marker_t)(slab + i * block);
+        header->prev.size = index;
+        header->prev.free = 0;
+        header->next.size = 0;
+        header->next.free = 0;
+        *(void **)(header + 1) = sclass->free_list;
+        sclass->free_list = header + 1;
+    }
+    sclass->total  += count;
+    pool->reserved += count * block + pad;
+    return 1;
+}
+
+void *mspool_alloc(mspool_handle_t *pool, uint32_t size)
+{
+    uint8_t index;
+
+    if (size == 0 || size > MSPOOL_MAX_SIZE) {
+        return NULL;
+    }
+    for (index = 0; class_sizes[index] < size; index++) {
+        ;
+    }
+
+    struct mspool_class *sclass = &pool->classes[index];
+    if (!sclass->free_list && !refill(pool, index)) {
+        return NULL;
+    }
+
+    void *ptr = sclass->free_list;
+    sclass->free_list = *(void **)ptr;
+
+    if (++sclass->used > sclass->high_water) {
+        sclass->high_water = sclass->used;
+    }
+    pool->used += sclass->size;
+    if (pool->used > pool->high_water) {
+        pool->high_water = pool->used;
+    }
+    return ptr;
+}
+
+int mspool_owns(void *ptr)
+{
+    marker_t header = (marker_t)ptr - 1;
+
+    return header->next.size == 0 && !header->next.free;
+}
+
+void mspool_free(mspool_handle_t *pool, void *ptr)
+{
+    marker_t header = (marker_t)ptr - 1;
+    struct mspool_class *sclass = &pool->classes[header->prev.size];
+
+    *(void **)ptr     = sclass->free_list;
+    sclass->free_list = ptr;
+    sclass->used--;
+    pool->used -= sclass->size;
+}
+
+uint32_t mspool_size(mspool_handle_t *pool, void *ptr)
+{
+    marker_t header = (marker_t)ptr - 1;
+
+    return pool->classes[header->prev.size].size;
+}
+
+void mspool_get_stats(mspool_handle_t *pool, struct mspool_stats *stats)
+{
+    stats->reserved   += pool->reserved;
+    stats->used       += pool->used;
+    stats->high_water += pool->high_water;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       mspool.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Size class pools in front of the msheap allocator
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MSPOOL_H
+#define MSPOOL_H
+
+#include "msheap.h"
+
+/*
+ * Small allocations (queues, callbacks, UAVObject instances, event entries...)
+ * are served from per size class free lists instead of searching and
+ * splitting the heap. Blocks are carved from slabs allocated from the heap
+ * when a class runs empty, and go back to their free list when freed; slabs
+ * are never returned to the heap.
+ *
+ * Each block is preceded by a heap marker with a zero next size, which the
+ * heap never uses for allocated regions, so pool blocks can be told apart
+ * from heap allocations at no extra cost.
+ */
+
+#define MSPOOL_NUM_CLASSES 12
+#define MSPOOL_MAX_SIZE    128 /* larger allocations go to the heap directly */
+#define MSPOOL_SLAB_SIZE   128 /* bytes taken from the heap at once, at least one block */
+#define MSPOOL_ALIGN       8 /* alignment of the blocks, whatever the heap marker size */
+
+struct mspool_class {
+    void     *free_list;
+    uint16_t size; /* payload size in bytes */
+    uint16_t used; /* blocks currently allocated */
+    uint16_t total; /* blocks carved from slabs */
+    uint16_t high_water; /* most blocks ever allocated at once */
+};
+
+typedef struct {
+    heap_handle_t *heap;
+    struct mspool_class classes[MSPOOL_NUM_CLASSES];
+    uint32_t reserved; /* bytes taken from the heap for slabs */
+    uint32_t used; /* bytes of payload currently allocated */
+    uint32_t high_water; /* most bytes of payload ever allocated at once */
+} mspool_handle_t;
+
+struct mspool_stats {
+    uint32_t reserved;
+    uint32_t used;
+    uint32_t high_water;
+};
+
+/**
+ * Initialise the pools, slabs will be taken from heap.
+ */
+extern void mspool_init(mspool_handle_t *pool, heap_handle_t *heap);
+
+/**
+ * Allocate a block from the pool of the smallest class that fits size.
+ *
+ * @return              NULL if size is larger than MSPOOL_MAX_SIZE or the
+ *                      heap has no room for a new slab.
+ */
+extern void *mspool_alloc(mspool_handle_t *pool, uint32_t size);
+
+/**
+ * Return nonzero if ptr is a pool block rather than a heap allocation.
+ */
+extern int mspool_owns(void *ptr);
+
+/**
+ * Return a block to its free list, ptr must be a pool block.
+ */
+extern void mspool_free(mspool_handle_t *pool, void *ptr);
+
+/**
+ * Return the usable size of a pool block.
+ */
+extern uint32_t mspool_size(mspool_handle_t *pool, void *ptr);
+
+/**
+ * Add the statistics of the pools to stats.
+ */
+extern void mspool_get_stats(mspool_handle_t *pool, struct mspool_stats *stats);
+
+#endif /* MSPOOL_H */
+
+/**
+ * @}
+ * @}
+ */
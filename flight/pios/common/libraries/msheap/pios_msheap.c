@@ -32,6 +32,7 @@
  */
 
 #include "msheap.h"
+#include "mspool.h"
 #include "pios_config.h"
 #include "pios.h"
 
@@ -62,10 +63,13 @@ extern char _efastheap;
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
 heap_handle_t sram_heap;
+mspool_handle_t sram_pool;
 #ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
 heap_handle_t fast_heap;
+mspool_handle_t fast_pool;
 #else
 #define fast_heap sram_heap
+#define fast_pool sram_pool
 #endif
 
 /*
@@ -73,19 +77,86 @@ heap_handle_t fast_heap;
  */
 extern void vApplicationMallocFailedHook(void) __attribute__((weak));
 
+/*
+ * Small allocations come from the size class pools, everything else
+ * (and whatever the pools cannot serve) from the heap.
+ */
+static void *
+pool_or_heap_alloc(mspool_handle_t *pool, heap_handle_t *heap, size_t s)
+{
+	void *p = mspool_alloc(pool, s);
+
+	if (!p) {
+		p = msheap_alloc(heap, NULL, s);
+	}
+	return p;
+}
+
+static void *
+general_alloc(size_t s, bool use_fast_heap)
+{
+	void *p = NULL;
+
+	if(use_fast_heap){
+		p = pool_or_heap_alloc(&fast_pool, &fast_heap, s);
+	}
+	if(!p) {
+		p = pool_or_heap_alloc(&sram_pool, &sram_heap, s);
+	}
+	return p;
+}
+
+static void
+general_free(void *p)
+{
+	if (!p) {
+		return;
+	}
+	if(IS_FAST_HEAP_POINTER(p)){
+		if (mspool_owns(p)) {
+			mspool_free(&fast_pool, p);
+		} else {
+			msheap_free(&fast_heap, p);
+		}
+	} else {
+		if (mspool_owns(p)) {
+			mspool_free(&sram_pool, p);
+		} else {
+			msheap_free(&sram_heap, p);
+		}
+	}
+}
+
 void *
 pios_general_malloc(void *ptr, size_t s, bool use_fast_heap)
 {
 	void *p;
 
 	vPortEnterCritical();
-	if(use_fast_heap){
-		p = msheap_alloc(&fast_heap, ptr, s);
-        if(!p) {
-            p = msheap_alloc(&sram_heap, ptr, s);
-        }
+	if (ptr && mspool_owns(ptr)) {
+		/* realloc of a pool block, blocks cannot grow in place */
+		mspool_handle_t *pool = IS_FAST_HEAP_POINTER(ptr) ? &fast_pool : &sram_pool;
+		uint32_t old_size = mspool_size(pool, ptr);
+		if (s <= old_size) {
+			p = ptr;
+		} else {
+			p = general_alloc(s, use_fast_heap);
+			if (p) {
+				memcpy(p, ptr, old_size);
+				mspool_free(pool, ptr);
+			}
+		}
+	} else if (ptr) {
+		if(use_fast_heap){
+			p = msheap_alloc(&fast_heap, ptr, s);
+			if(!p) {
+				p = msheap_alloc(&sram_heap, ptr, s);
+			}
+		} else {
+			p = msheap_alloc(&sram_heap, ptr, s);
+		}
 	} else {
-		p = msheap_alloc(&sram_heap, ptr, s);
+		p = general_alloc(s, use_fast_heap);
 	}
 	vPortExitCritical();
 
@@ -111,11 +182,7 @@ void
 vPortFree(void *p)
 {
 	vPortEnterCritical();
-	if(IS_FAST_HEAP_POINTER(p)){
-		msheap_free(&fast_heap, p);
-	} else {
-		msheap_free(&sram_heap, p);
-	}
+	general_free(p);
 	vPortExitCritical();
 }
 
@@ -134,11 +201,35 @@ void
 vPortInitialiseBlocks(void)
 {
 	msheap_init(&sram_heap, &_sheap, &_eheap);
+	mspool_init(&sram_pool, &sram_heap);
 #ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
 	msheap_init(&fast_heap, &_sfastheap, &_efastheap);
+	mspool_init(&fast_pool, &fast_heap);
 #endif
 }
 
+void
+pios_mem_get_stats(struct pios_mem_stats *stats)
+{
+	struct mspool_stats pool_stats = { 0 };
+
+	vPortEnterCritical();
+	mspool_get_stats(&sram_pool, &pool_stats);
+	stats->heapLargestFree = msheap_largest_free(&sram_heap);
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
+	mspool_get_stats(&fast_pool, &pool_stats);
+	uint32_t fast_largest = msheap_largest_free(&fast_heap);
+	if (fast_largest > stats->heapLargestFree) {
+		stats->heapLargestFree = fast_largest;
+	}
+#endif
+	vPortExitCritical();
+
+	stats->poolReserved  = pool_stats.reserved;
+	stats->poolUsed      = pool_stats.used;
+	stats->poolHighWater = pool_stats.high_water;
+}
+
 void
 xPortIncreaseHeapSize(size_t bytes)
 {
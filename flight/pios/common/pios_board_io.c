@@ -674,6 +674,7 @@ void PIOS_BOARD_IO_Configure_RFM22B()
             PIOS_RFM22B_SetCoordinatorID(pios_rfm22b_id, oplinkSettings.CoordID);
             PIOS_RFM22B_SetXtalCap(pios_rfm22b_id, oplinkSettings.RFXtalCap);
             PIOS_RFM22B_SetChannelConfig(pios_rfm22b_id, datarate, oplinkSettings.MinChannel, oplinkSettings.MaxChannel, is_coordinator, data_mode, ppm_mode);
+            PIOS_RFM22B_SetAggregation(pios_rfm22b_id, oplinkSettings.PacketAggregation == OPLINKSETTINGS_PACKETAGGREGATION_TRUE);
 
             /* Set the modem Tx power level */
             switch (oplinkSettings.MaxRFPower) {
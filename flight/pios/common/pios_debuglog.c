@@ -64,6 +64,31 @@ static uint8_t next_read_buffer_index;
 
 static uint32_t used_buffer_space = 0;
 
+// High rate mode packs several UAVObject updates in a DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS page.
+// Page header: FlightTime is the time of the first record, InstanceID the number of records and
+// Size the number of used bytes in Data. Each record is encoded as
+//   varint:dt ref [u32:objid varint:instid varint:size] payload
+// where dt is the time in us since the previous record of the page and ref indexes the page dictionary
+// of (objid, instid) pairs. A ref equal to the dictionary size adds a new pair, in which case the
+// bracketed fields and the raw payload follow. Otherwise the payload is delta encoded against the
+// previous record of the same pair as runs of varint:unchanged varint:changed bytes[changed],
+// the last run stops as soon as size bytes are covered.
+#define PAGE_DICT_SIZE 32
+struct page_dict_entry {
+    uint32_t objid;
+    uint16_t instid;
+    uint16_t size;
+    uint8_t  *last;
+};
+static bool highrate_enabled = false;
+static struct page_dict_entry page_dict[PAGE_DICT_SIZE];
+static uint8_t page_dict_count;
+// copy of the last payload of each dictionary entry, new entries are stored raw in the page so this never overflows
+static uint8_t page_shadow[LOG_ENTRY_MAX_DATA_SIZE];
+static uint16_t page_shadow_used;
+static uint32_t page_last_time;
+static uint8_t record_scratch[LOG_ENTRY_MAX_DATA_SIZE];
+
 #define CBTASK_PRIORITY   CALLBACK_TASK_AUXILIARY
 #define CALLBACK_PRIORITY CALLBACK_PRIORITY_LOW
 #define CB_TIMEOUT        100
@@ -72,6 +97,7 @@ static DelayedCallbackInfo *callbackHandle;
 
 /* Private Function Prototypes */
 static void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
+static void enqueue_compressed(uint32_t objid, uint16_t instid, size_t size, uint8_t *data);
 static bool write_current_buffer();
 static void writeTask();
 static uint8_t get_blocks_free();
@@ -99,6 +125,7 @@ void PIOS_DEBUGLOG_Initialize()
     fails_count = 0;
     used_buffer_space = 0;
     log_is_full = false;
+    next_read_buffer_index = current_write_buffer_index;
     while (PIOS_FLASHFS_ObjLoad(pios_user_fs_id, LOG_GET_FLIGHT_OBJID(flightnum), lognum, (uint8_t *)current_buffer, sizeof(DebugLogEntryData)) == 0) {
         flightnum++;
     }
@@ -122,6 +149,26 @@ void PIOS_DEBUGLOG_Enable(uint8_t enabled)
     logging_enabled = enabled;
 }
 
+/**
+ * @brief Enables or Disables the high rate logging mode.
+ * In high rate mode UAVObject updates are delta encoded and packed in pages,
+ * see DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS
+ * @param[in] enable or disable high rate mode
+ */
+void PIOS_DEBUGLOG_EnableHighRate(uint8_t enabled)
+{
+    if (!current_buffer || enabled == highrate_enabled) {
+        return;
+    }
+    mutexlock();
+    // do not mix encodings in the same page
+    if (used_buffer_space) {
+        write_current_buffer();
+    }
+    highrate_enabled = enabled;
+    mutexunlock();
+}
+
 /**
  * @brief Write a debug log entry with a uavobject
  * @param[in] objectid
@@ -137,7 +184,11 @@ void PIOS_DEBUGLOG_UAVObject(uint32_t objid, uint16_t instid, size_t size, uint8
     }
     mutexlock();
 
-    enqueue_data(objid, instid, size, data);
+    if (highrate_enabled) {
+        enqueue_compressed(objid, instid, size, data);
+    } else {
+        enqueue_data(objid, instid, size, data);
+    }
 
     mutexunlock();
 }
@@ -241,6 +292,13 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
 {
     DebugLogEntryData *entry;
 
+    // a compressed page can't hold plain entries, close it
+    if (used_buffer_space && current_buffer->Type == DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS) {
+        if (!write_current_buffer()) {
+            return;
+        }
+    }
+
     // start a new block
     if (!used_buffer_space) {
         entry = current_buffer;
@@ -257,6 +315,7 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
             memset(current_buffer->Data, 0xff, sizeof(current_buffer->Data));
             used_buffer_space += size;
         } else {
+            current_buffer->Type = DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS;
             entry = (DebugLogEntryData *)&current_buffer->Data[used_buffer_space];
             used_buffer_space += size + LOG_ENTRY_HEADER_SIZE;
         }
@@ -276,6 +335,143 @@ void enqueue_data(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
     memcpy(entry->Data, data, size);
 }
 
+static uint32_t put_varint(uint8_t *out, uint32_t pos, uint32_t limit, uint32_t value)
+{
+    do {
+        if (pos >= limit) {
+            return limit + 1;
+        }
+        out[pos++] = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+        value    >>= 7;
+    } while (value);
+    return pos;
+}
+
+static void start_page(uint32_t now)
+{
+    memset(current_buffer->Data, 0xff, sizeof(current_buffer->Data));
+    current_buffer->Flight     = flightnum;
+    current_buffer->FlightTime = now;
+    current_buffer->Entry      = lognum;
+    current_buffer->Type       = DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS;
+    current_buffer->ObjectID   = 0;
+    current_buffer->InstanceID = 0;
+    current_buffer->Size = 0;
+    page_dict_count  = 0;
+    page_shadow_used = 0;
+    page_last_time   = now;
+}
+
+/**
+ * Encode one record in record_scratch for the current page.
+ * @return encoded length, 0 if it does not fit in the space left
+ */
+static uint32_t encode_record(uint32_t now, uint8_t ref, uint32_t objid, uint16_t instid, size_t size, const uint8_t *data)
+{
+    const uint32_t limit = LOG_ENTRY_MAX_DATA_SIZE - used_buffer_space;
+    uint32_t pos = put_varint(record_scratch, 0, limit, now - page_last_time);
+
+    if (pos >= limit) {
+        return 0;
+    }
+    record_scratch[pos++] = ref;
+
+    if (ref == page_dict_count) {
+        if (pos + sizeof(objid) > limit) {
+            return 0;
+        }
+        memcpy(&record_scratch[pos], &objid, sizeof(objid));
+        pos += sizeof(objid);
+        pos  = put_varint(record_scratch, pos, limit, instid);
+        pos  = put_varint(record_scratch, pos, limit, size);
+        if (pos + size > limit) {
+            return 0;
+        }
+        memcpy(&record_scratch[pos], data, size);
+        return pos + size;
+    }
+
+    const uint8_t *last = page_dict[ref].last;
+    uint32_t i = 0;
+    while (i < size) {
+        uint32_t start = i;
+        while (i < size && data[i] == last[i]) {
+            i++;
+        }
+        pos = put_varint(record_scratch, pos, limit, i - start);
+        if (i == size) {
+            break;
+        }
+        start = i;
+        // a single unchanged byte between changes is cheaper to copy than to start a new run
+        while (i < size && (data[i] != last[i] || (i + 1 < size && data[i + 1] != last[i + 1]))) {
+            i++;
+        }
+        pos = put_varint(record_scratch, pos, limit, i - start);
+        if (pos + (i - start) > limit) {
+            return 0;
+        }
+        memcpy(&record_scratch[pos], &data[start], i - start);
+        pos += i - start;
+    }
+    return pos > limit ? 0 : pos;
+}
+
+void enqueue_compressed(uint32_t objid, uint16_t instid, size_t size, uint8_t *data)
+{
+    uint32_t now = PIOS_DELAY_GetuS();
+
+    if (used_buffer_space && current_buffer->Type != DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS) {
+        if (!write_current_buffer()) {
+            return;
+        }
+    }
+    if (!used_buffer_space) {
+        start_page(now);
+    }
+
+    uint8_t ref;
+    for (ref = 0; ref < page_dict_count; ref++) {
+        if (page_dict[ref].objid == objid && page_dict[ref].instid == instid && page_dict[ref].size == size) {
+            break;
+        }
+    }
+
+    uint32_t len = ref < PAGE_DICT_SIZE ? encode_record(now, ref, objid, instid, size, data) : 0;
+    if (!len) {
+        // page is full, queue it and start a new one
+        if (used_buffer_space) {
+            if (!write_current_buffer()) {
+                return;
+            }
+            start_page(now);
+            ref = 0;
+            len = encode_record(now, ref, objid, instid, size, data);
+        }
+        if (!len) {
+            // too large to be packed
+            enqueue_data(objid, instid, size, data);
+            return;
+        }
+    }
+
+    memcpy(&current_buffer->Data[used_buffer_space], record_scratch, len);
+    used_buffer_space += len;
+    current_buffer->Size = used_buffer_space;
+    current_buffer->InstanceID++;
+    page_last_time = now;
+
+    if (ref == page_dict_count) {
+        page_dict[ref].objid  = objid;
+        page_dict[ref].instid = instid;
+        page_dict[ref].size   = size;
+        page_dict[ref].last   = &page_shadow[page_shadow_used];
+        page_shadow_used += size;
+        page_dict_count++;
+    }
+    memcpy(page_dict[ref].last, data, size);
+}
+
 bool write_current_buffer()
 {
     PIOS_CALLBACKSCHEDULER_Dispatch(callbackHandle);
@@ -304,6 +500,8 @@ static uint8_t get_blocks_free()
 static void writeTask()
 {
     if (current_write_buffer_index != next_read_buffer_index) {
+        // entries are numbered when saved, text entries may have been written in the meantime
+        buffers[next_read_buffer_index]->Entry = lognum;
         // not enough space, write the block and start a new one
         if (PIOS_FLASHFS_ObjSave(pios_user_fs_id,
                                  LOG_GET_FLIGHT_OBJID(flightnum), lognum,
@@ -627,6 +627,7 @@ const struct pios_flash_driver pios_jedec_flash_driver = {
     .end_transaction   = PIOS_Flash_Jedec_EndTransaction,
     .erase_chip   = PIOS_Flash_Jedec_EraseChip,
     .erase_sector = PIOS_Flash_Jedec_EraseSector,
+    .async_erase  = true,
     .write_chunks = PIOS_Flash_Jedec_WriteChunks,
     .write_data   = PIOS_Flash_Jedec_WriteData,
     .read_data    = PIOS_Flash_Jedec_ReadData,
@@ -30,10 +30,14 @@
 #ifdef PIOS_INCLUDE_FLASH
 
 #include <stdbool.h>
+#include <string.h>
 #include <openpilot.h>
 #include <pios_math.h>
 #include <pios_wdg.h>
 #include "pios_flashfs_logfs_priv.h"
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+#include "callbackinfo.h"
+#endif
 
 /*
  * Filesystem state data tracked in RAM
@@ -43,6 +47,12 @@ enum pios_flashfs_logfs_dev_magic {
     PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+enum logfs_compact_state {
+    LOGFS_COMPACT_IDLE,
+    LOGFS_COMPACT_ERASING, /* erasing the destination arena one sector at a time */
+    LOGFS_COMPACT_COPYING, /* copying the active slots into the destination arena */
+};
+
 struct logfs_state {
     enum pios_flashfs_logfs_dev_magic magic;
     const struct flashfs_logfs_cfg    *cfg;
@@ -56,6 +66,17 @@ struct logfs_state {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 
+    /* Incremental garbage collection, see logfs_compact_step() */
+    enum logfs_compact_state compact_state;
+    uint8_t  compact_dst_arena_id;
+    uint16_t compact_sector_id; /* next sector of the destination arena to erase */
+    uint16_t compact_src_slot_id; /* next slot of the active arena to copy */
+    uint16_t compact_dst_slot_id; /* next unwritten slot of the destination arena */
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+    bool compact_background; /* compacted by the background callback */
+    struct logfs_state *compact_next;
+#endif
+
     /* Underlying flash driver glue */
     const struct pios_flash_driver *driver;
     uintptr_t flash_id;
@@ -110,6 +131,32 @@ struct arena_header {
 * Arena life-cycle transition functions
 ****************************************/
 
+/**
+ * @brief Sets an arena whose sectors have all been erased to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_mark_arena_erased(const struct logfs_state *logfs, uint8_t arena_id)
+{
+    uintptr_t arena_addr = logfs_get_addr(logfs, arena_id, 0);
+
+    /* Mark this arena as fully erased */
+    struct arena_header arena_hdr = {
+        .magic = logfs->cfg->fs_magic,
+        .state = ARENA_STATE_ERASED,
+    };
+
+    if (logfs->driver->write_data(logfs->flash_id,
+                                  arena_addr,
+                                  (uint8_t *)&arena_hdr,
+                                  sizeof(arena_hdr)) != 0) {
+        return -1;
+    }
+
+    /* Arena is ready to be activated */
+    return 0;
+}
+
 /**
  * @brief Erases all sectors within the given arena and sets arena to erased state.
  * @return 0 if success, < 0 on failure
@@ -132,16 +179,7 @@ static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_
         }
     }
 
-    /* Mark this arena as fully erased */
-    struct arena_header arena_hdr = {
-        .magic = logfs->cfg->fs_magic,
-        .state = ARENA_STATE_ERASED,
-    };
-
-    if (logfs->driver->write_data(logfs->flash_id,
-                                  arena_addr,
-                                  (uint8_t *)&arena_hdr,
-                                  sizeof(arena_hdr)) != 0) {
+    if (logfs_mark_arena_erased(logfs, arena_id) != 0) {
         return -2;
     }
 
@@ -396,6 +434,35 @@ static int32_t logfs_raw_copy_bytes(const struct logfs_state *logfs, uintptr_t s
     return 0;
 }
 
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_raw_compare_bytes(const struct logfs_state *logfs, uintptr_t src_addr, const uint8_t *data, uint16_t size)
+{
+    uint8_t data_block[RAW_COPY_BLOCK_SIZE];
+
+    while (size) {
+        uint16_t blk_size = MIN(size, RAW_COPY_BLOCK_SIZE);
+
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     src_addr,
+                                     data_block,
+                                     blk_size) != 0) {
+            /* Failed to read next chunk from source */
+            return -1;
+        }
+
+        if (memcmp(data_block, data, blk_size) != 0) {
+            /* Contents differ */
+            return 1;
+        }
+
+        size     -= blk_size;
+        src_addr += blk_size;
+        data     += blk_size;
+    }
+
+    return 0;
+}
+
 /*
  * Is the entire filesystem full?
  * true = all slots in the arena are in the ACTIVE state (ie. garbage collection won't free anything)
@@ -492,6 +559,16 @@ static bool PIOS_FLASHFS_Logfs_validate(const struct logfs_state *logfs)
     return logfs && (logfs->magic == PIOS_FLASHFS_LOGFS_DEV_MAGIC);
 }
 
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+/* Background compaction, see PIOS_FLASHFS_Logfs_EnableCompaction() */
+#define COMPACT_SLOTS_PER_STEP   4
+#define COMPACT_STEP_PERIOD_MS   10
+#define COMPACT_STACK_SIZE_BYTES 512
+
+static DelayedCallbackInfo *compact_callback;
+static struct logfs_state *compact_list;
+#endif
+
 #if defined(PIOS_INCLUDE_FREERTOS)
 static struct logfs_state *PIOS_FLASHFS_Logfs_alloc(void)
 {
@@ -573,6 +650,10 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
             logfs->driver   = driver; /* lower-level flash driver */
             logfs->flash_id = flash_id; /* lower-level flash device id */
             logfs->mounted  = false;
+            logfs->compact_state = LOGFS_COMPACT_IDLE;
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+            logfs->compact_background = false;
+#endif
 
             if (logfs->driver->start_transaction(logfs->flash_id) == 0) {
                 bool found = false;
@@ -632,6 +713,16 @@ int32_t PIOS_FLASHFS_Logfs_Destroy(uintptr_t fs_id)
         goto out_exit;
     }
 
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+    /* Stop compacting it in the background */
+    for (struct logfs_state * *prev = &compact_list; *prev; prev = &(*prev)->compact_next) {
+        if (*prev == logfs) {
+            *prev = logfs->compact_next;
+            break;
+        }
+    }
+#endif
+
     PIOS_FLASHFS_Logfs_free(logfs);
     rc = 0;
 
@@ -639,58 +730,151 @@ out_exit:
     return rc;
 }
 
+/*
+ * Garbage collection copies the active slots of the active arena into the
+ * next arena and then switches over to it.  It is split into small steps
+ * so that it can run in the background, between the other filesystem
+ * operations, instead of all at once in the PIOS_FLASHFS_ObjSave() that
+ * finds the log full:
+ *  - ERASING: one sector of the destination arena is erased per step
+ *  - COPYING: up to max_slots slots of the active arena are looked at per step
+ * Objects may be saved and deleted while a compaction is in progress.  New
+ * versions are appended to the active arena ahead of the copy cursor and are
+ * picked up when it gets there, versions that were already copied are
+ * obsoleted in both arenas (see logfs_compact_forget()).
+ */
+
 /* NOTE: Must be called while holding the flash transaction lock */
-static int32_t logfs_garbage_collect(struct logfs_state *logfs)
+static void logfs_compact_begin(struct logfs_state *logfs)
+{
+    logfs->compact_state = LOGFS_COMPACT_ERASING;
+    logfs->compact_dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+    logfs->compact_sector_id   = 0;
+    logfs->compact_src_slot_id = 1;
+    logfs->compact_dst_slot_id = 1;
+}
+
+/*
+ * Is it worth starting a compaction ahead of time?
+ * true = fewer than 1/8 of the slots are free and at least half of them are obsolete
+ * false = compaction would gain too little for the arena erase it costs
+ *
+ * The free slots left in the active arena are thrown away by the compaction,
+ * starting late keeps that waste, and so the flash wear, to 1/8 of an arena.
+ */
+static bool logfs_compact_wanted(const struct logfs_state *logfs)
+{
+    uint16_t num_slots    = (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1;
+    uint16_t num_obsolete = num_slots - logfs->num_active_slots - logfs->num_free_slots;
+
+    return logfs->mounted &&
+           logfs->num_free_slots < num_slots / 8 &&
+           num_obsolete >= num_slots / 2;
+}
+
+/**
+ * @brief Runs one bounded step of the garbage collection started by logfs_compact_begin()
+ * @return 1 if there is more work to do, 0 once the destination arena is mounted, < 0 on failure
+ * @note A failed compaction is abandoned, the next one starts over
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_compact_step(struct logfs_state *logfs, uint16_t max_slots)
 {
     PIOS_Assert(logfs->mounted);
 
     /* Source arena is the active arena */
     uint8_t src_arena_id = logfs->active_arena_id;
+    uint8_t dst_arena_id = logfs->compact_dst_arena_id;
+    uint16_t num_slots   = logfs->cfg->arena_size / logfs->cfg->slot_size;
+    int32_t rc;
 
-    /* Compute destination arena */
-    uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->cfg->total_fs_size / logfs->cfg->arena_size);
+    switch (logfs->compact_state) {
+    case LOGFS_COMPACT_ERASING:
+        if (logfs->compact_sector_id < (logfs->cfg->arena_size / logfs->cfg->sector_size)) {
+            /* Erase the next sector of the destination arena */
+#ifdef PIOS_INCLUDE_WDG
+            PIOS_WDG_Clear();
+#endif
+            if (logfs->driver->erase_sector(logfs->flash_id,
+                                            logfs_get_addr(logfs, dst_arena_id, 0) +
+                                            (logfs->compact_sector_id * logfs->cfg->sector_size))) {
+                rc = -1;
+                goto out_abort;
+            }
+            logfs->compact_sector_id++;
+            return 1;
+        }
 
-    /* Erase destination arena */
-    if (logfs_erase_arena(logfs, dst_arena_id) != 0) {
-        return -1;
-    }
+        /* Reserve the destination arena so we can start filling it */
+        if (logfs_mark_arena_erased(logfs, dst_arena_id) != 0 ||
+            logfs_reserve_arena(logfs, dst_arena_id) != 0) {
+            /* Unable to reserve the arena */
+            rc = -2;
+            goto out_abort;
+        }
+        logfs->compact_state = LOGFS_COMPACT_COPYING;
+        return 1;
+
+    case LOGFS_COMPACT_COPYING:
+        /* Copy active slots from active arena to destination arena */
+        for (uint16_t n = 0; n < max_slots; n++) {
+            if (logfs->compact_src_slot_id >= num_slots) {
+                /* Copied the whole arena */
+                goto out_switch;
+            }
 
-    /* Reserve the destination arena so we can start filling it */
-    if (logfs_reserve_arena(logfs, dst_arena_id) != 0) {
-        /* Unable to reserve the arena */
-        return -2;
-    }
+            struct slot_header slot_hdr;
+            uintptr_t src_addr = logfs_get_addr(logfs, src_arena_id, logfs->compact_src_slot_id);
+            if (logfs->driver->read_data(logfs->flash_id,
+                                         src_addr,
+                                         (uint8_t *)&slot_hdr,
+                                         sizeof(slot_hdr)) != 0) {
+                rc = -3;
+                goto out_abort;
+            }
 
-    /* Copy active slots from active arena to destination arena */
-    uint16_t dst_slot_id = 1;
-    for (uint16_t src_slot_id = 1;
-         src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-         src_slot_id++) {
-        struct slot_header slot_hdr;
-        uintptr_t src_addr = logfs_get_addr(logfs, src_arena_id, src_slot_id);
-        if (logfs->driver->read_data(logfs->flash_id,
-                                     src_addr,
-                                     (uint8_t *)&slot_hdr,
-                                     sizeof(slot_hdr)) != 0) {
-            return -3;
-        }
+            if (slot_hdr.state == SLOT_STATE_EMPTY) {
+                /* We hit the end of the log */
+                goto out_switch;
+            }
 
-        if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-            uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, dst_slot_id);
-            if (logfs_raw_copy_bytes(logfs,
-                                     src_addr,
-                                     sizeof(slot_hdr) + slot_hdr.obj_size,
-                                     dst_addr) != 0) {
-                /* Failed to copy all bytes */
-                return -4;
+            if (slot_hdr.state == SLOT_STATE_ACTIVE) {
+                if (logfs->compact_dst_slot_id >= num_slots) {
+                    /*
+                     * The destination arena filled up with copies that were
+                     * obsoleted again after they had been made, start over.
+                     */
+                    logfs_compact_begin(logfs);
+                    return 1;
+                }
+
+                uintptr_t dst_addr = logfs_get_addr(logfs, dst_arena_id, logfs->compact_dst_slot_id);
+                if (logfs_raw_copy_bytes(logfs,
+                                         src_addr,
+                                         sizeof(slot_hdr) + slot_hdr.obj_size,
+                                         dst_addr) != 0) {
+                    /* Failed to copy all bytes */
+                    rc = -4;
+                    goto out_abort;
+                }
+                logfs->compact_dst_slot_id++;
             }
-            dst_slot_id++;
-        }
+            logfs->compact_src_slot_id++;
 #ifdef PIOS_INCLUDE_WDG
-        PIOS_WDG_Clear();
+            PIOS_WDG_Clear();
 #endif
+        }
+        return 1;
+
+    case LOGFS_COMPACT_IDLE:
+    default:
+        PIOS_DEBUG_Assert(0);
+        return 0;
     }
 
+out_switch:
+    logfs->compact_state = LOGFS_COMPACT_IDLE;
+
     /* Activate the destination arena */
     if (logfs_activate_arena(logfs, dst_arena_id) != 0) {
         return -5;
@@ -712,6 +896,202 @@ static int32_t logfs_garbage_collect(struct logfs_state *logfs)
     }
 
     return 0;
+
+out_abort:
+    logfs->compact_state = LOGFS_COMPACT_IDLE;
+    return rc;
+}
+
+/*
+ * The slot slot_id of the active arena is being obsoleted.  If a compaction
+ * has already copied it, the copy must not survive the switch of arenas.
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_compact_forget(const struct logfs_state *logfs, uint16_t slot_id, const struct slot_header *slot_hdr)
+{
+    if (logfs->compact_state != LOGFS_COMPACT_COPYING || slot_id >= logfs->compact_src_slot_id) {
+        /* Not copied (yet) */
+        return 0;
+    }
+
+    for (uint16_t dst_slot_id = 1; dst_slot_id < logfs->compact_dst_slot_id; dst_slot_id++) {
+        struct slot_header dst_hdr;
+        uintptr_t dst_addr = logfs_get_addr(logfs, logfs->compact_dst_arena_id, dst_slot_id);
+
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     dst_addr,
+                                     (uint8_t *)&dst_hdr,
+                                     sizeof(dst_hdr)) != 0) {
+            return -1;
+        }
+        if (dst_hdr.state == SLOT_STATE_ACTIVE &&
+            dst_hdr.obj_id == slot_hdr->obj_id &&
+            dst_hdr.obj_inst_id == slot_hdr->obj_inst_id) {
+            dst_hdr.state = SLOT_STATE_OBSOLETE;
+            if (logfs->driver->write_data(logfs->flash_id,
+                                          dst_addr,
+                                          (uint8_t *)&dst_hdr,
+                                          sizeof(dst_hdr)) != 0) {
+                return -2;
+            }
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Completes the compaction in progress, or does a whole one if there is none.
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_garbage_collect(struct logfs_state *logfs)
+{
+    int32_t rc;
+
+    if (logfs->compact_state == LOGFS_COMPACT_IDLE) {
+        logfs_compact_begin(logfs);
+    }
+
+    do {
+        rc = logfs_compact_step(logfs, UINT16_MAX);
+    } while (rc > 0);
+
+    return rc;
+}
+
+/**
+ * @brief Does a bounded amount of garbage collection work
+ *
+ * Compaction starts once the log is running out of free slots and there are
+ * enough obsolete slots to make it worthwhile.  Each call holds the flash
+ * transaction lock for at most one sector erase or max_slots slot copies, so
+ * that a PIOS_FLASHFS_ObjSave() from another task is not held up for as long
+ * as a complete garbage collection takes.
+ *
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] max_slots Maximum number of slots to look at in this call
+ * @return 0 if there is nothing (left) to do, 1 if there is more work to do, or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if the compaction failed and was abandoned
+ */
+int32_t PIOS_FLASHFS_Logfs_Compact(uintptr_t fs_id, uint16_t max_slots)
+{
+    int32_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    if (logfs->compact_state == LOGFS_COMPACT_IDLE) {
+        if (!logfs_compact_wanted(logfs)) {
+            rc = 0;
+            goto out_end_trans;
+        }
+        logfs_compact_begin(logfs);
+    }
+
+    rc = logfs_compact_step(logfs, max_slots);
+    if (rc < 0) {
+        rc = -3;
+    }
+
+out_end_trans:
+    logfs->driver->end_transaction(logfs->flash_id);
+
+out_exit:
+    return rc;
+}
+
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+static void logfs_compact_task(void)
+{
+    bool more = false;
+
+    for (struct logfs_state *logfs = compact_list; logfs; logfs = logfs->compact_next) {
+        if (PIOS_FLASHFS_Logfs_Compact((uintptr_t)logfs, COMPACT_SLOTS_PER_STEP) > 0) {
+            more = true;
+        }
+    }
+
+    if (more) {
+        /* Leave the flash to the others for a moment before the next step */
+        PIOS_CALLBACKSCHEDULER_Schedule(compact_callback, COMPACT_STEP_PERIOD_MS, CALLBACK_UPDATEMODE_SOONER);
+    }
+}
+
+/**
+ * @brief Compact the filesystem from a low priority callback
+ *
+ * The log is then garbage collected in the background, a few slots at a time,
+ * as soon as it starts running out of free slots.  PIOS_FLASHFS_ObjSave() only
+ * has to garbage collect itself if objects are saved faster than that.
+ * Call after PIOS_CALLBACKSCHEDULER_Initialize().
+ *
+ * Arenas of a single sector are only compacted this way on a flash which erases
+ * on its own, such as an external JEDEC flash.  The erase cannot be split but
+ * it is then taken off the task that saves.  On the internal flash it would
+ * stall the CPU just as long, the log is better left to PIOS_FLASHFS_ObjSave().
+ *
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if the callback could not be created
+ * @retval -3 if the arenas of the filesystem are a single sector of a flash which stalls the CPU while erasing
+ */
+int32_t PIOS_FLASHFS_Logfs_EnableCompaction(uintptr_t fs_id)
+{
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        return -1;
+    }
+
+    if (logfs->cfg->arena_size / logfs->cfg->sector_size <= 1 && !logfs->driver->async_erase) {
+        return -3;
+    }
+
+    if (!compact_callback) {
+        compact_callback = PIOS_CALLBACKSCHEDULER_Create(&logfs_compact_task, CALLBACK_PRIORITY_LOW, CALLBACK_TASK_AUXILIARY, CALLBACKINFO_RUNNING_FLASHFS, COMPACT_STACK_SIZE_BYTES);
+        if (!compact_callback) {
+            return -2;
+        }
+    }
+
+    if (!logfs->compact_background) {
+        logfs->compact_next = compact_list;
+        compact_list = logfs;
+        logfs->compact_background = true;
+    }
+
+    /* The log may already be due */
+    PIOS_CALLBACKSCHEDULER_Dispatch(compact_callback);
+
+    return 0;
+}
+#endif /* defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION) */
+
+/* Wake up the background compaction if the log is getting full */
+static void logfs_compact_kick(const struct logfs_state *logfs)
+{
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_COMPACTION)
+    if (logfs->compact_background &&
+        logfs->compact_state == LOGFS_COMPACT_IDLE &&
+        logfs_compact_wanted(logfs)) {
+        PIOS_CALLBACKSCHEDULER_Dispatch(compact_callback);
+    }
+#else
+    (void)logfs;
+#endif
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
@@ -770,6 +1150,10 @@ static int8_t logfs_delete_object(struct logfs_state *logfs, uint32_t obj_id, ui
         switch (logfs_object_find_next(logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
         case 0:
             /* Found a matching slot.  Obsolete it. */
+            if (logfs_compact_forget(logfs, curr_slot_id, &slot_hdr) != 0) {
+                rc = -2;
+                goto out_exit;
+            }
             slot_hdr.state = SLOT_STATE_OBSOLETE;
             uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, curr_slot_id);
 
@@ -996,6 +1380,244 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 
 out_end_trans:
     logfs->driver->end_transaction(logfs->flash_id);
+    logfs_compact_kick(logfs);
+
+out_exit:
+    return rc;
+}
+
+/*
+ * Obsoletes the active slots below end_slot_id that hold a pending instance of the batch.
+ * NOTE: Must be called while holding the flash transaction lock
+ */
+static int8_t logfs_batch_obsolete(struct logfs_state *logfs, const struct PIOS_FLASHFS_ObjBatch *batch, uint16_t end_slot_id)
+{
+    for (uint16_t slot_id = 1; slot_id < end_slot_id; slot_id++) {
+        struct slot_header slot_hdr;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+        uint8_t *obj_data;
+        uint16_t obj_size;
+
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            return -1;
+        }
+        if (slot_hdr.state == SLOT_STATE_EMPTY) {
+            /* We hit the end of the log */
+            break;
+        }
+        if (slot_hdr.state != SLOT_STATE_ACTIVE ||
+            !batch->find(batch->ctx, slot_hdr.obj_id, slot_hdr.obj_inst_id, &obj_data, &obj_size)) {
+            continue;
+        }
+
+        if (logfs_compact_forget(logfs, slot_id, &slot_hdr) != 0) {
+            return -2;
+        }
+        slot_hdr.state = SLOT_STATE_OBSOLETE;
+        if (logfs->driver->write_data(logfs->flash_id,
+                                      slot_addr,
+                                      (uint8_t *)&slot_hdr,
+                                      sizeof(slot_hdr)) != 0) {
+            return -2;
+        }
+        logfs->num_active_slots--;
+#ifdef PIOS_INCLUDE_WDG
+        PIOS_WDG_Clear();
+#endif
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Saves a set of object instances in one pass over the log
+ *
+ * Unlike calling PIOS_FLASHFS_ObjSave() for each instance, garbage collection
+ * runs at most once and the new versions are appended back to back.
+ * Instances whose stored copy already matches are left alone and not written
+ * again.  The stored copies of the others are only obsoleted once the new
+ * versions are in the log, so they still load after any error.
+ * Each instance must only be pending once within the batch.
+ *
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] batch The pending object instances
+ * @return 0 if success or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if failure to read the log or to delete previous versions of the objects
+ * @retval -4 if filesystem is too full to hold the batch and garbage collection won't help
+ * @retval -5 if garbage collection failed
+ * @retval -6 if filesystem is full even after garbage collection should have freed space
+ * @retval -7 if writing a new object to the filesystem failed
+ */
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, const struct PIOS_FLASHFS_ObjBatch *batch)
+{
+    int8_t rc;
+
+    struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+    if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+        rc = -1;
+        goto out_exit;
+    }
+
+    PIOS_Assert(batch);
+
+    if (logfs->driver->start_transaction(logfs->flash_id) != 0) {
+        rc = -2;
+        goto out_exit;
+    }
+
+    uint16_t num_slots = logfs->cfg->arena_size / logfs->cfg->slot_size;
+
+    /*
+     * Read only pass over the log: pending instances whose stored copy is
+     * identical are done, the others are counted as replacing their copy.
+     */
+    uint16_t num_replaced = 0;
+    for (uint16_t slot_id = 1; slot_id < num_slots; slot_id++) {
+        struct slot_header slot_hdr;
+        uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+        uint8_t *obj_data;
+        uint16_t obj_size;
+
+        if (logfs->driver->read_data(logfs->flash_id,
+                                     slot_addr,
+                                     (uint8_t *)&slot_hdr,
+                                     sizeof(slot_hdr)) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        if (slot_hdr.state == SLOT_STATE_EMPTY) {
+            /* We hit the end of the log */
+            break;
+        }
+        if (slot_hdr.state != SLOT_STATE_ACTIVE ||
+            !batch->find(batch->ctx, slot_hdr.obj_id, slot_hdr.obj_inst_id, &obj_data, &obj_size)) {
+            continue;
+        }
+
+        if (slot_hdr.obj_size == obj_size) {
+            int32_t cmp = logfs_raw_compare_bytes(logfs, slot_addr + sizeof(slot_hdr), obj_data, obj_size);
+            if (cmp < 0) {
+                rc = -3;
+                goto out_end_trans;
+            }
+            if (cmp == 0) {
+                /* Stored copy is up to date */
+                batch->done(batch->ctx, slot_hdr.obj_id, slot_hdr.obj_inst_id);
+                continue;
+            }
+        }
+        num_replaced++;
+    }
+
+    /* Count what is left to write */
+    uint16_t num_pending = 0;
+    uint32_t cursor      = 0;
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t *obj_data;
+    uint16_t obj_size;
+
+    while (batch->next(batch->ctx, &cursor, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+        num_pending++;
+    }
+
+    if (num_pending == 0) {
+        /* Nothing changed */
+        rc = 0;
+        goto out_end_trans;
+    }
+
+    if (logfs->num_active_slots + num_pending - num_replaced > num_slots - 1) {
+        /* Not enough room for the batch even if all obsolete slots were reclaimed */
+        rc = -4;
+        goto out_end_trans;
+    }
+
+    /* One garbage collection makes room for the whole batch, the stored copies move along */
+    if (logfs->num_free_slots < num_pending) {
+        if (logfs_garbage_collect(logfs) != 0) {
+            rc = -5;
+            goto out_end_trans;
+        }
+    }
+
+    if (logfs->num_free_slots < num_pending) {
+        /*
+         * The log only holds the batch without the stored copies.  Obsolete
+         * them first and collect once more, like PIOS_FLASHFS_ObjSave() does.
+         */
+        if (logfs_batch_obsolete(logfs, batch, num_slots) != 0) {
+            rc = -3;
+            goto out_end_trans;
+        }
+        if (logfs_garbage_collect(logfs) != 0) {
+            rc = -5;
+            goto out_end_trans;
+        }
+        if (logfs->num_free_slots < num_pending) {
+            PIOS_DEBUG_Assert(0);
+            rc = -6;
+            goto out_end_trans;
+        }
+    }
+
+    /* Append the new versions after the stored copies */
+    uint16_t first_new_slot_id = num_slots - logfs->num_free_slots;
+    cursor = 0;
+    while (batch->next(batch->ctx, &cursor, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+            /* Drop the new versions written so far, the stored copies stay the active ones */
+            for (uint16_t slot_id = first_new_slot_id; slot_id < num_slots - logfs->num_free_slots; slot_id++) {
+                struct slot_header slot_hdr;
+                uintptr_t slot_addr = logfs_get_addr(logfs, logfs->active_arena_id, slot_id);
+
+                if (logfs->driver->read_data(logfs->flash_id,
+                                             slot_addr,
+                                             (uint8_t *)&slot_hdr,
+                                             sizeof(slot_hdr)) != 0 ||
+                    slot_hdr.state != SLOT_STATE_ACTIVE) {
+                    continue;
+                }
+                slot_hdr.state = SLOT_STATE_OBSOLETE;
+                if (logfs->driver->write_data(logfs->flash_id,
+                                              slot_addr,
+                                              (uint8_t *)&slot_hdr,
+                                              sizeof(slot_hdr)) == 0) {
+                    logfs->num_active_slots--;
+                }
+            }
+            rc = -7;
+            goto out_end_trans;
+        }
+#ifdef PIOS_INCLUDE_WDG
+        PIOS_WDG_Clear();
+#endif
+    }
+
+    /* Only now obsolete the stored copies the new versions replace */
+    if (logfs_batch_obsolete(logfs, batch, first_new_slot_id) != 0) {
+        rc = -3;
+        goto out_end_trans;
+    }
+
+    cursor = 0;
+    while (batch->next(batch->ctx, &cursor, &obj_id, &obj_inst_id, &obj_data, &obj_size)) {
+        batch->done(batch->ctx, obj_id, obj_inst_id);
+    }
+
+    /* Batch successfully written to the log */
+    rc = 0;
+
+out_end_trans:
+    logfs->driver->end_transaction(logfs->flash_id);
+    logfs_compact_kick(logfs);
 
 out_exit:
     return rc;
@@ -1143,6 +1765,9 @@ int32_t PIOS_FLASHFS_Format(uintptr_t fs_id)
         goto out_exit;
     }
 
+    /* Any compaction in progress is moot */
+    logfs->compact_state = LOGFS_COMPACT_IDLE;
+
     if (logfs_erase_all_arenas(logfs) != 0) {
         rc = -3;
         goto out_end_trans;
@@ -96,3 +96,11 @@ void pios_free(void *p)
 }
 
 #endif /* ifdef PIOS_TARGET_PROVIDES_FAST_HEAP */
+
+#ifndef PIOS_INCLUDE_MSHEAP
+// the allocator does not keep statistics
+void pios_mem_get_stats(struct pios_mem_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+#endif /* PIOS_INCLUDE_MSHEAP */
@@ -61,6 +61,7 @@
 #include <pios_spi_priv.h>
 #include <pios_rfm22b_regs.h>
 #include <pios_rfm22b_priv.h>
+#include <pios_rfm22b_frame.h>
 #include <pios_ppm_out.h>
 #include <ecc.h>
 #include <sha1.h>
@@ -637,6 +638,8 @@ void PIOS_RFM22B_SetChannelConfig(uint32_t rfm22b_id, enum rfm22b_datarate datar
     if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
         rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
     }
+    // Start aggregating at the full packet length.
+    rfm22b_dev->aggregate_len = 0;
 }
 
 /**
@@ -654,6 +657,23 @@ void PIOS_RFM22B_SetXtalCap(uint32_t rfm22b_id, uint8_t xtal_cap)
     }
 }
 
+/**
+ * Pack chunks of both COM streams into each packet, rather than sending one
+ * stream per packet. The receiver understands both formats, so this only
+ * changes what this modem sends.
+ *
+ * @param[in] rfm22b_id The RFM22B device index.
+ * @param[in] aggregate Enable aggregation.
+ */
+void PIOS_RFM22B_SetAggregation(uint32_t rfm22b_id, bool aggregate)
+{
+    struct pios_rfm22b_dev *rfm22b_dev = (struct pios_rfm22b_dev *)rfm22b_id;
+
+    if (PIOS_RFM22B_Validate(rfm22b_dev)) {
+        rfm22b_dev->aggregate = aggregate;
+    }
+}
+
 /**
  * Set a modem to be a coordinator or not.
  *
@@ -1862,27 +1882,20 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
     // Append data from the com interface if applicable.
     bool packet_data = false;
     if (!radio_dev->ppm_only_mode) {
-        uint8_t newlen  = 0;
-        bool need_yield = false;
-        uint8_t i = 0;
-        // Try to get some data to send
-        while (newlen == 0 && i < 2) {
-            radio_dev->last_stream_sent = (radio_dev->last_stream_sent + 1) % 2;
-            if (!radio_dev->last_stream_sent) {
-                if (radio_dev->tx_out_cb) {
-                    newlen = (radio_dev->tx_out_cb)(radio_dev->tx_out_context, p + len + 1, max_data_len - len - 1, NULL, &need_yield);
-                }
-            } else {
-                if (radio_dev->aux_tx_out_cb) {
-                    newlen = (radio_dev->aux_tx_out_cb)(radio_dev->aux_tx_out_context, p + len + 1, max_data_len - len - 1, NULL, &need_yield);
-                }
-            }
-            i++;
+        const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS] = {
+            { radio_dev->tx_out_cb,     radio_dev->tx_out_context     },
+            { radio_dev->aux_tx_out_cb, radio_dev->aux_tx_out_context },
+        };
+        uint8_t data_room = max_data_len - len;
+
+        // Fill no more than the link currently carries reliably.
+        if (radio_dev->aggregate && radio_dev->aggregate_len && data_room > radio_dev->aggregate_len) {
+            data_room = radio_dev->aggregate_len;
         }
+        uint8_t newlen = PIOS_RFM22B_FramePack(p + len, data_room, streams, &radio_dev->last_stream_sent, radio_dev->aggregate);
         if (newlen) {
             packet_data = true;
-            *(p + len)  = radio_dev->last_stream_sent;
-            len += newlen + 1;
+            len += newlen;
         }
     }
 
@@ -1897,7 +1910,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev *radio_dev)
     // Add the error correcting code.
     if (!radio_dev->ppm_only_mode) {
         if (len != 0) {
-            encode_data((unsigned char *)p, len, (unsigned char *)p);
+            rs_encode_packet((unsigned char *)p, len);
         }
         len += RS_ECC_NPARITY;
     }
@@ -1971,7 +1984,6 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
 {
     bool good_packet      = true;
     bool corrected_packet = false;
-    uint8_t stream_num    = 0;
     uint8_t data_len      = rx_len;
 
     // We don't rsencode ppm only packets.
@@ -1980,14 +1992,10 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
 
         // Attempt to correct any errors in the packet.
         if (data_len > 0) {
-            decode_data((unsigned char *)p, rx_len);
-            good_packet = check_syndrome() == 0;
-
-            // We have an error.  Try to correct it.
-            if (!good_packet && (correct_errors_erasures((unsigned char *)p, rx_len, 0, 0) != 0)) {
-                // We corrected it
-                corrected_packet = true;
-            }
+            int status = rs_decode_packet((unsigned char *)p, rx_len);
+            good_packet = (status == RS_DECODE_OK);
+            // We had an error, and corrected it.
+            corrected_packet = (status == RS_DECODE_CORRECTED);
         }
     }
 
@@ -2052,22 +2060,12 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev *radio_d
     enum pios_radio_event ret_event = RADIO_EVENT_RX_COMPLETE;
     if (good_packet || corrected_packet) {
         // Send the data to the com port
-        bool rx_need_yield;
-
-
         if ((data_len > 0) && !radio_dev->ppm_only_mode) {
-            stream_num = *p;
-            p++;
-            data_len--;
-            if (!stream_num) {
-                if (radio_dev->rx_in_cb) {
-                    (radio_dev->rx_in_cb)(radio_dev->rx_in_context, p, data_len, NULL, &rx_need_yield);
-                }
-            } else {
-                if (radio_dev->aux_rx_in_cb) {
-                    (radio_dev->aux_rx_in_cb)(radio_dev->aux_rx_in_context, p, data_len, NULL, &rx_need_yield);
-                }
-            }
+            const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS] = {
+                { radio_dev->rx_in_cb,     radio_dev->rx_in_context     },
+                { radio_dev->aux_rx_in_cb, radio_dev->aux_rx_in_context },
+            };
+            PIOS_RFM22B_FrameUnpack(p, data_len, streams);
         }
         /*
          * If the packet is valid and destined for us we synchronize the clock.
@@ -2180,6 +2178,14 @@ static void rfm22_updateStats(struct pios_rfm22b_dev *rfm22b_dev)
     // Using this equation, error and resent packets are counted as -2, and corrected packets are counted as -1.
     // The range is 0 (all error or resent packets) to 128 (all good packets).
     rfm22b_dev->stats.link_quality = 64 + rfm22b_dev->stats.rx_good - rfm22b_dev->stats.rx_error - rfm22b_dev->stats.rx_failure;
+
+    // The packets we receive on a hopping channel are a fair estimate of how ours arrive,
+    // so use them to size the aggregated packets.
+    if (rfm22b_dev->aggregate) {
+        rfm22b_dev->aggregate_len = PIOS_RFM22B_FrameAdaptLen(rfm22b_dev->aggregate_len,
+                                                              rfm22b_dev->max_packet_len - RS_ECC_NPARITY,
+                                                              rfm22b_dev->stats.rx_error + rfm22b_dev->stats.rx_failure);
+    }
 }
 
 /**
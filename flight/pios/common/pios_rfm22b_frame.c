@@ -0,0 +1,157 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief PIOS interface for for the RFM22B radio
+ * @{
+ *
+ * @file       pios_rfm22b_frame.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Packing of the COM streams into RFM22B packets
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * This file has no dependencies on the rest of PIOS, so the framing can be
+ * exercised by the host unit tests.
+ */
+#include <stddef.h>
+#include <pios_rfm22b_frame.h>
+
+// Lost packets out of the last 64 above which aggregated packets shrink, and below which they grow.
+// With the 4 byte RS code a full packet carries the most data per slot until more than
+// about 60% of them are lost, so only very bad links are worth sending less at a time.
+#define FRAME_SHRINK_LOST 40
+#define FRAME_GROW_LOST   28
+
+/**
+ * Pull at most max_len bytes from a stream.
+ */
+static uint8_t frame_pull(const struct rfm22b_frame_stream *stream, uint8_t *p, uint8_t max_len)
+{
+    bool need_yield = false;
+
+    if (!stream->cb) {
+        return 0;
+    }
+    return (stream->cb)(stream->context, p, max_len, NULL, &need_yield);
+}
+
+uint8_t PIOS_RFM22B_FramePack(uint8_t *p, uint8_t max_len, const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS],
+                              uint8_t *last_stream, bool aggregate)
+{
+    uint8_t len  = 0;
+    uint8_t idle = 0;
+
+    if (!aggregate) {
+        if (max_len < 2) {
+            return 0;
+        }
+        // Send a chunk of the first stream that has some data.
+        for (uint8_t i = 0; i < RFM22B_FRAME_NUM_STREAMS; ++i) {
+            *last_stream = (*last_stream + 1) % RFM22B_FRAME_NUM_STREAMS;
+            len = frame_pull(&streams[*last_stream], p + 1, max_len - 1);
+            if (len) {
+                p[0] = *last_stream;
+                return len + 1;
+            }
+        }
+        return 0;
+    }
+
+    // Let the streams take turns until the packet is full or they have nothing left.
+    while (idle < RFM22B_FRAME_NUM_STREAMS && (max_len - len) >= RFM22B_FRAME_CHUNK_HEADER + RFM22B_FRAME_MIN_CHUNK) {
+        *last_stream = (*last_stream + 1) % RFM22B_FRAME_NUM_STREAMS;
+        uint8_t newlen = frame_pull(&streams[*last_stream], p + len + RFM22B_FRAME_CHUNK_HEADER,
+                                    max_len - len - RFM22B_FRAME_CHUNK_HEADER);
+        if (newlen) {
+            p[len]     = RFM22B_FRAME_CHUNK | *last_stream;
+            p[len + 1] = newlen;
+            len += newlen + RFM22B_FRAME_CHUNK_HEADER;
+            idle = 0;
+        } else {
+            idle++;
+        }
+    }
+    return len;
+}
+
+bool PIOS_RFM22B_FrameUnpack(uint8_t *p, uint8_t len, const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS])
+{
+    bool need_yield = false;
+
+    if (len == 0) {
+        return true;
+    }
+
+    // A single chunk, any non zero stream number is the aux stream.
+    if (!(p[0] & RFM22B_FRAME_CHUNK)) {
+        const struct rfm22b_frame_stream *stream = &streams[p[0] ? 1 : 0];
+        if (stream->cb && len > 1) {
+            (stream->cb)(stream->context, p + 1, len - 1, NULL, &need_yield);
+        }
+        return true;
+    }
+
+    while (len) {
+        if (len < RFM22B_FRAME_CHUNK_HEADER || !(p[0] & RFM22B_FRAME_CHUNK)) {
+            return false;
+        }
+        uint8_t stream_num = p[0] & ~RFM22B_FRAME_CHUNK;
+        uint8_t chunk_len  = p[1];
+        if (stream_num >= RFM22B_FRAME_NUM_STREAMS || chunk_len > len - RFM22B_FRAME_CHUNK_HEADER) {
+            return false;
+        }
+        const struct rfm22b_frame_stream *stream = &streams[stream_num];
+        if (stream->cb && chunk_len) {
+            (stream->cb)(stream->context, p + RFM22B_FRAME_CHUNK_HEADER, chunk_len, NULL, &need_yield);
+        }
+        p   += chunk_len + RFM22B_FRAME_CHUNK_HEADER;
+        len -= chunk_len + RFM22B_FRAME_CHUNK_HEADER;
+    }
+    return true;
+}
+
+uint8_t PIOS_RFM22B_FrameAdaptLen(uint8_t cur_len, uint8_t max_len, uint8_t lost)
+{
+    uint8_t min_len = (max_len < RFM22B_FRAME_MIN_LEN) ? max_len : RFM22B_FRAME_MIN_LEN;
+
+    if (cur_len == 0 || cur_len > max_len) {
+        cur_len = max_len;
+    }
+    if (lost > FRAME_SHRINK_LOST) {
+        cur_len -= (cur_len / 8) ? (cur_len / 8) : 1;
+    } else if (lost < FRAME_GROW_LOST) {
+        cur_len += (max_len / 16) ? (max_len / 16) : 1;
+    }
+
+    if (cur_len > max_len) {
+        return max_len;
+    }
+    if (cur_len < min_len) {
+        return min_len;
+    }
+    return cur_len;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -38,5 +38,8 @@ extern void PIOS_BL_HELPER_FLASH_Read_Description(uint8_t *array, uint8_t size);
 extern uint8_t PIOS_BL_HELPER_FLASH_Start();
 extern uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader();
 extern void PIOS_BL_HELPER_CRC_Ini();
+extern uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t startAddress, uint32_t size);
+extern uint8_t PIOS_BL_HELPER_FLASH_Sector_Info(uint32_t address, uint32_t *sectorStart, uint32_t *sectorSize);
+extern uint8_t PIOS_BL_HELPER_FLASH_Erase_Sector(uint32_t address);
 
 #endif /* PIOS_BL_HELPER_H */
@@ -43,6 +43,14 @@ void PIOS_DEBUGLOG_Initialize();
  */
 void PIOS_DEBUGLOG_Enable(uint8_t enabled);
 
+/**
+ * @brief Enables or Disables the high rate logging mode.
+ * In high rate mode UAVObject updates are delta encoded and packed in pages,
+ * see DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS
+ * @param[in] enable or disable high rate mode
+ */
+void PIOS_DEBUGLOG_EnableHighRate(uint8_t enabled);
+
 /**
  * @brief Write a debug log entry with a uavobject
  * @param[in] objectid
@@ -28,17 +28,34 @@
 #define PIOS_FLASHFS_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 struct PIOS_FLASHFS_Stats {
     uint16_t num_free_slots; /* slots in free state */
     uint16_t num_active_slots; /* slots in active state */
 };
 
+/*
+ * A set of object instances saved together by PIOS_FLASHFS_ObjSaveBatch().
+ * The caller keeps track of which instances are still pending, so that no
+ * table of the batch is needed on either side.
+ */
+struct PIOS_FLASHFS_ObjBatch {
+    /* Is this instance pending?  If so return its contents. */
+    bool (*find)(void *ctx, uint32_t obj_id, uint16_t obj_inst_id, uint8_t **obj_data, uint16_t *obj_size);
+    /* Next pending instance after *cursor (0 to start), false when there are no more */
+    bool (*next)(void *ctx, uint32_t *cursor, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size);
+    /* The instance is stored in the filesystem and no longer pending */
+    void (*done)(void *ctx, uint32_t obj_id, uint16_t obj_inst_id);
+    void *ctx;
+};
+
 // define logfs subdirectory of a yaffs flash device
 #define PIOS_LOGFS_DIR "logfs"
 
 int32_t PIOS_FLASHFS_Format(uintptr_t fs_id);
 int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
+int32_t PIOS_FLASHFS_ObjSaveBatch(uintptr_t fs_id, const struct PIOS_FLASHFS_ObjBatch *batch);
 int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size);
 int32_t PIOS_FLASHFS_ObjDelete(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst_id);
 int32_t PIOS_FLASHFS_GetStats(uintptr_t fs_id, struct PIOS_FLASHFS_Stats *stats);
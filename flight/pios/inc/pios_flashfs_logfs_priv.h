@@ -45,4 +45,9 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 
 int32_t PIOS_FLASHFS_Logfs_Destroy(uintptr_t fs_id);
 
+int32_t PIOS_FLASHFS_Logfs_Compact(uintptr_t fs_id, uint16_t max_slots);
+
+/* Needs PIOS_INCLUDE_FLASH_LOGFS_COMPACTION */
+int32_t PIOS_FLASHFS_Logfs_EnableCompaction(uintptr_t fs_id);
+
 #endif /* PIOS_FLASHFS_LOGFS_PRIV_H */
@@ -36,4 +36,13 @@ void *pios_realloc(void *ptr, size_t size);
 
 void pios_free(void *p);
 
+struct pios_mem_stats {
+    uint32_t heapLargestFree; // largest block that can still be allocated
+    uint32_t poolReserved; // bytes of heap held by the small allocation pools
+    uint32_t poolUsed; // bytes allocated from the pools
+    uint32_t poolHighWater; // most bytes ever allocated from the pools
+};
+
+void pios_mem_get_stats(struct pios_mem_stats *stats);
+
 #endif /* PIOS_MEM_H */
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup   PIOS_RFM22B Radio Functions
+ * @brief PIOS interface for for the RFM22B radio
+ * @{
+ *
+ * @file       pios_rfm22b_frame.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @brief      Packing of the COM streams into RFM22B packets
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_RFM22B_FRAME_H
+#define PIOS_RFM22B_FRAME_H
+
+#include <pios_com.h>
+
+/*
+ * The data part of a packet (after the PPM block, if any) either holds a
+ * single chunk of one stream:
+ *
+ *   [stream number] [data ...]
+ *
+ * or, in aggregation mode, as many chunks of both streams as fit:
+ *
+ *   [RFM22B_FRAME_CHUNK | stream number] [length] [data ...] ...
+ *
+ * The receiver recognises both layouts, so aggregation only has to be
+ * enabled on the transmitting side of a link.
+ */
+#define RFM22B_FRAME_NUM_STREAMS   2
+#define RFM22B_FRAME_CHUNK         0x80
+#define RFM22B_FRAME_CHUNK_HEADER  2
+// Don't start a new chunk with less room than this.
+#define RFM22B_FRAME_MIN_CHUNK     4
+// Smallest data length the adaptive sizing goes down to.
+#define RFM22B_FRAME_MIN_LEN       16
+
+struct rfm22b_frame_stream {
+    pios_com_callback cb;
+    uint32_t context;
+};
+
+/**
+ * Fill a packet with data pulled from the COM streams.
+ *
+ * @param[out] p  The data part of the packet.
+ * @param[in] max_len  The room in the packet.
+ * @param[in] streams  The tx callbacks of the streams.
+ * @param[in,out] last_stream  The stream sent last, streams take turns.
+ * @param[in] aggregate  Pack chunks of both streams rather than a single chunk.
+ * @return uint8_t  The number of bytes used, 0 if there was nothing to send.
+ */
+extern uint8_t PIOS_RFM22B_FramePack(uint8_t *p, uint8_t max_len, const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS],
+                                     uint8_t *last_stream, bool aggregate);
+
+/**
+ * Hand the data part of a received packet to the COM streams.
+ *
+ * @param[in] p  The data part of the packet.
+ * @param[in] len  Its length.
+ * @param[in] streams  The rx callbacks of the streams.
+ * @return bool  False if the chunk layout is broken, the chunks before the
+ *               error have been delivered.
+ */
+extern bool PIOS_RFM22B_FrameUnpack(uint8_t *p, uint8_t len, const struct rfm22b_frame_stream streams[RFM22B_FRAME_NUM_STREAMS]);
+
+/**
+ * Adapt the data length of aggregated packets to the packet loss.
+ *
+ * @param[in] cur_len  The current length limit, 0 for none.
+ * @param[in] max_len  The room in a packet.
+ * @param[in] lost  The packets lost out of the last 64.
+ * @return uint8_t  The new length limit.
+ */
+extern uint8_t PIOS_RFM22B_FrameAdaptLen(uint8_t cur_len, uint8_t max_len, uint8_t lost);
+
+#endif /* PIOS_RFM22B_FRAME_H */
+
+/**
+ * @}
+ * @}
+ */
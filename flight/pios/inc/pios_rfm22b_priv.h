@@ -216,7 +216,11 @@ struct pios_rfm22b_dev {
     uint32_t aux_tx_out_context;
 
     // Send next packet on primary or aux channel?
-    bool     last_stream_sent;
+    uint8_t  last_stream_sent;
+    // Pack chunks of both streams into each packet?
+    bool     aggregate;
+    // The data length limit of aggregated packets, adapted to the link quality.
+    uint8_t  aggregate_len;
 
     // the transmit power to use for data transmissions
     uint8_t  tx_power;
@@ -43,6 +43,8 @@ uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
 
 #if defined(PIOS_INCLUDE_BL_HELPER_WRITE_SUPPORT)
 
+#define FLASH_PAGE_BYTES 1024
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress);
 
 uint8_t PIOS_BL_HELPER_FLASH_Ini()
@@ -73,6 +75,22 @@ uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
     return (success) ? 1 : 0;
 }
 
+uint8_t PIOS_BL_HELPER_FLASH_Sector_Info(uint32_t address, uint32_t *sectorStart, uint32_t *sectorSize)
+{
+    *sectorStart = address - (address % FLASH_PAGE_BYTES);
+    *sectorSize  = FLASH_PAGE_BYTES;
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Sector(uint32_t address)
+{
+    uint32_t pageAddress = address - (address % FLASH_PAGE_BYTES);
+
+    bool success = erase_flash(pageAddress, pageAddress + FLASH_PAGE_BYTES);
+
+    return (success) ? 1 : 0;
+}
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
 {
     uint32_t pageAddress = startAddress;
@@ -87,7 +105,7 @@ static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
                 fail = true;
             }
         }
-        pageAddress += 1024;
+        pageAddress += FLASH_PAGE_BYTES;
     }
     return !fail;
 }
@@ -98,9 +116,14 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
+    return PIOS_BL_HELPER_CRC_Block_Calc(bdinfo->fw_base, bdinfo->fw_size);
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t startAddress, uint32_t size)
+{
     PIOS_BL_HELPER_CRC_Ini();
     CRC_ResetDR();
-    CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
+    CRC_CalcBlockCRC((uint32_t *)startAddress, size >> 2);
     return CRC_GetCRC();
 }
 
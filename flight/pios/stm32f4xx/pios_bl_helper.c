@@ -221,6 +221,30 @@ uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
     return (success) ? 1 : 0;
 }
 
+uint8_t PIOS_BL_HELPER_FLASH_Sector_Info(uint32_t address, uint32_t *sectorStart, uint32_t *sectorSize)
+{
+    uint8_t sector_number;
+
+    return PIOS_BL_HELPER_FLASH_GetSectorInfo(address, &sector_number, sectorStart, sectorSize) ? 1 : 0;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Sector(uint32_t address)
+{
+    uint8_t sector_number;
+    uint32_t sector_start;
+    uint32_t sector_size;
+
+    if (!PIOS_BL_HELPER_FLASH_GetSectorInfo(address, &sector_number, &sector_start, &sector_size)) {
+        return 0;
+    }
+    for (int retry = 0; retry < MAX_DEL_RETRYS; ++retry) {
+        if (FLASH_EraseSector(sector_number, VoltageRange_3) == FLASH_COMPLETE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
 {
     uint32_t pageAddress = startAddress;
@@ -269,9 +293,14 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
+    return PIOS_BL_HELPER_CRC_Block_Calc(bdinfo->fw_base, bdinfo->fw_size);
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t startAddress, uint32_t size)
+{
     PIOS_BL_HELPER_CRC_Ini();
     CRC_ResetDR();
-    CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
+    CRC_CalcBlockCRC((uint32_t *)startAddress, size >> 2);
     return CRC_GetCRC();
 }
 
@@ -130,6 +130,7 @@
 #define PIOS_INCLUDE_FLASH
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
+#define PIOS_INCLUDE_FLASH_LOGFS_COMPACTION
 #define FLASH_FREERTOS
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 
@@ -186,6 +187,11 @@
 /* #define PIOS_TELEM_STACK_SIZE		500 */
 /* #define PIOS_EVENTDISPATCHER_STACK_SIZE	130 */
 
+/* Mix from the stabilization inner loop instead of the actuator task */
+/* #define ACTUATOR_FASTPATH */
+/* Gyro to outputs latency and inner loop time counters, 0x5AB00001/2 (needs PIOS_INCLUDE_INSTRUMENTATION) */
+/* #define ACTUATOR_FASTPATH_COUNTERS */
+
 /* This can't be too high to stop eventdispatcher thread overflowing */
 #define PIOS_EVENTDISAPTCHER_QUEUE 10
 
@@ -109,6 +109,7 @@
 #define PIOS_TELEM_PRIORITY_QUEUE      /* Enable a priority queue in telemetry */
 #define PIOS_QUATERNION_STABILIZATION  /* Stabilization options */
 // #define PIOS_GPS_SETS_HOMELOCATION      /* GPS options */
+#define PIOS_UAVOBJECT_LAZY_REGISTRATION /* Register objects on first access */
 
 /* Alarm Thresholds */
 #define HEAP_LIMIT_WARNING             4000
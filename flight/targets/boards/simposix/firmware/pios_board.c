@@ -142,8 +142,15 @@ void PIOS_Board_Init(void)
     EventDispatcherInitialize();
     UAVObjInitialize();
 
+    uint32_t init_start = PIOS_DELAY_GetRaw();
     UAVObjectsInitializeAll();
 
+    UAVObjStats uavo_stats;
+    UAVObjGetStats(&uavo_stats);
+    printf("PIOS: UAVObjects initialized in %u us, %u registered, %u declared, %u bytes allocated\n",
+           (unsigned int)PIOS_DELAY_DiffuS(init_start), uavo_stats.registeredObjects,
+           uavo_stats.declaredObjects, (unsigned int)uavo_stats.allocatedBytes);
+
     /* Initialize the alarms library */
     AlarmsInitialize();
 
@@ -132,6 +132,7 @@
 #define PIOS_INCLUDE_FLASH
 #define PIOS_INCLUDE_FLASH_INTERNAL
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
+#define PIOS_INCLUDE_FLASH_LOGFS_COMPACTION
 /* #define PIOS_INCLUDE_FLASH_OBJLIST */
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 #define FLASH_FREERTOS
@@ -46,9 +46,11 @@ typedef void (*pFunction)(void);
 /* Private define ------------------------------------------------------------*/
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
-#define UART_BUFFER_SIZE    256
 #define BL_WAIT_TIME        6 * 1000 * 1000
 #define DFU_BUFFER_SIZE     63
+#define SSP_RX_WINDOW       4
+// a filled gap hands the whole receive window to the callback at once, on top of what is still queued
+#define UART_BUFFER_SIZE    ((SSP_RX_WINDOW + 4) * DFU_BUFFER_SIZE)
 
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
@@ -65,6 +67,7 @@ static uint8_t process_buffer[DFU_BUFFER_SIZE];
 static uint8_t rx_buffer[UART_BUFFER_SIZE];
 static uint8_t txBuf[MAX_PACKET_BUF_SIZE];
 static uint8_t rxBuf[MAX_PACKET_BUF_SIZE];
+static uint8_t rxWindowBuf[SSP_WINDOW_BUF_SIZE(SSP_RX_WINDOW, MAX_PACKET_DATA_LEN)];
 
 /* Extern variables ----------------------------------------------------------*/
 DFUStates DeviceState = DFUidle;
@@ -97,6 +100,9 @@ static const PortConfig_t ssp_portConfig = {
     .pfSerialRead  = SSP_SerialRead,
     .pfSerialWrite = SSP_SerialWrite,
     .pfGetTime     = PIOS_DELAY_GetuS,
+    .windowSize    = SSP_RX_WINDOW,
+    .txWindowBuf   = NULL, // replies are few and small, send them stop and wait
+    .rxWindowBuf   = rxWindowBuf,
 };
 
 static Port_t ssp_port;
@@ -125,6 +125,7 @@
 /* #define LOG_FILENAME "startup.log" */
 #define PIOS_INCLUDE_FLASH
 #define PIOS_INCLUDE_FLASH_LOGFS_SETTINGS
+#define PIOS_INCLUDE_FLASH_LOGFS_COMPACTION
 #define FLASH_FREERTOS
 /* #define PIOS_INCLUDE_FLASH_EEPROM */
 /* #define PIOS_INCLUDE_FLASH_INTERNAL */
@@ -160,6 +161,9 @@
 /* Stabilization options */
 #define PIOS_QUATERNION_STABILIZATION
 /* #define PIOS_EXCLUDE_ADVANCED_FEATURES */
+/* UAVObject options */
+/* #define PIOS_UAVOBJECT_LAZY_REGISTRATION */
+
 /* Performance counters */
 #define IDLE_COUNTS_PER_SEC_AT_NO_LOAD  1995998
 
@@ -0,0 +1,50 @@
+#include "pios.h"
+#include "op_dfu.h"
+#include "bootloader_ut.h"
+
+/* The parts of the bootloader main.c that op_dfu.c talks to */
+
+DFUStates DeviceState;
+uint8_t JumpToApp;
+
+static uint8_t reply[64];
+static bool replyPending;
+
+int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len)
+{
+    memcpy(reply, msg, msg_len);
+    replyPending = true;
+    return msg_len;
+}
+
+void BL_UT_PowerUp(void)
+{
+    const uint8_t abortCommand[64] = { Abort_Operation };
+
+    // op_dfu.c keeps the transfer in globals, forget the last one
+    BL_UT_Command(abortCommand);
+
+    memset(BL_UT_Flash(), 0xFF, FW_BANK_SIZE);
+    BL_UT_ClearStats();
+    DeviceState  = BLidle;
+    JumpToApp    = 0;
+    replyPending = false;
+}
+
+void BL_UT_Command(const uint8_t *packet)
+{
+    uint8_t buffer[64];
+
+    memcpy(buffer, packet, sizeof(buffer));
+    processComand(buffer);
+}
+
+bool BL_UT_Reply(uint8_t *packet)
+{
+    if (!replyPending) {
+        return false;
+    }
+    memcpy(packet, reply, 63);
+    replyPending = false;
+    return true;
+}
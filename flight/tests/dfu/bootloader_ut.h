@@ -0,0 +1,39 @@
+#ifndef BOOTLOADER_UT_H
+#define BOOTLOADER_UT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Host stand-in for a Revolution bootloader: op_dfu.c on top of a flash in
+ * RAM with the STM32F4 128kB sectors of the firmware partition.
+ */
+
+#define FW_BANK_BASE   0x08020000
+#define FW_BANK_SIZE   0x000A0000
+#define FW_DESC_SIZE   0x00000064
+#define FW_SECTOR_SIZE 0x00020000
+
+/* Typical STM32F405 128kB sector erase time */
+#define SECTOR_ERASE_MS 1000
+
+struct bootloader_ut_stats {
+    uint32_t sectors_erased;
+    uint32_t words_programmed;
+    uint32_t program_errors; /* words programmed without being erased first */
+};
+
+/* Powers up in the bootloader with an erased partition, clears the stats */
+void BL_UT_PowerUp(void);
+
+/* Hands a command packet to the bootloader, without the report ID */
+void BL_UT_Command(const uint8_t *packet);
+
+/* Copies the bootloader's reply packet, if there is one */
+bool BL_UT_Reply(uint8_t *packet);
+
+uint8_t *BL_UT_Flash(void);
+void BL_UT_GetStats(struct bootloader_ut_stats *stats);
+void BL_UT_ClearStats(void);
+
+#endif /* BOOTLOADER_UT_H */
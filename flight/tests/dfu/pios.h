@@ -0,0 +1,28 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just what op_dfu.c needs from the bootloader, see pios_bl_helper_ut.c */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define BOARD_READABLE true
+#define BOARD_WRITABLE true
+
+typedef enum {
+    FLASH_BUSY = 1,
+    FLASH_ERROR_PROGRAM,
+    FLASH_ERROR_WRP,
+    FLASH_COMPLETE,
+    FLASH_TIMEOUT
+} FLASH_Status;
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data);
+void FLASH_Lock(void);
+
+void PIOS_IAP_WriteBootCount(uint16_t);
+void PIOS_IAP_WriteBootCmd(uint8_t number, uint32_t value);
+void PIOS_SYS_Reset(void);
+
+#endif /* PIOS_H */
@@ -0,0 +1,125 @@
+#include "pios.h"
+#include <assert.h> /* assert */
+#include <pios_board_info.h>
+#include <pios_bl_helper.h>
+#include "bootloader_ut.h"
+
+const struct pios_board_info pios_board_info_blob = {
+    .magic      = PIOS_BOARD_INFO_BLOB_MAGIC,
+    .board_type = 0x09,
+    .board_rev  = 0x03,
+    .bl_rev     = 0x80,
+    .hw_type    = 0,
+    .fw_base    = FW_BANK_BASE,
+    .fw_size    = FW_BANK_SIZE - FW_DESC_SIZE,
+    .desc_base  = FW_BANK_BASE + FW_BANK_SIZE - FW_DESC_SIZE,
+    .desc_size  = FW_DESC_SIZE,
+};
+
+static uint32_t flash[FW_BANK_SIZE / 4];
+static struct bootloader_ut_stats stats;
+
+uint8_t *BL_UT_Flash(void)
+{
+    return (uint8_t *)flash;
+}
+
+void BL_UT_GetStats(struct bootloader_ut_stats *out)
+{
+    *out = stats;
+}
+
+void BL_UT_ClearStats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
+{
+    assert(SectorAddress >= FW_BANK_BASE && SectorAddress < FW_BANK_BASE + FW_BANK_SIZE);
+    return (uint8_t *)flash + (SectorAddress - FW_BANK_BASE);
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Ini()
+{
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Sector_Info(uint32_t address, uint32_t *sectorStart, uint32_t *sectorSize)
+{
+    if (address < FW_BANK_BASE || address >= FW_BANK_BASE + FW_BANK_SIZE) {
+        return 0;
+    }
+    *sectorStart = address - (address - FW_BANK_BASE) % FW_SECTOR_SIZE;
+    *sectorSize  = FW_SECTOR_SIZE;
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Sector(uint32_t address)
+{
+    uint32_t sectorStart;
+    uint32_t sectorSize;
+
+    if (!PIOS_BL_HELPER_FLASH_Sector_Info(address, &sectorStart, &sectorSize)) {
+        return 0;
+    }
+    memset(PIOS_BL_HELPER_FLASH_If_Read(sectorStart), 0xFF, sectorSize);
+    stats.sectors_erased++;
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Start()
+{
+    for (uint32_t address = FW_BANK_BASE; address < FW_BANK_BASE + FW_BANK_SIZE; address += FW_SECTOR_SIZE) {
+        PIOS_BL_HELPER_FLASH_Erase_Sector(address);
+    }
+    return 1;
+}
+
+/* The STM32 CRC unit, one bit at a time */
+uint32_t PIOS_BL_HELPER_CRC_Block_Calc(uint32_t startAddress, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t address = startAddress; address < startAddress + size; address += 4) {
+        crc ^= *(uint32_t *)PIOS_BL_HELPER_FLASH_If_Read(address);
+        for (int bit = 0; bit < 32; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
+{
+    return PIOS_BL_HELPER_CRC_Block_Calc(pios_board_info_blob.fw_base, pios_board_info_blob.fw_size);
+}
+
+void PIOS_BL_HELPER_CRC_Ini()
+{}
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
+{
+    uint32_t *word = (uint32_t *)PIOS_BL_HELPER_FLASH_If_Read(Address);
+
+    /* Like the F1/F3 flash, refuse to program a word that is not erased */
+    if (*word != 0xFFFFFFFF) {
+        stats.program_errors++;
+        return FLASH_ERROR_PROGRAM;
+    }
+    *word = Data;
+    stats.words_programmed++;
+    return FLASH_COMPLETE;
+}
+
+void FLASH_Lock(void)
+{}
+
+void PIOS_IAP_WriteBootCount(__attribute__((unused)) uint16_t count)
+{}
+
+void PIOS_IAP_WriteBootCmd(__attribute__((unused)) uint8_t number, __attribute__((unused)) uint32_t value)
+{}
+
+void PIOS_SYS_Reset(void)
+{}
@@ -0,0 +1,439 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "bootloader_ut.h"
+#include "op_dfu.h"
+}
+
+/*
+ * Firmware uploads against the host bootloader stand-in. The Uploader below
+ * sends the same packet sequences as DFUObject::UploadFullT() and
+ * UploadDifferentialT() in the GCS uploader plugin, and counts them to model
+ * the time a USB HID transfer takes: one 64 byte report per 1ms frame each
+ * way, plus the sector erases. Programming a packet takes less than a frame.
+ */
+
+#define SIZE_OF_CODE  (FW_BANK_SIZE - FW_DESC_SIZE)
+#define WORDS         14
+#define PACKET_BYTES  (WORDS * 4)
+#define IMAGE_SIZE    0x5A000 // spans the first three sectors
+
+struct Sector {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t crc;
+};
+
+static uint32_t nextRandom(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static std::vector<uint8_t> makeImage(uint32_t seed, uint32_t size)
+{
+    std::vector<uint8_t> image(size);
+
+    for (uint32_t i = 0; i < size; i++) {
+        image[i] = nextRandom(seed);
+    }
+    return image;
+}
+
+// DFUObject::CRC32WideFast() over little endian words
+static uint32_t crc32(const uint8_t *data, uint32_t size)
+{
+    static const uint32_t CrcTable[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < size; i += 4) {
+        crc ^= data[i] | data[i + 1] << 8 | data[i + 2] << 16 | (uint32_t)data[i + 3] << 24;
+        for (int n = 0; n < 8; n++) {
+            crc = (crc << 4) ^ CrcTable[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+// The image padded to the whole firmware partition, as the CRC check sees it
+static std::vector<uint8_t> padded(const std::vector<uint8_t> & image)
+{
+    std::vector<uint8_t> partition(image);
+
+    partition.resize(SIZE_OF_CODE, 0xFF);
+    return partition;
+}
+
+static uint32_t unpack(const uint8_t *buf)
+{
+    return (uint32_t)buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+}
+
+class Uploader {
+public:
+    Uploader() : reports(0), replies(0), sleepMs(0), packetsSent(0) {}
+
+    int reports; // packets sent to the bootloader
+    int replies; // packets received from it
+    int sleepMs; // fixed delays
+    int packetsSent; // firmware data packets
+
+    uint32_t modelledMs()
+    {
+        struct bootloader_ut_stats stats;
+
+        BL_UT_GetStats(&stats);
+        return reports + replies + sleepMs + stats.sectors_erased * SECTOR_ERASE_MS;
+    }
+
+    void send(uint8_t command, uint32_t count, const uint8_t *data = NULL, int length = 0)
+    {
+        uint8_t packet[64];
+
+        memset(packet, 0, sizeof(packet));
+        packet[COMMAND]   = command;
+        packet[COUNT]     = count >> 24;
+        packet[COUNT + 1] = count >> 16;
+        packet[COUNT + 2] = count >> 8;
+        packet[COUNT + 3] = count;
+        if (data) {
+            memcpy(&packet[DATA], data, length);
+        }
+        BL_UT_Command(packet);
+        reports++;
+    }
+
+    bool receive(uint8_t *reply)
+    {
+        replies++;
+        return BL_UT_Reply(reply);
+    }
+
+    int status()
+    {
+        uint8_t reply[64];
+
+        send(Status_Request, 0);
+        if (!receive(reply) || reply[0] != Status_Rep) {
+            return -1;
+        }
+        return reply[5];
+    }
+
+    void enterDFU()
+    {
+        uint8_t device = 0;
+
+        send(EnterDFU, 0, &device, 1);
+    }
+
+    // findDevices(), true if the bootloader does differential uploads
+    bool findDevices()
+    {
+        uint8_t device = 1;
+        uint8_t reply[64];
+
+        send(Req_Capabilities, 0, &device, 1);
+        return receive(reply) && (reply[15] & DFU_CAPABILITY_DIFFERENTIAL);
+    }
+
+    std::vector<Sector> readSectorCrcs()
+    {
+        std::vector<Sector> sectors;
+        uint32_t offset = 0;
+
+        while (true) {
+            uint8_t reply[64];
+            send(Req_SectorCrc, offset);
+            if (!receive(reply) || reply[0] != Rep_SectorCrc || reply[5] == 0) {
+                break;
+            }
+            EXPECT_EQ(offset, unpack(&reply[1]));
+            for (int x = 0; x < reply[5]; x++) {
+                Sector sector = { offset, unpack(&reply[6 + x * 8]), unpack(&reply[10 + x * 8]) };
+                sectors.push_back(sector);
+                offset += sector.size;
+            }
+        }
+        return sectors;
+    }
+
+    // Sends packet packetcount of image
+    void sendPacket(const std::vector<uint8_t> & image, uint32_t packetcount, uint32_t packets)
+    {
+        uint8_t data[PACKET_BYTES];
+        uint32_t words = (packetcount == packets - 1) ? (image.size() - packetcount * PACKET_BYTES) / 4 : WORDS;
+
+        for (uint32_t x = 0; x < words * 4; x += 4) {
+            for (int byte = 0; byte < 4; byte++) {
+                data[x + byte] = image[packetcount * PACKET_BYTES + x + 3 - byte];
+            }
+        }
+        send(Upload, packetcount, data, words * 4);
+        packetsSent++;
+    }
+
+    void startUpload(uint32_t size, uint8_t type, uint32_t crc)
+    {
+        uint32_t packets = (size + PACKET_BYTES - 1) / PACKET_BYTES;
+        uint8_t data[6]  = { type, (uint8_t)((size - (packets - 1) * PACKET_BYTES) / 4),
+                             (uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc };
+
+        send(Upload | 0x20, packets, data, sizeof(data));
+        if (type == FW) {
+            sleepMs += 1000;
+        }
+    }
+
+    // UploadFullT(), or UploadDescription() for a Descript transfer
+    int uploadFull(const std::vector<uint8_t> & image, uint8_t type = FW, std::vector<bool> *skip = NULL)
+    {
+        uint32_t packets = (image.size() + PACKET_BYTES - 1) / PACKET_BYTES;
+
+        startUpload(image.size(), type, (type == FW) ? crc32(&padded(image)[0], SIZE_OF_CODE) : 0);
+        int ret = status();
+        if (ret != uploading) {
+            return ret;
+        }
+        for (uint32_t packetcount = 0; packetcount < packets; packetcount++) {
+            if (!skip || !(*skip)[packetcount]) {
+                sendPacket(image, packetcount, packets);
+            }
+        }
+        send(Op_END, 0);
+        return status();
+    }
+
+    // UploadDifferentialT()
+    int uploadDifferential(const std::vector<uint8_t> & image)
+    {
+        std::vector<Sector> sectors   = readSectorCrcs();
+        std::vector<uint8_t> partition = padded(image);
+        uint32_t packets = (image.size() + PACKET_BYTES - 1) / PACKET_BYTES;
+        std::vector<bool> sendPackets(packets, false);
+        std::vector<Sector> changed;
+
+        for (unsigned int i = 0; i < sectors.size(); i++) {
+            const Sector & sector = sectors[i];
+            if ((sector.offset + sector.size <= SIZE_OF_CODE)
+                && (crc32(&partition[sector.offset], sector.size) == sector.crc)) {
+                continue;
+            }
+            changed.push_back(sector);
+            uint32_t end = std::min((sector.offset + sector.size + PACKET_BYTES - 1) / PACKET_BYTES, packets);
+            for (uint32_t packet = sector.offset / PACKET_BYTES; packet < end; packet++) {
+                bool erased = true;
+                for (uint32_t x = 0; x < PACKET_BYTES; x++) {
+                    erased = erased && (partition[packet * PACKET_BYTES + x] == 0xFF);
+                }
+                sendPackets[packet] = !erased;
+            }
+        }
+
+        startUpload(image.size(), FW_Differential, crc32(&partition[0], SIZE_OF_CODE));
+        int ret = status();
+        if (ret != uploading) {
+            return ret;
+        }
+        for (unsigned int i = 0; i < changed.size(); i++) {
+            send(Erase_Sector, changed[i].offset);
+            ret = status();
+            if (ret != uploading) {
+                return ret;
+            }
+        }
+        for (uint32_t packetcount = 0; packetcount < packets; packetcount++) {
+            if (sendPackets[packetcount]) {
+                sendPacket(image, packetcount, packets);
+            }
+        }
+        send(Op_END, 0);
+        return status();
+    }
+
+    void clearCounters()
+    {
+        reports     = 0;
+        replies     = 0;
+        sleepMs     = 0;
+        packetsSent = 0;
+        BL_UT_ClearStats();
+    }
+};
+
+class DFUTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        BL_UT_PowerUp();
+        differential = uploader.findDevices();
+        uploader.enterDFU();
+        ASSERT_EQ(DFUidle, uploader.status());
+
+        // what the board runs before the upload
+        oldImage = makeImage(1, IMAGE_SIZE);
+        ASSERT_EQ(Last_operation_Success, uploader.uploadFull(oldImage));
+        ASSERT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+        uploader.clearCounters();
+    }
+
+    void expectFlashed(const std::vector<uint8_t> & image)
+    {
+        std::vector<uint8_t> partition = padded(image);
+
+        EXPECT_EQ(0, memcmp(&partition[0], BL_UT_Flash(), SIZE_OF_CODE));
+        EXPECT_EQ(0, memcmp(&description[0], BL_UT_Flash() + SIZE_OF_CODE, description.size()));
+    }
+
+    Uploader uploader;
+    bool differential;
+    std::vector<uint8_t> oldImage;
+    std::vector<uint8_t> description = std::vector<uint8_t>(FW_DESC_SIZE, 0x42);
+};
+
+TEST_F(DFUTest, SectorCrcs) {
+    std::vector<Sector> sectors = uploader.readSectorCrcs();
+    std::vector<uint8_t> partition = padded(oldImage);
+
+    partition.insert(partition.end(), description.begin(), description.end());
+
+    ASSERT_TRUE(differential);
+    ASSERT_EQ((unsigned)(FW_BANK_SIZE / FW_SECTOR_SIZE), sectors.size());
+    for (unsigned int i = 0; i < sectors.size(); i++) {
+        EXPECT_EQ(i * FW_SECTOR_SIZE, sectors[i].offset);
+        EXPECT_EQ((uint32_t)FW_SECTOR_SIZE, sectors[i].size);
+        EXPECT_EQ(crc32(&partition[sectors[i].offset], sectors[i].size), sectors[i].crc);
+    }
+
+    // asking for an offset within a sector starts at the sector
+    uint8_t reply[64];
+    uploader.send(Req_SectorCrc, FW_SECTOR_SIZE + 100);
+    ASSERT_TRUE(uploader.receive(reply));
+    EXPECT_EQ((uint32_t)FW_SECTOR_SIZE, unpack(&reply[1]));
+
+    // and nothing past the end
+    uploader.send(Req_SectorCrc, FW_BANK_SIZE);
+    ASSERT_TRUE(uploader.receive(reply));
+    EXPECT_EQ(0, reply[5]);
+}
+
+TEST_F(DFUTest, FullUpload) {
+    std::vector<uint8_t> image = makeImage(2, IMAGE_SIZE);
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadFull(image));
+    EXPECT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+    expectFlashed(image);
+}
+
+TEST_F(DFUTest, FullUploadMustNotSkipPackets) {
+    std::vector<uint8_t> image = makeImage(2, IMAGE_SIZE);
+    std::vector<bool> skip((IMAGE_SIZE + PACKET_BYTES - 1) / PACKET_BYTES, false);
+
+    skip[100] = true;
+    EXPECT_EQ(wrong_packet_received, uploader.uploadFull(image, FW, &skip));
+}
+
+TEST_F(DFUTest, EraseSectorOnlyInDifferentialUpload) {
+    struct bootloader_ut_stats stats;
+
+    uploader.send(Erase_Sector, 0);
+    EXPECT_EQ(Last_operation_failed, uploader.status());
+    BL_UT_GetStats(&stats);
+    EXPECT_EQ(0u, stats.sectors_erased);
+}
+
+TEST_F(DFUTest, DifferentialUnchanged) {
+    struct bootloader_ut_stats stats;
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadDifferential(oldImage));
+    BL_UT_GetStats(&stats);
+    // only the sector with the description, it holds no firmware
+    EXPECT_EQ(1u, stats.sectors_erased);
+    EXPECT_EQ(0, uploader.packetsSent);
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+    expectFlashed(oldImage);
+}
+
+TEST_F(DFUTest, DifferentialChangedSector) {
+    struct bootloader_ut_stats stats;
+    std::vector<uint8_t> image = oldImage;
+
+    image[FW_SECTOR_SIZE + 0x1234] ^= 0x01;
+    EXPECT_EQ(Last_operation_Success, uploader.uploadDifferential(image));
+    BL_UT_GetStats(&stats);
+    EXPECT_EQ(2u, stats.sectors_erased);
+    // the packets crossing into the unchanged neighbours are sent, their words there are left out
+    EXPECT_EQ(FW_SECTOR_SIZE / PACKET_BYTES + 2, uploader.packetsSent);
+    EXPECT_EQ(0u, stats.program_errors);
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+    expectFlashed(image);
+}
+
+TEST_F(DFUTest, DifferentialNewImage) {
+    struct bootloader_ut_stats stats;
+    std::vector<uint8_t> image = makeImage(3, IMAGE_SIZE - 0x10000);
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadDifferential(image));
+    BL_UT_GetStats(&stats);
+    EXPECT_EQ(0u, stats.program_errors);
+
+    EXPECT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+    expectFlashed(image);
+}
+
+TEST_F(DFUTest, Benchmark) {
+    std::vector<uint8_t> patched = oldImage;
+    std::vector<uint8_t> release = makeImage(4, IMAGE_SIZE);
+
+    patched[0x100] ^= 0x80;
+
+    printf("upload          reports  erases   modelled time\n");
+
+    const struct {
+        const char *name;
+        const std::vector<uint8_t> *image;
+        bool differential;
+    } runs[] = {
+        { "full, patch   ", &patched, false },
+        { "diff, patch   ", &patched, true  },
+        { "full, release ", &release, false },
+        { "diff, release ", &release, true  },
+        { "diff, same    ", &release, true  },
+    };
+    uint32_t ms[sizeof(runs) / sizeof(runs[0])];
+
+    for (unsigned int i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+        struct bootloader_ut_stats stats;
+        int ret;
+
+        // every run starts from oldImage, but the last which repeats the one before
+        if (i < 4) {
+            SetUp();
+        } else {
+            uploader.clearCounters();
+        }
+        ret = runs[i].differential ? uploader.uploadDifferential(*runs[i].image) : uploader.uploadFull(*runs[i].image);
+        ASSERT_EQ(Last_operation_Success, ret);
+        ASSERT_EQ(Last_operation_Success, uploader.uploadFull(description, Descript));
+        expectFlashed(*runs[i].image);
+
+        BL_UT_GetStats(&stats);
+        ms[i] = uploader.modelledMs();
+        printf("%s %8d %7u %12u ms\n", runs[i].name, uploader.reports, stats.sectors_erased, ms[i]);
+    }
+    EXPECT_LT(ms[1] * 2, ms[0]);
+    EXPECT_LT(ms[3], ms[2]);
+    EXPECT_LT(ms[4] * 5, ms[2]);
+}
@@ -0,0 +1,267 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <math.h> /* sinf */
+#include <time.h> /* clock */
+#include <vector>
+
+extern "C" {
+#include "pios.h"
+#include "debuglogentry.h"
+#include "pios_flash_ut_priv.h"
+#include "pios_debuglog_ut_priv.h"
+
+extern struct pios_flash_ut_cfg flash_config;
+
+#include "pios_flashfs_logfs_priv.h"
+
+extern struct flashfs_logfs_cfg flashfs_config_partition_a;
+}
+
+#define GYRO_ID       0x11111110
+#define ACCEL_ID      0x22222220
+#define ATTITUDE_ID   0x33333330
+
+#define LOG_PERIOD_US 2000 // 500Hz
+#define LOG_CYCLES    300 // standard mode must fit in one arena
+
+struct LogRecord {
+    uint32_t time;
+    uint32_t objId;
+    uint16_t instId;
+    std::vector<uint8_t> data;
+};
+
+struct LogStats {
+    uint32_t records;
+    uint32_t entries;
+    uint32_t bytesWritten;
+    uint32_t sectorsErased;
+    double   recordsPerSec;
+};
+
+static bool readVarint(const uint8_t *data, uint32_t size, uint32_t & pos, uint32_t & value)
+{
+    value = 0;
+    for (int shift = 0; pos < size && shift < 32; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reference decoder of DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS pages, mirrors the GCS one
+static bool decodePage(const DebugLogEntryData & entry, std::vector<LogRecord> & records)
+{
+    std::vector<LogRecord> dictionary;
+    uint32_t time = entry.FlightTime;
+    uint32_t pos  = 0;
+
+    for (int n = 0; n < entry.InstanceID; n++) {
+        uint32_t dt;
+        if (!readVarint(entry.Data, entry.Size, pos, dt) || pos >= entry.Size) {
+            return false;
+        }
+        time += dt;
+        uint8_t ref = entry.Data[pos++];
+        if (ref > dictionary.size()) {
+            return false;
+        }
+        if (ref == dictionary.size()) {
+            LogRecord record;
+            uint32_t instId, size;
+            memcpy(&record.objId, &entry.Data[pos], sizeof(record.objId));
+            pos += sizeof(record.objId);
+            if (!readVarint(entry.Data, entry.Size, pos, instId) || !readVarint(entry.Data, entry.Size, pos, size) || pos + size > entry.Size) {
+                return false;
+            }
+            record.instId = instId;
+            record.data.assign(&entry.Data[pos], &entry.Data[pos + size]);
+            pos += size;
+            dictionary.push_back(record);
+        } else {
+            std::vector<uint8_t> & last = dictionary[ref].data;
+            uint32_t i = 0;
+            while (i < last.size()) {
+                uint32_t unchanged, changed;
+                if (!readVarint(entry.Data, entry.Size, pos, unchanged)) {
+                    return false;
+                }
+                i += unchanged;
+                if (i >= last.size()) {
+                    break;
+                }
+                if (!readVarint(entry.Data, entry.Size, pos, changed) || pos + changed > entry.Size || i + changed > last.size()) {
+                    return false;
+                }
+                memcpy(&last[i], &entry.Data[pos], changed);
+                pos += changed;
+                i   += changed;
+            }
+        }
+        dictionary[ref].time = time;
+        records.push_back(dictionary[ref]);
+    }
+    return pos == entry.Size;
+}
+
+class DebugLogTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        /* create an empty, appropriately sized flash filesystem */
+        FILE *theflash = fopen(FLASH_IMAGE_FILE, "wb");
+        uint8_t sector[flash_config.size_of_sector];
+
+        memset(sector, 0xFF, sizeof(sector));
+        for (uint32_t i = 0; i < flash_config.size_of_flash / flash_config.size_of_sector; i++) {
+            fwrite(sector, sizeof(sector), 1, theflash);
+        }
+        fclose(theflash);
+
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&pios_user_fs_id, &flashfs_config_partition_a, &pios_ut_flash_driver, flash_id));
+        pios_debuglog_ut_time = 0;
+        PIOS_DEBUGLOG_Initialize();
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_DEBUGLOG_Enable(0);
+        PIOS_DEBUGLOG_EnableHighRate(0);
+        PIOS_FLASHFS_Logfs_Destroy(pios_user_fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+    }
+
+    // Simulated sensor and attitude stream, slowly changing floats like in flight
+    void logCycle(uint32_t cycle)
+    {
+        float t = cycle * (LOG_PERIOD_US * 1e-6f);
+        float gyro[4]     = { 10.0f * sinf(t), 5.0f * sinf(2.0f * t), 1.0f * sinf(0.5f * t), 35.0f };
+        float accel[4]    = { 0.1f * sinf(t), 0.2f * sinf(3.0f * t), -9.81f + 0.05f * sinf(t), 35.0f };
+        float attitude[7] = { 1.0f, 0.0f, 0.01f * sinf(t), 0.0f, 2.0f * sinf(t), 1.0f * sinf(2.0f * t), 90.0f };
+
+        log(GYRO_ID, 0, (uint8_t *)gyro, sizeof(gyro));
+        log(ACCEL_ID, 0, (uint8_t *)accel, sizeof(accel));
+        log(ATTITUDE_ID, 0, (uint8_t *)attitude, sizeof(attitude));
+    }
+
+    void log(uint32_t objId, uint16_t instId, uint8_t *data, uint32_t size)
+    {
+        LogRecord record;
+
+        record.time   = pios_debuglog_ut_time;
+        record.objId  = objId;
+        record.instId = instId;
+        record.data.assign(data, data + size);
+        expected.push_back(record);
+        PIOS_DEBUGLOG_UAVObject(objId, instId, size, data);
+    }
+
+    LogStats run(bool highRate)
+    {
+        LogStats stats;
+
+        PIOS_DEBUGLOG_EnableHighRate(highRate);
+        PIOS_DEBUGLOG_Enable(1);
+
+        clock_t start = clock();
+        for (uint32_t cycle = 0; cycle < LOG_CYCLES; cycle++) {
+            logCycle(cycle);
+            pios_debuglog_ut_time += LOG_PERIOD_US;
+            // the writer runs in the background between two logging cycles
+            PIOS_DEBUGLOG_UT_RunWriter();
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        stats.records = expected.size();
+        stats.recordsPerSec = elapsed > 0 ? stats.records / elapsed : 0;
+        uint16_t entries;
+        PIOS_DEBUGLOG_Info(NULL, &entries, NULL, NULL);
+        stats.entries = entries;
+        PIOS_Flash_UT_GetWear(flash_id, &stats.bytesWritten, &stats.sectorsErased);
+
+        printf("%-9s: %u records, %u log entries, %.1f records/entry, %u flash bytes written (%.1f/record), %u sectors erased, %.0f records/s\n",
+               highRate ? "high rate" : "standard", stats.records, stats.entries, (double)stats.records / stats.entries,
+               stats.bytesWritten, (double)stats.bytesWritten / stats.records, stats.sectorsErased, stats.recordsPerSec);
+        return stats;
+    }
+
+    uintptr_t flash_id;
+    std::vector<LogRecord> expected;
+};
+
+TEST_F(DebugLogTest, HighRateRoundTrip) {
+    run(true);
+
+    std::vector<LogRecord> records;
+    DebugLogEntryData entry;
+    for (uint16_t n = 0; PIOS_DEBUGLOG_Read(&entry, 0, n) == 0; n++) {
+        ASSERT_EQ(DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS, entry.Type);
+        ASSERT_EQ(n, entry.Entry);
+        ASSERT_TRUE(decodePage(entry, records));
+    }
+
+    // only the page still being filled is not on flash
+    ASSERT_LE(records.size(), expected.size());
+    ASSERT_GT(records.size(), expected.size() - 3 * 16);
+    for (uint32_t i = 0; i < records.size(); i++) {
+        EXPECT_EQ(expected[i].time, records[i].time);
+        EXPECT_EQ(expected[i].objId, records[i].objId);
+        EXPECT_EQ(expected[i].instId, records[i].instId);
+        EXPECT_TRUE(expected[i].data == records[i].data);
+    }
+}
+
+TEST_F(DebugLogTest, HighRateLargeObject) {
+    uint8_t small[16];
+    uint8_t large[sizeof(((DebugLogEntryData *)0)->Data)];
+
+    memset(small, 0x11, sizeof(small));
+    memset(large, 0x22, sizeof(large));
+
+    PIOS_DEBUGLOG_EnableHighRate(1);
+    PIOS_DEBUGLOG_Enable(1);
+    PIOS_DEBUGLOG_UAVObject(GYRO_ID, 0, sizeof(small), small);
+    // does not fit in a page, falls back to a plain entry
+    PIOS_DEBUGLOG_UAVObject(ATTITUDE_ID, 0, sizeof(large), large);
+    PIOS_DEBUGLOG_UT_RunWriter();
+    PIOS_DEBUGLOG_UAVObject(GYRO_ID, 0, sizeof(small), small);
+    PIOS_DEBUGLOG_UT_RunWriter();
+    // text is saved right away, the pending page is written afterwards
+    PIOS_DEBUGLOG_Printf((char *)"flush");
+    PIOS_DEBUGLOG_UT_RunWriter();
+
+    DebugLogEntryData entry;
+    ASSERT_EQ(0, PIOS_DEBUGLOG_Read(&entry, 0, 0));
+    EXPECT_EQ(DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS, entry.Type);
+    EXPECT_EQ(1, entry.InstanceID);
+    ASSERT_EQ(0, PIOS_DEBUGLOG_Read(&entry, 0, 1));
+    EXPECT_EQ(DEBUGLOGENTRY_TYPE_UAVOBJECT, entry.Type);
+    EXPECT_EQ((uint32_t)ATTITUDE_ID, entry.ObjectID);
+    EXPECT_EQ(0, memcmp(large, entry.Data, sizeof(large)));
+    ASSERT_EQ(0, PIOS_DEBUGLOG_Read(&entry, 0, 2));
+    EXPECT_EQ(DEBUGLOGENTRY_TYPE_TEXT, entry.Type);
+    ASSERT_EQ(0, PIOS_DEBUGLOG_Read(&entry, 0, 3));
+    EXPECT_EQ(DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS, entry.Type);
+    EXPECT_EQ(1, entry.InstanceID);
+}
+
+TEST_F(DebugLogTest, StandardVersusHighRate) {
+    LogStats standard = run(false);
+
+    TearDown();
+    expected.clear();
+    SetUp();
+    LogStats highRate = run(true);
+
+    ASSERT_EQ(standard.records, highRate.records);
+    // each page holds more records, so less flash is written and erased for the same data
+    EXPECT_GT((double)highRate.records / highRate.entries, 1.5 * standard.records / standard.entries);
+    EXPECT_LT(highRate.bytesWritten * 3, standard.bytesWritten * 2);
+    EXPECT_LE(highRate.sectorsErased, standard.sectorsErased);
+}
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ *
+ * @file       debuglogentry.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Stub of the generated DebugLogEntry object for pios_debuglog.c
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DEBUGLOGENTRY_H
+#define DEBUGLOGENTRY_H
+
+#include <stdint.h>
+
+#define DEBUGLOGENTRY_OBJID 0x7BAD0000
+
+typedef enum __attribute__((packed)) {
+    DEBUGLOGENTRY_TYPE_EMPTY = 0,
+    DEBUGLOGENTRY_TYPE_TEXT  = 1,
+    DEBUGLOGENTRY_TYPE_UAVOBJECT = 2,
+    DEBUGLOGENTRY_TYPE_MULTIPLEUAVOBJECTS   = 3,
+    DEBUGLOGENTRY_TYPE_COMPRESSEDUAVOBJECTS = 4
+} DebugLogEntryTypeOptions;
+
+/* Same field order as the generated object, fields are sorted by size */
+typedef struct {
+    uint32_t FlightTime;
+    uint32_t ObjectID;
+    uint16_t Flight;
+    uint16_t Entry;
+    uint16_t InstanceID;
+    uint16_t Size;
+    DebugLogEntryTypeOptions Type;
+    uint8_t  Data[200];
+} __attribute__((packed)) DebugLogEntryDataPacked;
+
+typedef DebugLogEntryDataPacked __attribute__((aligned(4))) DebugLogEntryData;
+
+#endif /* DEBUGLOGENTRY_H */
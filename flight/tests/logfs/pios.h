@@ -9,9 +9,22 @@
 #include "FreeRTOS.h"
 #endif
 #include "pios_mem.h"
+#ifdef PIOS_INCLUDE_CALLBACKSCHEDULER
+#include <stdint.h>
+#include <stdbool.h>
+#include <pios_callbackscheduler.h>
+#endif
 #ifdef PIOS_INCLUDE_FLASH
 #include <pios_flash.h>
 #include <pios_flashfs.h>
 #endif
+#ifdef PIOS_INCLUDE_DEBUGLOG
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "openpilot.h"
+#include <pios_debuglog.h>
+extern uint32_t PIOS_DELAY_GetuS();
+#endif
 
 #endif /* PIOS_H */
@@ -3,7 +3,10 @@
 
 /* Enable/Disable PiOS modules */
 #define PIOS_INCLUDE_FLASH
+#define PIOS_INCLUDE_FLASH_LOGFS_COMPACTION
 // #define PIOS_FLASHFS_LOGFS_MAX_DEVS 5
 #define PIOS_INCLUDE_FREERTOS
+#define PIOS_INCLUDE_CALLBACKSCHEDULER
+#define PIOS_INCLUDE_DEBUGLOG
 
 #endif /* PIOS_CONFIG_H */
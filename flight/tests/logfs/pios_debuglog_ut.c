@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_debuglog_ut.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Callback scheduler and clock stand-ins driving pios_debuglog.c and the logfs compaction in the tests
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "pios.h"
+#include "pios_debuglog_ut_priv.h"
+#include "callbackinfo.h"
+
+uintptr_t pios_user_fs_id;
+uint32_t pios_debuglog_ut_time;
+
+/* One stand-in per CALLBACKINFO_RUNNING_* id, run from the test */
+struct ut_callback {
+    DelayedCallback cb;
+    bool dispatched;
+    bool scheduled;
+};
+
+static struct ut_callback callbacks[2];
+
+DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(DelayedCallback cb,
+                                                   __attribute__((unused)) DelayedCallbackPriority priority,
+                                                   __attribute__((unused)) DelayedCallbackPriorityTask priorityTask,
+                                                   int16_t callbackID,
+                                                   __attribute__((unused)) uint32_t stacksize)
+{
+    struct ut_callback *callback = &callbacks[callbackID];
+
+    callback->cb = cb;
+    callback->dispatched = false;
+    callback->scheduled  = false;
+    return (DelayedCallbackInfo *)callback;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Schedule(DelayedCallbackInfo *cbinfo,
+                                        __attribute__((unused)) int32_t milliseconds,
+                                        __attribute__((unused)) DelayedCallbackUpdateMode updatemode)
+{
+    ((struct ut_callback *)cbinfo)->scheduled = true;
+    return 1;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
+{
+    ((struct ut_callback *)cbinfo)->dispatched = true;
+    return 1;
+}
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return pios_debuglog_ut_time;
+}
+
+void PIOS_DEBUGLOG_UT_RunWriter(void)
+{
+    struct ut_callback *writer = &callbacks[CALLBACKINFO_RUNNING_DEBUGLOG];
+
+    /* Only when dispatched, the periodic schedule is left to the test */
+    while (writer->dispatched) {
+        writer->dispatched = false;
+        writer->cb();
+    }
+}
+
+uint32_t PIOS_DEBUGLOG_UT_RunCallback(int16_t callbackID)
+{
+    struct ut_callback *callback = &callbacks[callbackID];
+    uint32_t runs = 0;
+
+    /* Rescheduled callbacks are run right away */
+    while (callback->cb && (callback->dispatched || callback->scheduled)) {
+        callback->dispatched = false;
+        callback->scheduled  = false;
+        callback->cb();
+        runs++;
+    }
+
+    return runs;
+}
@@ -0,0 +1,42 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_debuglog_ut_priv.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Test hooks of the pios_debuglog.c stand-ins
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_DEBUGLOG_UT_PRIV_H
+#define PIOS_DEBUGLOG_UT_PRIV_H
+
+#include <stdint.h>
+
+/* Flash filesystem used by pios_debuglog.c */
+extern uintptr_t pios_user_fs_id;
+
+/* Value returned by PIOS_DELAY_GetuS() */
+extern uint32_t pios_debuglog_ut_time;
+
+/* Runs the background writer callback if it has been dispatched */
+void PIOS_DEBUGLOG_UT_RunWriter(void);
+uint32_t PIOS_DEBUGLOG_UT_RunCallback(int16_t callbackID);
+
+#endif /* PIOS_DEBUGLOG_UT_PRIV_H */
@@ -15,6 +15,9 @@ struct flash_ut_dev {
     const struct pios_flash_ut_cfg *cfg;
     bool transaction_in_progress;
     FILE *flash_file;
+    uint32_t bytes_written;
+    uint32_t sectors_erased;
+    uint32_t bytes_read;
 };
 
 static struct flash_ut_dev *PIOS_Flash_UT_Alloc(void)
@@ -40,6 +43,9 @@ int32_t PIOS_Flash_UT_Init(uintptr_t *flash_id, const struct pios_flash_ut_cfg *
 
     flash_dev->cfg = cfg;
     flash_dev->transaction_in_progress = false;
+    flash_dev->bytes_written  = 0;
+    flash_dev->sectors_erased = 0;
+    flash_dev->bytes_read     = 0;
 
     flash_dev->flash_file = fopen(FLASH_IMAGE_FILE, "rb+");
     if (flash_dev->flash_file == NULL) {
@@ -74,6 +80,21 @@ int32_t PIOS_Flash_UT_Destroy(uintptr_t flash_id)
     return 0;
 }
 
+void PIOS_Flash_UT_GetWear(uintptr_t flash_id, uint32_t *bytes_written, uint32_t *sectors_erased)
+{
+    struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
+
+    *bytes_written  = flash_dev->bytes_written;
+    *sectors_erased = flash_dev->sectors_erased;
+}
+
+uint32_t PIOS_Flash_UT_GetBytesRead(uintptr_t flash_id)
+{
+    struct flash_ut_dev *flash_dev = (struct flash_ut_dev *)flash_id;
+
+    return flash_dev->bytes_read;
+}
+
 
 /**********************************
  *
@@ -123,6 +144,9 @@ static int32_t PIOS_Flash_UT_EraseSector(uintptr_t flash_id, uint32_t addr)
 
     assert(s == flash_dev->cfg->size_of_sector);
 
+    free(buf);
+    flash_dev->sectors_erased++;
+
     return 0;
 }
 
@@ -144,6 +168,8 @@ static int32_t PIOS_Flash_UT_WriteData(uintptr_t flash_id, uint32_t addr, uint8_
 
     assert(s == len);
 
+    flash_dev->bytes_written += len;
+
     return 0;
 }
 
@@ -165,6 +191,8 @@ static int32_t PIOS_Flash_UT_ReadData(uintptr_t flash_id, uint32_t addr, uint8_t
 
     assert(s == len);
 
+    flash_dev->bytes_read += len;
+
     return 0;
 }
 
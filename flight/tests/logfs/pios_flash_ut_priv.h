@@ -8,6 +8,10 @@ struct pios_flash_ut_cfg {
 int32_t PIOS_Flash_UT_Init(uintptr_t *flash_id, const struct pios_flash_ut_cfg *cfg);
 
 int32_t PIOS_Flash_UT_Destroy(uintptr_t flash_id);
+
+/* Flash wear counters since init */
+void PIOS_Flash_UT_GetWear(uintptr_t flash_id, uint32_t *bytes_written, uint32_t *sectors_erased);
+uint32_t PIOS_Flash_UT_GetBytesRead(uintptr_t flash_id);
 extern const struct pios_flash_driver pios_ut_flash_driver;
 
 #if !defined(FLASH_IMAGE_FILE)
@@ -3,19 +3,26 @@
 #include <stdio.h> /* printf */
 #include <stdlib.h> /* abort */
 #include <string.h> /* memset */
+#include <chrono>
+#include <algorithm> /* std::max */
 
 extern "C" {
 #include "pios_flash.h" /* PIOS_FLASH_* API */
 #include "pios_flash_ut_priv.h"
 
 extern struct pios_flash_ut_cfg flash_config;
+extern struct pios_flash_ut_cfg flash_config_small_sectors;
 
 #include "pios_flashfs_logfs_priv.h"
 
 extern struct flashfs_logfs_cfg flashfs_config_partition_a;
 extern struct flashfs_logfs_cfg flashfs_config_partition_b;
+extern struct flashfs_logfs_cfg flashfs_config_partition_c;
 
 #include "pios_flashfs.h" /* PIOS_FLASHFS_* */
+
+#include "pios_debuglog_ut_priv.h" /* PIOS_DEBUGLOG_UT_RunCallback */
+#include "callbackinfo.h"
 }
 
 #define OBJ0_ID   0xAA55AA55
@@ -297,6 +304,593 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
     EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+/* A batch kept in a table, the way a caller of PIOS_FLASHFS_ObjSaveBatch() would */
+struct batch_entry {
+    uint32_t obj_id;
+    uint16_t obj_inst_id;
+    uint8_t  *obj_data;
+    uint16_t obj_size;
+    bool     pending;
+};
+
+struct batch_table {
+    struct batch_entry *entries;
+    uint32_t num_entries;
+};
+
+static bool batch_find(void *ctx, uint32_t obj_id, uint16_t obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct batch_table *table = (struct batch_table *)ctx;
+
+    for (uint32_t i = 0; i < table->num_entries; i++) {
+        struct batch_entry *entry = &table->entries[i];
+        if (entry->pending && entry->obj_id == obj_id && entry->obj_inst_id == obj_inst_id) {
+            *obj_data = entry->obj_data;
+            *obj_size = entry->obj_size;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool batch_next(void *ctx, uint32_t *cursor, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    struct batch_table *table = (struct batch_table *)ctx;
+
+    for (; *cursor < table->num_entries; (*cursor)++) {
+        struct batch_entry *entry = &table->entries[*cursor];
+        if (entry->pending) {
+            *obj_id      = entry->obj_id;
+            *obj_inst_id = entry->obj_inst_id;
+            *obj_data    = entry->obj_data;
+            *obj_size    = entry->obj_size;
+            (*cursor)++;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void batch_done(void *ctx, uint32_t obj_id, uint16_t obj_inst_id)
+{
+    struct batch_table *table = (struct batch_table *)ctx;
+
+    for (uint32_t i = 0; i < table->num_entries; i++) {
+        struct batch_entry *entry = &table->entries[i];
+        if (entry->obj_id == obj_id && entry->obj_inst_id == obj_inst_id) {
+            entry->pending = false;
+        }
+    }
+}
+
+static struct PIOS_FLASHFS_ObjBatch batchOf(struct batch_table *table)
+{
+    struct PIOS_FLASHFS_ObjBatch batch = { batch_find, batch_next, batch_done, table };
+
+    return batch;
+}
+
+TEST_F(LogfsTestCooked, BatchWriteVerify) {
+    struct batch_entry entries[] = {
+        { OBJ0_ID, 0,   NULL,     0,                true },
+        { OBJ1_ID, 0,   obj1,     sizeof(obj1),     true },
+        { OBJ1_ID, 123, obj1_alt, sizeof(obj1_alt), true },
+        { OBJ2_ID, 0,   obj2,     sizeof(obj2),     true },
+        { OBJ3_ID, 0,   obj3,     sizeof(obj3),     true },
+    };
+    struct batch_table table = { entries, sizeof(entries) / sizeof(entries[0]) };
+    struct PIOS_FLASHFS_ObjBatch batch = batchOf(&table);
+
+    EXPECT_EQ(-1, PIOS_FLASHFS_ObjSaveBatch(fs_id + 1, &batch));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+    for (uint32_t i = 0; i < table.num_entries; i++) {
+        EXPECT_FALSE(entries[i].pending);
+    }
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ0_ID, 0, NULL, 0));
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 123, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    memset(obj2_check, 0, sizeof(obj2_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+    EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+}
+
+TEST_F(LogfsTestCooked, BatchSkipsUnchanged) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 123, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+
+    struct PIOS_FLASHFS_Stats before;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &before));
+
+    /* Only instance 123 changes */
+    struct batch_entry entries[] = {
+        { OBJ1_ID, 0,   obj1,     sizeof(obj1),     true },
+        { OBJ1_ID, 123, obj1_alt, sizeof(obj1_alt), true },
+        { OBJ2_ID, 0,   obj2,     sizeof(obj2),     true },
+    };
+    struct batch_table table = { entries, sizeof(entries) / sizeof(entries[0]) };
+    struct PIOS_FLASHFS_ObjBatch batch = batchOf(&table);
+
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+
+    struct PIOS_FLASHFS_Stats after;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &after));
+    EXPECT_EQ(before.num_active_slots, after.num_active_slots);
+    EXPECT_EQ(before.num_free_slots - 1, after.num_free_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 123, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    /* Saving the same batch again writes nothing */
+    uint32_t bytes_written, sectors_erased, bytes_written_again;
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written, &sectors_erased);
+    for (uint32_t i = 0; i < table.num_entries; i++) {
+        entries[i].pending = true;
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written_again, &sectors_erased);
+    EXPECT_EQ(bytes_written, bytes_written_again);
+}
+
+TEST_F(LogfsTestCooked, BatchGarbageCollect) {
+    uint16_t num_slots = (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) - 1;
+
+    /* Leave just two free slots, with everything but one slot obsolete */
+    for (uint32_t i = 0; i < num_slots - 2U; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, (i & 1) ? obj1_alt : obj1, sizeof(obj1)));
+    }
+
+    struct batch_entry entries[] = {
+        { OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt), true },
+        { OBJ1_ID, 1, obj1,     sizeof(obj1),     true },
+        { OBJ2_ID, 0, obj2,     sizeof(obj2),     true },
+        { OBJ3_ID, 0, obj3,     sizeof(obj3),     true },
+    };
+    struct batch_table table = { entries, sizeof(entries) / sizeof(entries[0]) };
+    struct PIOS_FLASHFS_ObjBatch batch = batchOf(&table);
+
+    uint32_t bytes_written, sectors_erased_before, sectors_erased_after;
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written, &sectors_erased_before);
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written, &sectors_erased_after);
+
+    /* One garbage collection (one arena) for the whole batch */
+    EXPECT_EQ(flashfs_config_partition_a.arena_size / flashfs_config_partition_a.sector_size,
+              sectors_erased_after - sectors_erased_before);
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(4, stats.num_active_slots);
+    /* The replaced copy of obj1 was carried across by the gc and obsoleted after the append */
+    EXPECT_EQ(num_slots - 5, stats.num_free_slots);
+
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+}
+
+TEST_F(LogfsTestCooked, BatchFilesystemFull) {
+    /* Fill up the entire filesystem with multiple instances of obj1 */
+    for (uint32_t i = 0; i < (flashfs_config_partition_a.arena_size / flashfs_config_partition_a.slot_size) - 1; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+    }
+
+    /* A new object does not fit */
+    struct batch_entry entries[] = {
+        { OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt), true },
+        { OBJ2_ID, 0, obj2,     sizeof(obj2),     true },
+    };
+    struct batch_table table = { entries, sizeof(entries) / sizeof(entries[0]) };
+    struct PIOS_FLASHFS_ObjBatch batch = batchOf(&table);
+
+    EXPECT_EQ(-4, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+    EXPECT_TRUE(entries[0].pending);
+    EXPECT_TRUE(entries[1].pending);
+
+    /* The failed batch left the stored copy alone */
+    unsigned char obj1_check[OBJ1_SIZE];
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+    /* Replacing an existing one does, after gc */
+    entries[1].pending = false;
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+    memset(obj1_check, 0, sizeof(obj1_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 1, obj1_check, sizeof(obj1_check)));
+    EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+}
+
+/*
+ * Applying a full vehicle configuration, object by object and as one batch.
+ * Prints the flash traffic and time of both, checks that the batch does less.
+ */
+TEST_F(LogfsTestCooked, BatchFullConfiguration) {
+#define CONFIG_OBJECTS 50
+    static unsigned char config[CONFIG_OBJECTS][OBJ2_SIZE];
+    struct batch_entry entries[CONFIG_OBJECTS];
+
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i++) {
+        memset(config[i], i, sizeof(config[i]));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID + i, 0, config[i], sizeof(config[i])));
+    }
+
+    /* An import changing a fifth of the settings */
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i += 5) {
+        config[i][0] ^= 0xFF;
+    }
+
+    uint32_t bytes_read0 = PIOS_Flash_UT_GetBytesRead(flash_id);
+    uint32_t bytes_written0, bytes_written1, bytes_written2, sectors_erased;
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written0, &sectors_erased);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID + i, 0, config[i], sizeof(config[i])));
+    }
+
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    uint32_t bytes_read1 = PIOS_Flash_UT_GetBytesRead(flash_id);
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written1, &sectors_erased);
+
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i += 5) {
+        config[i][0] ^= 0xFF;
+    }
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i++) {
+        entries[i].obj_id      = OBJ2_ID + i;
+        entries[i].obj_inst_id = 0;
+        entries[i].obj_data    = config[i];
+        entries[i].obj_size    = sizeof(config[i]);
+        entries[i].pending     = true;
+    }
+    struct batch_table table = { entries, CONFIG_OBJECTS };
+    struct PIOS_FLASHFS_ObjBatch batch = batchOf(&table);
+
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveBatch(fs_id, &batch));
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    uint32_t bytes_read2 = PIOS_Flash_UT_GetBytesRead(flash_id);
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written2, &sectors_erased);
+
+    printf("%d objects: one by one %u bytes read %u written %.0f us, batch %u bytes read %u written %.0f us\n",
+           CONFIG_OBJECTS,
+           bytes_read1 - bytes_read0, bytes_written1 - bytes_written0,
+           std::chrono::duration<double, std::micro>(t1 - t0).count(),
+           bytes_read2 - bytes_read1, bytes_written2 - bytes_written1,
+           std::chrono::duration<double, std::micro>(t3 - t2).count());
+
+    EXPECT_LT(bytes_read2 - bytes_read1, (bytes_read1 - bytes_read0) / 4);
+    EXPECT_LT(bytes_written2 - bytes_written1, (bytes_written1 - bytes_written0) / 2);
+
+    for (uint32_t i = 0; i < CONFIG_OBJECTS; i++) {
+        unsigned char check[OBJ2_SIZE];
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID + i, 0, check, sizeof(check)));
+        EXPECT_EQ(0, memcmp(config[i], check, sizeof(check)));
+    }
+#undef CONFIG_OBJECTS
+}
+
+/* Overwrite instance 0 until the log has no free slots left */
+static void fillLog(uintptr_t fs_id, unsigned char *obj, uint16_t obj_size)
+{
+    struct PIOS_FLASHFS_Stats stats;
+
+    do {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj, obj_size));
+        EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    } while (stats.num_free_slots > 0);
+}
+
+TEST_F(LogfsTestCooked, CompactionNeedsSeveralSectors) {
+    /* Partition a arenas are a single sector */
+    EXPECT_EQ(-3, PIOS_FLASHFS_Logfs_EnableCompaction(fs_id));
+    EXPECT_EQ(-1, PIOS_FLASHFS_Logfs_EnableCompaction(fs_id + 1));
+}
+
+TEST_F(LogfsTestRaw, CompactionSingleSectorAsyncErase) {
+    /* Like an external flash, the single sector erase is left to the device */
+    struct pios_flash_driver async_driver = pios_ut_flash_driver;
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+
+    async_driver.async_erase = true;
+    EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_a, &async_driver, flash_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_EnableCompaction(fs_id));
+    PIOS_DEBUGLOG_UT_RunCallback(CALLBACKINFO_RUNNING_FLASHFS);
+
+    for (uint32_t i = 0; i < 240; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, obj1, sizeof(obj1)));
+    }
+
+    /* The whole arena is erased in one step, then the slots are copied a few at a time */
+    EXPECT_LT(2u, PIOS_DEBUGLOG_UT_RunCallback(CALLBACKINFO_RUNNING_FLASHFS));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(10, stats.num_active_slots);
+    EXPECT_EQ(255 - 10, stats.num_free_slots);
+
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    PIOS_Flash_UT_Destroy(flash_id);
+}
+
+/* Compaction runs on the arenas of 16 small sectors of partition c */
+class LogfsTestCompact : public LogfsTestRaw {
+protected:
+    virtual void SetUp()
+    {
+        /* First, we need to set up the super fixture (LogfsTestRaw) */
+        LogfsTestRaw::SetUp();
+
+        EXPECT_EQ(0, PIOS_Flash_UT_Init(&flash_id, &flash_config_small_sectors));
+        EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_c, &pios_ut_flash_driver, flash_id));
+    }
+
+    virtual void TearDown()
+    {
+        PIOS_FLASHFS_Logfs_Destroy(fs_id);
+        PIOS_Flash_UT_Destroy(flash_id);
+    }
+
+    uintptr_t flash_id;
+    uintptr_t fs_id;
+};
+
+TEST_F(LogfsTestCompact, CompactOnlyWhenWorthIt) {
+    struct PIOS_FLASHFS_Stats stats;
+
+    /* Plenty of free slots left */
+    for (uint32_t i = 0; i < 20; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, obj1, sizeof(obj1)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Compact(fs_id, 4));
+
+    /* Nearly full, but less than half of it obsolete */
+    for (uint32_t i = 10; i < 150; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+    }
+    for (uint32_t i = 0; i < 90; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1_alt, sizeof(obj1_alt)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(150, stats.num_active_slots);
+    EXPECT_EQ(255 - 250, stats.num_free_slots);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Compact(fs_id, 4));
+
+    EXPECT_EQ(-1, PIOS_FLASHFS_Logfs_Compact(fs_id + 1, 4));
+}
+
+TEST_F(LogfsTestCompact, CompactInBackground) {
+    struct PIOS_FLASHFS_Stats stats;
+
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_EnableCompaction(fs_id));
+    PIOS_DEBUGLOG_UT_RunCallback(CALLBACKINFO_RUNNING_FLASHFS);
+
+    /* The saves wake up the compaction once the log is nearly full of obsolete slots */
+    for (uint32_t i = 0; i < 240; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i % 10, (i < 230) ? obj1 : obj1_alt, sizeof(obj1)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(10, stats.num_active_slots);
+    EXPECT_EQ(255 - 240, stats.num_free_slots);
+
+    /* Erase sector by sector, reserve, a few slots per step, switch arenas */
+    EXPECT_LT(16u, PIOS_DEBUGLOG_UT_RunCallback(CALLBACKINFO_RUNNING_FLASHFS));
+
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(10, stats.num_active_slots);
+    EXPECT_EQ(255 - 10, stats.num_free_slots);
+
+    for (uint16_t i = 0; i < 10; i++) {
+        unsigned char obj1_check[OBJ1_SIZE];
+        memset(obj1_check, 0, sizeof(obj1_check));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+        EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_check)));
+    }
+
+    /* Nothing left to do */
+    EXPECT_EQ(0u, PIOS_DEBUGLOG_UT_RunCallback(CALLBACKINFO_RUNNING_FLASHFS));
+}
+
+TEST_F(LogfsTestCompact, CompactInterleaved) {
+#define INSTANCES 20
+    uint8_t version[INSTANCES];
+    bool deleted[INSTANCES];
+    unsigned char obj[OBJ1_SIZE];
+    struct PIOS_FLASHFS_Stats stats;
+
+    for (uint16_t i = 0; i < INSTANCES; i++) {
+        version[i] = 0;
+        deleted[i] = false;
+        memset(obj, version[i] + i, sizeof(obj));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj, sizeof(obj)));
+    }
+    /* Mostly obsolete log */
+    for (uint32_t n = 0; n < 215; n++) {
+        uint16_t i = n % INSTANCES;
+        memset(obj, ++version[i] + i, sizeof(obj));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj, sizeof(obj)));
+    }
+
+    /*
+     * Keep changing the objects while the compaction copies them, both
+     * ahead of the copy cursor and behind it.
+     */
+    uint32_t steps = 0;
+    int32_t rc;
+    while ((rc = PIOS_FLASHFS_Logfs_Compact(fs_id, 8)) > 0) {
+        uint16_t i = (steps * 7) % INSTANCES;
+        if (steps % 5 == 4) {
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, i));
+            deleted[i] = true;
+        } else {
+            memset(obj, ++version[i] + i, sizeof(obj));
+            EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj, sizeof(obj)));
+            deleted[i] = false;
+        }
+        steps++;
+    }
+    EXPECT_EQ(0, rc);
+    EXPECT_LT((uint32_t)INSTANCES, steps);
+
+    /* Exactly one version of each live instance made it across */
+    uint16_t live = 0;
+    for (uint16_t i = 0; i < INSTANCES; i++) {
+        unsigned char check[OBJ1_SIZE];
+        if (deleted[i]) {
+            EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, check, sizeof(check)));
+            continue;
+        }
+        live++;
+        memset(obj, version[i] + i, sizeof(obj));
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, check, sizeof(check)));
+        EXPECT_EQ(0, memcmp(obj, check, sizeof(check)));
+    }
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(live, stats.num_active_slots);
+    EXPECT_LT(200, stats.num_free_slots);
+
+    /* The new arena mounts the same after a restart */
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_partition_c, &pios_ut_flash_driver, flash_id));
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(live, stats.num_active_slots);
+#undef INSTANCES
+}
+
+TEST_F(LogfsTestCompact, CompactFinishedBySave) {
+    for (uint16_t i = 1; i < 50; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, i, obj3, sizeof(obj3)));
+    }
+    fillLog(fs_id, obj3, sizeof(obj3));
+
+    /* Part way through the copy, past the 16 sector erases and the reserve */
+    for (uint32_t n = 0; n < 20; n++) {
+        EXPECT_EQ(1, PIOS_FLASHFS_Logfs_Compact(fs_id, 4));
+    }
+
+    /* The log is full, the save has to complete the compaction itself */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Compact(fs_id, 4));
+
+    struct PIOS_FLASHFS_Stats stats;
+    EXPECT_EQ(0, PIOS_FLASHFS_GetStats(fs_id, &stats));
+    EXPECT_EQ(51, stats.num_active_slots);
+    EXPECT_EQ(255 - 51, stats.num_free_slots);
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    for (uint16_t i = 0; i < 50; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, i, obj3_check, sizeof(obj3_check)));
+        EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3_check)));
+    }
+}
+
+/* Sector erases and whole slots written on the flash since the last call */
+static void flashWork(uintptr_t flash_id, uint32_t *sectors, uint32_t *slots)
+{
+    static uint32_t last_bytes_written, last_sectors_erased;
+    uint32_t bytes_written, sectors_erased;
+
+    PIOS_Flash_UT_GetWear(flash_id, &bytes_written, &sectors_erased);
+    *sectors = sectors_erased - last_sectors_erased;
+    *slots   = (bytes_written - last_bytes_written) / flashfs_config_partition_c.slot_size;
+    last_bytes_written  = bytes_written;
+    last_sectors_erased = sectors_erased;
+}
+
+/*
+ * Worst case work one call does on the flash, garbage collecting a log of 100
+ * live objects all at once in PIOS_FLASHFS_ObjSave() against one step of the
+ * incremental compaction.  The objects fill their slots, so the bytes written
+ * count the slot copies, the small header updates are rounded away.
+ */
+TEST_F(LogfsTestCompact, CompactLatency) {
+#define LIVE_OBJECTS 100
+    uint32_t sectors, slots;
+
+    for (uint16_t i = 1; i < LIVE_OBJECTS; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, i, obj3, sizeof(obj3)));
+    }
+    fillLog(fs_id, obj3, sizeof(obj3));
+
+    flashWork(flash_id, &sectors, &slots);
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    uint32_t blocking_sectors, blocking_slots;
+    flashWork(flash_id, &blocking_sectors, &blocking_slots);
+
+    /* The whole arena, the other live objects and the new version */
+    EXPECT_EQ(16u, blocking_sectors);
+    EXPECT_EQ((uint32_t)LIVE_OBJECTS, blocking_slots);
+
+    /* Same log again, compacted in steps */
+    EXPECT_EQ(0, PIOS_FLASHFS_Format(fs_id));
+    for (uint16_t i = 1; i < LIVE_OBJECTS; i++) {
+        EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, i, obj3, sizeof(obj3)));
+    }
+    fillLog(fs_id, obj3, sizeof(obj3));
+
+    uint32_t steps = 0, step_sectors = 0, step_slots = 0;
+    int32_t rc;
+    flashWork(flash_id, &sectors, &slots);
+    do {
+        rc = PIOS_FLASHFS_Logfs_Compact(fs_id, 4);
+        flashWork(flash_id, &sectors, &slots);
+
+        /* A step either erases a sector or copies a few slots */
+        EXPECT_TRUE(sectors == 0 || slots == 0);
+        step_sectors = std::max(step_sectors, sectors);
+        step_slots   = std::max(step_slots, slots);
+        steps++;
+    } while (rc > 0);
+    EXPECT_EQ(0, rc);
+
+    printf("%d objects: blocking gc %u sector erases + %u slot writes, incremental %u steps worst %u sector erases or %u slot writes\n",
+           LIVE_OBJECTS, blocking_sectors, blocking_slots, steps, step_sectors, step_slots);
+
+    EXPECT_EQ(1u, step_sectors);
+    EXPECT_EQ(4u, step_slots);
+
+    /* A save now only appends */
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+    flashWork(flash_id, &sectors, &slots);
+    EXPECT_EQ(0u, sectors);
+    EXPECT_EQ(1u, slots);
+#undef LIVE_OBJECTS
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
     virtual void SetUp()
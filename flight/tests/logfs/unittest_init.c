@@ -11,6 +11,12 @@ const struct pios_flash_ut_cfg flash_config = {
     .size_of_sector = 0x00010000,
 };
 
+/* Same flash seen with small erase sectors, for partition c */
+const struct pios_flash_ut_cfg flash_config_small_sectors = {
+    .size_of_flash  = 0x00100000,
+    .size_of_sector = 0x00001000,
+};
+
 #include "pios_flashfs_logfs_priv.h"
 
 const struct flashfs_logfs_cfg flashfs_config_partition_a = {
@@ -34,3 +40,14 @@ const struct flashfs_logfs_cfg flashfs_config_partition_b = {
     .sector_size   = 0x00010000, /* 64K bytes */
     .page_size     = 0x00000100, /* 256 bytes */
 };
+
+const struct flashfs_logfs_cfg flashfs_config_partition_c = {
+    .fs_magic      = 0x89abcdef,
+    .total_fs_size = 0x00040000, /* 256K bytes (4 arenas) */
+    .arena_size    = 0x00010000, /* 256 * slot size = 16 sectors */
+    .slot_size     = 0x00000100, /* 256 bytes */
+
+    .start_offset  = 0,          /* start at the beginning of the chip */
+    .sector_size   = 0x00001000, /* 4K bytes */
+    .page_size     = 0x00000100, /* 256 bytes */
+};
@@ -0,0 +1,215 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <math.h>
+#include <float.h> /* FLT_MAX */
+#include <chrono>
+
+extern "C" {
+#include "fastmath.h"
+#include "sin_lookup.h"
+#include <inc/CoordinateConversions.h>
+}
+
+// the bounds documented in fastmath.h
+#define epsilon_sin   3e-7
+#define epsilon_atan2 6e-7
+#define epsilon_asin  6e-7
+
+// attitude in degrees, against the libm version and after a round trip
+#define epsilon_rpy   1e-4f
+#define epsilon_roundtrip 2e-3f // asin() amplifies the rounding of q close to +-90 pitch
+
+class FastMathTest : public testing::Test {};
+
+// Quaternion2RPY() as it was with libm
+static void Quaternion2RPYlibm(const float q[4], float rpy[3])
+{
+    float q0s = q[0] * q[0];
+    float q1s = q[1] * q[1];
+    float q2s = q[2] * q[2];
+    float q3s = q[3] * q[3];
+
+    rpy[1] = RAD2DEG(asinf(-2.0f * (q[1] * q[3] - q[0] * q[2])));
+    rpy[2] = RAD2DEG(atan2f(2.0f * (q[1] * q[2] + q[0] * q[3]), q0s + q1s - q2s - q3s));
+    rpy[0] = RAD2DEG(atan2f(2.0f * (q[2] * q[3] + q[0] * q[1]), q0s - q1s - q2s + q3s));
+}
+
+// difference of two angles, wrapped to [-pi, pi]
+static double angleError(double a, double b)
+{
+    double e = fabs(a - b);
+
+    return (e > M_PI) ? fabs(e - 2.0 * M_PI) : e;
+}
+
+TEST_F(FastMathTest, SinCos) {
+    double maxSin = 0.0, maxCos = 0.0, maxSinCos = 0.0;
+    float maxAbs  = 0.0f;
+
+    for (int i = -2000000; i <= 2000000; i++) {
+        float x = i * 5e-3f; // +-1e4 rad
+        float s, c;
+
+        fast_sincosf(x, &s, &c);
+        maxSin    = fmax(maxSin, fabs(fast_sinf(x) - sin((double)x)));
+        maxCos    = fmax(maxCos, fabs(fast_cosf(x) - cos((double)x)));
+        maxSinCos = fmax(maxSinCos, fmax(fabs(s - sin((double)x)), fabs(c - cos((double)x))));
+        maxAbs    = fmaxf(maxAbs, fmaxf(fabsf(s), fabsf(c)));
+    }
+    printf("sin %.3g cos %.3g sincos %.3g\n", maxSin, maxCos, maxSinCos);
+    EXPECT_LT(maxSin, epsilon_sin);
+    EXPECT_LT(maxCos, epsilon_sin);
+    EXPECT_LT(maxSinCos, epsilon_sin);
+
+    // never beyond +-1, callers take acosf() of products of these
+    EXPECT_LE(maxAbs, 1.0f);
+    EXPECT_EQ(0.0f, fast_sinf(0.0f));
+    EXPECT_NEAR(1.0f, fast_cosf(0.0f), epsilon_sin);
+}
+
+TEST_F(FastMathTest, SinCosOutOfRange) {
+    // beyond the int32 range of the turn count, the reduction falls back to fmodf
+    float big[] = { 3e9f, -3e9f, 1e30f, -1e30f, FLT_MAX };
+
+    for (unsigned int i = 0; i < sizeof(big) / sizeof(big[0]); i++) {
+        float x = fmodf(big[i], M_2PI_F);
+        EXPECT_NEAR(sinf(x), fast_sinf(big[i]), epsilon_sin);
+        EXPECT_NEAR(cosf(x), fast_cosf(big[i]), epsilon_sin);
+    }
+
+    // NaN in and out, as from sinf()
+    EXPECT_TRUE(isnan(fast_sinf(NAN)));
+    EXPECT_TRUE(isnan(fast_cosf(NAN)));
+    EXPECT_TRUE(isnan(fast_sinf(INFINITY)));
+    EXPECT_TRUE(isnan(fast_cosf(-INFINITY)));
+    EXPECT_TRUE(isnan(sin_lookup_deg(NAN)));
+}
+
+TEST_F(FastMathTest, Atan2) {
+    double maxError = 0.0;
+
+    for (int i = 0; i < 1000000; i++) {
+        double t = i * (2.0 * M_PI / 1000000) - M_PI;
+        float r  = 1e-3f + (i % 7) * 37.0f;
+        float y  = (float)(r * sin(t));
+        float x  = (float)(r * cos(t));
+        maxError = fmax(maxError, angleError(fast_atan2f(y, x), atan2((double)y, (double)x)));
+    }
+    printf("atan2 %.3g\n", maxError);
+    EXPECT_LT(maxError, epsilon_atan2);
+
+    // axes and the origin
+    EXPECT_NEAR(0.0f, fast_atan2f(0.0f, 1.0f), epsilon_atan2);
+    EXPECT_NEAR(M_PI_2_F, fast_atan2f(1.0f, 0.0f), epsilon_atan2);
+    EXPECT_NEAR(M_PI_F, fast_atan2f(0.0f, -1.0f), epsilon_atan2);
+    EXPECT_NEAR(-M_PI_2_F, fast_atan2f(-1.0f, 0.0f), epsilon_atan2);
+    EXPECT_EQ(0.0f, fast_atan2f(0.0f, 0.0f));
+}
+
+TEST_F(FastMathTest, Asin) {
+    double maxError = 0.0;
+
+    for (int i = -1000000; i <= 1000000; i++) {
+        float x = i * 1e-6f;
+        maxError = fmax(maxError, fabs(fast_asinf(x) - asin((double)x)));
+    }
+    printf("asin %.3g\n", maxError);
+    EXPECT_LT(maxError, epsilon_asin);
+
+    // rounding just outside the domain must not give NaN
+    EXPECT_NEAR(M_PI_2_F, fast_asinf(1.0000001f), epsilon_asin);
+    EXPECT_NEAR(-M_PI_2_F, fast_asinf(-1.0000001f), epsilon_asin);
+}
+
+TEST_F(FastMathTest, SinLookup) {
+    sin_lookup_initalize();
+
+    for (float deg = -720.0f; deg <= 720.0f; deg += 0.25f) {
+        EXPECT_NEAR(sin(deg * M_PI / 180.0), sin_lookup_deg(deg), 1e-6);
+        EXPECT_NEAR(cos(deg * M_PI / 180.0), cos_lookup_deg(deg), 1e-6);
+        EXPECT_NEAR(sin(deg * M_PI / 180.0), sin_lookup_rad(DEG2RAD(deg)), 1e-6);
+        EXPECT_NEAR(cos(deg * M_PI / 180.0), cos_lookup_rad(DEG2RAD(deg)), 1e-6);
+    }
+}
+
+TEST_F(FastMathTest, QuaternionRPY) {
+    for (float roll = -179.0f; roll < 180.0f; roll += 17.0f) {
+        for (float pitch = -89.0f; pitch < 90.0f; pitch += 11.0f) {
+            for (float yaw = -179.0f; yaw < 180.0f; yaw += 23.0f) {
+                float rpy[3] = { roll, pitch, yaw };
+                float q[4], out[3], ref[3];
+
+                RPY2Quaternion(rpy, q);
+
+                // against the same formulas in double precision
+                double phi = roll * M_PI / 360.0, theta = pitch * M_PI / 360.0, psi = yaw * M_PI / 360.0;
+                double q0  = cos(phi) * cos(theta) * cos(psi) + sin(phi) * sin(theta) * sin(psi);
+                double q1  = sin(phi) * cos(theta) * cos(psi) - cos(phi) * sin(theta) * sin(psi);
+                EXPECT_NEAR(fabs(q0), q[0], 1e-6);
+                EXPECT_NEAR(q0 < 0 ? -q1 : q1, q[1], 1e-6);
+
+                Quaternion2RPY(q, out);
+                Quaternion2RPYlibm(q, ref);
+                for (int k = 0; k < 3; k++) {
+                    EXPECT_NEAR(ref[k], out[k], epsilon_rpy);
+                    EXPECT_NEAR(rpy[k], out[k], epsilon_roundtrip);
+                }
+            }
+        }
+    }
+
+    // a slightly denormalised quaternion at 90 degrees pitch used to give NaN
+    float q[4] = { 0.70710683f, 0.0f, 0.70710683f, 0.0f };
+    float rpy[3];
+    Quaternion2RPY(q, rpy);
+    EXPECT_NEAR(90.0f, rpy[1], 0.01f);
+}
+
+/*
+ * Not a pass/fail test, prints the cost per call next to the libm functions.
+ * On the host libm is well optimised, the gain is on the F4 where newlib
+ * computes sinf/cosf/atan2f in software double precision.
+ */
+TEST_F(FastMathTest, Benchmark) {
+    const int count = 1000000;
+    volatile float sink;
+    float sum;
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    sum = 0.0f;
+    for (int i = 0; i < count; i++) {
+        float x = i * 1e-5f;
+        sum += sinf(x) + cosf(x);
+    }
+    sink = sum;
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    sum  = 0.0f;
+    for (int i = 0; i < count; i++) {
+        float s, c;
+        fast_sincosf(i * 1e-5f, &s, &c);
+        sum += s + c;
+    }
+    sink = sum;
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    sum  = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += atan2f(1.0f - i * 2e-6f, 0.5f);
+    }
+    sink = sum;
+    std::chrono::steady_clock::time_point t3 = std::chrono::steady_clock::now();
+    sum  = 0.0f;
+    for (int i = 0; i < count; i++) {
+        sum += fast_atan2f(1.0f - i * 2e-6f, 0.5f);
+    }
+    sink = sum;
+    std::chrono::steady_clock::time_point t4 = std::chrono::steady_clock::now();
+    (void)sink;
+
+    printf("sinf+cosf %.1f ns, fast_sincosf %.1f ns, atan2f %.1f ns, fast_atan2f %.1f ns\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / count,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / count,
+           std::chrono::duration<double, std::nano>(t3 - t2).count() / count,
+           std::chrono::duration<double, std::nano>(t4 - t3).count() / count);
+}
@@ -0,0 +1,10 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+/* Just what sin_lookup.c needs */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#endif /* OPENPILOT_H */
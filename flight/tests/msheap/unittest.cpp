@@ -0,0 +1,240 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <time.h> /* clock */
+#include <vector>
+
+extern "C" {
+#include "msheap.h"
+#include "mspool.h"
+}
+
+#define HEAP_SIZE     (96 * 1024)
+#define STARTUP_ALLOC 300
+#define CHURN_OPS     200000
+#define CHURN_LIVE    48
+
+// Allocation trace modelled on a simposix boot: UAVObject instances,
+// queues, callbacks and task stacks allocated once at startup, followed by
+// event entries, callback and telemetry buffers allocated and freed in flight
+struct TraceOp {
+    bool     alloc;
+    uint32_t size; // alloc: bytes, free: index of the allocation
+};
+
+static uint32_t nextRandom(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static uint32_t startupSize(uint32_t & state)
+{
+    static const uint32_t small[] = { 12, 16, 20, 24, 28, 36, 44, 52, 64, 76, 100, 120 };
+    uint32_t r = nextRandom(state) % 100;
+
+    if (r < 75) {
+        return small[nextRandom(state) % (sizeof(small) / sizeof(small[0]))];
+    } else if (r < 95) {
+        return 160 + nextRandom(state) % 480; // queue storage, larger UAVObjects
+    }
+    return 1024 + nextRandom(state) % 2048; // task stacks
+}
+
+static uint32_t churnSize(uint32_t & state)
+{
+    static const uint32_t sizes[] = { 12, 16, 16, 20, 24, 24, 32, 40, 64, 96 };
+
+    return sizes[nextRandom(state) % (sizeof(sizes) / sizeof(sizes[0]))];
+}
+
+static std::vector<TraceOp> buildTrace()
+{
+    std::vector<TraceOp> trace;
+    std::vector<uint32_t> live;
+    uint32_t state = 0x12345678;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < STARTUP_ALLOC; i++) {
+        trace.push_back({ true, startupSize(state) });
+        // some of the startup allocations are temporary
+        if (nextRandom(state) % 8 == 0) {
+            live.push_back(count);
+        }
+        count++;
+    }
+    for (uint32_t i = 0; i < live.size(); i++) {
+        trace.push_back({ false, live[i] });
+    }
+    live.clear();
+    for (uint32_t i = 0; i < CHURN_OPS; i++) {
+        if (live.size() < CHURN_LIVE && (live.empty() || nextRandom(state) % 2)) {
+            trace.push_back({ true, churnSize(state) });
+            live.push_back(count++);
+        } else {
+            uint32_t n = nextRandom(state) % live.size();
+            trace.push_back({ false, live[n] });
+            live[n] = live.back();
+            live.pop_back();
+        }
+    }
+    return trace;
+}
+
+struct ReplayStats {
+    double   opsPerSec;
+    uint32_t freeSpace;
+    uint32_t largestFree;
+    uint32_t heapOps; // allocations and frees that went to the heap
+    bool     failed;
+};
+
+class MsHeapTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        memory.assign(HEAP_SIZE, 0);
+        msheap_init(&heap, &memory[0], &memory[0] + HEAP_SIZE);
+        mspool_init(&pool, &heap);
+    }
+
+    // same policy as pios_general_malloc()
+    void *alloc(uint32_t size, bool pooled)
+    {
+        void *p = pooled ? mspool_alloc(&pool, size) : NULL;
+
+        if (!p) {
+            p = msheap_alloc(&heap, NULL, size);
+            heapOps++;
+        }
+        return p;
+    }
+
+    void release(void *p)
+    {
+        if (mspool_owns(p)) {
+            mspool_free(&pool, p);
+        } else {
+            msheap_free(&heap, p);
+            heapOps++;
+        }
+    }
+
+    ReplayStats replay(const std::vector<TraceOp> & trace, bool pooled)
+    {
+        ReplayStats stats;
+        std::vector<void *> pointers;
+
+        stats.failed = false;
+        heapOps = 0;
+        clock_t start = clock();
+        for (uint32_t i = 0; i < trace.size(); i++) {
+            if (trace[i].alloc) {
+                void *p = alloc(trace[i].size, pooled);
+                stats.failed |= !p;
+                pointers.push_back(p);
+            } else if (pointers[trace[i].size]) {
+                release(pointers[trace[i].size]);
+            }
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        stats.opsPerSec   = elapsed > 0 ? trace.size() / elapsed : 0;
+        stats.freeSpace   = msheap_free_space(&heap);
+        stats.largestFree = msheap_largest_free(&heap);
+        stats.heapOps     = heapOps;
+        return stats;
+    }
+
+    std::vector<uint8_t> memory;
+    heap_handle_t heap;
+    mspool_handle_t pool;
+    uint32_t heapOps;
+};
+
+TEST_F(MsHeapTest, LargestFree) {
+    EXPECT_EQ(msheap_free_space(&heap) - 4, msheap_largest_free(&heap));
+
+    void *a = msheap_alloc(&heap, NULL, 100);
+    void *b = msheap_alloc(&heap, NULL, 100);
+    msheap_free(&heap, a);
+    // the free region before b is smaller than the one after it
+    EXPECT_LT(msheap_largest_free(&heap), msheap_free_space(&heap) - 100);
+    msheap_free(&heap, b);
+    EXPECT_EQ(msheap_free_space(&heap) - 4, msheap_largest_free(&heap));
+}
+
+TEST_F(MsHeapTest, PoolBlocks) {
+    std::vector<void *> blocks;
+
+    for (uint32_t size = 1; size <= MSPOOL_MAX_SIZE; size++) {
+        void *p = mspool_alloc(&pool, size);
+        ASSERT_TRUE(p != NULL);
+        EXPECT_TRUE(mspool_owns(p));
+        EXPECT_GE(mspool_size(&pool, p), size);
+        EXPECT_EQ(0u, (uintptr_t)p % MSPOOL_ALIGN);
+        memset(p, size, size);
+        blocks.push_back(p);
+    }
+    EXPECT_TRUE(mspool_alloc(&pool, 0) == NULL);
+    EXPECT_TRUE(mspool_alloc(&pool, MSPOOL_MAX_SIZE + 1) == NULL);
+
+    // blocks must not overlap each other or the heap markers
+    for (uint32_t size = 1; size <= MSPOOL_MAX_SIZE; size++) {
+        uint8_t *p = (uint8_t *)blocks[size - 1];
+        for (uint32_t i = 0; i < size; i++) {
+            ASSERT_EQ(size, p[i]);
+        }
+    }
+    EXPECT_EQ(1, msheap_check(&heap));
+
+    void *large = msheap_alloc(&heap, NULL, 200);
+    EXPECT_FALSE(mspool_owns(large));
+
+    struct mspool_stats stats = { 0, 0, 0 };
+    mspool_get_stats(&pool, &stats);
+    EXPECT_GT(stats.used, 0u);
+    EXPECT_GE(stats.reserved, stats.used);
+
+    // freed blocks are reused first
+    void *last = blocks.back();
+    mspool_free(&pool, last);
+    EXPECT_EQ(last, mspool_alloc(&pool, MSPOOL_MAX_SIZE));
+
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+        mspool_free(&pool, blocks[i]);
+    }
+    memset(&stats, 0, sizeof(stats));
+    mspool_get_stats(&pool, &stats);
+    EXPECT_EQ(0u, stats.used);
+    EXPECT_GT(stats.high_water, 0u);
+    EXPECT_EQ(1, msheap_check(&heap));
+}
+
+TEST_F(MsHeapTest, TraceReplay) {
+    std::vector<TraceOp> trace = buildTrace();
+
+    ReplayStats plain  = replay(trace, false);
+    EXPECT_FALSE(plain.failed);
+    EXPECT_EQ(1, msheap_check(&heap));
+
+    SetUp();
+    ReplayStats pooled = replay(trace, true);
+    EXPECT_FALSE(pooled.failed);
+    EXPECT_EQ(1, msheap_check(&heap));
+
+    struct mspool_stats stats = { 0, 0, 0 };
+    mspool_get_stats(&pool, &stats);
+
+    printf("heap only : %.0f ops/s, %u heap operations, %u bytes free, largest free block %u\n",
+           plain.opsPerSec, plain.heapOps, plain.freeSpace, plain.largestFree);
+    printf("with pools: %.0f ops/s, %u heap operations, %u bytes free, largest free block %u, pools %u bytes reserved, %u used, %u high water\n",
+           pooled.opsPerSec, pooled.heapOps, pooled.freeSpace, pooled.largestFree, stats.reserved, stats.used, stats.high_water);
+
+    // once the slabs are carved, the in flight churn does not search the heap anymore
+    EXPECT_LT(pooled.heapOps * 100, plain.heapOps);
+    EXPECT_LE(stats.high_water, stats.reserved);
+}
@@ -0,0 +1,17 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* PIOS Feature Selection */
+#include "pios_config.h"
+
+/* Frame buffer geometry, as in pios_video.h for PAL */
+#define GRAPHICS_HDEADBAND   80
+#define GRAPHICS_VDEADBAND   0
+#define GRAPHICS_WIDTH_REAL  416
+#define GRAPHICS_HEIGHT_REAL (270 + GRAPHICS_VDEADBAND)
+#define GRAPHICS_BOTTOM      (GRAPHICS_HEIGHT_REAL - GRAPHICS_VDEADBAND - 1)
+#define GRAPHICS_RIGHT       (GRAPHICS_WIDTH_REAL - GRAPHICS_HDEADBAND - 1)
+#define GRAPHICS_WIDTH       (GRAPHICS_WIDTH_REAL / 8)
+#define GRAPHICS_HEIGHT      GRAPHICS_HEIGHT_REAL
+
+#endif /* PIOS_H */
@@ -0,0 +1,4 @@
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+#endif /* PIOS_CONFIG_H */
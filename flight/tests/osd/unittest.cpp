@@ -0,0 +1,357 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+#include <math.h> /* sinf */
+#include <time.h> /* clock */
+#include <vector>
+
+extern "C" {
+#include "osdgen.h"
+#include "font12x18.h"
+#include "font8x10.h"
+
+uint8_t *draw_buffer_level;
+uint8_t *draw_buffer_mask;
+uint8_t *disp_buffer_level;
+uint8_t *disp_buffer_mask;
+}
+
+#define BUFFER_SIZE  (GRAPHICS_WIDTH * GRAPHICS_HEIGHT)
+#define FRAMES       200
+#define BENCH_FRAMES 1000
+
+// Widget ids of the test HUD
+#define HUD_ATTITUDE 0
+#define HUD_SPEED    1
+#define HUD_ALTITUDE 2
+#define HUD_HEADING  3
+#define HUD_TEXT     4
+
+struct Frame {
+    std::vector<uint8_t> level;
+    std::vector<uint8_t> mask;
+};
+
+static void drawText(uint8_t id, const char *text, int x, int y, int ha, int font)
+{
+    char str[32];
+
+    strncpy(str, text, sizeof(str) - 1);
+    str[sizeof(str) - 1] = 0;
+    write_string_widget(id, str, x, y, TEXT_VA_TOP, ha, font);
+}
+
+static void drawScale(int value, int x, int y, int side)
+{
+    char temp[16];
+
+    write_vline_lm(x, y - 50, y + 50, 1, 1);
+    for (int v = value - 50 - (value % 10); v <= value + 50; v += 10) {
+        int yy = y + value - v;
+        if (yy > y - 50 && yy < y + 50) {
+            write_hline_lm(x, x + side * ((v % 50) ? 5 : 10), yy, 1, 1);
+        }
+    }
+    write_filled_rectangle_lm(side > 0 ? x + 12 : x - 44, y - 6, 32, 12, 0, 1);
+    sprintf(temp, "%d", value);
+    write_string(temp, x + side * 14, y - 5, 0, 0, TEXT_VA_TOP, side > 0 ? TEXT_HA_LEFT : TEXT_HA_RIGHT, 0, 2);
+}
+
+static void drawAttitudeIndicator(int16_t pitch, int16_t roll, int cx, int cy)
+{
+    float s = sinf(roll * 3.14159265f / 180.0f), c = cosf(roll * 3.14159265f / 180.0f);
+
+    for (int p = -20; p <= 20; p += 10) {
+        int offset = (p - pitch) * 2;
+        int len    = p ? 20 : 48;
+        int x0     = cx - len * c - offset * s, y0 = cy - len * s + offset * c;
+        int x1     = cx + len * c - offset * s, y1 = cy + len * s + offset * c;
+        if (y0 > 10 && y1 > 10 && y0 < GRAPHICS_BOTTOM - 10 && y1 < GRAPHICS_BOTTOM - 10) {
+            write_line_outlined(x0, y0, x1, y1, 2, 2, 0, 1);
+        }
+    }
+    write_circle_outlined(cx, cy, 4, 0, 0, 0, 1);
+}
+
+static void drawCompass(int heading, int x, int y)
+{
+    char temp[8];
+
+    write_hline_lm(x - 60, x + 60, y, 1, 1);
+    for (int h = heading - 60 - (heading % 15); h <= heading + 60; h += 15) {
+        int xx = x + h - heading;
+        if (xx > x - 60 && xx < x + 60) {
+            write_vline_lm(xx, y - ((h % 45) ? 4 : 8), y, 1, 1);
+        }
+    }
+    sprintf(temp, "%03d", (heading + 360) % 360);
+    write_string(temp, x, y + 4, 0, 0, TEXT_VA_TOP, TEXT_HA_CENTER, 0, 3);
+}
+
+// Characters drawn word by word, as before the glyph cache
+static void referenceChar(uint8_t ch, unsigned int x, unsigned int y, int flags, int font)
+{
+    struct FontEntry font_info;
+    char lookup = 0;
+
+    if (!fetch_font_info(ch, font, &font_info, font < 2 ? &lookup : NULL)) {
+        return;
+    }
+    unsigned int addr   = CALC_BUFF_ADDR(x, y);
+    unsigned int wbit   = CALC_BIT_IN_WORD(x);
+    unsigned int xshift = 16 - font_info.width;
+    for (unsigned int yy = 0; yy < font_info.height; yy++) {
+        uint16_t or_mask, and_mask, levels;
+        if (font == 3) {
+            unsigned int row = ch * font_info.height + yy;
+            levels   = ~font_frame12x18[row];
+            or_mask  = font_mask12x18[row] << xshift;
+            and_mask = (font_mask12x18[row] & levels) << xshift;
+        } else if (font == 2) {
+            unsigned int row = ch * font_info.height + yy;
+            levels   = ~font_frame8x10[row];
+            or_mask  = font_mask8x10[row] << xshift;
+            and_mask = (font_mask8x10[row] & levels) << xshift;
+        } else {
+            unsigned int row = lookup * font_info.height * 2 + yy;
+            levels = font_info.data[row + font_info.height];
+            if (!(flags & FONT_INVERT)) {
+                levels = ~levels;
+            }
+            or_mask  = font_info.data[row] << xshift;
+            and_mask = (font_info.data[row] & levels) << xshift;
+        }
+        write_word_misaligned_OR(draw_buffer_mask, or_mask, addr, wbit);
+        write_word_misaligned_OR(draw_buffer_level, or_mask, addr, wbit);
+        write_word_misaligned_NAND(draw_buffer_level, and_mask, addr, wbit);
+        addr += GRAPHICS_WIDTH_REAL / 8;
+    }
+}
+
+// A standard HUD: attitude, speed and altitude scales, compass, text lines and
+// a crosshair drawn in immediate mode. Values change like in a slow flight.
+static void drawHud(uint32_t frame)
+{
+    float t = frame * 0.04f;
+    int16_t pitch = 10.0f * sinf(0.7f * t);
+    int16_t roll  = 25.0f * sinf(t);
+    int speed     = 12 + frame / 50;
+    int altitude  = 100 + frame / 20;
+    int heading   = (frame / 8) % 360;
+    char temp[32];
+
+    write_hline_lm(APPLY_HDEADBAND(GRAPHICS_RIGHT / 2 - 6), APPLY_HDEADBAND(GRAPHICS_RIGHT / 2 + 6), GRAPHICS_BOTTOM / 2, 1, 1);
+    write_vline_lm(APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), GRAPHICS_BOTTOM / 2 - 6, GRAPHICS_BOTTOM / 2 + 6, 1, 1);
+
+    int32_t attitudeKey[] = { pitch, roll };
+    if (osd_render_widget_begin_values(HUD_ATTITUDE, attitudeKey, 2)) {
+        drawAttitudeIndicator(pitch, roll, APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), GRAPHICS_BOTTOM / 2);
+    }
+    osd_render_widget_end();
+    int32_t speedKey[] = { speed };
+    if (osd_render_widget_begin_values(HUD_SPEED, speedKey, 1)) {
+        drawScale(speed, APPLY_HDEADBAND(50), GRAPHICS_BOTTOM / 2, -1);
+    }
+    osd_render_widget_end();
+    int32_t altitudeKey[] = { altitude };
+    if (osd_render_widget_begin_values(HUD_ALTITUDE, altitudeKey, 1)) {
+        drawScale(altitude, APPLY_HDEADBAND(GRAPHICS_RIGHT - 50), GRAPHICS_BOTTOM / 2, +1);
+    }
+    osd_render_widget_end();
+    int32_t headingKey[] = { heading };
+    if (osd_render_widget_begin_values(HUD_HEADING, headingKey, 1)) {
+        drawCompass(heading, APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), GRAPHICS_BOTTOM - 30);
+    }
+    osd_render_widget_end();
+
+    sprintf(temp, "Lat:%11.7f", 48.1234567 + (frame / 40) * 1e-6);
+    drawText(HUD_TEXT + 0, temp, APPLY_HDEADBAND(5), 5, TEXT_HA_LEFT, 2);
+    sprintf(temp, "Lon:%11.7f", 11.7654321 + (frame / 40) * 1e-6);
+    drawText(HUD_TEXT + 1, temp, APPLY_HDEADBAND(5), 15, TEXT_HA_LEFT, 2);
+    drawText(HUD_TEXT + 2, "Fix:3", APPLY_HDEADBAND(5), 25, TEXT_HA_LEFT, 2);
+    sprintf(temp, "Sat:%d", 9 + (frame / 100) % 3);
+    drawText(HUD_TEXT + 3, temp, APPLY_HDEADBAND(5), 35, TEXT_HA_LEFT, 2);
+    drawText(HUD_TEXT + 4, "Lines: 270", APPLY_HDEADBAND(GRAPHICS_RIGHT - 8), 5, TEXT_HA_RIGHT, 2);
+    sprintf(temp, "FltV:%4.2fV", 12.6 - (frame / 60) * 0.01);
+    drawText(HUD_TEXT + 5, temp, APPLY_HDEADBAND(GRAPHICS_RIGHT - 8), 15, TEXT_HA_RIGHT, 2);
+    sprintf(temp, "%02d:%02d", frame / 1500, (frame / 25) % 60);
+    drawText(HUD_TEXT + 6, temp, APPLY_HDEADBAND(GRAPHICS_RIGHT - 8), 25, TEXT_HA_RIGHT, 3);
+    // Only shown for a while
+    if ((frame / 60) % 2) {
+        drawText(HUD_TEXT + 7, "LOW BATTERY", APPLY_HDEADBAND(GRAPHICS_RIGHT / 2), 60, TEXT_HA_CENTER, 3);
+    }
+}
+
+class OsdRenderTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        for (int n = 0; n < 2; n++) {
+            level[n].assign(BUFFER_SIZE, 0);
+            mask[n].assign(BUFFER_SIZE, 0);
+        }
+        select(0);
+        osd_render_reset();
+        struct osd_render_stats stats;
+        osd_render_get_stats(&stats);
+    }
+
+    void select(int n)
+    {
+        draw_buffer_level = &level[n][0];
+        draw_buffer_mask  = &mask[n][0];
+        disp_buffer_level = &level[!n][0];
+        disp_buffer_mask  = &mask[!n][0];
+    }
+
+    // What the OSD did before, clear everything and draw everything
+    void drawFull(uint32_t frame)
+    {
+        osd_render_reset();
+        drawHud(frame);
+    }
+
+    void drawRetained(uint32_t frame)
+    {
+        select(frame % 2);
+        osd_render_begin_frame();
+        drawHud(frame);
+        osd_render_end_frame();
+    }
+
+    double benchmark(bool retained, struct osd_render_stats *stats)
+    {
+        clock_t start = clock();
+
+        osd_render_reset();
+        osd_render_get_stats(stats);
+        for (uint32_t frame = 0; frame < BENCH_FRAMES; frame++) {
+            if (retained) {
+                drawRetained(frame);
+            } else {
+                drawFull(frame);
+            }
+        }
+        double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+        osd_render_get_stats(stats);
+        return elapsed > 0 ? BENCH_FRAMES / elapsed : 0;
+    }
+
+    std::vector<uint8_t> level[2];
+    std::vector<uint8_t> mask[2];
+};
+
+TEST_F(OsdRenderTest, FillBytes) {
+    uint8_t buffer[64], expected[64];
+
+    for (int i = 0; i < 2000; i++) {
+        unsigned int addr  = rand() % 32;
+        unsigned int count = rand() % 32;
+        int mode = rand() % 3;
+        for (unsigned int n = 0; n < sizeof(buffer); n++) {
+            buffer[n] = expected[n] = rand();
+        }
+        for (unsigned int n = addr; n < addr + count; n++) {
+            WRITE_WORD_MODE(expected, n, 0xff, mode);
+        }
+        osd_render_fill_bytes(buffer, addr, count, mode);
+        ASSERT_EQ(0, memcmp(expected, buffer, sizeof(buffer))) << "addr " << addr << " count " << count << " mode " << mode;
+    }
+}
+
+TEST_F(OsdRenderTest, Glyphs) {
+    for (int font = 0; font < 4; font++) {
+        struct FontEntry font_info;
+        fetch_font_info(0, font, &font_info, NULL);
+        for (unsigned int ch = 0; ch < 128; ch++) {
+            // All bit offsets, over a background that is not empty
+            for (int n = 0; n < 2; n++) {
+                memset(&level[n][0], 0x5a, BUFFER_SIZE);
+                memset(&mask[n][0], 0x33, BUFFER_SIZE);
+            }
+            for (unsigned int shift = 0; shift < 8; shift++) {
+                unsigned int x = 16 + shift * (font_info.width + 9), y = 20 + shift * 3;
+                select(0);
+                if (font < 2) {
+                    write_char(ch, x, y, (ch & 1) ? FONT_INVERT : 0, font);
+                } else {
+                    write_char16(ch, x, y, font);
+                }
+                select(1);
+                referenceChar(ch, x, y, (ch & 1) ? FONT_INVERT : 0, font);
+            }
+            ASSERT_TRUE(level[0] == level[1]) << "font " << font << " char " << ch;
+            ASSERT_TRUE(mask[0] == mask[1]) << "font " << font << " char " << ch;
+        }
+    }
+}
+
+TEST_F(OsdRenderTest, RetainedMatchesFullRedraw) {
+    std::vector<Frame> reference(FRAMES);
+
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        drawFull(frame);
+        reference[frame].level.assign(draw_buffer_level, draw_buffer_level + BUFFER_SIZE);
+        reference[frame].mask.assign(draw_buffer_mask, draw_buffer_mask + BUFFER_SIZE);
+    }
+
+    osd_render_reset();
+    for (uint32_t frame = 0; frame < FRAMES; frame++) {
+        drawRetained(frame);
+        ASSERT_TRUE(reference[frame].level == level[frame % 2]) << "level differs in frame " << frame;
+        ASSERT_TRUE(reference[frame].mask == mask[frame % 2]) << "mask differs in frame " << frame;
+    }
+
+    struct osd_render_stats stats;
+    osd_render_get_stats(&stats);
+    EXPECT_EQ((uint32_t)FRAMES, stats.frames);
+    // the first frame in each buffer
+    EXPECT_EQ(2u, stats.fullClears);
+    EXPECT_GT(stats.widgetsRetained, stats.widgetsDrawn);
+}
+
+TEST_F(OsdRenderTest, WidgetsRetainedUntilChanged) {
+    struct osd_render_stats stats;
+    char text[] = "Sat:9";
+    int32_t values[] = { 10, 20 };
+
+    for (uint32_t frame = 0; frame < 6; frame++) {
+        // the values change on frame 4, the text on frame 5
+        if (frame == 4) {
+            values[1] = 21;
+        }
+        if (frame == 5) {
+            text[4] = '8';
+        }
+        select(frame % 2);
+        osd_render_begin_frame();
+        if (osd_render_widget_begin_values(HUD_SPEED, values, 2)) {
+            drawScale(values[1], APPLY_HDEADBAND(50), GRAPHICS_BOTTOM / 2, -1);
+        }
+        osd_render_widget_end();
+        write_string_widget(HUD_TEXT, text, APPLY_HDEADBAND(5), 5, TEXT_VA_TOP, TEXT_HA_LEFT, 2);
+        osd_render_end_frame();
+    }
+
+    osd_render_get_stats(&stats);
+    // both widgets drawn once in each buffer, then the scale again in both
+    // buffers after its change and the text in the last one
+    EXPECT_EQ(4u + 2u + 1u, stats.widgetsDrawn);
+    EXPECT_EQ(12u - 7u, stats.widgetsRetained);
+}
+
+TEST_F(OsdRenderTest, Benchmark) {
+    struct osd_render_stats full, retained;
+    double fullFps     = benchmark(false, &full);
+    double retainedFps = benchmark(true, &retained);
+
+    printf("full redraw: %.0f frames/s, %u bytes cleared/frame\n", fullFps, full.bytesCleared / BENCH_FRAMES);
+    printf("retained   : %.0f frames/s, %u bytes cleared/frame, %.1f widgets drawn/frame, %.1f widgets retained/frame, %u glyph cache misses\n",
+           retainedFps, retained.bytesCleared / BENCH_FRAMES, (double)retained.widgetsDrawn / BENCH_FRAMES,
+           (double)retained.widgetsRetained / BENCH_FRAMES, retained.glyphCacheMisses);
+
+    EXPECT_LT(retained.bytesCleared * 4, full.bytesCleared);
+    EXPECT_LT(retained.widgetsDrawn * 2, retained.widgetsRetained);
+}
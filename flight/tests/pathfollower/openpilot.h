@@ -0,0 +1,13 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pios.h"
+#include <mathmisc.h>
+#include "uavobjectmanager.h"
+#include "alarms.h"
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,36 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pios_math.h>
+#include "pios_mem.h"
+
+#define PIOS_Assert(test) assert(test)
+#define PIOS_STATIC_ASSERT(test) ((void)sizeof(int[1 - 2 * !(test)]))
+
+/* No settings initcall section and no FreeRTOS, the generated UAVOs only name them */
+#define SETTINGS_INITCALL(fn)
+typedef void *xQueueHandle;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The delay runs on the simulated time of the test */
+uint32_t PIOS_DELAY_GetRaw();
+uint32_t PIOS_DELAY_GetuS();
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t);
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw);
+
+#include <pios_deltatime.h>
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIOS_H */
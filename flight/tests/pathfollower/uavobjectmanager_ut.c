@@ -0,0 +1,208 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectmanager_ut.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Fake of the UAVObject manager and the alarms for the path follower controllers
+ *
+ * Single instance objects in plain memory behind the interface of
+ * flight/uavobjects/inc/uavobjectmanager.h, for the generated objects.
+ * Callbacks run straight from the update, there is no event task and
+ * the metadata is dropped.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+#include <stdlib.h>
+#include <alarms.h>
+
+#define MAX_OBJECTS   64
+#define MAX_CALLBACKS 4
+
+struct UAVOData {
+    const UAVObjType    *type;
+    UAVObjEventCallback callbacks[MAX_CALLBACKS];
+    uint8_t *data;
+    bool    isSettings;
+};
+
+static struct UAVOData objects[MAX_OBJECTS];
+static uint32_t numObjects;
+
+UAVObjHandle UAVObjRegister(const UAVObjType *type, __attribute__((unused)) bool isSingleInstance,
+                            bool isSettings, __attribute__((unused)) bool isPriority)
+{
+    PIOS_Assert(numObjects < MAX_OBJECTS);
+
+    struct UAVOData *obj = &objects[numObjects++];
+    obj->type = type;
+    obj->isSettings = isSettings;
+    obj->data = (uint8_t *)calloc(1, type->instance_size);
+    PIOS_Assert(obj->data);
+
+    UAVObjSetDefaults(obj);
+    return obj;
+}
+
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+    for (uint32_t n = 0; n < numObjects; n++) {
+        if (objects[n].type->id == id) {
+            return &objects[n];
+        }
+    }
+    return NULL;
+}
+
+uint32_t UAVObjGetID(UAVObjHandle obj)
+{
+    return ((struct UAVOData *)obj)->type->id;
+}
+
+uint32_t UAVObjGetNumBytes(UAVObjHandle obj)
+{
+    return ((struct UAVOData *)obj)->type->instance_size;
+}
+
+bool UAVObjIsSettings(UAVObjHandle obj)
+{
+    return ((struct UAVOData *)obj)->isSettings;
+}
+
+int32_t UAVObjSetDefaults(UAVObjHandle obj_handle)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj);
+    obj->type->init_callback(obj, 0);
+    return 0;
+}
+
+int32_t UAVObjSetData(UAVObjHandle obj_handle, const void *dataIn)
+{
+    return UAVObjSetInstanceData(obj_handle, 0, dataIn);
+}
+
+int32_t UAVObjGetData(UAVObjHandle obj_handle, void *dataOut)
+{
+    return UAVObjGetInstanceData(obj_handle, 0, dataOut);
+}
+
+int32_t UAVObjSetDataField(UAVObjHandle obj_handle, const void *dataIn, uint32_t offset, uint32_t size)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj && offset + size <= obj->type->instance_size);
+    memcpy(obj->data + offset, dataIn, size);
+    UAVObjUpdated(obj);
+    return 0;
+}
+
+int32_t UAVObjGetDataField(UAVObjHandle obj_handle, void *dataOut, uint32_t offset, uint32_t size)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj && offset + size <= obj->type->instance_size);
+    memcpy(dataOut, obj->data + offset, size);
+    return 0;
+}
+
+int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const void *dataIn)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj && instId == 0);
+    memcpy(obj->data, dataIn, obj->type->instance_size);
+    UAVObjUpdated(obj);
+    return 0;
+}
+
+int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void *dataOut)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj && instId == 0);
+    memcpy(dataOut, obj->data, obj->type->instance_size);
+    return 0;
+}
+
+int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, __attribute__((unused)) const UAVObjMetadata *dataIn)
+{
+    PIOS_Assert(obj_handle);
+    return 0;
+}
+
+int32_t UAVObjConnectCallback(UAVObjHandle obj_handle, UAVObjEventCallback cb,
+                              __attribute__((unused)) uint8_t eventMask, __attribute__((unused)) bool fast)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+
+    PIOS_Assert(obj);
+    for (int n = 0; n < MAX_CALLBACKS; n++) {
+        if (!obj->callbacks[n]) {
+            obj->callbacks[n] = cb;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void UAVObjUpdated(UAVObjHandle obj_handle)
+{
+    struct UAVOData *obj = (struct UAVOData *)obj_handle;
+    UAVObjEvent ev = { obj, 0, EV_UPDATED, false };
+
+    for (int n = 0; n < MAX_CALLBACKS && obj->callbacks[n]; n++) {
+        obj->callbacks[n](&ev);
+    }
+}
+
+void UAVObjIterate(void (*iterator)(UAVObjHandle obj))
+{
+    for (uint32_t n = 0; n < numObjects; n++) {
+        iterator(&objects[n]);
+    }
+}
+
+/* The controllers only raise their alarm, it goes straight to SystemAlarms */
+
+int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity)
+{
+    SystemAlarmsAlarmOptions alarms[SYSTEMALARMS_ALARM_NUMELEM];
+
+    SystemAlarmsAlarmArrayGet(alarms);
+    alarms[alarm] = severity;
+    SystemAlarmsAlarmArraySet(alarms);
+    return 0;
+}
+
+SystemAlarmsAlarmOptions AlarmsGet(SystemAlarmsAlarmElem alarm)
+{
+    SystemAlarmsAlarmOptions alarms[SYSTEMALARMS_ALARM_NUMELEM];
+
+    SystemAlarmsAlarmArrayGet(alarms);
+    return alarms[alarm];
+}
+
+/**
+ * @}
+ * @}
+ */
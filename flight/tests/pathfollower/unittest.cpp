@@ -0,0 +1,946 @@
+#include "gtest/gtest.h"
+
+#include <math.h>
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* getenv */
+#include <sys/mman.h> /* mmap */
+#include <sys/wait.h> /* waitpid */
+#include <unistd.h> /* fork, sysconf */
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+extern "C" {
+#include "openpilot.h"
+#include <accelstate.h>
+#include <airspeedstate.h>
+#include <attitudestate.h>
+#include <fixedwingpathfollowersettings.h>
+#include <fixedwingpathfollowerstatus.h>
+#include <flightmodesettings.h>
+#include <flightstatus.h>
+#include <groundpathfollowersettings.h>
+#include <homelocation.h>
+#include <manualcontrolcommand.h>
+#include <pathdesired.h>
+#include <pathstatus.h>
+#include <pathsummary.h>
+#include <pidstatus.h>
+#include <poilocation.h>
+#include <positionstate.h>
+#include <stabilizationbank.h>
+#include <stabilizationdesired.h>
+#include <statusgrounddrive.h>
+#include <statusvtolautotakeoff.h>
+#include <statusvtolland.h>
+#include <systemalarms.h>
+#include <systemsettings.h>
+#include <takeofflocation.h>
+#include <velocitydesired.h>
+#include <velocitystate.h>
+#include <vtolpathfollowersettings.h>
+#include <vtolselftuningstats.h>
+#include "paths.h"
+#include "plans.h"
+}
+#include "pathfollowercontrol.h"
+#include "vtolflycontroller.h"
+#include "vtollandcontroller.h"
+#include "fixedwingflycontroller.h"
+#include "grounddrivecontroller.h"
+
+/*
+ * Monte-Carlo mission simulator for the path follower controllers.
+ *
+ * The real VtolFlyController, VtolLandController, FixedWingFlyController and
+ * GroundDriveController, with paths.c, plans.c and the PID libraries, fly
+ * randomized missions against simple vehicle plants. The generated UAVOs
+ * sit on a fake uavobjectmanager, and the glue
+ * below does what the PathFollower module does around the controllers:
+ * the plant publishes PositionState, VelocityState, AttitudeState and
+ * AirspeedState, the active controller runs every UpdatePeriod and its
+ * StabilizationDesired drives the plant.
+ *
+ * The controllers are singletons on global objects, so the missions of a
+ * process run one after the other. runForked() runs each in a forked process
+ * on its own copy of the objects, one per core at a time. Set
+ * PATHFOLLOWER_MISSIONS to run more or less of them, e.g. when tuning.
+ */
+
+#define PLANT_STEPS    10 // plant integration steps per control period
+#define GRAVITY        9.81f
+#define MISSIONS       2000
+#define SWEEP_MISSIONS 500
+#define LEG_TIMEOUT    120.0f // seconds, a leg not finished by then fails the mission
+#define HOLD_TIME      20.0f // seconds spent holding the last waypoint
+#define SETTLE_RADIUS  2.0f // metres from the last waypoint that count as settled
+#define LAND_TIMEOUT   180.0f // seconds from the start of a landing to the disarm
+
+/* The delay runs on the simulated time */
+static uint32_t simTimeUs;
+
+extern "C" {
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return simTimeUs;
+}
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return simTimeUs;
+}
+
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t)
+{
+    return simTimeUs - t;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return simTimeUs - raw;
+}
+}
+
+/*
+ * PathFollower module glue, as in pathfollower.cpp without its task and frame type handling
+ */
+static PathDesiredData pathDesired;
+static FlightStatusData flightStatus;
+static PathStatusData pathStatus;
+static VtolPathFollowerSettingsData vtolPathFollowerSettings;
+static FixedWingPathFollowerSettingsData fixedWingPathFollowerSettings;
+static GroundPathFollowerSettingsData groundPathFollowerSettings;
+static PathFollowerControl *activeController;
+
+static void pathFollowerObjectiveUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    PathDesiredGet(&pathDesired);
+
+    if (activeController) {
+        activeController->ObjectiveUpdated();
+    }
+}
+
+static void airspeedStateUpdatedCb(UAVObjEvent *ev)
+{
+    FixedWingFlyController::instance()->AirspeedStateUpdatedCb(ev);
+}
+
+static void pathFollowerInitialize()
+{
+    static bool initialised = false;
+
+    if (initialised) {
+        return;
+    }
+    initialised = true;
+
+    AccelStateInitialize();
+    AirspeedStateInitialize();
+    AttitudeStateInitialize();
+    FixedWingPathFollowerSettingsInitialize();
+    FixedWingPathFollowerStatusInitialize();
+    FlightModeSettingsInitialize();
+    FlightStatusInitialize();
+    GroundPathFollowerSettingsInitialize();
+    HomeLocationInitialize();
+    ManualControlCommandInitialize();
+    PathDesiredInitialize();
+    PathStatusInitialize();
+    PathSummaryInitialize();
+    PIDStatusInitialize();
+    PoiLocationInitialize();
+    PositionStateInitialize();
+    StabilizationBankInitialize();
+    StabilizationDesiredInitialize();
+    StatusGroundDriveInitialize();
+    StatusVtolAutoTakeoffInitialize();
+    StatusVtolLandInitialize();
+    SystemAlarmsInitialize();
+    SystemSettingsInitialize();
+    TakeOffLocationInitialize();
+    VelocityDesiredInitialize();
+    VelocityStateInitialize();
+    VtolPathFollowerSettingsInitialize();
+    VtolSelfTuningStatsInitialize();
+
+    PathFollowerControl::Initialize(&pathDesired, &flightStatus, &pathStatus);
+    VtolFlyController::instance()->Initialize(&vtolPathFollowerSettings);
+    VtolLandController::instance()->Initialize(&vtolPathFollowerSettings);
+    FixedWingFlyController::instance()->Initialize(&fixedWingPathFollowerSettings);
+    GroundDriveController::instance()->Initialize(&groundPathFollowerSettings);
+
+    PathDesiredConnectCallback(&pathFollowerObjectiveUpdatedCb);
+    AirspeedStateConnectCallback(&airspeedStateUpdatedCb);
+}
+
+static void resetObject(UAVObjHandle obj)
+{
+    UAVObjSetDefaults(obj);
+}
+
+static void resetStateObject(UAVObjHandle obj)
+{
+    if (!UAVObjIsSettings(obj)) {
+        UAVObjSetDefaults(obj);
+    }
+}
+
+static void pathFollowerDisengage()
+{
+    if (activeController) {
+        activeController->Deactivate();
+        activeController = 0;
+    }
+}
+
+// Engage the controller on the current PathDesired, as when switching to a path follower flight mode
+static void pathFollowerEngage(PathFollowerControl *controller)
+{
+    pathFollowerDisengage();
+
+    VtolPathFollowerSettingsGet(&vtolPathFollowerSettings);
+    FixedWingPathFollowerSettingsGet(&fixedWingPathFollowerSettings);
+    GroundPathFollowerSettingsGet(&groundPathFollowerSettings);
+
+    FlightStatusControlChainData controlChain;
+    FlightStatusControlChainGet(&controlChain);
+    controlChain.Stabilization = FLIGHTSTATUS_CONTROLCHAIN_TRUE;
+    controlChain.PathFollower  = FLIGHTSTATUS_CONTROLCHAIN_TRUE;
+    FlightStatusControlChainSet(&controlChain);
+    FlightStatusGet(&flightStatus);
+    PathStatusGet(&pathStatus);
+    PathDesiredGet(&pathDesired);
+
+    activeController = controller;
+    activeController->Activate();
+    activeController->ObjectiveUpdated();
+}
+
+static void pathFollowerTask()
+{
+    FlightStatusGet(&flightStatus);
+
+    pathStatus.UID    = pathDesired.UID;
+    pathStatus.Status = PATHSTATUS_STATUS_INPROGRESS;
+
+    activeController->UpdateAutoPilot();
+}
+
+/*
+ * Plants
+ */
+
+static uint32_t nextRandom(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// uniform in [min, max]
+static float randomRange(uint32_t & state, float min, float max)
+{
+    return min + (max - min) * (float)(nextRandom(state) & 0xffffff) / (float)0xffffff;
+}
+
+static float wrapDegrees(float angle)
+{
+    while (angle > 180.0f) {
+        angle -= 360.0f;
+    }
+    while (angle < -180.0f) {
+        angle += 360.0f;
+    }
+    return angle;
+}
+
+struct Wind {
+    float mean[2];
+    float gust; // fraction of the wind
+    float gustPeriod;
+
+    void randomize(uint32_t & rnd, float maxSpeed)
+    {
+        float speed = randomRange(rnd, 0.0f, maxSpeed);
+        float dir   = randomRange(rnd, 0.0f, 2.0f * M_PI_F);
+
+        mean[0]    = speed * cosf(dir);
+        mean[1]    = speed * sinf(dir);
+        gust       = randomRange(rnd, 0.0f, 0.3f);
+        gustPeriod = randomRange(rnd, 2.0f, 10.0f);
+    }
+
+    void at(float t, float wind[2]) const
+    {
+        float w = 1.0f + gust * sinf(2.0f * M_PI_F * t / gustPeriod);
+
+        wind[0] = mean[0] * w;
+        wind[1] = mean[1] * w;
+    }
+};
+
+struct Plant {
+    float pos[3]; // north, east, down
+    float vel[3];
+    float roll, pitch, yaw; // degrees
+    Wind  wind;
+
+    virtual ~Plant() {}
+    virtual void step(const StabilizationDesiredData & desired, float t, float dT) = 0;
+
+    virtual void publish()
+    {
+        PositionStateData positionState;
+        VelocityStateData velocityState;
+        AttitudeStateData attitudeState;
+
+        PositionStateGet(&positionState);
+        positionState.North = pos[0];
+        positionState.East  = pos[1];
+        positionState.Down  = pos[2];
+        PositionStateSet(&positionState);
+
+        VelocityStateGet(&velocityState);
+        velocityState.North = vel[0];
+        velocityState.East  = vel[1];
+        velocityState.Down  = vel[2];
+        VelocityStateSet(&velocityState);
+
+        AttitudeStateGet(&attitudeState);
+        attitudeState.Roll  = roll;
+        attitudeState.Pitch = pitch;
+        attitudeState.Yaw   = wrapDegrees(yaw);
+        AttitudeStateSet(&attitudeState);
+    }
+};
+
+// Multirotor: attitude follows the command with a first order lag, the stabilization
+// keeps the vertical thrust in cruise control, linear drag against the wind
+struct Multirotor : public Plant {
+    float tau; // attitude response time constant
+    float drag; // 1/s
+    float hoverThrust;
+    float accDown;
+    bool  landed;
+    float touchdownSpeed;
+
+    void randomize(uint32_t & rnd)
+    {
+        memset(pos, 0, sizeof(pos));
+        memset(vel, 0, sizeof(vel));
+        roll  = pitch = 0.0f;
+        yaw   = randomRange(rnd, -180.0f, 180.0f);
+        tau   = randomRange(rnd, 0.08f, 0.3f);
+        drag  = randomRange(rnd, 0.1f, 0.5f);
+        hoverThrust = randomRange(rnd, 0.4f, 0.6f);
+        accDown = 0.0f;
+        landed  = false;
+        touchdownSpeed = 0.0f;
+        wind.randomize(rnd, 5.0f);
+        // start in the hover, drifting with the wind
+        wind.at(0.0f, vel);
+    }
+
+    void step(const StabilizationDesiredData & desired, float t, float dT)
+    {
+        roll  += (desired.Roll - roll) * dT / tau;
+        pitch += (desired.Pitch - pitch) * dT / tau;
+        if (desired.StabilizationMode.Yaw == STABILIZATIONDESIRED_STABILIZATIONMODE_ATTITUDE) {
+            yaw += wrapDegrees(desired.Yaw - yaw) * dT / tau;
+        } else {
+            yaw += desired.Yaw * dT;
+        }
+
+        if (landed) {
+            if (desired.Thrust <= hoverThrust) {
+                return;
+            }
+            landed = false;
+        }
+
+        // nose down pitch moves forward, right roll moves right
+        float forward = -GRAVITY * tanf(DEG2RAD(pitch));
+        float right   = GRAVITY * tanf(DEG2RAD(roll));
+        float c = cosf(DEG2RAD(yaw));
+        float s = sinf(DEG2RAD(yaw));
+        float w[2];
+        wind.at(t, w);
+
+        float acc[3] = { forward * c - right * s, forward * s + right * c, 0.0f };
+        for (int i = 0; i < 2; i++) {
+            acc[i] -= drag * (vel[i] - w[i]);
+        }
+        acc[2]  = GRAVITY * (1.0f - boundf(desired.Thrust, 0.0f, 1.0f) / hoverThrust) - drag * vel[2];
+        accDown = acc[2];
+        for (int i = 0; i < 3; i++) {
+            vel[i] += acc[i] * dT;
+            pos[i] += vel[i] * dT;
+        }
+
+        // the ground is at the takeoff location
+        if (pos[2] >= 0.0f) {
+            touchdownSpeed = vel[2];
+            landed = true;
+            pos[2] = 0.0f;
+            memset(vel, 0, sizeof(vel));
+            accDown = 0.0f;
+        }
+    }
+
+    void publish()
+    {
+        Plant::publish();
+
+        AccelStateData accelState;
+        AccelStateGet(&accelState);
+        accelState.z = accDown - GRAVITY;
+        AccelStateSet(&accelState);
+    }
+};
+
+// Fixed wing: coordinated turns, speed from thrust against drag and climb,
+// the trim pitch grows with lower speed as the wing needs more lift
+struct FixedWing : public Plant {
+    float tau;
+    float airspeed;
+    float cruise; // speed flying level with neutral thrust and pitch
+
+    void randomize(uint32_t & rnd)
+    {
+        memset(pos, 0, sizeof(pos));
+        pos[2]   = -100.0f;
+        roll     = 0.0f;
+        pitch    = 5.0f;
+        yaw      = randomRange(rnd, -180.0f, 180.0f);
+        tau      = randomRange(rnd, 0.1f, 0.4f);
+        cruise   = randomRange(rnd, 14.0f, 16.0f);
+        airspeed = cruise;
+        wind.randomize(rnd, 5.0f);
+        updateVelocity(0.0f);
+    }
+
+    void updateVelocity(float t)
+    {
+        float w[2];
+        float gamma = DEG2RAD(pitch - 5.0f * (cruise * cruise) / (airspeed * airspeed));
+
+        wind.at(t, w);
+        vel[0] = airspeed * cosf(gamma) * cosf(DEG2RAD(yaw)) + w[0];
+        vel[1] = airspeed * cosf(gamma) * sinf(DEG2RAD(yaw)) + w[1];
+        vel[2] = -airspeed * sinf(gamma);
+    }
+
+    void step(const StabilizationDesiredData & desired, float t, float dT)
+    {
+        const float dragK = 0.01f;
+        const float thrustK = 2.0f * dragK * cruise * cruise; // level at cruise with half thrust
+
+        roll  += (desired.Roll - roll) * dT / tau;
+        pitch += (desired.Pitch - pitch) * dT / tau;
+        yaw   += RAD2DEG(GRAVITY * tanf(DEG2RAD(roll)) / airspeed) * dT;
+
+        float gamma = DEG2RAD(pitch - 5.0f * (cruise * cruise) / (airspeed * airspeed));
+        airspeed += (thrustK * boundf(desired.Thrust, 0.0f, 1.0f) - dragK * airspeed * airspeed - GRAVITY * sinf(gamma)) * dT;
+        airspeed  = fmaxf(airspeed, 5.0f);
+
+        updateVelocity(t);
+        for (int i = 0; i < 3; i++) {
+            pos[i] += vel[i] * dT;
+        }
+    }
+
+    void publish()
+    {
+        Plant::publish();
+
+        AirspeedStateData airspeedState;
+        AirspeedStateGet(&airspeedState);
+        airspeedState.CalibratedAirspeed = airspeed;
+        airspeedState.TrueAirspeed = airspeed;
+        AirspeedStateSet(&airspeedState);
+    }
+};
+
+// Ground vehicle: bicycle steering, the motor drives the speed with a lag
+struct Rover : public Plant {
+    float speed;
+    float motorGain; // m/s at full thrust
+    float wheelbase;
+
+    void randomize(uint32_t & rnd)
+    {
+        memset(pos, 0, sizeof(pos));
+        memset(vel, 0, sizeof(vel));
+        roll      = pitch = 0.0f;
+        yaw       = randomRange(rnd, -180.0f, 180.0f);
+        speed     = 0.0f;
+        motorGain = randomRange(rnd, 6.0f, 10.0f);
+        wheelbase = randomRange(rnd, 0.2f, 0.4f);
+        memset(&wind, 0, sizeof(wind));
+    }
+
+    void step(const StabilizationDesiredData & desired, __attribute__((unused)) float t, float dT)
+    {
+        const float motorTau = 0.3f;
+        const float maxSteer = 30.0f;
+
+        speed += (desired.Thrust * motorGain - speed) * dT / motorTau;
+        yaw   += RAD2DEG(speed / wheelbase * tanf(DEG2RAD(boundf(desired.Yaw, -1.0f, 1.0f) * maxSteer))) * dT;
+        vel[0] = speed * cosf(DEG2RAD(yaw));
+        vel[1] = speed * sinf(DEG2RAD(yaw));
+        for (int i = 0; i < 2; i++) {
+            pos[i] += vel[i] * dT;
+        }
+    }
+};
+
+// One controller period: publish the state, run the controller, move the plant
+static void simulate(Plant & plant, float controlDT, float & t)
+{
+    StabilizationDesiredData desired;
+
+    plant.publish();
+    pathFollowerTask();
+    StabilizationDesiredGet(&desired);
+    for (int i = 0; i < PLANT_STEPS; i++) {
+        plant.step(desired, t, controlDT / PLANT_STEPS);
+        t += controlDT / PLANT_STEPS;
+    }
+    simTimeUs = (uint32_t)(t * 1e6f);
+}
+
+/*
+ * Workers
+ */
+
+// runs run(i) for i = 0 .. count - 1, each in its own process with one per core, the results go through shared memory
+template<typename Result, typename Run>
+static std::vector<Result> runForked(int count, Run run)
+{
+    std::vector<Result> results(count);
+    int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (workers < 1) {
+        workers = 1;
+    }
+
+    Result *shared = (Result *)mmap(NULL, count * sizeof(Result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        ADD_FAILURE() << "no shared memory for " << count << " results";
+        return results;
+    }
+    memset(shared, 0, count * sizeof(Result));
+
+    // nothing buffered may be printed twice by the workers
+    fflush(stdout);
+
+    // a fresh fork per run, so no run sees what the controllers kept from another and
+    // the results do not depend on the number of cores
+    int next = 0, running = 0, failed = 0;
+    while (next < count || running > 0) {
+        if (next < count && running < workers) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                shared[next] = run(next);
+                _exit(0);
+            }
+            if (pid > 0) {
+                next++;
+                running++;
+                continue;
+            }
+            if (running == 0) {
+                ADD_FAILURE() << "fork failed at run " << next;
+                break;
+            }
+        }
+
+        int status;
+        if (waitpid(-1, &status, 0) < 0) {
+            break;
+        }
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+    EXPECT_EQ(0, failed) << "runs did not finish";
+
+    std::copy(shared, shared + count, results.begin());
+    munmap(shared, count * sizeof(Result));
+    return results;
+}
+
+/*
+ * Missions
+ */
+
+struct MissionResult {
+    bool  completed;
+    float rmsError; // distance from the track while following the legs
+    float maxError;
+    float settleTime; // from reaching the last leg's end to staying within SETTLE_RADIUS
+    bool  guidanceOk; // the controller left the guidance alarm OK
+};
+
+enum Vehicle { VTOL, FIXEDWING, GROUND };
+
+// Waypoint legs flown with FOLLOWVECTOR, then a position hold at the last one for the VTOL
+static MissionResult runMission(uint32_t seed, Vehicle vehicle)
+{
+    uint32_t rnd = seed * 2654435761u + 1;
+    MissionResult result = { true, 0.0f, 0.0f, 0.0f, false };
+    Multirotor multirotor;
+    FixedWing fixedWing;
+    Rover rover;
+    Plant *plant;
+    PathFollowerControl *controller;
+    float controlDT;
+    float minLeg, maxLeg, minSpeed, maxSpeed, minDown, maxDown;
+    float maxTurn = M_PI_F; // heading change from one leg to the next
+    bool mode3D = true;
+
+    UAVObjIterate(&resetStateObject);
+    switch (vehicle) {
+    case VTOL:
+        multirotor.randomize(rnd);
+        multirotor.pos[2] = -20.0f;
+        plant      = &multirotor;
+        controller = VtolFlyController::instance();
+        VtolPathFollowerSettingsGet(&vtolPathFollowerSettings);
+        controlDT  = vtolPathFollowerSettings.UpdatePeriod / 1000.0f;
+        minLeg     = 20.0f;
+        maxLeg     = 150.0f;
+        minSpeed   = 3.0f;
+        maxSpeed   = vtolPathFollowerSettings.HorizontalVelMax;
+        minDown    = -30.0f;
+        maxDown    = -10.0f;
+        break;
+    case FIXEDWING:
+        fixedWing.randomize(rnd);
+        plant      = &fixedWing;
+        controller = FixedWingFlyController::instance();
+        FixedWingPathFollowerSettingsGet(&fixedWingPathFollowerSettings);
+        controlDT  = fixedWingPathFollowerSettings.UpdatePeriod / 1000.0f;
+        minLeg     = 300.0f;
+        maxLeg     = 800.0f;
+        minSpeed   = 12.0f;
+        maxSpeed   = 18.0f;
+        minDown    = -150.0f;
+        maxDown    = -50.0f;
+        maxTurn    = M_PI_F / 3.0f; // the turn radius makes sharp corners a matter of the airframe
+        break;
+    default:
+        rover.randomize(rnd);
+        plant      = &rover;
+        controller = GroundDriveController::instance();
+        GroundPathFollowerSettingsGet(&groundPathFollowerSettings);
+        controlDT  = groundPathFollowerSettings.UpdatePeriod / 1000.0f;
+        minLeg     = 10.0f;
+        maxLeg     = 40.0f;
+        minSpeed   = 0.5f;
+        maxSpeed   = groundPathFollowerSettings.HorizontalVelMax;
+        minDown    = 0.0f;
+        maxDown    = 0.0f;
+        mode3D     = false;
+        break;
+    }
+
+    PathDesiredData path;
+    memset(&path, 0, sizeof(path));
+    path.End.North = plant->pos[0];
+    path.End.East  = plant->pos[1];
+    path.End.Down  = plant->pos[2];
+
+    float heading = DEG2RAD(plant->yaw);
+    int legs      = 3 + nextRandom(rnd) % 4;
+    float t       = 0.0f;
+    double sumSq  = 0.0;
+    long samples  = 0;
+    bool hold     = false;
+
+    simTimeUs = 0;
+    for (int leg = 0; leg <= legs && !hold; leg++) {
+        hold = (leg == legs);
+        if (hold && vehicle != VTOL) {
+            break;
+        }
+        path.Start.North = path.End.North;
+        path.Start.East  = path.End.East;
+        path.Start.Down  = path.End.Down;
+        if (!hold) {
+            float length  = randomRange(rnd, minLeg, maxLeg);
+            heading += randomRange(rnd, -maxTurn, maxTurn);
+            path.End.North += length * cosf(heading);
+            path.End.East  += length * sinf(heading);
+            path.End.Down   = randomRange(rnd, minDown, maxDown);
+            path.StartingVelocity = path.EndingVelocity = randomRange(rnd, minSpeed, maxSpeed);
+            path.Mode = PATHDESIRED_MODE_FOLLOWVECTOR;
+        } else {
+            // a vector of zero length holds the last waypoint without switching the controller
+            path.StartingVelocity = path.EndingVelocity = 0.0f;
+        }
+        path.UID = leg;
+
+        // as in the module, a new leg only updates the objective unless its mode changes
+        PathDesiredSet(&path);
+        if (leg == 0 || controller->Mode() != path.Mode) {
+            plant->publish();
+            pathFollowerEngage(controller);
+        }
+
+        float legTime  = 0.0f;
+        float lastAway = 0.0f;
+        while (true) {
+            simulate(*plant, controlDT, t);
+            legTime += controlDT;
+
+            struct path_status status;
+            path_progress(&path, plant->pos, &status, mode3D);
+
+            if (hold) {
+                if (status.error > SETTLE_RADIUS) {
+                    lastAway = legTime;
+                }
+                if (legTime >= HOLD_TIME) {
+                    result.settleTime = lastAway;
+                    result.completed  = result.completed && (lastAway < HOLD_TIME - 1.0f);
+                    break;
+                }
+            } else {
+                sumSq += status.error * status.error;
+                samples++;
+                if (status.error > result.maxError) {
+                    result.maxError = status.error;
+                }
+                if (status.fractional_progress >= 1.0f) {
+                    break;
+                }
+                if (legTime > LEG_TIMEOUT) {
+                    result.completed = false;
+                    break;
+                }
+            }
+        }
+    }
+    result.guidanceOk = (AlarmsGet(SYSTEMALARMS_ALARM_GUIDANCE) == SYSTEMALARMS_ALARM_OK);
+    pathFollowerDisengage();
+
+    result.rmsError = samples ? sqrt(sumSq / samples) : 0.0f;
+    return result;
+}
+
+struct MissionSummary {
+    int    runs;
+    int    completed;
+    int    guidanceOk;
+    double meanRmsError;
+    double maxError;
+    double meanSettleTime;
+    double maxSettleTime;
+    double runsPerSecond;
+};
+
+// runs the missions with seeds 0 .. missions - 1
+static MissionSummary runMissions(int missions, Vehicle vehicle)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<MissionResult> results = runForked<MissionResult>(missions, [vehicle](int i) {
+        return runMission(i, vehicle);
+    });
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    MissionSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.runs = missions;
+    for (int i = 0; i < missions; i++) {
+        summary.completed += results[i].completed;
+        summary.guidanceOk += results[i].guidanceOk;
+        summary.meanRmsError   += results[i].rmsError;
+        summary.meanSettleTime += results[i].settleTime;
+        if (results[i].maxError > summary.maxError) {
+            summary.maxError = results[i].maxError;
+        }
+        if (results[i].settleTime > summary.maxSettleTime) {
+            summary.maxSettleTime = results[i].settleTime;
+        }
+    }
+    summary.meanRmsError   /= missions;
+    summary.meanSettleTime /= missions;
+    summary.runsPerSecond   = elapsed > 0 ? missions / elapsed : 0;
+    return summary;
+}
+
+static void printSummary(const char *name, const MissionSummary & s)
+{
+    printf("%-24s %5d/%-5d completed, track error rms %5.2f m max %6.2f m, settle mean %5.2f s max %5.2f s, %6.0f runs/s\n",
+           name, s.completed, s.runs, s.meanRmsError, s.maxError, s.meanSettleTime, s.maxSettleTime, s.runsPerSecond);
+}
+
+struct LandingResult {
+    bool  disarmed;
+    float time;
+    float touchdownSpeed;
+    float drift; // horizontal distance from where the landing started
+};
+
+// Land from a random height with VtolLandController on the plan_setup_land() objective
+static LandingResult runLanding(uint32_t seed)
+{
+    uint32_t rnd = seed * 2654435761u + 1;
+    LandingResult result = { false, 0.0f, 0.0f, 0.0f };
+    Multirotor multirotor;
+
+    UAVObjIterate(&resetStateObject);
+    multirotor.randomize(rnd);
+    multirotor.pos[2] = -randomRange(rnd, 5.0f, 40.0f);
+    // landing from a position hold
+    memset(multirotor.vel, 0, sizeof(multirotor.vel));
+
+    VtolPathFollowerSettingsGet(&vtolPathFollowerSettings);
+    const float controlDT = vtolPathFollowerSettings.UpdatePeriod / 1000.0f;
+
+    simTimeUs = 0;
+    multirotor.publish();
+    plan_setup_land();
+    pathFollowerEngage(VtolLandController::instance());
+
+    float t = 0.0f;
+    StatusVtolLandData status;
+    do {
+        simulate(multirotor, controlDT, t);
+        if (multirotor.landed && result.touchdownSpeed == 0.0f) {
+            result.touchdownSpeed = multirotor.touchdownSpeed;
+        }
+        StatusVtolLandGet(&status);
+    } while (status.State != STATUSVTOLLAND_STATE_DISARMED && t < LAND_TIMEOUT);
+
+    result.disarmed = (status.State == STATUSVTOLLAND_STATE_DISARMED);
+    result.time     = t;
+    result.drift    = sqrtf(multirotor.pos[0] * multirotor.pos[0] + multirotor.pos[1] * multirotor.pos[1]);
+
+    // the landed vehicle reports the objective done and cuts the thrust
+    PathStatusData landStatus;
+    StabilizationDesiredData desired;
+    PathStatusGet(&landStatus);
+    StabilizationDesiredGet(&desired);
+    if (landStatus.fractional_progress < 1.0f || desired.Thrust > 0.0f) {
+        result.disarmed = false;
+    }
+    pathFollowerDisengage();
+    return result;
+}
+
+class PathFollowerSim : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        const char *env = getenv("PATHFOLLOWER_MISSIONS");
+
+        missions = env ? atoi(env) : 0;
+        if (missions <= 0) {
+            missions = MISSIONS;
+        }
+
+        pathFollowerInitialize();
+        UAVObjIterate(&resetObject);
+    }
+
+    int missions;
+};
+
+TEST_F(PathFollowerSim, PathProgressFollowVector) {
+    PathDesiredData path;
+
+    memset(&path, 0, sizeof(path));
+    path.End.North = 100.0f;
+    path.StartingVelocity = path.EndingVelocity = 5.0f;
+    path.Mode = PATHDESIRED_MODE_FOLLOWVECTOR;
+
+    float cur[3] = { 50.0f, 3.0f, 0.0f };
+    struct path_status status;
+    path_progress(&path, cur, &status, true);
+
+    EXPECT_NEAR(0.5f, status.fractional_progress, 1e-4f);
+    EXPECT_NEAR(3.0f, status.error, 1e-4f);
+    // correction back onto the track, movement along it
+    EXPECT_NEAR(-3.0f, status.correction_vector[1], 1e-4f);
+    EXPECT_NEAR(5.0f, status.path_vector[0], 1e-4f);
+}
+
+TEST_F(PathFollowerSim, Deterministic) {
+    for (uint32_t seed = 0; seed < 5; seed++) {
+        MissionResult a = runMission(seed, VTOL);
+        MissionResult b = runMission(seed, VTOL);
+        ASSERT_EQ(a.completed, b.completed);
+        ASSERT_EQ(a.rmsError, b.rmsError);
+        ASSERT_EQ(a.settleTime, b.settleTime);
+    }
+}
+
+TEST_F(PathFollowerSim, VtolFlyDefaultSettings) {
+    MissionSummary summary = runMissions(missions, VTOL);
+
+    printSummary("vtol default settings", summary);
+    // limits a bit above what the defaults fly, strong gusty wind still beats a few holds
+    EXPECT_GE(summary.completed, summary.runs * 97 / 100);
+    EXPECT_LT(summary.meanRmsError, 4.0);
+    EXPECT_LT(summary.meanSettleTime, 7.5);
+    EXPECT_EQ(summary.runs, summary.guidanceOk);
+}
+
+// What tuning a setting looks like, the track error has to get worse without position feedback
+TEST_F(PathFollowerSim, VtolFlyHorizontalPosPSweep) {
+    float values[] = { 0.0f, 0.1f, 0.25f, 0.5f, 1.0f };
+    double rms[sizeof(values) / sizeof(values[0])];
+
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        VtolPathFollowerSettingsHorizontalPosPSet(&values[i]);
+
+        char name[32];
+        snprintf(name, sizeof(name), "HorizontalPosP %.2f", (double)values[i]);
+        MissionSummary summary = runMissions(SWEEP_MISSIONS, VTOL);
+        printSummary(name, summary);
+        rms[i] = summary.meanRmsError;
+    }
+    EXPECT_GT(rms[0], rms[2]);
+}
+
+TEST_F(PathFollowerSim, VtolLandDefaultSettings) {
+    int disarmed = 0;
+    float maxTouchdown = 0.0f, maxDrift = 0.0f, meanTime = 0.0f;
+    std::vector<LandingResult> results = runForked<LandingResult>(missions, [](int i) {
+        return runLanding(i);
+    });
+
+    for (const LandingResult & result : results) {
+        disarmed += result.disarmed;
+        meanTime += result.time / missions;
+        maxTouchdown = fmaxf(maxTouchdown, result.touchdownSpeed);
+        maxDrift     = fmaxf(maxDrift, result.drift);
+    }
+    printf("%-24s %5d/%-5d disarmed, touchdown max %4.2f m/s, drift max %5.2f m, time mean %5.1f s\n",
+           "vtol land", disarmed, missions, maxTouchdown, maxDrift, meanTime);
+
+    EXPECT_EQ(missions, disarmed);
+    EXPECT_LT(maxTouchdown, 1.0f);
+    EXPECT_LT(maxDrift, 4.0f);
+}
+
+TEST_F(PathFollowerSim, FixedWingFlyDefaultSettings) {
+    MissionSummary summary = runMissions(missions, FIXEDWING);
+
+    printSummary("fixed wing defaults", summary);
+    EXPECT_GE(summary.completed, summary.runs * 97 / 100);
+    EXPECT_LT(summary.meanRmsError, 25.0);
+}
+
+TEST_F(PathFollowerSim, GroundDriveDefaultSettings) {
+    MissionSummary summary = runMissions(missions, GROUND);
+
+    printSummary("ground drive defaults", summary);
+    EXPECT_GE(summary.completed, summary.runs * 97 / 100);
+    EXPECT_LT(summary.meanRmsError, 1.0);
+}
@@ -0,0 +1,348 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <vector>
+
+extern "C" {
+#include "pios_rfm22b_frame.h"
+#include "ecc.h"
+}
+
+// max_packet_len at 64kbps, and the sync, header and length bytes in front of it
+#define PACKET_LEN     63
+#define DATA_ROOM      (PACKET_LEN - RS_ECC_NPARITY)
+#define OVERHEAD_BYTES 9
+#define QUEUE_SIZE     256 // com tx buffer of a stream
+#define STATS_LEN      64 // packets in the link quality window
+#define STATS_PERIOD   8 // packets between link quality updates
+#define SLOTS          20000
+
+static uint32_t nextRandom(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// content of byte offset of a stream, to tell wrong data from right
+static uint8_t pattern(int stream, uint32_t offset)
+{
+    return (offset * 131 + (offset >> 8) * 7 + stream * 59) & 0xff;
+}
+
+struct Message {
+    uint32_t start;
+    uint32_t len;
+    uint32_t received;
+};
+
+// A com tx buffer fed with whole messages, messages that don't fit are dropped
+struct SimStream {
+    uint32_t written;
+    uint32_t sent;
+    uint32_t dropped;
+    std::vector<Message> messages;
+
+    void reset()
+    {
+        written = sent = dropped = 0;
+        messages.clear();
+    }
+
+    void enqueue(uint32_t len)
+    {
+        if (written - sent + len > QUEUE_SIZE) {
+            dropped += len;
+            return;
+        }
+        messages.push_back({ written, len, 0 });
+        written += len;
+    }
+
+    void deliver(uint32_t offset, uint32_t len)
+    {
+        // messages are in offset order, find the first one overlapping
+        uint32_t lo = 0, hi = messages.size();
+
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (messages[mid].start + messages[mid].len <= offset) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (uint32_t i = lo; i < messages.size() && messages[i].start < offset + len; i++) {
+            uint32_t begin = std::max(offset, messages[i].start);
+            uint32_t end   = std::min(offset + len, messages[i].start + messages[i].len);
+            messages[i].received += end - begin;
+        }
+    }
+
+    // bytes of messages that arrived complete
+    uint32_t goodput() const
+    {
+        uint32_t bytes = 0;
+
+        for (uint32_t i = 0; i < messages.size(); i++) {
+            if (messages[i].received == messages[i].len) {
+                bytes += messages[i].len;
+            }
+        }
+        return bytes;
+    }
+};
+
+struct Chunk {
+    int      stream;
+    uint32_t offset;
+    uint32_t len;
+};
+
+enum Mode { MODE_SINGLE, MODE_AGGREGATE, MODE_ADAPTIVE };
+
+struct SimResult {
+    double   goodput; // bytes of complete messages per slot
+    uint32_t packets;
+    uint32_t lost;
+    uint32_t corrupted;
+};
+
+// The streams and packet contents the callbacks work on, the com callbacks
+// only get an integer context.
+static SimStream streams[RFM22B_FRAME_NUM_STREAMS];
+static std::vector<Chunk> chunks;
+static uint32_t nextChunk;
+static uint32_t corruptedChunks;
+
+static uint16_t txOut(uint32_t context, uint8_t *buf, uint16_t buf_len, __attribute__((unused)) uint16_t *headroom,
+                      __attribute__((unused)) bool *task_woken)
+{
+    SimStream *s = &streams[context];
+    uint16_t len = std::min<uint32_t>(buf_len, s->written - s->sent);
+
+    for (uint16_t i = 0; i < len; i++) {
+        buf[i] = pattern(context, s->sent + i);
+    }
+    if (len) {
+        chunks.push_back({ (int)context, s->sent, len });
+        s->sent += len;
+    }
+    return len;
+}
+
+static uint16_t rxIn(uint32_t context, uint8_t *buf, uint16_t buf_len, __attribute__((unused)) uint16_t *headroom,
+                     __attribute__((unused)) bool *task_woken)
+{
+    // the chunks must arrive in the order they were packed
+    if (nextChunk >= chunks.size() || chunks[nextChunk].stream != (int)context || chunks[nextChunk].len != buf_len) {
+        corruptedChunks++;
+        return 0;
+    }
+    const Chunk & c = chunks[nextChunk++];
+    for (uint16_t i = 0; i < buf_len; i++) {
+        if (buf[i] != pattern(c.stream, c.offset + i)) {
+            corruptedChunks++;
+            return 0;
+        }
+    }
+    streams[context].deliver(c.offset, c.len);
+    return buf_len;
+}
+
+class RadioChannelTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        initialize_ecc();
+        chunks.clear();
+        nextChunk = 0;
+        corruptedChunks = 0;
+        for (int i = 0; i < RFM22B_FRAME_NUM_STREAMS; i++) {
+            streams[i].reset();
+            txStreams[i] = { txOut, (uint32_t)i };
+            rxStreams[i] = { rxIn, (uint32_t)i };
+        }
+    }
+
+    // Telemetry: UAVTalk objects of a few sizes, about 36 bytes per slot.
+    // Aux: a serial device trickling a few bytes into every slot.
+    void generateTraffic(uint32_t slot, uint32_t & state)
+    {
+        static const uint32_t sizes[] = { 14, 18, 26, 38, 50, 90 };
+
+        while (nextRandom(state) % 100 < 45) {
+            streams[0].enqueue(sizes[nextRandom(state) % (sizeof(sizes) / sizeof(sizes[0]))]);
+        }
+        if (slot % 2 == 0) {
+            streams[1].enqueue(12);
+        }
+    }
+
+    // Each transmitted byte is hit with probability byteErrorRate, errors in
+    // the sync, header or length bytes lose the whole packet.
+    SimResult simulate(Mode mode, double byteErrorRate)
+    {
+        SimResult result = { 0, 0, 0, 0 };
+        uint32_t threshold = byteErrorRate * 4294967295.0;
+        uint32_t state     = 0x5eed1234;
+        uint32_t channel   = 0x0badcafe;
+        uint8_t lastStream = 0;
+        uint8_t aggregateLen = 0;
+        uint8_t status[STATS_LEN];
+        uint8_t packet[PACKET_LEN];
+
+        SetUp();
+        memset(status, 0, sizeof(status));
+
+        for (uint32_t slot = 0; slot < SLOTS; slot++) {
+            generateTraffic(slot, state);
+
+            uint8_t room = DATA_ROOM;
+            if (mode == MODE_ADAPTIVE && aggregateLen && room > aggregateLen) {
+                room = aggregateLen;
+            }
+            chunks.clear();
+            nextChunk = 0;
+            uint8_t len = PIOS_RFM22B_FramePack(packet, room, txStreams, &lastStream, mode != MODE_SINGLE);
+            if (len == 0) {
+                continue;
+            }
+            result.packets++;
+            rs_encode_packet(packet, len);
+
+            bool lost = false;
+            for (int i = 0; i < OVERHEAD_BYTES; i++) {
+                lost |= nextRandom(channel) < threshold;
+            }
+            for (int i = 0; i < len + RS_ECC_NPARITY; i++) {
+                if (nextRandom(channel) < threshold) {
+                    packet[i] ^= 1 + nextRandom(channel) % 255;
+                }
+            }
+
+            // 0 good, 1 corrected, 2 error, 3 failure, as in rfm22b_add_rx_status()
+            uint8_t rx = 3;
+            if (!lost) {
+                int decoded = rs_decode_packet(packet, len + RS_ECC_NPARITY);
+                rx = (decoded == RS_DECODE_OK) ? 0 : (decoded == RS_DECODE_CORRECTED) ? 1 : 2;
+                if (rx < 2) {
+                    PIOS_RFM22B_FrameUnpack(packet, len, rxStreams);
+                }
+            }
+            result.lost += rx >= 2;
+            status[result.packets % STATS_LEN] = rx;
+
+            // the losses the receiving side would see, as in rfm22_updateStats()
+            if (mode == MODE_ADAPTIVE && result.packets % STATS_PERIOD == 0) {
+                uint8_t lostPackets = 0;
+                for (int i = 0; i < STATS_LEN; i++) {
+                    lostPackets += status[i] >= 2;
+                }
+                aggregateLen = PIOS_RFM22B_FrameAdaptLen(aggregateLen, DATA_ROOM, lostPackets);
+            }
+        }
+
+        result.goodput   = (double)(streams[0].goodput() + streams[1].goodput()) / SLOTS;
+        result.corrupted = corruptedChunks;
+        return result;
+    }
+
+    struct rfm22b_frame_stream txStreams[RFM22B_FRAME_NUM_STREAMS];
+    struct rfm22b_frame_stream rxStreams[RFM22B_FRAME_NUM_STREAMS];
+};
+
+TEST_F(RadioChannelTest, SingleChunkLayout) {
+    uint8_t packet[PACKET_LEN];
+    uint8_t lastStream = 0;
+
+    streams[0].enqueue(10);
+    streams[1].enqueue(10);
+
+    // one stream per packet, taking turns, the stream number in front
+    uint8_t len = PIOS_RFM22B_FramePack(packet, DATA_ROOM, txStreams, &lastStream, false);
+    EXPECT_EQ(11, len);
+    EXPECT_EQ(1, packet[0]);
+    chunks.clear();
+    len = PIOS_RFM22B_FramePack(packet, DATA_ROOM, txStreams, &lastStream, false);
+    EXPECT_EQ(11, len);
+    EXPECT_EQ(0, packet[0]);
+    EXPECT_EQ(0, PIOS_RFM22B_FramePack(packet, DATA_ROOM, txStreams, &lastStream, false));
+
+    // the receiver still understands it
+    EXPECT_TRUE(PIOS_RFM22B_FrameUnpack(packet, 11, rxStreams));
+    EXPECT_EQ(0u, corruptedChunks);
+    EXPECT_EQ(10u, streams[0].goodput());
+}
+
+TEST_F(RadioChannelTest, AggregatedLayout) {
+    uint8_t packet[PACKET_LEN];
+    uint8_t lastStream = 0;
+
+    streams[0].enqueue(20);
+    streams[1].enqueue(12);
+
+    uint8_t len = PIOS_RFM22B_FramePack(packet, DATA_ROOM, txStreams, &lastStream, true);
+    EXPECT_EQ(20 + 12 + 2 * RFM22B_FRAME_CHUNK_HEADER, len);
+    EXPECT_EQ(RFM22B_FRAME_CHUNK | 1, packet[0]);
+    EXPECT_EQ(12, packet[1]);
+    EXPECT_TRUE(PIOS_RFM22B_FrameUnpack(packet, len, rxStreams));
+    EXPECT_EQ(0u, corruptedChunks);
+    EXPECT_EQ(32u, streams[0].goodput() + streams[1].goodput());
+
+    // chunks running past the end of the packet are rejected
+    packet[1] = 200;
+    EXPECT_FALSE(PIOS_RFM22B_FrameUnpack(packet, len, rxStreams));
+    packet[1] = 12;
+    packet[0] = RFM22B_FRAME_CHUNK | 5;
+    EXPECT_FALSE(PIOS_RFM22B_FrameUnpack(packet, len, rxStreams));
+}
+
+TEST_F(RadioChannelTest, AdaptLen) {
+    // links losing less than half of the packets use the whole packet
+    EXPECT_EQ(DATA_ROOM, PIOS_RFM22B_FrameAdaptLen(0, DATA_ROOM, 0));
+    EXPECT_EQ(DATA_ROOM, PIOS_RFM22B_FrameAdaptLen(DATA_ROOM, DATA_ROOM, 20));
+
+    // bad links shrink down to the minimum, and grow back
+    uint8_t len = DATA_ROOM;
+    for (int i = 0; i < 40; i++) {
+        len = PIOS_RFM22B_FrameAdaptLen(len, DATA_ROOM, 60);
+    }
+    EXPECT_EQ(RFM22B_FRAME_MIN_LEN, len);
+    EXPECT_EQ(len, PIOS_RFM22B_FrameAdaptLen(len, DATA_ROOM, 32));
+    for (int i = 0; i < 40; i++) {
+        len = PIOS_RFM22B_FrameAdaptLen(len, DATA_ROOM, 10);
+    }
+    EXPECT_EQ(DATA_ROOM, len);
+}
+
+TEST_F(RadioChannelTest, Goodput) {
+    static const double rates[] = { 0, 0.005, 0.01, 0.02, 0.04, 0.06, 0.08 };
+
+    printf("byte errors  goodput bytes/slot (lost packets): single stream, aggregated, adaptive\n");
+    for (uint32_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        SimResult single    = simulate(MODE_SINGLE, rates[i]);
+        SimResult aggregate = simulate(MODE_AGGREGATE, rates[i]);
+        SimResult adaptive  = simulate(MODE_ADAPTIVE, rates[i]);
+
+        printf("%10.1f%%  %6.2f (%5u)  %6.2f (%5u)  %6.2f (%5u)\n", rates[i] * 100,
+               single.goodput, single.lost, aggregate.goodput, aggregate.lost, adaptive.goodput, adaptive.lost);
+
+        // packing both streams fits the offered load where one stream per slot does not,
+        // on links losing most packets the short single stream packets get through better
+        if (rates[i] <= 0.02) {
+            EXPECT_GT(aggregate.goodput, single.goodput * 1.05) << rates[i];
+        }
+        // adapting only kicks in on such links, and then makes up for some of it
+        EXPECT_GE(adaptive.goodput, aggregate.goodput * 0.95) << rates[i];
+        if (rates[i] >= 0.08) {
+            EXPECT_GT(adaptive.goodput, aggregate.goodput * 1.2) << rates[i];
+        }
+        if (rates[i] == 0) {
+            EXPECT_EQ(0u, single.corrupted + aggregate.corrupted + adaptive.corrupted);
+            EXPECT_EQ(0u, adaptive.lost);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock */
+
+extern "C" {
+#include "ecc.h"
+}
+
+#define MAX_PACKET_LEN 255
+#define PACKETS        20000
+#define BENCH_PACKETS  20000
+#define BENCH_LEN      64
+
+static uint32_t nextRandom(uint32_t & state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+class RsCodeTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        initialize_ecc();
+        state = 0x2545f491;
+    }
+
+    void randomPacket(uint8_t *data, int len)
+    {
+        for (int i = 0; i < len; i++) {
+            data[i] = nextRandom(state);
+        }
+    }
+
+    // flips between 0 and maxErrors bytes, returns how many
+    int injectErrors(uint8_t *codeword, int csize, int maxErrors)
+    {
+        int errors = nextRandom(state) % (maxErrors + 1);
+
+        for (int n = 0; n < errors; n++) {
+            codeword[nextRandom(state) % csize] ^= 1 + nextRandom(state) % 255;
+        }
+        return errors;
+    }
+
+    // what the radio driver used to do
+    int referenceDecode(uint8_t *codeword, int csize)
+    {
+        decode_data(codeword, csize);
+        if (check_syndrome() == 0) {
+            return RS_DECODE_OK;
+        }
+        return correct_errors_erasures(codeword, csize, 0, 0) ? RS_DECODE_CORRECTED : RS_DECODE_FAILED;
+    }
+
+    uint32_t state;
+};
+
+TEST_F(RsCodeTest, EncodeMatchesReference) {
+    uint8_t data[MAX_PACKET_LEN];
+    uint8_t reference[MAX_PACKET_LEN];
+
+    for (int len = 1; len <= MAX_PACKET_LEN - RS_ECC_NPARITY; len++) {
+        randomPacket(data, len);
+        encode_data(data, len, reference);
+        rs_encode_packet(data, len);
+        ASSERT_EQ(0, memcmp(reference, data, len + RS_ECC_NPARITY)) << "length " << len;
+    }
+}
+
+TEST_F(RsCodeTest, DecodeMatchesReference) {
+    uint8_t codeword[MAX_PACKET_LEN];
+    uint8_t reference[MAX_PACKET_LEN];
+    int results[3] = { 0, 0, 0 };
+
+    for (int n = 0; n < PACKETS; n++) {
+        int len = 1 + nextRandom(state) % (MAX_PACKET_LEN - RS_ECC_NPARITY);
+        int csize = len + RS_ECC_NPARITY;
+        randomPacket(codeword, len);
+        rs_encode_packet(codeword, len);
+        int errors = injectErrors(codeword, csize, RS_ECC_NPARITY);
+        memcpy(reference, codeword, csize);
+
+        int expected = referenceDecode(reference, csize);
+        int status   = rs_decode_packet(codeword, csize);
+        ASSERT_EQ(expected, status) << "packet " << n;
+        ASSERT_EQ(0, memcmp(reference, codeword, csize)) << "packet " << n;
+        if (errors == 0) {
+            ASSERT_EQ(RS_DECODE_OK, status);
+        }
+        results[status + 1]++;
+    }
+    printf("%d packets: %d good, %d corrected, %d uncorrectable\n", PACKETS, results[RS_DECODE_OK + 1],
+           results[RS_DECODE_CORRECTED + 1], results[RS_DECODE_FAILED + 1]);
+    // with 4 parity bytes up to 2 byte errors are corrected
+    EXPECT_GT(results[RS_DECODE_CORRECTED + 1], 0);
+}
+
+TEST_F(RsCodeTest, Benchmark) {
+    static uint8_t packets[BENCH_PACKETS][BENCH_LEN + RS_ECC_NPARITY];
+
+    for (int n = 0; n < BENCH_PACKETS; n++) {
+        randomPacket(packets[n], BENCH_LEN);
+    }
+
+    clock_t start = clock();
+    for (int n = 0; n < BENCH_PACKETS; n++) {
+        encode_data(packets[n], BENCH_LEN, packets[n]);
+        referenceDecode(packets[n], BENCH_LEN + RS_ECC_NPARITY);
+    }
+    double reference = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    int good = 0;
+    for (int n = 0; n < BENCH_PACKETS; n++) {
+        rs_encode_packet(packets[n], BENCH_LEN);
+        good += rs_decode_packet(packets[n], BENCH_LEN + RS_ECC_NPARITY) == RS_DECODE_OK;
+    }
+    double table = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    EXPECT_EQ(BENCH_PACKETS, good);
+    printf("%d byte packets, encode + check: rscode %.0f packets/s, table driven %.0f packets/s\n", BENCH_LEN,
+           reference > 0 ? BENCH_PACKETS / reference : 0, table > 0 ? BENCH_PACKETS / table : 0);
+}
@@ -0,0 +1,11 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just what ssp.c needs */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#endif /* PIOS_H */
@@ -0,0 +1,412 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* getenv */
+#include <deque>
+#include <vector>
+
+extern "C" {
+#include "ssp.h"
+}
+
+/*
+ * Two SSP ports talking over a simulated serial link: the ground end as used
+ * by the GCS uploader and the board end as used by the bootloaders. Each
+ * direction sends one byte per byte time, delivers it after a fixed latency
+ * and drops whole packets at the given rate. Time only advances in the test
+ * loop, so the results do not depend on the host.
+ */
+
+#define SYNC            225
+#define TICK_US         20
+#define PACKET_BYTES    63 // DFU_BUFFER_SIZE
+#define MAX_DATA_LEN    255
+#define MAX_BUF_SIZE    (1 + 1 + MAX_DATA_LEN + 2)
+#define TIMEOUT_US      250000
+#define MAX_RETRY       10
+
+struct LinkParams {
+    uint32_t byte_us; // time on the wire per byte
+    uint32_t latency_us; // added to every byte
+    float    loss; // fraction of packets lost
+};
+
+// 57600 baud over a USB serial adapter or radio modem
+static const LinkParams defaultLink = { 174, 10000, 0.01f };
+
+static uint32_t simTime;
+
+class Link {
+public:
+    void reset(const LinkParams & params, uint32_t seed)
+    {
+        p = params;
+        rng      = seed;
+        busyUntil = 0;
+        dropping = false;
+        down     = false;
+        bytes.clear();
+    }
+
+    void write(uint8_t c)
+    {
+        // SYNC is never escaped, it starts every packet
+        if (c == SYNC) {
+            dropping = down || (nextRandom() % 10000) < (uint32_t)(p.loss * 10000.0f);
+        }
+        if (dropping) {
+            return;
+        }
+        busyUntil = ((busyUntil > simTime) ? busyUntil : simTime) + p.byte_us;
+        bytes.push_back(std::make_pair(busyUntil + p.latency_us, c));
+    }
+
+    int16_t read()
+    {
+        if (bytes.empty() || bytes.front().first > simTime) {
+            return -1;
+        }
+        uint8_t c = bytes.front().second;
+        bytes.pop_front();
+        return c;
+    }
+
+    bool down;
+
+private:
+    uint32_t nextRandom()
+    {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+
+    LinkParams p;
+    uint32_t rng;
+    uint32_t busyUntil;
+    bool dropping;
+    std::deque<std::pair<uint32_t, uint8_t> > bytes;
+};
+
+static Link toBoard;
+static Link toGround;
+
+static Port_t ground;
+static Port_t board;
+static std::vector<uint8_t> groundReceived;
+static std::vector<uint8_t> boardReceived;
+static bool pumpBoard; // let the board run while the ground blocks in ssp_Synchronise()
+
+static void step();
+
+static int16_t groundRead(void)
+{
+    return toGround.read();
+}
+
+static void groundWrite(uint8_t c)
+{
+    toBoard.write(c);
+}
+
+static void groundCallBack(uint8_t *buf, uint16_t len)
+{
+    groundReceived.insert(groundReceived.end(), buf, buf + len);
+}
+
+static uint32_t groundTime(void)
+{
+    if (pumpBoard) {
+        step();
+    }
+    return simTime;
+}
+
+static int16_t boardRead(void)
+{
+    return toBoard.read();
+}
+
+static void boardWrite(uint8_t c)
+{
+    toGround.write(c);
+}
+
+static void boardCallBack(uint8_t *buf, uint16_t len)
+{
+    boardReceived.insert(boardReceived.end(), buf, buf + len);
+}
+
+static uint32_t boardTime(void)
+{
+    return simTime;
+}
+
+static void process(Port_t *port)
+{
+    while (ssp_ReceiveProcess(port) == SSP_RX_COMPLETE) {}
+}
+
+// the board loop while the ground is blocked, time passes in the ground's ssp_SendProcess()
+static void step()
+{
+    simTime += TICK_US;
+    process(&board);
+    (void)ssp_SendProcess(&board);
+}
+
+class SSPTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        simTime = 0;
+        toBoard.reset(defaultLink, 0x1234567);
+        toGround.reset(defaultLink, 0x7654321);
+        groundReceived.clear();
+        boardReceived.clear();
+        pumpBoard = false;
+    }
+
+    void setLink(const LinkParams & params)
+    {
+        toBoard.reset(params, 0x1234567);
+        toGround.reset(params, 0x7654321);
+    }
+
+    // window 0 is a port that does not know about windows
+    void init(uint8_t groundWindow, uint8_t boardWindow, bool boardTxWindow = false)
+    {
+        PortConfig_t config = {
+            .rxBuf         = groundRxBuf,
+            .rxBufSize     = MAX_DATA_LEN,
+            .txBuf         = groundTxBuf,
+            .txBufSize     = MAX_DATA_LEN,
+            .max_retry     = MAX_RETRY,
+            .timeoutLen    = TIMEOUT_US,
+            .pfCallBack    = groundCallBack,
+            .pfSerialRead  = groundRead,
+            .pfSerialWrite = groundWrite,
+            .pfGetTime     = groundTime,
+            .windowSize    = groundWindow,
+            .txWindowBuf   = groundTxWindow,
+            .rxWindowBuf   = groundRxWindow,
+        };
+
+        memset(&ground, 0, sizeof(ground));
+        ssp_Init(&ground, &config);
+
+        // the bootloaders only receive with a window
+        config.rxBuf         = boardRxBuf;
+        config.txBuf         = boardTxBuf;
+        config.pfCallBack    = boardCallBack;
+        config.pfSerialRead  = boardRead;
+        config.pfSerialWrite = boardWrite;
+        config.pfGetTime     = boardTime;
+        config.windowSize    = boardWindow;
+        config.txWindowBuf   = boardTxWindow ? boardTxWindowBuf : NULL;
+        config.rxWindowBuf   = boardRxWindow;
+        memset(&board, 0, sizeof(board));
+        ssp_Init(&board, &config);
+    }
+
+    bool synchronise()
+    {
+        pumpBoard = true;
+        bool ok = ssp_Synchronise(&ground);
+        pumpBoard = false;
+        return ok;
+    }
+
+    // both ends running their loops until the data has arrived, returns the time it took in us
+    uint32_t transfer(const std::vector<uint8_t> & toBoardData, const std::vector<uint8_t> & toGroundData)
+    {
+        uint32_t start = simTime;
+        size_t groundSent = 0;
+        size_t boardSent  = 0;
+
+        while (boardReceived.size() < toBoardData.size() || groundReceived.size() < toGroundData.size()) {
+            if (groundSent < toBoardData.size()) {
+                uint16_t len = std::min((size_t)PACKET_BYTES, toBoardData.size() - groundSent);
+                if (ssp_SendData(&ground, &toBoardData[groundSent], len) == SSP_TX_WAITING) {
+                    groundSent += len;
+                }
+            }
+            if (boardSent < toGroundData.size()) {
+                uint16_t len = std::min((size_t)PACKET_BYTES, toGroundData.size() - boardSent);
+                if (ssp_SendData(&board, &toGroundData[boardSent], len) == SSP_TX_WAITING) {
+                    boardSent += len;
+                }
+            }
+            process(&ground);
+            EXPECT_NE(SSP_TX_TIMEOUT, ssp_SendProcess(&ground));
+            process(&board);
+            EXPECT_NE(SSP_TX_TIMEOUT, ssp_SendProcess(&board));
+            simTime += TICK_US;
+            if (simTime - start > 600000000u) {
+                ADD_FAILURE() << "transfer did not finish";
+                break;
+            }
+        }
+        return simTime - start;
+    }
+
+    static std::vector<uint8_t> makeData(uint32_t seed, size_t size)
+    {
+        std::vector<uint8_t> data(size);
+
+        for (size_t i = 0; i < size; i++) {
+            seed    = seed * 1103515245 + 12345;
+            data[i] = seed >> 16;
+        }
+        return data;
+    }
+
+    uint8_t groundRxBuf[MAX_BUF_SIZE];
+    uint8_t groundTxBuf[MAX_BUF_SIZE];
+    uint8_t groundTxWindow[SSP_WINDOW_BUF_SIZE(SSP_WINDOW_MAX, MAX_DATA_LEN)];
+    uint8_t groundRxWindow[SSP_WINDOW_BUF_SIZE(SSP_WINDOW_MAX, MAX_DATA_LEN)];
+    uint8_t boardRxBuf[MAX_BUF_SIZE];
+    uint8_t boardTxBuf[MAX_BUF_SIZE];
+    uint8_t boardTxWindowBuf[SSP_WINDOW_BUF_SIZE(SSP_WINDOW_MAX, MAX_DATA_LEN)];
+    uint8_t boardRxWindow[SSP_WINDOW_BUF_SIZE(SSP_WINDOW_MAX, MAX_DATA_LEN)];
+};
+
+TEST_F(SSPTest, NegotiatesSmallerWindow) {
+    init(8, 4);
+    ASSERT_TRUE(synchronise());
+    EXPECT_EQ(4, ground.txWindow);
+    EXPECT_EQ(8, ground.rxWindow);
+    EXPECT_EQ(1, board.txWindow); // no tx window storage
+    EXPECT_EQ(4, board.rxWindow);
+}
+
+TEST_F(SSPTest, OldBoardStaysStopAndWait) {
+    init(8, 0);
+    ASSERT_TRUE(synchronise());
+    EXPECT_EQ(1, ground.txWindow);
+    EXPECT_EQ(1, ground.rxWindow);
+    EXPECT_EQ(1, board.rxWindow);
+}
+
+TEST_F(SSPTest, OldGroundStaysStopAndWait) {
+    init(0, 8);
+    ASSERT_TRUE(synchronise());
+    EXPECT_EQ(1, ground.txWindow);
+    EXPECT_EQ(1, board.txWindow);
+    EXPECT_EQ(1, board.rxWindow);
+}
+
+TEST_F(SSPTest, StopAndWaitTransfer) {
+    std::vector<uint8_t> data = makeData(1, 8000);
+
+    init(0, 0);
+    ASSERT_TRUE(synchronise());
+    transfer(data, std::vector<uint8_t>());
+    EXPECT_TRUE(data == boardReceived);
+}
+
+TEST_F(SSPTest, WindowTransferInOrderDespiteLoss) {
+    LinkParams lossy = defaultLink;
+    std::vector<uint8_t> data = makeData(2, 20000);
+
+    lossy.loss = 0.1f;
+    setLink(lossy);
+    init(8, 8);
+    ASSERT_TRUE(synchronise());
+    ASSERT_EQ(8, ground.txWindow);
+    transfer(data, std::vector<uint8_t>());
+    EXPECT_TRUE(data == boardReceived);
+}
+
+TEST_F(SSPTest, WindowBothWays) {
+    LinkParams lossy = defaultLink;
+    std::vector<uint8_t> up   = makeData(3, 10000);
+    std::vector<uint8_t> down = makeData(4, 10000);
+
+    lossy.loss = 0.05f;
+    setLink(lossy);
+    init(6, 8, true);
+    ASSERT_TRUE(synchronise());
+    ASSERT_EQ(6, ground.txWindow); // limited by its own window
+    ASSERT_EQ(6, board.txWindow); // limited by the ground's receive window
+    transfer(up, down);
+    EXPECT_TRUE(up == boardReceived);
+    EXPECT_TRUE(down == groundReceived);
+}
+
+TEST_F(SSPTest, ResynchroniseRestartsWindow) {
+    std::vector<uint8_t> data = makeData(5, 3000);
+
+    init(8, 8);
+    ASSERT_TRUE(synchronise());
+    transfer(data, std::vector<uint8_t>());
+    ASSERT_TRUE(synchronise());
+    boardReceived.clear();
+    transfer(data, std::vector<uint8_t>());
+    EXPECT_TRUE(data == boardReceived);
+}
+
+TEST_F(SSPTest, WindowTimesOut) {
+    uint8_t data[PACKET_BYTES] = { 0 };
+    int16_t status;
+
+    init(8, 8);
+    ASSERT_TRUE(synchronise());
+    toBoard.down = true;
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(SSP_TX_WAITING, ssp_SendData(&ground, data, sizeof(data)));
+    }
+    do {
+        simTime += TICK_US;
+        process(&ground);
+        status = ssp_SendProcess(&ground);
+    } while (status == SSP_TX_WAITING);
+    EXPECT_EQ(SSP_TX_TIMEOUT, status);
+    EXPECT_EQ(SSP_TX_IDLE, ssp_SendProcess(&ground));
+    EXPECT_EQ(SSP_TX_WAITING, ssp_SendData(&ground, data, sizeof(data)));
+}
+
+/*
+ * Upload time of a small firmware image at a few link latencies and loss
+ * rates. SSP_LATENCY_US and SSP_LOSS add a link of your own.
+ */
+TEST_F(SSPTest, Benchmark) {
+    std::vector<LinkParams> links;
+    std::vector<uint8_t> image = makeData(6, 32 * 1024);
+
+    links.push_back((LinkParams) { 174, 0, 0.0f });
+    links.push_back((LinkParams) { 174, 5000, 0.0f });
+    links.push_back(defaultLink);
+    links.push_back((LinkParams) { 174, 40000, 0.02f });
+    if (getenv("SSP_LATENCY_US") || getenv("SSP_LOSS")) {
+        LinkParams custom = defaultLink;
+        if (getenv("SSP_LATENCY_US")) {
+            custom.latency_us = atoi(getenv("SSP_LATENCY_US"));
+        }
+        if (getenv("SSP_LOSS")) {
+            custom.loss = atof(getenv("SSP_LOSS"));
+        }
+        links.push_back(custom);
+    }
+
+    printf("latency   loss  stop and wait    window %d   speedup\n", SSP_WINDOW_MAX);
+    for (size_t i = 0; i < links.size(); i++) {
+        uint32_t us[2];
+        for (int windowed = 0; windowed < 2; windowed++) {
+            SetUp();
+            setLink(links[i]);
+            init(windowed ? SSP_WINDOW_MAX : 0, windowed ? SSP_WINDOW_MAX : 0);
+            ASSERT_TRUE(synchronise());
+            us[windowed] = transfer(image, std::vector<uint8_t>());
+            ASSERT_TRUE(image == boardReceived);
+        }
+        printf("%5u ms %5.1f%% %10.2f s %10.2f s %8.1fx\n", links[i].latency_us / 1000, (double)links[i].loss * 100.0,
+               us[0] / 1e6, us[1] / 1e6, (double)us[0] / us[1]);
+        // never slower, clearly faster once the round trip is longer than a packet
+        EXPECT_LE(us[1], us[0] + us[0] / 50);
+        if (links[i].latency_us >= 10000) {
+            EXPECT_LT(us[1] * 2, us[0]);
+        }
+    }
+}
@@ -0,0 +1,256 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <math.h> /* fabsf */
+#include <chrono>
+
+extern "C" {
+#include "WorldMagModel.h"
+#include "WMMInternal.h"
+}
+
+/*
+ * Reference values are what WMM_GetMagVector() returned before it was made
+ * allocation free, for a spread of locations, altitudes and dates.
+ */
+
+struct Date {
+    uint16_t month;
+    uint16_t day;
+    uint16_t year;
+};
+
+struct Location {
+    float lat;
+    float lon;
+    float alt;
+};
+
+static const Date dates[] = {
+    { 1,  1,  2015 },
+    { 7,  2,  2017 },
+    { 6,  15, 2019 },
+    { 12, 31, 2020 },
+};
+
+static const Location locations[] = {
+    { 80.0f,   0.0f,    0.0f      },
+    { 0.0f,    120.0f,  0.0f      },
+    { -80.0f,  -120.0f, 0.0f      },
+    { 80.0f,   0.0f,    100000.0f },
+    { 0.0f,    120.0f,  100000.0f },
+    { -80.0f,  -120.0f, 100000.0f },
+    { 47.37f,  8.54f,   450.0f    },
+    { -33.87f, 151.21f, 50.0f     },
+    { 37.77f,  -122.42f, 10.0f    },
+    { 64.10f,  -21.90f, 30.0f     },
+    { -89.90f, 10.0f,   0.0f      },
+    { 0.0f,    -180.0f, 0.0f      },
+    { 52.52f,  13.40f,  2000.0f   },
+};
+
+#define NUM_DATES     (sizeof(dates) / sizeof(dates[0]))
+#define NUM_LOCATIONS (sizeof(locations) / sizeof(locations[0]))
+
+static const float reference[NUM_DATES][NUM_LOCATIONS][3] = {
+    {
+        { 66.3657f,  -4.5188f,   544.0889f  }, { 395.2110f, 3.7768f,    -112.2879f }, { 57.9629f,  157.5909f, -529.2713f },
+        { 63.2339f,  -4.7762f,   522.4907f  }, { 375.3806f, 3.5107f,    -107.5108f }, { 56.1222f,  147.8926f, -503.8580f },
+        { 214.7959f, 7.3358f,    427.4260f  }, { 241.8096f, 53.7980f,   -514.3477f }, { 226.9338f, 55.6614f,  425.2878f  },
+        { 126.9563f, -33.0151f,  506.9105f  }, { 128.5927f, -107.4284f, -522.5145f }, { 335.6360f, 56.5794f,  -29.5535f  },
+        { 186.1817f, 10.8993f,   458.2115f  },
+    },
+    {
+        { 66.0521f,  -2.9879f,   545.0628f  }, { 395.6937f, 2.5234f,    -110.6803f }, { 58.6453f,  157.6413f, -527.0625f },
+        { 62.9436f,  -3.3117f,   523.3776f  }, { 375.8435f, 2.3578f,    -106.0062f }, { 56.7489f,  147.9307f, -501.7961f },
+        { 215.0188f, 8.8279f,    428.5407f  }, { 241.6111f, 53.8414f,   -514.2299f }, { 226.1362f, 54.6683f,  422.9641f  },
+        { 127.6855f, -31.3225f,  507.3783f  }, { 128.1561f, -108.4097f, -520.9553f }, { 335.3479f, 56.6933f,  -30.0894f  },
+        { 186.1818f, 12.2964f,   459.4708f  },
+    },
+    {
+        { 65.8070f,  -1.7911f,   545.8243f  }, { 396.0710f, 1.5435f,    -109.4235f }, { 59.1788f,  157.6807f, -525.3357f },
+        { 62.7167f,  -2.1668f,   524.0707f  }, { 376.2055f, 1.4565f,    -104.8299f }, { 57.2388f,  147.9605f, -500.1841f },
+        { 215.1932f, 9.9943f,    429.4122f  }, { 241.4559f, 53.8754f,   -514.1378f }, { 225.5126f, 53.8919f,  421.1474f  },
+        { 128.2556f, -29.9993f,  507.7444f  }, { 127.8149f, -109.1768f, -519.7365f }, { 335.1226f, 56.7822f,  -30.5083f  },
+        { 186.1820f, 13.3885f,   460.4553f  },
+    },
+    {
+        { 65.6130f,  -0.8443f,   546.4266f  }, { 396.3696f, 0.7683f,    -108.4293f }, { 59.6008f,  157.7118f, -523.9700f },
+        { 62.5372f,  -1.2611f,   524.6191f  }, { 376.4919f, 0.7435f,    -103.8993f }, { 57.6263f,  147.9840f, -498.9091f },
+        { 215.3311f, 10.9171f,   430.1013f  }, { 241.3330f, 53.9022f,   -514.0649f }, { 225.0193f, 53.2777f,  419.7103f  },
+        { 128.7066f, -28.9525f,  508.0338f  }, { 127.5450f, -109.7837f, -518.7722f }, { 334.9443f, 56.8526f,  -30.8397f  },
+        { 186.1822f, 14.2525f,   461.2340f  },
+    },
+};
+
+// reference values are printed with four decimals, the rest is float rounding
+#define epsilon_reference 0.01f
+
+// interpolation error of the grid, in the same units as B (mGauss)
+#define epsilon_grid      0.5f
+
+class WMMTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        WMM_Initialize();
+    }
+};
+
+TEST_F(WMMTest, MatchesReference) {
+    float B[3];
+
+    for (unsigned d = 0; d < NUM_DATES; d++) {
+        for (unsigned l = 0; l < NUM_LOCATIONS; l++) {
+            const Location &loc = locations[l];
+            ASSERT_EQ(0, WMM_GetMagVector(loc.lat, loc.lon, loc.alt, dates[d].month, dates[d].day, dates[d].year, B));
+            for (unsigned k = 0; k < 3; k++) {
+                EXPECT_NEAR(reference[d][l][k], B[k], epsilon_reference) << "date " << d << " location " << l << " axis " << k;
+            }
+        }
+    }
+}
+
+TEST_F(WMMTest, RangeErrors) {
+    float B[3];
+
+    EXPECT_EQ(-1, WMM_GetMagVector(-90.1f, 0.0f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-2, WMM_GetMagVector(90.1f, 0.0f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-3, WMM_GetMagVector(0.0f, -180.1f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-4, WMM_GetMagVector(0.0f, 180.1f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-8, WMM_GetMagVector(0.0f, 0.0f, 0.0f, 13, 1, 2018, B));
+    EXPECT_EQ(-8, WMM_GetMagVector(0.0f, 0.0f, 0.0f, 2, 29, 2018, B));
+
+    EXPECT_EQ(-1, WMM_GetGridMagVector(-90.1f, 0.0f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-2, WMM_GetGridMagVector(90.1f, 0.0f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-3, WMM_GetGridMagVector(0.0f, -180.1f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-4, WMM_GetGridMagVector(0.0f, 180.1f, 0.0f, 1, 1, 2018, B));
+    EXPECT_EQ(-8, WMM_GetGridMagVector(0.0f, 0.0f, 0.0f, 13, 1, 2018, B));
+}
+
+// flies a straight line and checks the grid against the model on every step
+static float maxGridError(float lat, float lon, float alt, float dLat, float dLon, float dAlt, int steps)
+{
+    float maxError = 0.0f;
+
+    for (int s = 0; s < steps; s++) {
+        float direct[3], interpolated[3];
+
+        EXPECT_EQ(0, WMM_GetMagVector(lat, lon, alt, 6, 1, 2018, direct));
+        EXPECT_EQ(0, WMM_GetGridMagVector(lat, lon, alt, 6, 1, 2018, interpolated));
+        for (int k = 0; k < 3; k++) {
+            maxError = fmaxf(maxError, fabsf(direct[k] - interpolated[k]));
+        }
+
+        lat += dLat;
+        lon += dLon;
+        alt += dAlt;
+        if (lon > 180.0f) {
+            lon -= 360.0f;
+        } else if (lon < -180.0f) {
+            lon += 360.0f;
+        }
+    }
+    return maxError;
+}
+
+TEST_F(WMMTest, GridAccuracy) {
+    // long flights in all directions, steps well below the grid spacing
+    float error = 0.0f;
+
+    error = fmaxf(error, maxGridError(47.37f, 8.54f, 450.0f, 0.01f, 0.013f, 0.0f, 1000));
+    error = fmaxf(error, maxGridError(-33.87f, 151.21f, 50.0f, -0.007f, -0.011f, 0.5f, 1000));
+    error = fmaxf(error, maxGridError(64.10f, -21.90f, 30.0f, 0.003f, 0.02f, 0.0f, 1000));
+    error = fmaxf(error, maxGridError(-5.0f, 100.0f, 3000.0f, 0.02f, 0.0f, -2.0f, 1000));
+    printf("largest grid error %.4f mG\n", (double)error);
+    EXPECT_LT(error, epsilon_grid);
+}
+
+TEST_F(WMMTest, GridWrapsAroundDateLine) {
+    float error = maxGridError(-17.0f, 179.0f, 0.0f, 0.001f, 0.005f, 0.0f, 400);
+
+    EXPECT_LT(error, epsilon_grid);
+    error = maxGridError(52.0f, -179.5f, 0.0f, 0.0f, -0.004f, 0.0f, 400);
+    EXPECT_LT(error, epsilon_grid);
+}
+
+TEST_F(WMMTest, GridShiftMatchesRebuild) {
+    float shifted[3], rebuilt[3];
+
+    // start somewhere, then move far enough for a shift of the grid but not a rebuild
+    ASSERT_EQ(0, WMM_GetGridMagVector(46.0f, 7.0f, 500.0f, 6, 1, 2018, shifted));
+    ASSERT_EQ(0, WMM_GetGridMagVector(46.7f, 7.3f, 500.0f, 6, 1, 2018, shifted));
+    ASSERT_EQ(0, WMM_GetGridMagVector(45.9f, 8.2f, 500.0f, 6, 1, 2018, shifted));
+
+    // a large altitude change forces a rebuild, coming back forces another around the same nodes
+    ASSERT_EQ(0, WMM_GetGridMagVector(45.9f, 8.2f, 5000.0f, 6, 1, 2018, rebuilt));
+    ASSERT_EQ(0, WMM_GetGridMagVector(45.9f, 8.2f, 500.0f, 6, 1, 2018, rebuilt));
+
+    for (int k = 0; k < 3; k++) {
+        EXPECT_NEAR(shifted[k], rebuilt[k], 1e-3f);
+    }
+}
+
+TEST_F(WMMTest, GridFollowsDateAndAltitude) {
+    float B[3], direct[3];
+
+    ASSERT_EQ(0, WMM_GetGridMagVector(47.37f, 8.54f, 450.0f, 1, 1, 2015, B));
+    EXPECT_NEAR(reference[0][6][0], B[0], epsilon_grid);
+    EXPECT_NEAR(reference[0][6][1], B[1], epsilon_grid);
+    EXPECT_NEAR(reference[0][6][2], B[2], epsilon_grid);
+
+    ASSERT_EQ(0, WMM_GetGridMagVector(47.37f, 8.54f, 450.0f, 12, 31, 2020, B));
+    EXPECT_NEAR(reference[3][6][0], B[0], epsilon_grid);
+    EXPECT_NEAR(reference[3][6][1], B[1], epsilon_grid);
+    EXPECT_NEAR(reference[3][6][2], B[2], epsilon_grid);
+
+    ASSERT_EQ(0, WMM_GetGridMagVector(47.37f, 8.54f, 100000.0f, 12, 31, 2020, B));
+    ASSERT_EQ(0, WMM_GetMagVector(47.37f, 8.54f, 100000.0f, 12, 31, 2020, direct));
+    for (int k = 0; k < 3; k++) {
+        EXPECT_NEAR(direct[k], B[k], epsilon_grid);
+    }
+}
+
+TEST_F(WMMTest, GridNotUsedNearPoles) {
+    float lat = 90.0f - WMM_GRID_NODES * WMM_GRID_SPACING + 0.01f;
+    float B[3], direct[3];
+
+    for (float l = lat; l <= 90.0f; l += 0.37f) {
+        ASSERT_EQ(0, WMM_GetGridMagVector(l, 33.3f, 0.0f, 6, 1, 2018, B));
+        ASSERT_EQ(0, WMM_GetMagVector(l, 33.3f, 0.0f, 6, 1, 2018, direct));
+        for (int k = 0; k < 3; k++) {
+            EXPECT_EQ(direct[k], B[k]);
+        }
+        ASSERT_EQ(0, WMM_GetGridMagVector(-l, 33.3f, 0.0f, 6, 1, 2018, B));
+        ASSERT_EQ(0, WMM_GetMagVector(-l, 33.3f, 0.0f, 6, 1, 2018, direct));
+        for (int k = 0; k < 3; k++) {
+            EXPECT_EQ(direct[k], B[k]);
+        }
+    }
+}
+
+TEST_F(WMMTest, Throughput) {
+    // a vehicle cruising at 30 m/s, asked once a second for an hour
+    const int steps = 3600;
+    const float dLat = 30.0f / 111000.0f;
+    float B[3], sum = 0.0f;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (int s = 0; s < steps; s++) {
+        WMM_GetMagVector(47.0f + s * dLat, 8.0f + s * dLat, 500.0f, 6, 1, 2018, B);
+        sum += B[0];
+    }
+    std::chrono::steady_clock::time_point middle = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        WMM_GetGridMagVector(47.0f + s * dLat, 8.0f + s * dLat, 500.0f, 6, 1, 2018, B);
+        sum -= B[0];
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    double direct = std::chrono::duration<double, std::micro>(middle - start).count() / steps;
+    double grid   = std::chrono::duration<double, std::micro>(end - middle).count() / steps;
+
+    printf("direct %.2f us, grid %.2f us per call (difference of sums %.3f)\n", direct, grid, (double)sum);
+    EXPECT_LT(grid, direct);
+}
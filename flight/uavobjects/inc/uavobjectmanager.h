@@ -180,6 +180,9 @@ typedef struct {
     uint32_t eventCallbackErrors;
     uint32_t lastCallbackErrorID;
     uint32_t lastQueueErrorID;
+    uint16_t registeredObjects; /** Number of objects with allocated data */
+    uint16_t declaredObjects; /** Number of declared objects not registered yet */
+    uint32_t allocatedBytes; /** Heap used by object and instance data */
 } UAVObjStats;
 
 typedef struct {
@@ -188,10 +191,32 @@ typedef struct {
     uint16_t instance_size;
 } __attribute__((packed, aligned(4))) UAVObjType;
 
+/**
+ * Registration parameters of an object declared with UAVObjDeclare().
+ */
+typedef struct {
+    const UAVObjType *type;
+    bool isSingleInstance;
+    bool isSettings;
+    bool isPriority;
+} __attribute__((aligned(4))) UAVObjDeclaration;
+
+/**
+ * A declared object handle points to its declaration with the lowest bit set,
+ * the object is registered on first access.
+ */
+static inline bool UAVObjIsDeclared(UAVObjHandle obj_handle)
+{
+    return ((uintptr_t)obj_handle) & 1;
+}
+
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats *statsOut);
 void UAVObjClearStats();
 UAVObjHandle UAVObjRegister(const UAVObjType *type, bool isSingleInstance, bool isSettings, bool isPriority);
+int32_t UAVObjDeclare(UAVObjHandle *handle, const UAVObjDeclaration *declaration);
+UAVObjHandle UAVObjRegisterDeclared(UAVObjHandle *handle);
+void UAVObjSetRegisteredCallback(void (*callback)(UAVObjHandle obj));
 UAVObjHandle UAVObjGetByID(uint32_t id);
 uint32_t UAVObjGetID(UAVObjHandle obj);
 uint32_t UAVObjGetNumBytes(UAVObjHandle obj);
@@ -208,9 +233,14 @@ uint8_t UAVObjUpdateCRC(UAVObjHandle obj_handle, uint16_t instId, uint8_t crc);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjDeleteById(uint32_t obj_id, uint16_t instId);
 int32_t UAVObjSaveSettings();
 int32_t UAVObjLoadSettings();
 int32_t UAVObjDeleteSettings();
+void UAVObjBeginSettingsTransaction();
+int32_t UAVObjCommitSettingsTransaction();
+void UAVObjAbortSettingsTransaction();
+int32_t UAVObjSaveStagedSettings();
 int32_t UAVObjSaveMetaobjects();
 int32_t UAVObjLoadMetaobjects();
 int32_t UAVObjDeleteMetaobjects();
@@ -59,7 +59,10 @@ extern struct UAVOData *__stop__uavo_handles[] __attribute__((weak));
          _uavo_slot && _uavo_slot < __stop__uavo_handles; \
          _uavo_slot++) { \
         struct UAVOData *_item = *_uavo_slot; \
-        if (_item == NULL) { continue; }
+        if (_item == NULL || UAVObjIsDeclared(_item)) { continue; }
+
+/* Declaration of an object not registered yet, see UAVObjDeclare() */
+#define UAVO_DECLARATION(_item) ((const UAVObjDeclaration *)((uintptr_t)(_item) & ~(uintptr_t)1))
 
 /**
  * List of event queues and the eventmask associated with the queue.
@@ -101,6 +104,7 @@ struct UAVOBase {
         bool isSingle      : 1;
         bool isSettings    : 1;
         bool isPriority    : 1;
+        bool isStaged      : 1; /* updated during a settings transaction, not saved yet */
     } flags;
 } __attribute__((packed));
 
@@ -40,6 +40,7 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb, uint8_t eventMask, bool fast);
 static int32_t disconnectObj(UAVObjHandle obj_handle, xQueueHandle queue, UAVObjEventCallback cb);
 static void instanceAutoUpdated(UAVObjHandle obj_handle, uint16_t instId);
+static UAVObjHandle getRegisteredByID(uint32_t id);
 
 
 int32_t UAVObjPers_stub(__attribute__((unused)) UAVObjHandle obj_handle, __attribute__((unused))  uint16_t instId)
@@ -50,9 +51,22 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)  __attribute__((wea
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
 int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId) __attribute__((weak, alias("UAVObjPers_stub")));
 
+int32_t UAVObjPersId_stub(__attribute__((unused)) uint32_t obj_id, __attribute__((unused))  uint16_t instId)
+{
+    return 0;
+}
+int32_t UAVObjDeleteById(uint32_t obj_id, uint16_t instId) __attribute__((weak, alias("UAVObjPersId_stub")));
+
+int32_t UAVObjPersBatch_stub()
+{
+    return 0;
+}
+int32_t UAVObjSaveStagedSettings() __attribute__((weak, alias("UAVObjPersBatch_stub")));
+
 
 // Private variables
 static xSemaphoreHandle mutex;
+static bool settingsTransaction;
 static const UAVObjMetadata defMetadata = {
     .flags                    = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
               ACCESS_READWRITE << UAVOBJ_GCS_ACCESS_SHIFT |
@@ -66,6 +80,10 @@ static const UAVObjMetadata defMetadata = {
 };
 
 static UAVObjStats stats;
+static uint16_t registeredObjects;
+static uint16_t declaredObjects;
+static uint32_t allocatedBytes;
+static void (*registeredCallback)(UAVObjHandle obj);
 
 
 static inline bool IsMetaobject(UAVObjHandle obj_handle)
@@ -188,6 +206,9 @@ void UAVObjGetStats(UAVObjStats *statsOut)
 {
     xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
     memcpy(statsOut, &stats, sizeof(UAVObjStats));
+    statsOut->registeredObjects = registeredObjects;
+    statsOut->declaredObjects   = declaredObjects;
+    statsOut->allocatedBytes    = allocatedBytes;
     xSemaphoreGiveRecursive(mutex);
 }
 
@@ -230,6 +251,7 @@ static struct UAVOData *UAVObjAllocSingle(uint32_t num_bytes)
     if (!uavo_single) {
         return NULL;
     }
+    allocatedBytes += object_size;
 
     /* Fill in the common part of the UAVO */
     struct UAVOBase *uavo_base = &(uavo_single->uavo.base);
@@ -255,6 +277,7 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
     if (!uavo_multi) {
         return NULL;
     }
+    allocatedBytes += object_size;
 
     /* Fill in the common part of the UAVO */
     struct UAVOBase *uavo_base = &(uavo_multi->uavo.base);
@@ -276,26 +299,10 @@ static struct UAVOData *UAVObjAllocMulti(uint32_t num_bytes)
  * UAVObject Database APIs
  *************************/
 
-/**
- * Register and new object in the object manager.
- * \param[in] pointer to UAVObjType structure that holds Unique object ID, instance size, initialization function
- * \param[in] isSingleInstance Is this a single instance or multi-instance object
- * \param[in] isSettings Is this a settings object
- * \param[in] isPriority
- * \return Object handle, or NULL if failure.
- * \return
- */
-UAVObjHandle UAVObjRegister(const UAVObjType *type,
-                            bool isSingleInstance, bool isSettings, bool isPriority)
+static struct UAVOData *UAVObjCreate(const UAVObjType *type,
+                                     bool isSingleInstance, bool isSettings, bool isPriority)
 {
-    struct UAVOData *uavo_data = NULL;
-
-    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
-    /* Don't allow duplicate registrations */
-    if (UAVObjGetByID(type->id)) {
-        goto unlock_exit;
-    }
+    struct UAVOData *uavo_data;
 
     /* Map the various flags to one of the UAVO types we understand */
     if (isSingleInstance) {
@@ -305,7 +312,7 @@ UAVObjHandle UAVObjRegister(const UAVObjType *type,
     }
 
     if (!uavo_data) {
-        goto unlock_exit;
+        return NULL;
     }
 
     /* Fill in the details about this UAVO */
@@ -324,7 +331,22 @@ UAVObjHandle UAVObjRegister(const UAVObjType *type,
     if (type->init_callback) {
         type->init_callback((UAVObjHandle)uavo_data, 0);
     }
+    return uavo_data;
+}
+
+/* Only for an object created by UAVObjCreate() which was never published */
+static void UAVObjFree(struct UAVOData *uavo_data)
+{
+    if (uavo_data->base.flags.isSingle) {
+        allocatedBytes -= sizeof(struct UAVOSingle) + uavo_data->type->instance_size;
+    } else {
+        allocatedBytes -= sizeof(struct UAVOMulti) + uavo_data->type->instance_size;
+    }
+    pios_free(uavo_data);
+}
 
+static void UAVObjLoadStored(struct UAVOData *uavo_data)
+{
     /* Always try to load the meta object from flash */
     UAVObjLoad((UAVObjHandle) & (uavo_data->metaObj), 0);
 
@@ -332,10 +354,40 @@ UAVObjHandle UAVObjRegister(const UAVObjType *type,
     if (uavo_data->base.flags.isSettings) {
         UAVObjLoad((UAVObjHandle)uavo_data, 0);
     }
+}
+
+/**
+ * Register and new object in the object manager.
+ * \param[in] pointer to UAVObjType structure that holds Unique object ID, instance size, initialization function
+ * \param[in] isSingleInstance Is this a single instance or multi-instance object
+ * \param[in] isSettings Is this a settings object
+ * \param[in] isPriority
+ * \return Object handle, or NULL if failure.
+ * \return
+ */
+UAVObjHandle UAVObjRegister(const UAVObjType *type,
+                            bool isSingleInstance, bool isSettings, bool isPriority)
+{
+    struct UAVOData *uavo_data = NULL;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    /* Don't allow duplicate registrations */
+    if (getRegisteredByID(type->id)) {
+        goto unlock_exit;
+    }
+
+    uavo_data = UAVObjCreate(type, isSingleInstance, isSettings, isPriority);
+    if (!uavo_data) {
+        goto unlock_exit;
+    }
+
+    UAVObjLoadStored(uavo_data);
 
     // fire events for outer object and its embedded meta object
     instanceAutoUpdated((UAVObjHandle)uavo_data, 0);
     instanceAutoUpdated((UAVObjHandle) & (uavo_data->metaObj), 0);
+    registeredObjects++;
 
 unlock_exit:
     xSemaphoreGiveRecursive(mutex);
@@ -343,11 +395,99 @@ unlock_exit:
 }
 
 /**
- * Retrieve an object from the list given its id
- * \param[in] The object ID
- * \return The object or NULL if not found.
+ * Declare an object without allocating it.
+ * The object is registered by UAVObjRegisterDeclared() on first access through its handle
+ * function or when it is first looked up by UAVObjGetByID(), for instance by telemetry.
+ * Until then it uses no heap and its settings are not loaded from flash.
+ * \param[in] handle The handle slot of the object, it is set to the tagged declaration
+ * \param[in] declaration Registration parameters, must stay valid (static const)
+ * \return 0 Success
+ * \return -2 if already declared or registered
  */
-UAVObjHandle UAVObjGetByID(uint32_t id)
+int32_t UAVObjDeclare(UAVObjHandle *handle, const UAVObjDeclaration *declaration)
+{
+    int32_t rc = -2;
+
+    PIOS_Assert(((uintptr_t)declaration & 1) == 0);
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    if (*handle == NULL) {
+        *handle = (UAVObjHandle)((uintptr_t)declaration | 1);
+        declaredObjects++;
+        rc = 0;
+    }
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
+/**
+ * Register a declared object, allocating its data and loading its settings.
+ * The object is loaded from flash without holding the object manager lock and
+ * only published in its handle slot afterwards. If another task registered it
+ * meanwhile the copy is dropped and the published object returned.
+ * \param[in] handle The handle slot of the object
+ * \return Object handle, or NULL if failure.
+ */
+UAVObjHandle UAVObjRegisterDeclared(UAVObjHandle *handle)
+{
+    UAVObjHandle obj_handle;
+    struct UAVOData *uavo_data;
+    bool registered = false;
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    obj_handle = *handle;
+    if (!UAVObjIsDeclared(obj_handle)) {
+        xSemaphoreGiveRecursive(mutex);
+        return obj_handle;
+    }
+    const UAVObjDeclaration *declaration = UAVO_DECLARATION(obj_handle);
+    uavo_data = UAVObjCreate(declaration->type, declaration->isSingleInstance,
+                             declaration->isSettings, declaration->isPriority);
+    xSemaphoreGiveRecursive(mutex);
+
+    if (!uavo_data) {
+        return NULL;
+    }
+
+    // nothing else can reach the object yet
+    UAVObjLoadStored(uavo_data);
+
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    if (UAVObjIsDeclared(*handle)) {
+        *handle = (UAVObjHandle)uavo_data;
+        declaredObjects--;
+        registeredObjects++;
+        registered = true;
+
+        // fire events for outer object and its embedded meta object
+        instanceAutoUpdated((UAVObjHandle)uavo_data, 0);
+        instanceAutoUpdated((UAVObjHandle) & (uavo_data->metaObj), 0);
+    } else {
+        UAVObjFree(uavo_data);
+    }
+    obj_handle = *handle;
+    xSemaphoreGiveRecursive(mutex);
+
+    // notify outside of the lock, the callback connects to the object
+    if (registered && registeredCallback) {
+        registeredCallback(obj_handle);
+        registeredCallback(UAVObjGetLinkedObj(obj_handle));
+    }
+    return obj_handle;
+}
+
+/**
+ * Set the function called for each object (and its metaobject) registered on demand
+ * after a declaration, so that modules which enumerated the objects with
+ * UAVObjIterate() can handle it as well.
+ * \param[in] callback The function, NULL to disable
+ */
+void UAVObjSetRegisteredCallback(void (*callback)(UAVObjHandle obj))
+{
+    registeredCallback = callback;
+}
+
+static UAVObjHandle getRegisteredByID(uint32_t id)
 {
     UAVObjHandle *found_obj = (UAVObjHandle *)NULL;
 
@@ -371,6 +511,54 @@ xSemaphoreGiveRecursive(mutex);
 return found_obj;
 }
 
+/**
+ * Retrieve an object from the list given its id, a declared object is registered.
+ * \param[in] The object ID
+ * \return The object or NULL if not found.
+ */
+UAVObjHandle UAVObjGetByID(uint32_t id)
+{
+    UAVObjHandle found_obj = getRegisteredByID(id);
+
+    if (found_obj || !declaredObjects) {
+        return found_obj;
+    }
+
+    UAVObjHandle *found_slot = NULL;
+    bool isMeta = false;
+
+    // Get lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    for (struct UAVOData * *slot = __start__uavo_handles; slot && slot < __stop__uavo_handles; slot++) {
+        if (!UAVObjIsDeclared(*slot)) {
+            continue;
+        }
+        uint32_t obj_id = UAVO_DECLARATION(*slot)->type->id;
+        if (obj_id == id || MetaObjectId(obj_id) == id) {
+            found_slot = (UAVObjHandle *)slot;
+            isMeta     = (obj_id != id);
+            break;
+        }
+    }
+
+    // Release lock
+    xSemaphoreGiveRecursive(mutex);
+
+    if (!found_slot) {
+        return NULL;
+    }
+
+    // register without holding the lock, this allocates the object, loads it
+    // from flash and runs the registered callback. If another task registered
+    // it meanwhile UAVObjRegisterDeclared() just returns the handle.
+    found_obj = UAVObjRegisterDeclared(found_slot);
+    if (found_obj && isMeta) {
+        found_obj = UAVObjGetLinkedObj(found_obj);
+    }
+    return found_obj;
+}
+
 /**
  * Get the object's ID
  * \param[in] obj The object handle
@@ -548,6 +736,11 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t *da
 
         // Set the data
         memcpy(InstanceData(instEntry), dataIn, obj->type->instance_size);
+
+        // Settings received during a transaction are saved on commit
+        if (settingsTransaction && IsSettings(obj_handle)) {
+            obj->base.flags.isStaged = true;
+        }
     }
 
     // Fire event
@@ -745,6 +938,7 @@ return rc;
 
 /**
  * Delete all settings objects from the SD card.
+ * Declared objects which were never registered are deleted by ID.
  * @return 0 if success or -1 if failure
  */
 int32_t UAVObjDeleteSettings()
@@ -754,17 +948,24 @@ int32_t UAVObjDeleteSettings()
 
     int32_t rc = -1;
 
-    // Save all settings objects
-    UAVO_LIST_ITERATE(obj)
-    // Check if this is a settings object
-    if (IsSettings(obj)) {
-        // Save object
-        if (UAVObjDelete((UAVObjHandle)obj, 0)
-            == -1) {
-            goto unlock_exit;
+    // Delete all settings objects
+    for (struct UAVOData * *slot = __start__uavo_handles; slot && slot < __stop__uavo_handles; slot++) {
+        struct UAVOData *obj = *slot;
+
+        if (obj == NULL) {
+            continue;
+        }
+        if (UAVObjIsDeclared(obj)) {
+            const UAVObjDeclaration *declaration = UAVO_DECLARATION(obj);
+            if (declaration->isSettings && UAVObjDeleteById(declaration->type->id, 0) == -1) {
+                goto unlock_exit;
+            }
+        } else if (IsSettings(obj)) {
+            if (UAVObjDelete((UAVObjHandle)obj, 0) == -1) {
+                goto unlock_exit;
+            }
         }
     }
-}
 
 rc = 0;
 
@@ -773,6 +974,65 @@ xSemaphoreGiveRecursive(mutex);
 return rc;
 }
 
+/**
+ * Start a settings transaction. Settings objects unpacked from now
+ * on are staged and saved together by UAVObjCommitSettingsTransaction(),
+ * anything staged by an earlier transaction is dropped.
+ */
+void UAVObjBeginSettingsTransaction()
+{
+    // Get lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    UAVO_LIST_ITERATE(obj)
+    obj->base.flags.isStaged = false;
+}
+
+settingsTransaction = true;
+
+xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Drop a settings transaction that was never committed, e.g. because the
+ * GCS went away in the middle of it. Nothing staged is saved.
+ */
+void UAVObjAbortSettingsTransaction()
+{
+    // Get lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    UAVO_LIST_ITERATE(obj)
+    obj->base.flags.isStaged = false;
+}
+
+settingsTransaction = false;
+
+xSemaphoreGiveRecursive(mutex);
+}
+
+/**
+ * Save all settings objects staged since UAVObjBeginSettingsTransaction()
+ * in one operation. On failure the transaction stays open so that the
+ * commit can be retried.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjCommitSettingsTransaction()
+{
+    // Get lock
+    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+
+    int32_t rc = -1;
+
+    if (settingsTransaction && UAVObjSaveStagedSettings() == 0) {
+        settingsTransaction = false;
+        rc = 0;
+    }
+
+    xSemaphoreGiveRecursive(mutex);
+    return rc;
+}
+
 /**
  * Save all metaobjects to the SD card.
  * @return 0 if success or -1 if failure
@@ -829,6 +1089,7 @@ return rc;
 
 /**
  * Delete all metaobjects from the SD card.
+ * Declared objects which were never registered are deleted by ID.
  * @return 0 if success or -1 if failure
  */
 int32_t UAVObjDeleteMetaobjects()
@@ -838,14 +1099,21 @@ int32_t UAVObjDeleteMetaobjects()
 
     int32_t rc = -1;
 
-    // Load all settings objects
-    UAVO_LIST_ITERATE(obj)
-    // Load object
-    if (UAVObjDelete((UAVObjHandle)MetaObjectPtr(obj), 0)
-        == -1) {
-        goto unlock_exit;
+    // Delete all metaobjects
+    for (struct UAVOData * *slot = __start__uavo_handles; slot && slot < __stop__uavo_handles; slot++) {
+        struct UAVOData *obj = *slot;
+
+        if (obj == NULL) {
+            continue;
+        }
+        if (UAVObjIsDeclared(obj)) {
+            if (UAVObjDeleteById(MetaObjectId(UAVO_DECLARATION(obj)->type->id), 0) == -1) {
+                goto unlock_exit;
+            }
+        } else if (UAVObjDelete((UAVObjHandle)MetaObjectPtr(obj), 0) == -1) {
+            goto unlock_exit;
+        }
     }
-}
 
 rc = 0;
 
@@ -1640,6 +1908,7 @@ static InstanceHandle createInstance(struct UAVOData *obj, uint16_t instId)
     if (!instEntry) {
         return NULL;
     }
+    allocatedBytes += size;
     memset(instEntry, 0, size);
     LL_APPEND(((struct UAVOMulti *)obj)->instance0.next, instEntry);
 
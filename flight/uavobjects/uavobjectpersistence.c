@@ -126,3 +126,100 @@ int32_t UAVObjDelete(UAVObjHandle obj_handle, uint16_t instId)
     }
     return 0;
 }
+
+/**
+ * Delete an object from the file system by its ID, for objects which are only
+ * declared and have no handle to pass to UAVObjDelete().
+ * @param[in] obj_id The object ID (or metaobject ID)
+ * @param[in] instId The object instance
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjDeleteById(uint32_t obj_id, uint16_t instId)
+{
+    PIOS_FLASHFS_ObjDelete(pios_uavo_settings_fs_id, obj_id, instId);
+    return 0;
+}
+
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+/*
+ * The staged settings objects as a PIOS_FLASHFS_ObjBatch, the isStaged
+ * flag marks them pending. Like UAVObjSaveSettings() only instance 0
+ * of each object takes part.
+ */
+static bool stagedFind(__attribute__((unused)) void *ctx, uint32_t obj_id, uint16_t obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    if (obj_inst_id != 0) {
+        return false;
+    }
+
+    UAVO_LIST_ITERATE(obj)
+    if (obj->base.flags.isStaged && obj->type->id == obj_id) {
+        *obj_data = InstanceData(getInstance(obj, 0));
+        *obj_size = obj->type->instance_size;
+        return true;
+    }
+}
+
+return false;
+}
+
+static bool stagedNext(__attribute__((unused)) void *ctx, uint32_t *cursor, uint32_t *obj_id, uint16_t *obj_inst_id, uint8_t **obj_data, uint16_t *obj_size)
+{
+    while (__start__uavo_handles && &__start__uavo_handles[*cursor] < __stop__uavo_handles) {
+        struct UAVOData *obj = __start__uavo_handles[(*cursor)++];
+
+        if (obj == NULL || UAVObjIsDeclared(obj) || !obj->base.flags.isStaged) {
+            continue;
+        }
+        *obj_id      = obj->type->id;
+        *obj_inst_id = 0;
+        *obj_data    = InstanceData(getInstance(obj, 0));
+        *obj_size    = obj->type->instance_size;
+        return true;
+    }
+
+    return false;
+}
+
+static void stagedDone(__attribute__((unused)) void *ctx, uint32_t obj_id, __attribute__((unused)) uint16_t obj_inst_id)
+{
+    UAVO_LIST_ITERATE(obj)
+    if (obj->type->id == obj_id) {
+        obj->base.flags.isStaged = false;
+        return;
+    }
+}
+}
+
+static const struct PIOS_FLASHFS_ObjBatch stagedSettings = {
+    .find = stagedFind,
+    .next = stagedNext,
+    .done = stagedDone,
+    .ctx  = NULL,
+};
+#endif /* PIOS_INCLUDE_FLASH_LOGFS_SETTINGS */
+
+/**
+ * Save the staged settings objects. With logfs they are written in a single
+ * pass over the log and objects whose stored copy is unchanged are skipped.
+ * Must be called with the object manager lock held.
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjSaveStagedSettings()
+{
+#if defined(PIOS_INCLUDE_FLASH_LOGFS_SETTINGS)
+    if (PIOS_FLASHFS_ObjSaveBatch(pios_uavo_settings_fs_id, &stagedSettings) != 0) {
+        return -1;
+    }
+#else
+    UAVO_LIST_ITERATE(obj)
+    if (obj->base.flags.isStaged) {
+        if (UAVObjSave((UAVObjHandle)obj, 0) != 0) {
+            return -1;
+        }
+        obj->base.flags.isStaged = false;
+    }
+}
+#endif /* PIOS_INCLUDE_FLASH_LOGFS_SETTINGS */
+    return 0;
+}
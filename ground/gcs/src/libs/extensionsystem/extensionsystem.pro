@@ -8,7 +8,7 @@ unix:!macx:!freebsd*:LIBS += -ldl
 
 DEFINES += GCS_TEST_DIR=$$shell_quote(\"$$GCS_SOURCE_TREE\")
 
-QT += widgets
+QT += widgets concurrent
 
 HEADERS += pluginerrorview.h \
     plugindetailsview.h \
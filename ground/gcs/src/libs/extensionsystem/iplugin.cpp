@@ -195,9 +195,11 @@
     found, the plugin loading is done in three phases:
     \list 1
     \o All plugin libraries are loaded in 'root-to-leaf' order of the
-       dependency tree.
+       dependency tree. The libraries are loaded on worker threads, and
+       the plugin instance is created once its library is in.
     \o All plugins' initialize methods are called in 'root-to-leaf' order
-       of the dependency tree. This is a good place to put
+       of the dependency tree, as soon as the plugin and the plugins it
+       depends on are loaded. This is a good place to put
        objects in the plugin manager's object pool.
     \o All plugins' extensionsInitialized methods are called in 'leaf-to-root'
        order of the dependency tree. At this point, plugins can
@@ -226,6 +228,19 @@
     \sa extensionsInitialized()
  */
 
+/*!
+    \fn void IPlugin::initializeInBackground()
+    Called on a worker thread after the IPlugin::initialize() method returned,
+    while the other plugins are initialized. Plugins with slow startup work
+    that does not touch widgets or the object pool (reading files, building
+    lookup tables) can opt in by doing it here instead of in initialize().
+    All background initializations are finished before the first
+    IPlugin::extensionsInitialized() method is called, plugins that depend
+    on this plugin must not rely on its results in their initialize methods.
+    The default implementation does nothing.
+    \sa initialize()
+ */
+
 /*!
     \fn void IPlugin::extensionsInitialized()
     Called after the IPlugin::initialize() method has been called,
@@ -50,6 +50,7 @@ public:
     virtual ~IPlugin();
 
     virtual bool initialize(const QStringList &arguments, QString *errorString) = 0;
+    virtual void initializeInBackground() {}
     virtual void extensionsInitialized() = 0;
     virtual void shutdown() {}
 
@@ -36,6 +36,8 @@ using namespace ExtensionSystem::Internal;
 static const char *END_OF_OPTIONS = "--";
 const char *OptionsParser::NO_LOAD_OPTION = "-noload";
 const char *OptionsParser::TEST_OPTION    = "-test";
+const char *OptionsParser::PROFILE_OPTION = "-profile";
+const char *OptionsParser::PROFILE_TRACE_OPTION = "-profile-trace";
 
 OptionsParser::OptionsParser(const QStringList &args,
                              const QMap<QString, bool> &appOptions,
@@ -76,6 +78,9 @@ bool OptionsParser::parse()
         if (checkForTestOption()) {
             continue;
         }
+        if (checkForProfileOption()) {
+            continue;
+        }
         if (checkForAppOption()) {
             continue;
         }
@@ -125,6 +130,22 @@ bool OptionsParser::checkForTestOption()
     return true;
 }
 
+bool OptionsParser::checkForProfileOption()
+{
+    if (m_currentArg == QLatin1String(PROFILE_OPTION)) {
+        m_pmPrivate->profiling = true;
+        return true;
+    }
+    if (m_currentArg != QLatin1String(PROFILE_TRACE_OPTION)) {
+        return false;
+    }
+    if (nextToken(RequiredToken)) {
+        m_pmPrivate->profiling = true;
+        m_pmPrivate->profileTraceFile = m_currentArg;
+    }
+    return true;
+}
+
 bool OptionsParser::checkForNoLoadOption()
 {
     if (m_currentArg != QLatin1String(NO_LOAD_OPTION)) {
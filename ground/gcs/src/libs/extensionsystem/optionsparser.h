@@ -48,12 +48,15 @@ public:
 
     static const char *NO_LOAD_OPTION;
     static const char *TEST_OPTION;
+    static const char *PROFILE_OPTION;
+    static const char *PROFILE_TRACE_OPTION;
 private:
     // return value indicates if the option was processed
     // it doesn't indicate success (--> m_hasError)
     bool checkForEndOfOptions();
     bool checkForNoLoadOption();
     bool checkForTestOption();
+    bool checkForProfileOption();
     bool checkForAppOption();
     bool checkForPluginOption();
     bool checkForUnknownOption();
@@ -35,8 +35,16 @@
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
 #include <QtCore/QWriteLocker>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtDebug>
 #ifdef WITH_TESTS
 #include <QTest>
@@ -161,6 +169,39 @@ static bool lessThanByPluginName(const PluginSpec *one, const PluginSpec *two)
     return one->name() < two->name();
 }
 
+static const char *const profilePhaseNames[PluginManagerPrivate::ProfilePhaseCount] = {
+    "library", "load", "initialize", "background", "extensions"
+};
+
+// When and where a step done on a worker thread ran
+struct WorkerTiming {
+    qint64   start;
+    qint64   end;
+    quintptr thread;
+};
+
+static WorkerTiming preloadLibrary(const QElapsedTimer *timer, const QString &libName)
+{
+    WorkerTiming timing;
+
+    timing.thread = (quintptr)QThread::currentThread();
+    timing.start  = timer->nsecsElapsed() / 1000;
+    PluginSpecPrivate::preloadLibrary(libName);
+    timing.end    = timer->nsecsElapsed() / 1000;
+    return timing;
+}
+
+static WorkerTiming initializeInBackground(const QElapsedTimer *timer, IPlugin *plugin)
+{
+    WorkerTiming timing;
+
+    timing.thread = (quintptr)QThread::currentThread();
+    timing.start  = timer->nsecsElapsed() / 1000;
+    plugin->initializeInBackground();
+    timing.end    = timer->nsecsElapsed() / 1000;
+    return timing;
+}
+
 PluginManager *PluginManager::m_instance = 0;
 
 /*!
@@ -382,6 +423,12 @@ void PluginManager::formatOptions(QTextStream &str, int optionIndentation, int d
     formatOption(str, QLatin1String(OptionsParser::NO_LOAD_OPTION),
                  QLatin1String("plugin"), QLatin1String("Do not load <plugin>"),
                  optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::PROFILE_OPTION),
+                 QString(), QLatin1String("Print the load and initialization times of the plugins"),
+                 optionIndentation, descriptionIndentation);
+    formatOption(str, QLatin1String(OptionsParser::PROFILE_TRACE_OPTION),
+                 QLatin1String("file"), QLatin1String("Write the plugin startup steps to <file> as a chrome://tracing trace"),
+                 optionIndentation, descriptionIndentation);
 }
 
 /*!
@@ -494,7 +541,7 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
     \internal
  */
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
-    : extension("xml"), q(pluginManager)
+    : extension("xml"), profiling(false), q(pluginManager)
 {}
 
 /*!
@@ -581,24 +628,166 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 void PluginManagerPrivate::loadPlugins()
 {
     QList<PluginSpec *> queue = loadQueue();
+
+    profileTimer.start();
+    profileEvents.clear();
+
+    // Map the libraries on worker threads, in dependency order. The plugin
+    // instances are created and initialized on this thread as soon as their
+    // library is in, while the libraries of their dependents are loaded.
+    QList<QFuture<WorkerTiming> > libraries;
     foreach(PluginSpec * spec, queue) {
-        loadPlugin(spec, PluginSpec::Loaded);
+        libraries << QtConcurrent::run(preloadLibrary, &profileTimer, spec->d->libraryPath());
     }
-    foreach(PluginSpec * spec, queue) {
+    QList<QPair<PluginSpec *, QFuture<WorkerTiming> > > background;
+    for (int i = 0; i < queue.size(); ++i) {
+        PluginSpec *spec    = queue.at(i);
+        WorkerTiming timing = libraries.at(i).result();
+        addProfileEvent(spec, ProfileLibrary, timing.start, timing.end, timing.thread);
+
+        qint64 start = profileTime();
+        loadPlugin(spec, PluginSpec::Loaded);
+        addProfileEvent(spec, ProfileLoad, start, profileTime());
+
+        start = profileTime();
         loadPlugin(spec, PluginSpec::Initialized);
+        addProfileEvent(spec, ProfileInitialize, start, profileTime());
+
+        if (spec->state() == PluginSpec::Initialized) {
+            background << qMakePair(spec, QtConcurrent::run(initializeInBackground, &profileTimer, spec->plugin()));
+        }
+    }
+    for (int i = 0; i < background.size(); ++i) {
+        WorkerTiming timing = background.at(i).second.result();
+        addProfileEvent(background.at(i).first, ProfileBackground, timing.start, timing.end, timing.thread);
     }
+
     QListIterator<PluginSpec *> it(queue);
     it.toBack();
     while (it.hasPrevious()) {
         PluginSpec *plugin = it.previous();
         emit q->pluginAboutToBeLoaded(plugin);
+        qint64 start = profileTime();
         loadPlugin(plugin, PluginSpec::Running);
+        addProfileEvent(plugin, ProfileExtensions, start, profileTime());
     }
+    reportProfile();
     emit q->pluginsChanged();
     q->m_allPluginsLoaded = true;
     emit q->pluginsLoadEnded();
 }
 
+/*!
+    \fn qint64 PluginManagerPrivate::profileTime() const
+    \internal
+ */
+qint64 PluginManagerPrivate::profileTime() const
+{
+    return profileTimer.nsecsElapsed() / 1000;
+}
+
+/*!
+    \fn void PluginManagerPrivate::addProfileEvent(PluginSpec *spec, ProfilePhase phase, qint64 start, qint64 end, quintptr thread)
+    \internal
+ */
+void PluginManagerPrivate::addProfileEvent(PluginSpec *spec, ProfilePhase phase, qint64 start, qint64 end, quintptr thread)
+{
+    if (!profiling) {
+        return;
+    }
+    ProfileEvent event;
+    event.plugin   = spec->name();
+    event.phase    = phase;
+    event.start    = start;
+    event.duration = end - start;
+    event.thread   = thread;
+    profileEvents.append(event);
+}
+
+/*!
+    \fn void PluginManagerPrivate::reportProfile()
+    \internal
+
+    Prints the time each plugin spent in each step to stdout, slowest first,
+    and writes all steps as a trace in the Trace Event Format if a trace file
+    was given.
+ */
+void PluginManagerPrivate::reportProfile()
+{
+    if (!profiling) {
+        return;
+    }
+
+    QMap<QString, QVector<qint64> > times;
+    foreach(const ProfileEvent &event, profileEvents) {
+        QVector<qint64> &plugin = times[event.plugin];
+        if (plugin.isEmpty()) {
+            plugin.fill(0, ProfilePhaseCount + 1);
+        }
+        plugin[event.phase] += event.duration;
+        if (event.thread == 0) {
+            // the last column is the time the GUI thread spent on the plugin
+            plugin[ProfilePhaseCount] += event.duration;
+        }
+    }
+    QList<QPair<qint64, QString> > order;
+    for (QMap<QString, QVector<qint64> >::const_iterator it = times.constBegin(); it != times.constEnd(); ++it) {
+        order << qMakePair(-it.value().at(ProfilePhaseCount), it.key());
+    }
+    qSort(order);
+
+    QTextStream out(stdout);
+    out << QString("%1").arg("plugin (ms)", -24);
+    for (int phase = 0; phase < ProfilePhaseCount; ++phase) {
+        out << QString("%1").arg(profilePhaseNames[phase], 12);
+    }
+    out << QString("%1").arg("gui thread", 12) << '\n';
+    qint64 guiTotal = 0;
+    for (int i = 0; i < order.size(); ++i) {
+        const QVector<qint64> &plugin = times.value(order.at(i).second);
+        out << QString("%1").arg(order.at(i).second, -24);
+        for (int phase = 0; phase <= ProfilePhaseCount; ++phase) {
+            out << QString("%1").arg(plugin.at(phase) / 1000.0, 12, 'f', 1);
+        }
+        out << '\n';
+        guiTotal += plugin.at(ProfilePhaseCount);
+    }
+    out << "Loaded " << times.size() << " plugins in " << profileTime() / 1000 << " ms, "
+        << guiTotal / 1000 << " ms of it on the GUI thread\n";
+    out.flush();
+
+    if (profileTraceFile.isEmpty()) {
+        return;
+    }
+    QHash<quintptr, int> threads;
+    threads.insert(0, 0);
+    QJsonArray traceEvents;
+    foreach(const ProfileEvent &event, profileEvents) {
+        if (!threads.contains(event.thread)) {
+            threads.insert(event.thread, threads.size());
+        }
+        QJsonObject traceEvent;
+        traceEvent["name"] = event.plugin;
+        traceEvent["cat"]  = QString(profilePhaseNames[event.phase]);
+        traceEvent["ph"]   = QString("X");
+        traceEvent["ts"]   = (double)event.start;
+        traceEvent["dur"]  = (double)event.duration;
+        traceEvent["pid"]  = 1;
+        traceEvent["tid"]  = threads.value(event.thread);
+        traceEvents.append(traceEvent);
+    }
+    QJsonObject trace;
+    trace["traceEvents"]     = traceEvents;
+    trace["displayTimeUnit"] = QString("ms");
+
+    QFile file(profileTraceFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "PluginManagerPrivate::reportProfile(): cannot write" << profileTraceFile;
+        return;
+    }
+    file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+}
+
 /*!
     \fn void PluginManagerPrivate::loadQueue()
     \internal
@@ -675,7 +864,9 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
         return;
     }
     foreach(PluginSpec * depSpec, spec->dependencySpecs()) {
-        if (depSpec->state() != destState) {
+        // dependencies are initialized by the time their dependents are loaded
+        bool ready = (destState == PluginSpec::Stopped) ? depSpec->state() == destState : depSpec->state() >= destState;
+        if (!ready) {
             spec->d->hasError    = true;
             spec->d->errorString =
                 PluginManager::tr("Cannot load plugin because dependency failed to load: %1(%2)\nReason: %3")
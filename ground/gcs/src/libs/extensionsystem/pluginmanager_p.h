@@ -31,6 +31,7 @@
 
 #include "pluginspec.h"
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QList>
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
@@ -66,6 +67,13 @@ public:
 
     QStringList arguments;
 
+    // Startup profiling
+    enum ProfilePhase {
+        ProfileLibrary, ProfileLoad, ProfileInitialize, ProfileBackground, ProfileExtensions, ProfilePhaseCount
+    };
+    bool profiling;
+    QString profileTraceFile;
+
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
     PluginSpec *pluginByName(const QString &name) const;
@@ -76,6 +84,20 @@ public:
 private:
     PluginManager *q;
 
+    struct ProfileEvent {
+        QString  plugin;
+        ProfilePhase phase;
+        qint64   start; // us since loadPlugins() started
+        qint64   duration; // us
+        quintptr thread; // 0 for the GUI thread
+    };
+    QElapsedTimer profileTimer;
+    QList<ProfileEvent> profileEvents;
+
+    qint64 profileTime() const;
+    void addProfileEvent(PluginSpec *spec, ProfilePhase phase, qint64 start, qint64 end, quintptr thread = 0);
+    void reportProfile();
+
     void readPluginPaths();
     bool loadQueue(PluginSpec *spec,
                    QList<PluginSpec *> &queue,
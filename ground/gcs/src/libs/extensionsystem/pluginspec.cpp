@@ -35,6 +35,7 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QLibrary>
 #include <QtCore/QXmlStreamReader>
 #include <QtCore/QRegExp>
 #include <QtCore/QCoreApplication>
@@ -770,22 +771,11 @@ bool PluginSpecPrivate::resolveDependencies(const QList<PluginSpec *> &specs)
 }
 
 /*!
-    \fn bool PluginSpecPrivate::loadLibrary()
+    \fn QString PluginSpecPrivate::libraryPath() const
     \internal
  */
-bool PluginSpecPrivate::loadLibrary()
+QString PluginSpecPrivate::libraryPath() const
 {
-    if (hasError) {
-        return false;
-    }
-    if (state != PluginSpec::Resolved) {
-        if (state == PluginSpec::Loaded) {
-            return true;
-        }
-        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
-        hasError    = true;
-        return false;
-    }
 #ifdef QT_NO_DEBUG
 
 #ifdef Q_OS_WIN
@@ -807,6 +797,41 @@ bool PluginSpecPrivate::loadLibrary()
 #endif
 
 #endif
+    return libName;
+}
+
+/*!
+    \fn void PluginSpecPrivate::preloadLibrary(const QString &libName)
+    \internal
+
+    Maps the library into the process without creating the plugin instance,
+    so it can run on a worker thread. Errors are left for loadLibrary() to report.
+ */
+void PluginSpecPrivate::preloadLibrary(const QString &libName)
+{
+    QLibrary library(libName);
+
+    library.load();
+}
+
+/*!
+    \fn bool PluginSpecPrivate::loadLibrary()
+    \internal
+ */
+bool PluginSpecPrivate::loadLibrary()
+{
+    if (hasError) {
+        return false;
+    }
+    if (state != PluginSpec::Resolved) {
+        if (state == PluginSpec::Loaded) {
+            return true;
+        }
+        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
+        hasError    = true;
+        return false;
+    }
+    QString libName = libraryPath();
 
     PluginLoader loader(libName);
     if (!loader.load()) {
@@ -49,6 +49,8 @@ public:
     bool read(const QString &fileName);
     bool provides(const QString &pluginName, const QString &version) const;
     bool resolveDependencies(const QList<PluginSpec *> &specs);
+    QString libraryPath() const;
+    static void preloadLibrary(const QString &libName);
     bool loadLibrary();
     bool initializePlugin();
     bool initializeExtensions();
@@ -0,0 +1,498 @@
+/**
+ ******************************************************************************
+ *
+ * @file       columnarlog.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "columnarlog.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <QDataStream>
+
+#include <limits>
+
+#define DEFAULT_ROWS_PER_CHUNK 4096
+#define TRAILER_SIZE_BYTES     (sizeof(quint64) + sizeof(ColumnarLog::MAGIC))
+
+const char ColumnarLog::MAGIC[4] = { 'O', 'P', 'L', 'C' };
+
+static void writeString(QDataStream &stream, const QString &str)
+{
+    QByteArray utf8 = str.toUtf8();
+
+    stream << (quint32)utf8.size();
+    stream.writeRawData(utf8.constData(), utf8.size());
+}
+
+static QString readString(QDataStream &stream)
+{
+    quint32 length;
+
+    stream >> length;
+    if (stream.status() != QDataStream::Ok || length > (1024 * 1024)) {
+        stream.setStatus(QDataStream::ReadCorruptData);
+        return QString();
+    }
+    QByteArray utf8(length, 0);
+    stream.readRawData(utf8.data(), length);
+    return QString::fromUtf8(utf8);
+}
+
+int ColumnarLog::typeSize(ColumnType type)
+{
+    switch (type) {
+    case INT8:
+    case UINT8:
+        return sizeof(quint8);
+
+    case INT16:
+    case UINT16:
+        return sizeof(quint16);
+
+    case INT32:
+    case UINT32:
+    case FLOAT32:
+        return sizeof(quint32);
+
+    default:
+        return 0;
+    }
+}
+
+double ColumnarLog::valueAt(ColumnType type, const char *data, int index)
+{
+    const uchar *p = (const uchar *)data + index * typeSize(type);
+
+    switch (type) {
+    case INT8:
+        return (qint8)*p;
+
+    case UINT8:
+        return *p;
+
+    case INT16:
+        return qFromLittleEndian<qint16>(p);
+
+    case UINT16:
+        return qFromLittleEndian<quint16>(p);
+
+    case INT32:
+        return qFromLittleEndian<qint32>(p);
+
+    case UINT32:
+        return qFromLittleEndian<quint32>(p);
+
+    case FLOAT32:
+    {
+        quint32 raw = qFromLittleEndian<quint32>(p);
+        float value;
+        memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+
+    default:
+        return 0.0;
+    }
+}
+
+ColumnarLogWriter::ColumnarLogWriter() :
+    m_compress(true),
+    m_rowsPerChunk(DEFAULT_ROWS_PER_CHUNK)
+{}
+
+ColumnarLogWriter::~ColumnarLogWriter()
+{
+    close();
+}
+
+bool ColumnarLogWriter::open(const QString &fileName)
+{
+    close();
+
+    m_tables.clear();
+    m_pending.clear();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "ColumnarLogWriter - unable to open" << fileName << m_file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&m_file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(MAGIC, sizeof(MAGIC));
+    stream << VERSION;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+bool ColumnarLogWriter::close()
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    bool success = true;
+    for (int table = 0; table < m_tables.size(); table++) {
+        success &= flushTable(table);
+    }
+    success &= writeFooter();
+
+    m_file.close();
+    return success;
+}
+
+int ColumnarLogWriter::addTable(const QString &name, quint32 id)
+{
+    Table table;
+
+    table.name = name;
+    table.id   = id;
+    m_tables.append(table);
+
+    PendingRows pending;
+    pending.rows    = 0;
+    pending.rowSize = 0;
+    m_pending.append(pending);
+
+    return m_tables.size() - 1;
+}
+
+int ColumnarLogWriter::addColumn(int table, const QString &name, ColumnType type, const QString &units)
+{
+    if (table < 0 || table >= m_tables.size() || typeSize(type) == 0) {
+        return -1;
+    }
+    // The schema of a table is frozen once it holds data
+    if (m_pending[table].rows > 0 || !m_tables[table].chunks.isEmpty()) {
+        return -1;
+    }
+
+    Column column;
+    column.name  = name;
+    column.type  = type;
+    column.units = units;
+    m_tables[table].columns.append(column);
+
+    QByteArray buffer;
+    buffer.reserve(m_rowsPerChunk * typeSize(type));
+    m_pending[table].buffers.append(buffer);
+    m_pending[table].rowSize += typeSize(type);
+
+    return m_tables[table].columns.size() - 1;
+}
+
+int ColumnarLogWriter::rowSize(int table) const
+{
+    return (table >= 0 && table < m_pending.size()) ? m_pending[table].rowSize : 0;
+}
+
+bool ColumnarLogWriter::appendRow(int table, const quint8 *row)
+{
+    if (!m_file.isOpen() || table < 0 || table >= m_tables.size()) {
+        return false;
+    }
+
+    const QVector<Column> &columns = m_tables[table].columns;
+    PendingRows &pending = m_pending[table];
+
+    // Scatter the row over the column buffers
+    for (int i = 0; i < columns.size(); i++) {
+        int size = typeSize(columns[i].type);
+        pending.buffers[i].append((const char *)row, size);
+        row += size;
+    }
+
+    if (++pending.rows >= m_rowsPerChunk) {
+        return flushTable(table);
+    }
+    return true;
+}
+
+bool ColumnarLogWriter::flushTable(int table)
+{
+    PendingRows &pending = m_pending[table];
+
+    if (pending.rows == 0) {
+        return true;
+    }
+
+    QVector<Column> &columns = m_tables[table].columns;
+    Chunk chunk;
+    chunk.rows = pending.rows;
+
+    for (int i = 0; i < columns.size(); i++) {
+        QByteArray &raw = pending.buffers[i];
+        Block block;
+
+        block.min = std::numeric_limits<double>::max();
+        block.max = -std::numeric_limits<double>::max();
+        for (int row = 0; row < pending.rows; row++) {
+            double value = valueAt(columns[i].type, raw.constData(), row);
+            block.min = qMin(block.min, value);
+            block.max = qMax(block.max, value);
+        }
+
+        QByteArray stored = m_compress ? qCompress(raw) : raw;
+        // Only keep compressed data if it actually saves space, an equal size would be ambiguous
+        if (stored.size() >= raw.size()) {
+            stored = raw;
+        }
+
+        block.offset     = m_file.pos();
+        block.storedSize = stored.size();
+        block.rawSize    = raw.size();
+        if (m_file.write(stored) != stored.size()) {
+            qWarning() << "ColumnarLogWriter - write error" << m_file.errorString();
+            return false;
+        }
+        chunk.blocks.append(block);
+
+        raw.resize(0);
+    }
+
+    m_tables[table].chunks.append(chunk);
+    pending.rows = 0;
+
+    return true;
+}
+
+bool ColumnarLogWriter::writeFooter()
+{
+    quint64 footerOffset = m_file.pos();
+    QDataStream stream(&m_file);
+
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream << (quint32)m_tables.size();
+    foreach(const Table &table, m_tables) {
+        writeString(stream, table.name);
+        stream << table.id;
+        stream << (quint32)table.columns.size();
+        foreach(const Column &column, table.columns) {
+            writeString(stream, column.name);
+            stream << (quint8)column.type;
+            writeString(stream, column.units);
+        }
+        stream << (quint32)table.chunks.size();
+        foreach(const Chunk &chunk, table.chunks) {
+            stream << chunk.rows;
+            foreach(const Block &block, chunk.blocks) {
+                stream << block.offset << block.storedSize << block.rawSize << block.min << block.max;
+            }
+        }
+    }
+    stream << footerOffset;
+    stream.writeRawData(MAGIC, sizeof(MAGIC));
+
+    return stream.status() == QDataStream::Ok;
+}
+
+ColumnarLogReader::ColumnarLogReader()
+{}
+
+ColumnarLogReader::~ColumnarLogReader()
+{
+    close();
+}
+
+bool ColumnarLogReader::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+    if (!readFooter()) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+void ColumnarLogReader::close()
+{
+    // Closing the file also releases all the mappings
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_tables.clear();
+}
+
+bool ColumnarLogReader::readFooter()
+{
+    char magic[sizeof(MAGIC)];
+    quint32 version;
+
+    QDataStream stream(&m_file);
+
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream.readRawData(magic, sizeof(magic));
+    stream >> version;
+    if (stream.status() != QDataStream::Ok || memcmp(magic, MAGIC, sizeof(MAGIC)) || version != VERSION) {
+        m_errorString = QString("Not a columnar log file or unsupported version");
+        return false;
+    }
+
+    quint64 footerOffset;
+    if (m_file.size() < (qint64)(sizeof(MAGIC) + sizeof(version) + TRAILER_SIZE_BYTES)) {
+        m_errorString = QString("File is truncated");
+        return false;
+    }
+    m_file.seek(m_file.size() - TRAILER_SIZE_BYTES);
+    stream >> footerOffset;
+    stream.readRawData(magic, sizeof(magic));
+    if (stream.status() != QDataStream::Ok || memcmp(magic, MAGIC, sizeof(MAGIC))
+        || footerOffset >= (quint64)m_file.size()) {
+        m_errorString = QString("File was not closed properly, footer is missing");
+        return false;
+    }
+
+    m_file.seek(footerOffset);
+    quint32 tableCount;
+    stream >> tableCount;
+    for (quint32 t = 0; t < tableCount && stream.status() == QDataStream::Ok; t++) {
+        Table table;
+        quint32 columnCount;
+        quint32 chunkCount;
+
+        table.name = readString(stream);
+        stream >> table.id >> columnCount;
+        for (quint32 c = 0; c < columnCount && stream.status() == QDataStream::Ok; c++) {
+            Column column;
+            quint8 type;
+            column.name  = readString(stream);
+            stream >> type;
+            column.type  = (ColumnType)type;
+            column.units = readString(stream);
+            if (typeSize(column.type) == 0) {
+                m_errorString = QString("Unknown type %1 of column %2").arg(type).arg(column.name);
+                m_tables.clear();
+                return false;
+            }
+            table.columns.append(column);
+        }
+        stream >> chunkCount;
+        for (quint32 k = 0; k < chunkCount && stream.status() == QDataStream::Ok; k++) {
+            Chunk chunk;
+            stream >> chunk.rows;
+            for (quint32 c = 0; c < columnCount && stream.status() == QDataStream::Ok; c++) {
+                Block block;
+                stream >> block.offset >> block.storedSize >> block.rawSize >> block.min >> block.max;
+                chunk.blocks.append(block);
+            }
+            table.chunks.append(chunk);
+        }
+        m_tables.append(table);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        m_errorString = QString("Corrupted footer");
+        m_tables.clear();
+        return false;
+    }
+    return true;
+}
+
+int ColumnarLogReader::findTable(const QString &name) const
+{
+    for (int i = 0; i < m_tables.size(); i++) {
+        if (m_tables[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ColumnarLogReader::findColumn(int table, const QString &name) const
+{
+    if (table < 0 || table >= m_tables.size()) {
+        return -1;
+    }
+    const QVector<Column> &columns = m_tables[table].columns;
+    for (int i = 0; i < columns.size(); i++) {
+        if (columns[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+QByteArray ColumnarLogReader::readBlock(int table, int chunk, int column)
+{
+    if (table < 0 || table >= m_tables.size()
+        || chunk < 0 || chunk >= m_tables[table].chunks.size()
+        || column < 0 || column >= m_tables[table].columns.size()) {
+        return QByteArray();
+    }
+
+    const Block &block = m_tables[table].chunks[chunk].blocks[column];
+    if (block.storedSize == 0) {
+        return QByteArray();
+    }
+
+    uchar *data = m_file.map(block.offset, block.storedSize);
+    if (!data) {
+        m_errorString = m_file.errorString();
+        return QByteArray();
+    }
+
+    QByteArray result;
+    if (block.storedSize == block.rawSize) {
+        result = QByteArray((const char *)data, block.rawSize);
+    } else {
+        result = qUncompress(data, block.storedSize);
+    }
+    m_file.unmap(data);
+
+    return result;
+}
+
+QVector<double> ColumnarLogReader::readColumn(int table, int column, int firstChunk, int lastChunk)
+{
+    QVector<double> values;
+
+    if (table < 0 || table >= m_tables.size() || column < 0 || column >= m_tables[table].columns.size()) {
+        return values;
+    }
+
+    const Table &t = m_tables[table];
+    if (lastChunk < 0 || lastChunk >= t.chunks.size()) {
+        lastChunk = t.chunks.size() - 1;
+    }
+
+    ColumnType type = t.columns[column].type;
+    for (int chunk = qMax(0, firstChunk); chunk <= lastChunk; chunk++) {
+        QByteArray block = readBlock(table, chunk, column);
+        int rows = qMin((int)t.chunks[chunk].rows, block.size() / typeSize(type));
+        values.reserve(values.size() + rows);
+        for (int row = 0; row < rows; row++) {
+            values.append(valueAt(type, block.constData(), row));
+        }
+    }
+
+    return values;
+}
@@ -0,0 +1,174 @@
+/**
+ ******************************************************************************
+ *
+ * @file       columnarlog.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef COLUMNARLOG_H
+#define COLUMNARLOG_H
+
+#include "utils_global.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+/**
+ * Columnar binary log format (*.oplc).
+ *
+ * Data is grouped in tables (typically one per UAVObject) made of typed
+ * columns (typically one per field element). Rows are buffered per table and
+ * written as chunks, one block per column. Each block may be zlib compressed
+ * and carries the min/max of its values so that readers can skip chunks
+ * without decoding them. The schema and the chunk index are written as a
+ * footer when the file is closed, so a file is produced in a single
+ * streaming pass.
+ *
+ * All integers are little endian:
+ *   file   := "OPLC" u32:version block* footer u64:footerOffset "OPLC"
+ *   footer := u32:tableCount table*
+ *   table  := str:name u32:id u32:columnCount column* u32:chunkCount chunk*
+ *   column := str:name u8:type str:units
+ *   chunk  := u32:rowCount block{columnCount}
+ *   block  := u64:offset u32:storedSize u32:rawSize f64:min f64:max
+ *   str    := u32:length u8[length] (UTF-8)
+ * A block is compressed when storedSize differs from rawSize, in which case
+ * it holds the big endian raw size (u32) followed by a zlib stream.
+ */
+class QTCREATOR_UTILS_EXPORT ColumnarLog {
+public:
+    static const quint32 VERSION = 1;
+
+    typedef enum { INT8 = 0, INT16, INT32, UINT8, UINT16, UINT32, FLOAT32 } ColumnType;
+
+    typedef struct {
+        quint64 offset;
+        quint32 storedSize;
+        quint32 rawSize;
+        double  min;
+        double  max;
+    } Block;
+
+    typedef struct {
+        quint32 rows;
+        QVector<Block> blocks;
+    } Chunk;
+
+    typedef struct {
+        QString    name;
+        ColumnType type;
+        QString    units;
+    } Column;
+
+    typedef struct {
+        QString name;
+        quint32 id;
+        QVector<Column> columns;
+        QVector<Chunk>  chunks;
+    } Table;
+
+    static int typeSize(ColumnType type);
+    static double valueAt(ColumnType type, const char *data, int index);
+
+protected:
+    static const char MAGIC[4];
+};
+
+class QTCREATOR_UTILS_EXPORT ColumnarLogWriter : public ColumnarLog {
+public:
+    ColumnarLogWriter();
+    ~ColumnarLogWriter();
+
+    void setCompression(bool compress)
+    {
+        m_compress = compress;
+    }
+    void setRowsPerChunk(int rows)
+    {
+        m_rowsPerChunk = qMax(1, rows);
+    }
+
+    bool open(const QString &fileName);
+    bool close();
+    bool isOpen() const
+    {
+        return m_file.isOpen();
+    }
+
+    int addTable(const QString &name, quint32 id);
+    int addColumn(int table, const QString &name, ColumnType type, const QString &units = QString());
+    int rowSize(int table) const;
+
+    // Append one row, row holds the packed values of all columns in declaration order
+    bool appendRow(int table, const quint8 *row);
+
+private:
+    typedef struct {
+        int rows;
+        int rowSize;
+        QVector<QByteArray> buffers;
+    } PendingRows;
+
+    QFile m_file;
+    bool m_compress;
+    int m_rowsPerChunk;
+    QVector<Table> m_tables;
+    QVector<PendingRows> m_pending;
+
+    bool flushTable(int table);
+    bool writeFooter();
+};
+
+class QTCREATOR_UTILS_EXPORT ColumnarLogReader : public ColumnarLog {
+public:
+    ColumnarLogReader();
+    ~ColumnarLogReader();
+
+    bool open(const QString &fileName);
+    void close();
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    const QVector<Table> &tables() const
+    {
+        return m_tables;
+    }
+
+    int findTable(const QString &name) const;
+    int findColumn(int table, const QString &name) const;
+
+    // Decoded (uncompressed) content of a single block, only that block is mapped
+    QByteArray readBlock(int table, int chunk, int column);
+
+    // Values of a column converted to double for chunks [firstChunk, lastChunk], lastChunk = -1 reads to the end
+    QVector<double> readColumn(int table, int column, int firstChunk = 0, int lastChunk = -1);
+
+private:
+    QFile m_file;
+    QString m_errorString;
+    QVector<Table> m_tables;
+
+    bool readFooter();
+};
+
+#endif // COLUMNARLOG_H
@@ -37,6 +37,7 @@ SOURCES += \
     svgimageprovider.cpp \
     hostosinfo.cpp \
     logfile.cpp \
+    columnarlog.cpp \
     crc.cpp \
     mustache.cpp \
     textbubbleslider.cpp \
@@ -71,6 +72,7 @@ HEADERS += \
     svgimageprovider.h \
     hostosinfo.h \
     logfile.h \
+    columnarlog.h \
     crc.h \
     mustache.h \
     textbubbleslider.h \
@@ -105,6 +105,11 @@ Rectangle {
                             id: totalEntries
                             text: "<b>" + qsTr("Entries downloaded:") + "</b> " + logManager.logEntriesCount
                         }
+                        Text {
+                            id: transferRate
+                            visible: logManager.transferRate !== ""
+                            text: "<b>" + qsTr("Download speed:") + "</b> " + logManager.transferRate
+                        }
                         Rectangle {
                             Layout.fillHeight: true
                         }
@@ -147,6 +152,12 @@ Rectangle {
                                 activeFocusOnPress: true
                                 onClicked: logManager.retrieveLogs(flightCombo.currentIndex - 1)
                             }
+                            Button {
+                                text: qsTr("Resume")
+                                enabled: !logManager.disableControls && logManager.boardConnected && logManager.canResume
+                                activeFocusOnPress: true
+                                onClicked: logManager.resumeRetrieveLogs()
+                            }
                         }
                         Rectangle {
                             Layout.fillHeight: true
@@ -198,6 +209,18 @@ Rectangle {
                             logManager.setLoggingEnabled(currentIndex);
                         }
                     }
+                    Text {
+                        text: qsTr("Log mode: ")
+                    }
+                    ComboBox {
+                        enabled: !logManager.disableControls && logManager.boardConnected
+                        model: logManager.logModes
+                        Layout.preferredWidth: 120
+                        currentIndex: logManager.loggingMode
+                        onCurrentIndexChanged: {
+                            logManager.setLoggingMode(currentIndex);
+                        }
+                    }
 
                 }
 
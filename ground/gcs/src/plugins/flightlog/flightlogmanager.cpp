@@ -32,6 +32,9 @@
 #include <QFileDialog>
 #include <QXmlStreamReader>
 #include <QMessageBox>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtEndian>
 #include <QDebug>
 
 #include "debuglogcontrol.h"
@@ -39,12 +42,16 @@
 #include "uavtalk/uavtalk.h"
 #include "utils/logfile.h"
 #include "uavdataobject.h"
+#include "uavobjectcolumnarwriter.h"
 #include <uavobjectutil/uavobjectutilmanager.h>
 
 FlightLogManager::FlightLogManager(QObject *parent) :
     QObject(parent), m_disableControls(false),
     m_disableExport(true), m_cancelDownload(false),
-    m_adjustExportedTimestamps(true)
+    m_adjustExportedTimestamps(true), m_loggingMode(0), m_canResume(false),
+    m_retrieveFlight(0), m_retrieveLastFlight(-1), m_retrieveEntry(0),
+    m_windowActive(false), m_windowComplete(false),
+    m_retrievedBytes(0), m_transferTime(0)
 {
     ExtensionSystem::PluginManager *pluginManager = ExtensionSystem::PluginManager::instance();
 
@@ -68,6 +75,11 @@ FlightLogManager::FlightLogManager(QObject *parent) :
 
     m_flightLogEntry    = DebugLogEntry::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogEntry);
+    // Streamed entries arrive on all the DebugLogEntry instances
+    foreach(UAVObject * object, m_objectManager->getObjectInstances(DebugLogEntry::OBJID)) {
+        newObjectInstance(object);
+    }
+    connect(m_objectManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newObjectInstance(UAVObject *)));
 
     m_flightLogSettings = DebugLogSettings::GetInstance(m_objectManager);
     Q_ASSERT(m_flightLogSettings);
@@ -187,85 +199,53 @@ void FlightLogManager::clearLogList()
 }
 
 void FlightLogManager::retrieveLogs(int flightToRetrieve)
+{
+    clearLogList();
+
+    // Set up what to retrieve
+    m_retrieveFlight     = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
+    m_retrieveLastFlight = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
+    m_retrieveEntry  = 0;
+    m_retrievedBytes = 0;
+    m_transferTime   = 0;
+
+    continueRetrieveLogs();
+}
+
+void FlightLogManager::resumeRetrieveLogs()
+{
+    if (m_canResume) {
+        continueRetrieveLogs();
+    }
+}
+
+void FlightLogManager::continueRetrieveLogs()
 {
     setDisableControls(true);
+    setCanResume(false);
     QApplication::setOverrideCursor(Qt::WaitCursor);
     m_cancelDownload = false;
-    UAVObjectUpdaterHelper updateHelper;
-    UAVObjectRequestHelper requestHelper;
-
-    clearLogList();
 
-    // Set up what to retrieve
-    int startFlight = (flightToRetrieve == -1) ? 0 : flightToRetrieve;
-    int endFlight   = (flightToRetrieve == -1) ? m_flightLogStatus->getFlight() : flightToRetrieve;
-
-    // Prepare to send request for event retrieval
-    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVE);
-    for (int flight = startFlight; flight <= endFlight; flight++) {
-        m_flightLogControl->setFlight(flight);
-        bool gotLast = false;
-        int slot     = 0;
-        while (!gotLast) {
-            // Send request for loading flight entry on flight side and wait for ack/nack
-            m_flightLogControl->setEntry(slot);
-
-            if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS &&
-                requestHelper.doObjectAndWait(m_flightLogEntry, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS) {
-                if (m_flightLogEntry->getType() != DebugLogEntry::TYPE_EMPTY) {
-                    // Ok, we retrieved the entry, and it was the correct one. clone it and add it to the list
-                    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
-
-                    logEntry->setData(m_flightLogEntry->getData(), m_objectManager);
-                    m_logEntries << logEntry;
-                    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
-                        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
-                        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
-                        const quint32 header_len = total_len - data_len;
-
-                        DebugLogEntry::DataFields fields;
-                        quint32 start = logEntry->getData().Size;
-
-                        // cycle until there is space for another object
-                        while (start + header_len + 1 < data_len) {
-                            memset(&fields, 0xFF, total_len);
-                            memcpy(&fields, &logEntry->getData().Data[start], header_len);
-                            // check wether a packed object is found
-                            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
-                            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
-                            quint32 toread = header_len + fields.Size;
-                            if (!(toread + start > data_len)) {
-                                memcpy(&fields, &logEntry->getData().Data[start], toread);
-                                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
-                                subEntry->setData(fields, m_objectManager);
-                                m_logEntries << subEntry;
-                            }
-                            start += toread;
-                        }
-                    }
+    QElapsedTimer timer;
+    timer.start();
 
-                    // Increment to get next entry from flight side
-                    slot++;
-                } else {
-                    // We are done, not more entries on this flight
-                    gotLast = true;
-                }
-            } else {
-                // We failed for some reason
-                break;
-            }
-            if (m_cancelDownload) {
-                break;
-            }
-        }
-        if (m_cancelDownload) {
+    int retries = 0;
+    while (m_retrieveFlight <= m_retrieveLastFlight && !m_cancelDownload) {
+        if (retrieveWindow()) {
+            retries = 0;
+        } else if (++retries > RETRIEVE_MAX_RETRIES) {
+            // The link dropped, keep what we have so that the download can be resumed
             break;
         }
+        updateTransferRate(m_transferTime + timer.elapsed());
     }
+    m_transferTime += timer.elapsed();
 
     if (m_cancelDownload) {
         clearLogList();
         m_cancelDownload = false;
+    } else {
+        setCanResume(m_retrieveFlight <= m_retrieveLastFlight);
     }
 
     emit logEntriesChanged();
@@ -275,6 +255,238 @@ void FlightLogManager::retrieveLogs(int flightToRetrieve)
     setDisableControls(false);
 }
 
+/**
+ * Request the next window of entries and wait until they are streamed back.
+ * Returns true if at least one new entry was retrieved.
+ */
+bool FlightLogManager::retrieveWindow()
+{
+    UAVObjectUpdaterHelper updateHelper;
+
+    m_windowEntries.clear();
+    m_windowComplete = false;
+    m_windowActive   = true;
+
+    m_flightLogControl->setOperation(DebugLogControl::OPERATION_RETRIEVERANGE);
+    m_flightLogControl->setFlight(m_retrieveFlight);
+    m_flightLogControl->setEntry(m_retrieveEntry);
+    m_flightLogControl->setCount(RETRIEVE_WINDOW_SIZE);
+
+    // Entries may already arrive while waiting for the ack
+    if (updateHelper.doObjectAndWait(m_flightLogControl, UAVTALK_TIMEOUT) == UAVObjectUpdaterHelper::SUCCESS
+        && !m_windowComplete && !m_cancelDownload) {
+        QTimer timeoutTimer;
+        timeoutTimer.setSingleShot(true);
+        connect(&timeoutTimer, SIGNAL(timeout()), &m_windowLoop, SLOT(quit()));
+        timeoutTimer.start(UAVTALK_TIMEOUT);
+        m_windowLoop.exec();
+    }
+    m_windowActive = false;
+
+    // Keep the consecutive entries, anything after a gap is requested again with the next window
+    bool progress = false;
+    while (m_windowEntries.contains(m_retrieveEntry)) {
+        DebugLogEntry::DataFields data = m_windowEntries.take(m_retrieveEntry);
+        progress = true;
+        if (data.Type == DebugLogEntry::TYPE_EMPTY) {
+            // We are done, no more entries on this flight
+            m_retrieveFlight++;
+            m_retrieveEntry = 0;
+            break;
+        }
+        addLogEntry(data);
+        m_retrieveEntry++;
+    }
+    return progress;
+}
+
+void FlightLogManager::addLogEntry(const DebugLogEntry::DataFields &data)
+{
+    if (data.Type == DebugLogEntry::TYPE_COMPRESSEDUAVOBJECTS) {
+        addCompressedLogEntries(data);
+        return;
+    }
+
+    ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+
+    logEntry->setData(data, m_objectManager);
+    m_logEntries << logEntry;
+    if (logEntry->getData().Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+        const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+        const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+        const quint32 header_len = total_len - data_len;
+
+        DebugLogEntry::DataFields fields;
+        quint32 start = logEntry->getData().Size;
+
+        // cycle until there is space for another object
+        while (start + header_len + 1 < data_len) {
+            memset(&fields, 0xFF, total_len);
+            memcpy(&fields, &logEntry->getData().Data[start], header_len);
+            // check wether a packed object is found
+            // note that empty data blocks are set as 0xFF in flight side to minimize flash wearing
+            // thus as soon as this read outside of used area, the test will fail as lenght would be 0xFFFF
+            quint32 toread = header_len + fields.Size;
+            if (!(toread + start > data_len)) {
+                memcpy(&fields, &logEntry->getData().Data[start], toread);
+                ExtendedDebugLogEntry *subEntry = new ExtendedDebugLogEntry();
+                subEntry->setData(fields, m_objectManager);
+                m_logEntries << subEntry;
+            }
+            start += toread;
+        }
+    }
+}
+
+static bool readVarint(const quint8 *data, quint32 size, quint32 &pos, quint32 &value)
+{
+    value = 0;
+    for (int shift = 0; pos < size && shift < 32; shift += 7) {
+        quint8 byte = data[pos++];
+        value |= (quint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decodes a high rate page, the encoding is documented in flight/pios/common/pios_debuglog.c
+void FlightLogManager::addCompressedLogEntries(const DebugLogEntry::DataFields &data)
+{
+    typedef struct {
+        quint32 objId;
+        quint16 instId;
+        QByteArray last;
+    } PageObject;
+
+    const quint8 *page = data.Data;
+    const quint32 size = qMin<quint32>(data.Size, sizeof(data.Data));
+    QVector<PageObject> dictionary;
+    quint32 time = data.FlightTime;
+    quint32 pos  = 0;
+
+    for (int record = 0; record < data.InstanceID && pos < size; record++) {
+        quint32 dt;
+        if (!readVarint(page, size, pos, dt) || pos >= size) {
+            break;
+        }
+        time += dt;
+        quint8 ref = page[pos++];
+        if (ref > dictionary.size()) {
+            break;
+        }
+        if (ref == dictionary.size()) {
+            PageObject object;
+            quint32 instId, length;
+            if (pos + sizeof(quint32) > size) {
+                break;
+            }
+            object.objId = qFromLittleEndian<quint32>(&page[pos]);
+            pos += sizeof(quint32);
+            if (!readVarint(page, size, pos, instId) || !readVarint(page, size, pos, length) || pos + length > size) {
+                break;
+            }
+            object.instId = instId;
+            object.last   = QByteArray((const char *)&page[pos], length);
+            pos += length;
+            dictionary << object;
+        } else {
+            QByteArray &last = dictionary[ref].last;
+            quint32 i = 0;
+            bool ok   = true;
+            while (ok && i < (quint32)last.size()) {
+                quint32 unchanged, changed;
+                ok = readVarint(page, size, pos, unchanged);
+                i += unchanged;
+                if (!ok || i >= (quint32)last.size()) {
+                    break;
+                }
+                ok = readVarint(page, size, pos, changed) && pos + changed <= size && i + changed <= (quint32)last.size();
+                if (ok) {
+                    memcpy(last.data() + i, &page[pos], changed);
+                    pos += changed;
+                    i   += changed;
+                }
+            }
+            if (!ok) {
+                break;
+            }
+        }
+
+        const PageObject &object = dictionary[ref];
+        if (!m_objectManager->getObject(object.objId, object.instId)
+            || object.last.size() > (int)sizeof(data.Data)) {
+            // Unknown object, skip it
+            continue;
+        }
+        DebugLogEntry::DataFields fields;
+        memset(&fields, 0xFF, sizeof(fields));
+        fields.Flight     = data.Flight;
+        fields.FlightTime = time;
+        fields.Entry      = data.Entry;
+        fields.Type       = DebugLogEntry::TYPE_UAVOBJECT;
+        fields.ObjectID   = object.objId;
+        fields.InstanceID = object.instId;
+        fields.Size       = object.last.size();
+        memcpy(fields.Data, object.last.constData(), object.last.size());
+
+        ExtendedDebugLogEntry *logEntry = new ExtendedDebugLogEntry();
+        logEntry->setData(fields, m_objectManager);
+        m_logEntries << logEntry;
+    }
+}
+
+void FlightLogManager::logEntryUpdated(UAVObject *object)
+{
+    DebugLogEntry *entry = qobject_cast<DebugLogEntry *>(object);
+
+    if (!m_windowActive || !entry) {
+        return;
+    }
+
+    DebugLogEntry::DataFields data = entry->getData();
+    if (data.Flight != m_retrieveFlight || data.Entry < m_retrieveEntry
+        || data.Entry >= m_retrieveEntry + RETRIEVE_WINDOW_SIZE) {
+        // Late entry from a previous window
+        return;
+    }
+    if (!m_windowEntries.contains(data.Entry)) {
+        // Entries sent again after a retry are not counted twice
+        m_retrievedBytes += entry->getNumBytes();
+    }
+    m_windowEntries.insert(data.Entry, data);
+
+    // The window is complete once all its entries, or all entries up to the end of the flight, are in
+    int next = m_retrieveEntry;
+    while (m_windowEntries.contains(next) && m_windowEntries[next].Type != DebugLogEntry::TYPE_EMPTY) {
+        next++;
+    }
+    if (m_windowEntries.contains(next) || next == m_retrieveEntry + RETRIEVE_WINDOW_SIZE) {
+        m_windowComplete = true;
+        m_windowLoop.quit();
+    }
+}
+
+void FlightLogManager::newObjectInstance(UAVObject *object)
+{
+    if (object->getObjID() == DebugLogEntry::OBJID) {
+        connect(object, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(logEntryUpdated(UAVObject *)));
+    }
+}
+
+void FlightLogManager::updateTransferRate(qint64 elapsedMs)
+{
+    if (elapsedMs <= 0) {
+        return;
+    }
+    double seconds = elapsedMs / 1000.0;
+    m_transferRate = tr("%1 kB/s, %2 entries/s")
+                     .arg(m_retrievedBytes / 1024.0 / seconds, 0, 'f', 1)
+                     .arg(m_logEntries.count() / seconds, 0, 'f', 1);
+    emit transferRateChanged(m_transferRate);
+}
+
 void FlightLogManager::exportToOPL(QString fileName)
 {
     // Fix the file name
@@ -321,6 +533,42 @@ void FlightLogManager::exportToOPL(QString fileName)
     }
 }
 
+void FlightLogManager::exportToColumnar(QString fileName)
+{
+    // Fix the file name
+    fileName.replace(QString(".oplc"), QString("%1.oplc"));
+
+    // Loop and create a new file for each flight, same as the OPL export.
+    int currentEntry  = 0;
+    int currentFlight = 0;
+    quint32 adjustedBaseTime = 0;
+    while (currentEntry < m_logEntries.count()) {
+        if (m_adjustExportedTimestamps) {
+            adjustedBaseTime = m_logEntries[currentEntry]->getFlightTime();
+        }
+
+        currentFlight = m_logEntries[currentEntry]->getFlight();
+
+        UAVObjectColumnarWriter writer(m_objectManager);
+        if (!writer.open(fileName.arg(tr("_flight-%1").arg(currentFlight + 1)))) {
+            break;
+        }
+
+        // Entries are streamed, each object type is buffered until a chunk is complete
+        while (currentEntry < m_logEntries.count() && m_logEntries[currentEntry]->getFlight() == currentFlight) {
+            ExtendedDebugLogEntry *entry = m_logEntries[currentEntry];
+
+            // Only log uavobjects
+            if (entry->getType() == ExtendedDebugLogEntry::TYPE_UAVOBJECT || entry->getType() == ExtendedDebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+                writer.writeObject(entry->uavObject(), entry->getFlightTime() - adjustedBaseTime);
+            }
+            currentEntry++;
+        }
+
+        writer.close();
+    }
+}
+
 void FlightLogManager::exportToCSV(QString fileName)
 {
     QFile csvFile(fileName);
@@ -381,14 +629,15 @@ void FlightLogManager::exportLogs()
     setDisableControls(true);
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    QString oplFilter = tr("OpenPilot Log file %1").arg("(*.opl)");
-    QString csvFilter = tr("Text file %1").arg("(*.csv)");
-    QString xmlFilter = tr("XML file %1").arg("(*.xml)");
+    QString oplFilter  = tr("OpenPilot Log file %1").arg("(*.opl)");
+    QString csvFilter  = tr("Text file %1").arg("(*.csv)");
+    QString xmlFilter  = tr("XML file %1").arg("(*.xml)");
+    QString oplcFilter = tr("Columnar Log file %1").arg("(*.oplc)");
 
     QString selectedFilter = csvFilter;
 
     QString fileName = QFileDialog::getSaveFileName(NULL, tr("Save Log Entries"), QDir::homePath(),
-                                                    QString("%1;;%2;;%3").arg(oplFilter, csvFilter, xmlFilter), &selectedFilter);
+                                                    QString("%1;;%2;;%3;;%4").arg(oplFilter, csvFilter, xmlFilter, oplcFilter), &selectedFilter);
     if (!fileName.isEmpty()) {
         if (selectedFilter == oplFilter) {
             if (!fileName.endsWith(".opl")) {
@@ -405,6 +654,11 @@ void FlightLogManager::exportLogs()
                 fileName.append(".xml");
             }
             exportToXML(fileName);
+        } else if (selectedFilter == oplcFilter) {
+            if (!fileName.endsWith(".oplc")) {
+                fileName.append(".oplc");
+            }
+            exportToColumnar(fileName);
         }
     }
 
@@ -415,6 +669,8 @@ void FlightLogManager::exportLogs()
 void FlightLogManager::cancelExportLogs()
 {
     m_cancelDownload = true;
+    // Don't wait for the rest of the window
+    m_windowLoop.quit();
 }
 
 void FlightLogManager::loadSettings()
@@ -445,6 +701,10 @@ void FlightLogManager::loadSettings()
                     break;
                 }
 
+                // Files saved before the high rate mode existed have no mode attribute
+                int mode = xmlReader.attributes().value("mode").toInt(&ok);
+                setLoggingMode(ok ? mode : 0);
+
                 while (xmlReader.readNextStartElement()) {
                     if (xmlReader.name() == "setting") {
                         QString name = xmlReader.attributes().value("name").toString();
@@ -497,6 +757,7 @@ void FlightLogManager::saveSettings()
             xmlWriter.writeStartElement("settings");
             xmlWriter.writeAttribute("version", QString::number(LOG_SETTINGS_FILE_VERSION));
             xmlWriter.writeAttribute("enabled", QString::number(m_loggingEnabled));
+            xmlWriter.writeAttribute("mode", QString::number(m_loggingMode));
             foreach(UAVOLogSettingsWrapper * wrapper, m_uavoEntries) {
                 xmlWriter.writeStartElement("setting");
                 xmlWriter.writeAttribute("name", wrapper->name());
@@ -515,6 +776,7 @@ void FlightLogManager::saveSettings()
 void FlightLogManager::resetSettings(bool clear)
 {
     setLoggingEnabled(clear ? 0 : m_flightLogSettings->getLoggingEnabled());
+    setLoggingMode(clear ? 0 : m_flightLogSettings->getLoggingMode());
     foreach(UAVOLogSettingsWrapper * wrapper, m_uavoEntries) {
         wrapper->reset(clear);
     }
@@ -523,6 +785,7 @@ void FlightLogManager::resetSettings(bool clear)
 void FlightLogManager::saveSettingsToBoard()
 {
     m_flightLogSettings->setLoggingEnabled(m_loggingEnabled);
+    m_flightLogSettings->setLoggingMode(m_loggingMode);
     m_flightLogSettings->updated();
     saveUAVObjectToFlash(m_flightLogSettings);
 
@@ -596,6 +859,7 @@ void FlightLogManager::setupLogSettings()
 void FlightLogManager::setupLogStatuses()
 {
     m_logStatuses << tr("Never") << tr("Only when Armed") << tr("Always");
+    m_logModes << tr("Standard") << tr("High rate");
 }
 
 void FlightLogManager::connectionStatusChanged()
@@ -33,6 +33,8 @@
 #include <QHash>
 #include <QQmlListProperty>
 #include <QSemaphore>
+#include <QEventLoop>
+#include <QMap>
 #include <QXmlStreamWriter>
 #include <QTextStream>
 
@@ -182,7 +184,11 @@ class FlightLogManager : public QObject {
     Q_PROPERTY(QStringList logSettings READ logSettings NOTIFY logSettingsChanged)
     Q_PROPERTY(QStringList logStatuses READ logStatuses NOTIFY logStatusesChanged)
     Q_PROPERTY(int loggingEnabled READ loggingEnabled WRITE setLoggingEnabled NOTIFY loggingEnabledChanged)
+    Q_PROPERTY(QStringList logModes READ logModes NOTIFY logModesChanged)
+    Q_PROPERTY(int loggingMode READ loggingMode WRITE setLoggingMode NOTIFY loggingModeChanged)
     Q_PROPERTY(int logEntriesCount READ logEntriesCount NOTIFY logEntriesChanged)
+    Q_PROPERTY(bool canResume READ canResume NOTIFY canResumeChanged)
+    Q_PROPERTY(QString transferRate READ transferRate NOTIFY transferRateChanged)
 
 public:
     explicit FlightLogManager(QObject *parent = 0);
@@ -244,10 +250,30 @@ public:
     {
         return m_loggingEnabled;
     }
+
+    QStringList logModes() const
+    {
+        return m_logModes;
+    }
+
+    int loggingMode() const
+    {
+        return m_loggingMode;
+    }
     int logEntriesCount()
     {
         return m_logEntries.count();
     }
+
+    bool canResume() const
+    {
+        return m_canResume;
+    }
+
+    QString transferRate() const
+    {
+        return m_transferRate;
+    }
 signals:
     void logEntriesChanged();
     void flightEntriesChanged();
@@ -260,10 +286,15 @@ signals:
 
     void logStatusesChanged(QStringList arg);
     void loggingEnabledChanged(int arg);
+    void logModesChanged(QStringList arg);
+    void loggingModeChanged(int arg);
+    void canResumeChanged(bool arg);
+    void transferRateChanged(QString arg);
 
 public slots:
     void clearAllLogs();
     void retrieveLogs(int flightToRetrieve = -1);
+    void resumeRetrieveLogs();
     void exportLogs();
     void cancelExportLogs();
     void loadSettings();
@@ -312,6 +343,14 @@ public slots:
         }
     }
 
+    void setLoggingMode(int arg)
+    {
+        if (m_loggingMode != arg) {
+            m_loggingMode = arg;
+            emit loggingModeChanged(arg);
+        }
+    }
+
 private slots:
     void updateFlightEntries(quint16 currentFlight);
     void setupUAVOWrappers();
@@ -319,6 +358,8 @@ private slots:
     void setupLogStatuses();
     void connectionStatusChanged();
     bool updateLogWrapper(QString name, int level, int period);
+    void logEntryUpdated(UAVObject *object);
+    void newObjectInstance(UAVObject *object);
 
 private:
     UAVObjectManager *m_objectManager;
@@ -334,6 +375,7 @@ private:
     QStringList m_flightEntries;
     QStringList m_logSettings;
     QStringList m_logStatuses;
+    QStringList m_logModes;
 
     QList<UAVOLogSettingsWrapper *> m_uavoEntries;
     QHash<QString, UAVOLogSettingsWrapper *> m_uavoEntriesHash;
@@ -341,8 +383,27 @@ private:
     void exportToOPL(QString fileName);
     void exportToCSV(QString fileName);
     void exportToXML(QString fileName);
+    void exportToColumnar(QString fileName);
+
+    void continueRetrieveLogs();
+    bool retrieveWindow();
+    void addLogEntry(const DebugLogEntry::DataFields &data);
+    void addCompressedLogEntries(const DebugLogEntry::DataFields &data);
+    void updateTransferRate(qint64 elapsedMs);
+
+    void setCanResume(bool arg)
+    {
+        if (m_canResume != arg) {
+            m_canResume = arg;
+            emit canResumeChanged(arg);
+        }
+    }
 
     static const int UAVTALK_TIMEOUT = 4000;
+    // Number of entries streamed by the flight side per request, and
+    // number of consecutive windows without progress before giving up
+    static const int RETRIEVE_WINDOW_SIZE = 8;
+    static const int RETRIEVE_MAX_RETRIES = 3;
     static const int LOG_SETTINGS_FILE_VERSION = 1;
     bool m_disableControls;
     bool m_disableExport;
@@ -350,6 +411,20 @@ private:
     bool m_adjustExportedTimestamps;
     bool m_boardConnected;
     int m_loggingEnabled;
+    int m_loggingMode;
+    bool m_canResume;
+
+    // Streamed download state, kept between calls so an interrupted download can be resumed
+    int m_retrieveFlight;
+    int m_retrieveLastFlight;
+    int m_retrieveEntry;
+    bool m_windowActive;
+    bool m_windowComplete;
+    QEventLoop m_windowLoop;
+    QMap<int, DebugLogEntry::DataFields> m_windowEntries;
+    quint64 m_retrievedBytes;
+    qint64 m_transferTime;
+    QString m_transferRate;
 };
 
 #endif // FLIGHTLOGMANAGER_H
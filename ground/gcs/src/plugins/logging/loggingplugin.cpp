@@ -34,7 +34,10 @@
 
 #include "logginggadgetfactory.h"
 #include "uavobjectmanager.h"
+#include "uavobjectcolumnarwriter.h"
 #include <uavtalk/uavtalk.h>
+#include <uavtalk/uavtalkdispatcher.h>
+#include <utils/crc.h>
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/actionmanager/actionmanager.h>
 
@@ -49,6 +52,8 @@
 #include <QErrorMessage>
 #include <QWriteLocker>
 #include <QKeySequence>
+#include <QRegExp>
+#include <QtEndian>
 
 LoggingConnection::LoggingConnection() :
     m_deviceOpened(false), logFile()
@@ -188,6 +193,8 @@ void LoggingThread::startLogging()
             objects++;
         }
     }
+    // every received update is logged, not only the newest of each batch
+    UAVTalkDispatcher::setKeepAllUpdates(true);
 
     GCSTelemetryStats *gcsStatsObj = GCSTelemetryStats::GetInstance(objManager);
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
@@ -225,6 +232,7 @@ void LoggingThread::stopLogging()
             disconnect(*j, &UAVObject::objectUpdated, this, &LoggingThread::objectUpdated);
         }
     }
+    UAVTalkDispatcher::setKeepAllUpdates(false);
 
     logFile.close();
 
@@ -299,6 +307,7 @@ void LoggingThread::transactionCompleted(UAVObject *obj, bool success)
 
 LoggingPlugin::LoggingPlugin() :
     loggingCommand(NULL),
+    exportColumnarCommand(NULL),
     state(IDLE),
     loggingThread(NULL),
     logConnection(new LoggingConnection())
@@ -335,6 +344,15 @@ bool LoggingPlugin::initialize(const QStringList & args, QString *errMsg)
 
     connect(loggingCommand->action(), &QAction::triggered, this, &LoggingPlugin::toggleLogging);
 
+    // Command to convert a log file to the columnar format
+    exportColumnarCommand = am->registerAction(new QAction(tr("Export log to columnar format..."), this),
+                                               "LoggingPlugin.ExportColumnar",
+                                               QList<int>() <<
+                                               Core::Constants::C_GLOBAL_ID);
+    ac->addAction(exportColumnarCommand, "Logging");
+
+    connect(exportColumnarCommand->action(), &QAction::triggered, this, &LoggingPlugin::exportColumnar);
+
     LoggingGadgetFactory *mf = new LoggingGadgetFactory(this);
     addAutoReleasedObject(mf);
 
@@ -453,6 +471,114 @@ void LoggingPlugin::replayStopped()
     }
 }
 
+/**
+ * Asks for an OPL log file and converts it to the columnar format
+ */
+void LoggingPlugin::exportColumnar()
+{
+    QString logFileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""), tr("OpenPilot Log (*.opl)"));
+
+    if (logFileName.isEmpty()) {
+        return;
+    }
+
+    QString columnarFileName = logFileName;
+    columnarFileName.replace(QRegExp("\\.opl$"), QString());
+    columnarFileName = QFileDialog::getSaveFileName(NULL, tr("Export log"),
+                                                    columnarFileName + ".oplc",
+                                                    tr("Columnar Log (*.oplc)"));
+    if (columnarFileName.isEmpty()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool success = convertToColumnar(logFileName, columnarFileName);
+    QApplication::restoreOverrideCursor();
+
+    if (!success) {
+        QErrorMessage err;
+        err.showMessage(tr("Unable to export log file %1").arg(logFileName));
+        err.exec();
+    }
+}
+
+/**
+ * Streams the object updates of an OPL log file into a columnar log file.
+ * The log file is a sequence of records made of a 32 bit time stamp,
+ * a 64 bit packet size and a complete UAVTalk packet.
+ */
+bool LoggingPlugin::convertToColumnar(const QString &logFileName, const QString &columnarFileName)
+{
+    // UAVTalk packet layout: sync(1), type(1), size(2), object ID(4), instance ID(2), data, checksum(1)
+    static const quint8 SYNC_VAL          = 0x3C;
+    static const quint8 TYPE_OBJ          = 0x20;
+    static const quint8 TYPE_OBJ_ACK      = 0x22;
+    static const int HEADER_LENGTH        = 10;
+    static const qint64 MAX_PACKET_LENGTH = 1024 * 1024;
+
+    QFile logFile(logFileName);
+
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "LoggingPlugin - unable to open" << logFileName;
+        return false;
+    }
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+
+    UAVObjectColumnarWriter writer(objManager);
+    if (!writer.open(columnarFileName)) {
+        return false;
+    }
+
+    QByteArray packet;
+    quint32 timeStamp;
+    qint64 dataSize;
+    int objects = 0;
+    int skipped = 0;
+
+    while (logFile.read((char *)&timeStamp, sizeof(timeStamp)) == sizeof(timeStamp)
+           && logFile.read((char *)&dataSize, sizeof(dataSize)) == sizeof(dataSize)) {
+        if (dataSize < 1 || dataSize > MAX_PACKET_LENGTH) {
+            qWarning() << "LoggingPlugin - log file corrupted, unlikely packet size" << dataSize;
+            break;
+        }
+        packet = logFile.read(dataSize);
+        if (packet.size() != dataSize) {
+            break;
+        }
+
+        const quint8 *data = (const quint8 *)packet.constData();
+        if (dataSize < HEADER_LENGTH + 1 || data[0] != SYNC_VAL) {
+            skipped++;
+            continue;
+        }
+        quint8 type    = data[1];
+        quint16 length = qFromLittleEndian<quint16>(&data[2]);
+        if (length < HEADER_LENGTH || length + 1 > dataSize
+            || Utils::Crc::updateCRC(0, data, length) != data[length]) {
+            skipped++;
+            continue;
+        }
+        if (type != TYPE_OBJ && type != TYPE_OBJ_ACK) {
+            // Requests, acks and nacks carry no object data
+            continue;
+        }
+
+        quint32 objId  = qFromLittleEndian<quint32>(&data[4]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[8]);
+        if (writer.writePacked(objId, instId, &data[HEADER_LENGTH], length - HEADER_LENGTH, timeStamp)) {
+            objects++;
+        } else {
+            skipped++;
+        }
+    }
+
+    qDebug() << "LoggingPlugin - exported" << objects << "objects to" << columnarFileName << "," << skipped << "packets skipped";
+
+    return writer.close();
+}
+
 void LoggingPlugin::extensionsInitialized()
 {
     addAutoReleasedObject(logConnection);
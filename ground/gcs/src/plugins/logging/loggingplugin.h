@@ -136,6 +136,8 @@ public:
         return state;
     }
 
+    static bool convertToColumnar(const QString &logFileName, const QString &columnarFileName);
+
 signals:
     void stateChanged(State);
 
@@ -147,9 +149,11 @@ private slots:
     void loggingStopped();
     void replayStarted();
     void replayStopped();
+    void exportColumnar();
 
 private:
     Core::Command *loggingCommand;
+    Core::Command *exportColumnarCommand;
     State state;
     // These are used for replay, logging in its own thread
     LoggingThread *loggingThread;
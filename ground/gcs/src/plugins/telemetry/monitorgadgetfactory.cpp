@@ -61,6 +61,9 @@ MonitorWidget *MonitorGadgetFactory::createMonitorWidget(QWidget *parent)
     // connect(tm, SIGNAL(connected()), widget, SLOT(telemetryConnected()));
     // connect(tm, SIGNAL(disconnected()), widget, SLOT(telemetryDisconnected()));
     connect(tm, SIGNAL(telemetryUpdated(double, double)), widget, SLOT(telemetryUpdated(double, double)));
+    connect(tm, SIGNAL(objectsRetrieved(int, int, int)), widget, SLOT(objectsRetrieved(int, int, int)));
+    connect(tm, SIGNAL(dispatchUpdated(double, double, double, double)),
+            widget, SLOT(dispatchUpdated(double, double, double, double)));
 
     // connect widget to connection manager
     Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
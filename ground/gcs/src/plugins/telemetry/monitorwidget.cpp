@@ -241,6 +241,8 @@ void MonitorWidget::telemetryDisconnected()
     qDebug() << "MonitorWidget::telemetryDisconnected";
     if (connected) {
         connected = false;
+        retrievedInfo.clear();
+        dispatchInfo.clear();
 
         setToolTip(tr("Disconnected"));
 
@@ -262,7 +264,14 @@ void MonitorWidget::telemetryUpdated(double txRate, double rxRate)
     double rxIndex = (rxRate - minValue) / (maxValue - minValue) * rxNodes.count();
 
     if (connected) {
-        this->setToolTip(QString("Tx: %0 bytes/s, Rx: %1 bytes/s").arg(txRate).arg(rxRate));
+        QString toolTip = QString("Tx: %0 bytes/s, Rx: %1 bytes/s").arg(txRate).arg(rxRate);
+        if (!retrievedInfo.isEmpty()) {
+            toolTip += "\n" + retrievedInfo;
+        }
+        if (!dispatchInfo.isEmpty()) {
+            toolTip += "\n" + dispatchInfo;
+        }
+        this->setToolTip(toolTip);
     }
 
     for (int i = 0; i < txNodes.count(); i++) {
@@ -302,6 +311,27 @@ void MonitorWidget::telemetryUpdated(double txRate, double rxRate)
     update();
 }
 
+/*!
+   \brief Called once the objects are retrieved after connecting
+ */
+void MonitorWidget::objectsRetrieved(int objects, int failed, int elapsedMs)
+{
+    retrievedInfo = tr("Connected in %0 s, %1 objects retrieved").arg(elapsedMs / 1000.0, 0, 'f', 1).arg(objects);
+    if (failed > 0) {
+        retrievedInfo += tr(", %0 failed").arg(failed);
+    }
+}
+
+/*!
+   \brief Called with the rate and latency of the received updates handed to the GUI thread
+ */
+void MonitorWidget::dispatchUpdated(double updateRate, double supersededRate, double meanLatencyMs, double maxLatencyMs)
+{
+    dispatchInfo = tr("Updates: %0/s, %1/s superseded, latency %2 ms mean, %3 ms max")
+                   .arg(updateRate, 0, 'f', 0).arg(supersededRate, 0, 'f', 0)
+                   .arg(meanLatencyMs, 0, 'f', 1).arg(maxLatencyMs, 0, 'f', 1);
+}
+
 void MonitorWidget::showEvent(QShowEvent *event)
 {
     Q_UNUSED(event);
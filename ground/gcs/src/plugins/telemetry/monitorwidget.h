@@ -65,6 +65,8 @@ public slots:
     void telemetryConnected();
     void telemetryDisconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    void objectsRetrieved(int objects, int failed, int elapsedMs);
+    void dispatchUpdated(double updateRate, double supersededRate, double meanLatencyMs, double maxLatencyMs);
 
 protected:
     void showEvent(QShowEvent *event);
@@ -81,6 +83,10 @@ private:
     QPointer<QGraphicsTextItem> txSpeed;
     QPointer<QGraphicsTextItem> rxSpeed;
 
+    // connect time and update hand-over, shown in the tooltip
+    QString retrievedInfo;
+    QString dispatchInfo;
+
     QList<QGraphicsSvgItem *> txNodes;
     QList<QGraphicsSvgItem *> rxNodes;
 
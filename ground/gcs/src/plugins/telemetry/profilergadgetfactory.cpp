@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilergadgetfactory.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryPlugin Telemetry Plugin
+ * @{
+ * @brief Per object telemetry bandwidth gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "profilergadgetfactory.h"
+
+#include "profilergadget.h"
+#include "monitorgadgetconfiguration.h"
+
+ProfilerGadgetFactory::ProfilerGadgetFactory(QObject *parent) :
+    IUAVGadgetFactory(QString("TelemetryProfilerGadget"), tr("Telemetry Profiler"), parent)
+{}
+
+ProfilerGadgetFactory::~ProfilerGadgetFactory()
+{}
+
+Core::IUAVGadget *ProfilerGadgetFactory::createGadget(QWidget *parent)
+{
+    return new ProfilerGadget(QString("TelemetryProfilerGadget"), new ProfilerWidget(parent), parent);
+}
+
+IUAVGadgetConfiguration *ProfilerGadgetFactory::createConfiguration(QSettings &settings)
+{
+    // nothing to configure, the monitor's empty configuration will do
+    return new MonitorGadgetConfiguration(QString("TelemetryProfilerGadget"), settings);
+}
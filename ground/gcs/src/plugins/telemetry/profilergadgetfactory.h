@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilergadgetfactory.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryPlugin Telemetry Plugin
+ * @{
+ * @brief Per object telemetry bandwidth gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PROFILERGADGETFACTORY_H
+#define PROFILERGADGETFACTORY_H
+
+#include <coreplugin/iuavgadgetfactory.h>
+
+namespace Core {
+class IUAVGadget;
+class IUAVGadgetFactory;
+}
+
+using namespace Core;
+
+class ProfilerGadgetFactory : public IUAVGadgetFactory {
+    Q_OBJECT
+public:
+    ProfilerGadgetFactory(QObject *parent = 0);
+    ~ProfilerGadgetFactory();
+
+    Core::IUAVGadget *createGadget(QWidget *parent);
+    IUAVGadgetConfiguration *createConfiguration(QSettings &settings);
+};
+
+#endif // PROFILERGADGETFACTORY_H
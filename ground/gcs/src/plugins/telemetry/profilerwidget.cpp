@@ -0,0 +1,237 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilerwidget.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryPlugin Telemetry Plugin
+ * @{
+ * @brief Per object telemetry bandwidth gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "profilerwidget.h"
+
+#include <extensionsystem/pluginmanager.h>
+#include <uavtalk/telemetrymanager.h>
+
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#define REFRESH_PERIOD_MS 1000
+
+static double perSecond(double count, qint64 durationMs)
+{
+    return durationMs > 0 ? count * 1000.0 / durationMs : 0.0;
+}
+
+ProfilerWidget::ProfilerWidget(QWidget *parent) : QWidget(parent), comparing(false)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+
+    telemetryManager = pm->getObject<TelemetryManager>();
+
+    tree = new QTreeWidget(this);
+    tree->setRootIsDecorated(false);
+    tree->setSortingEnabled(true);
+    tree->setColumnCount(COLUMN_COUNT);
+    tree->setHeaderLabels(QStringList() << tr("Object") << tr("Tx B/s") << tr("Rx B/s") << tr("Tx pkt/s") << tr("Rx pkt/s")
+                                        << tr("Ack ms") << tr("Max ack ms") << tr("Retries") << tr("Tx drops") << tr("Rx drops")
+                                        << tr("Tx B/s change") << tr("Rx B/s change"));
+    tree->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    tree->sortByColumn(COLUMN_RX_RATE, Qt::DescendingOrder);
+    tree->setColumnHidden(COLUMN_TX_RATE_DELTA, true);
+    tree->setColumnHidden(COLUMN_RX_RATE_DELTA, true);
+
+    QPushButton *resetButton   = new QPushButton(tr("Reset"), this);
+    QPushButton *saveButton    = new QPushButton(tr("Save..."), this);
+    QPushButton *openButton    = new QPushButton(tr("Open..."), this);
+    QPushButton *liveButton    = new QPushButton(tr("Live"), this);
+    QPushButton *compareButton = new QPushButton(tr("Compare with..."), this);
+    QPushButton *clearButton   = new QPushButton(tr("Clear comparison"), this);
+    connect(resetButton, SIGNAL(clicked()), this, SLOT(reset()));
+    connect(saveButton, SIGNAL(clicked()), this, SLOT(save()));
+    connect(openButton, SIGNAL(clicked()), this, SLOT(open()));
+    connect(liveButton, SIGNAL(clicked()), this, SLOT(showLive()));
+    connect(compareButton, SIGNAL(clicked()), this, SLOT(compare()));
+    connect(clearButton, SIGNAL(clicked()), this, SLOT(clearComparison()));
+
+    status = new QLabel(this);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addWidget(resetButton);
+    buttons->addWidget(saveButton);
+    buttons->addWidget(openButton);
+    buttons->addWidget(liveButton);
+    buttons->addWidget(compareButton);
+    buttons->addWidget(clearButton);
+    buttons->addStretch();
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(buttons);
+    layout->addWidget(tree);
+    layout->addWidget(status);
+
+    timer = new QTimer(this);
+    connect(timer, SIGNAL(timeout()), this, SLOT(refresh()));
+    showLive();
+}
+
+ProfilerWidget::~ProfilerWidget()
+{}
+
+void ProfilerWidget::refresh()
+{
+    showProfile(telemetryManager->getProfile());
+}
+
+void ProfilerWidget::reset()
+{
+    telemetryManager->resetProfile();
+    showLive();
+}
+
+void ProfilerWidget::save()
+{
+    TelemetryProfile profile = telemetryManager->getProfile();
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save telemetry profile"), QString(), tr("Telemetry profile (*.json)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QString errorString;
+    if (!profile.save(fileName, &errorString)) {
+        QMessageBox::warning(this, tr("Save telemetry profile"), tr("Could not save %1: %2").arg(fileName, errorString));
+    }
+}
+
+void ProfilerWidget::open()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open telemetry profile"), QString(), tr("Telemetry profile (*.json)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    TelemetryProfile profile;
+    QString errorString;
+    if (!profile.load(fileName, &errorString)) {
+        QMessageBox::warning(this, tr("Open telemetry profile"), tr("Could not open %1: %2").arg(fileName, errorString));
+        return;
+    }
+    timer->stop();
+    openedFile = fileName;
+    showProfile(profile);
+}
+
+void ProfilerWidget::showLive()
+{
+    openedFile.clear();
+    refresh();
+    timer->start(REFRESH_PERIOD_MS);
+}
+
+void ProfilerWidget::compare()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Compare with telemetry profile"), QString(), tr("Telemetry profile (*.json)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QString errorString;
+    if (!baseline.load(fileName, &errorString)) {
+        QMessageBox::warning(this, tr("Compare with telemetry profile"), tr("Could not open %1: %2").arg(fileName, errorString));
+        return;
+    }
+    comparing    = true;
+    baselineFile = fileName;
+    tree->setColumnHidden(COLUMN_TX_RATE_DELTA, false);
+    tree->setColumnHidden(COLUMN_RX_RATE_DELTA, false);
+    if (!timer->isActive()) {
+        // a saved profile is shown, load it again to fill in the changes
+        TelemetryProfile profile;
+        profile.load(openedFile);
+        showProfile(profile);
+    }
+}
+
+void ProfilerWidget::clearComparison()
+{
+    comparing = false;
+    baselineFile.clear();
+    tree->setColumnHidden(COLUMN_TX_RATE_DELTA, true);
+    tree->setColumnHidden(COLUMN_RX_RATE_DELTA, true);
+}
+
+void ProfilerWidget::showProfile(const TelemetryProfile &profile)
+{
+    double txTotal = 0.0;
+    double rxTotal = 0.0;
+
+    // keep the items, so that the selection and scroll position survive the refresh
+    foreach(quint32 objId, items.keys()) {
+        if (!profile.objects.contains(objId)) {
+            delete items.take(objId);
+        }
+    }
+
+    tree->setSortingEnabled(false);
+    for (QMap<quint32, TelemetryProfile::Counters>::const_iterator it = profile.objects.constBegin(); it != profile.objects.constEnd(); ++it) {
+        const TelemetryProfile::Counters &c = it.value();
+        QTreeWidgetItem *item = items.value(it.key());
+        if (!item) {
+            item = new QTreeWidgetItem(tree);
+            items.insert(it.key(), item);
+        }
+        double txRate = perSecond(c.txBytes, profile.durationMs);
+        double rxRate = perSecond(c.rxBytes, profile.durationMs);
+        txTotal += txRate;
+        rxTotal += rxRate;
+
+        item->setText(COLUMN_NAME, c.name);
+        item->setData(COLUMN_TX_RATE, Qt::DisplayRole, qRound(txRate));
+        item->setData(COLUMN_RX_RATE, Qt::DisplayRole, qRound(rxRate));
+        item->setData(COLUMN_TX_PACKETS, Qt::DisplayRole, qRound(perSecond(c.txPackets, profile.durationMs) * 10) / 10.0);
+        item->setData(COLUMN_RX_PACKETS, Qt::DisplayRole, qRound(perSecond(c.rxPackets, profile.durationMs) * 10) / 10.0);
+        item->setData(COLUMN_ACK_TIME, Qt::DisplayRole, c.acks ? qRound((double)c.ackTimeUs / c.acks / 100.0) / 10.0 : 0.0);
+        item->setData(COLUMN_MAX_ACK_TIME, Qt::DisplayRole, qRound(c.maxAckTimeUs / 100.0) / 10.0);
+        item->setData(COLUMN_RETRIES, Qt::DisplayRole, c.retries);
+        item->setData(COLUMN_TX_DROPS, Qt::DisplayRole, c.txDrops);
+        item->setData(COLUMN_RX_DROPS, Qt::DisplayRole, c.rxDrops);
+        if (comparing) {
+            TelemetryProfile::Counters base = baseline.objects.value(it.key());
+            item->setData(COLUMN_TX_RATE_DELTA, Qt::DisplayRole, qRound(txRate - perSecond(base.txBytes, baseline.durationMs)));
+            item->setData(COLUMN_RX_RATE_DELTA, Qt::DisplayRole, qRound(rxRate - perSecond(base.rxBytes, baseline.durationMs)));
+        }
+    }
+    tree->setSortingEnabled(true);
+
+    QString source = openedFile.isEmpty() ? tr("Live") : QFileInfo(openedFile).fileName();
+    QString text   = tr("%1: %2 s, %3 B/s sent, %4 B/s received").arg(source).arg(profile.durationMs / 1000)
+                     .arg(qRound(txTotal)).arg(qRound(rxTotal));
+    if (comparing) {
+        text += tr(", compared with %1").arg(QFileInfo(baselineFile).fileName());
+    }
+    status->setText(text);
+}
@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilerwidget.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryPlugin Telemetry Plugin
+ * @{
+ * @brief Per object telemetry bandwidth gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PROFILERWIDGET_H
+#define PROFILERWIDGET_H
+
+#include <uavtalk/telemetryprofiler.h>
+
+#include <QWidget>
+#include <QMap>
+
+class QLabel;
+class QTimer;
+class QTreeWidget;
+class QTreeWidgetItem;
+class TelemetryManager;
+
+/**
+ * Shows the bandwidth each object takes on the telemetry link, live or from
+ * a saved profile, optionally against a second saved profile.
+ */
+class ProfilerWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit ProfilerWidget(QWidget *parent = 0);
+    ~ProfilerWidget();
+
+private slots:
+    void refresh();
+    void reset();
+    void save();
+    void open();
+    void showLive();
+    void compare();
+    void clearComparison();
+
+private:
+    enum Column {
+        COLUMN_NAME, COLUMN_TX_RATE, COLUMN_RX_RATE, COLUMN_TX_PACKETS, COLUMN_RX_PACKETS,
+        COLUMN_ACK_TIME, COLUMN_MAX_ACK_TIME, COLUMN_RETRIES, COLUMN_TX_DROPS, COLUMN_RX_DROPS,
+        COLUMN_TX_RATE_DELTA, COLUMN_RX_RATE_DELTA, COLUMN_COUNT
+    };
+
+    void showProfile(const TelemetryProfile &profile);
+
+    TelemetryManager *telemetryManager;
+    QTreeWidget *tree;
+    QLabel *status;
+    QTimer *timer;
+    QMap<quint32, QTreeWidgetItem *> items;
+    TelemetryProfile baseline;
+    bool comparing;
+    QString openedFile;
+    QString baselineFile;
+};
+
+#endif // PROFILERWIDGET_H
@@ -14,7 +14,10 @@ HEADERS += \
     monitorgadgetconfiguration.h \
     monitorgadget.h \
     monitorgadgetfactory.h \
-    monitorgadgetoptionspage.h
+    monitorgadgetoptionspage.h \
+    profilerwidget.h \
+    profilergadget.h \
+    profilergadgetfactory.h
 
 SOURCES += \
     telemetryplugin.cpp \
@@ -22,7 +25,10 @@ SOURCES += \
     monitorgadgetconfiguration.cpp \
     monitorgadget.cpp \
     monitorgadgetfactory.cpp \
-    monitorgadgetoptionspage.cpp
+    monitorgadgetoptionspage.cpp \
+    profilerwidget.cpp \
+    profilergadget.cpp \
+    profilergadgetfactory.cpp
 
 OTHER_FILES += Telemetry.pluginspec
 
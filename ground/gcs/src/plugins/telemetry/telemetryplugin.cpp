@@ -27,6 +27,7 @@
 
 #include "telemetryplugin.h"
 #include "monitorgadgetfactory.h"
+#include "profilergadgetfactory.h"
 
 #include "version_info/version_info.h"
 #include "uavobjectmanager.h"
@@ -62,6 +63,7 @@ bool TelemetryPlugin::initialize(const QStringList & args, QString *errMsg)
 
     MonitorGadgetFactory *mf = new MonitorGadgetFactory(this);
     addAutoReleasedObject(mf);
+    addAutoReleasedObject(new ProfilerGadgetFactory(this));
 
     // mop = new TelemetryPluginOptionsPage(this);
     // addAutoReleasedObject(mop);
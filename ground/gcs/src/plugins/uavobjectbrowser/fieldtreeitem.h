@@ -37,6 +37,7 @@
 #include <QDoubleSpinBox>
 #include <qscispinbox/QScienceSpinBox.h>
 #include <QComboBox>
+#include <QLocale>
 
 #include <limits>
 
@@ -55,10 +56,10 @@ class FieldTreeItem : public TreeItem {
 public:
 
     FieldTreeItem(int index, const QList<QVariant> &data, UAVObjectField *field) :
-        TreeItem(data), m_index(index), m_field(field)
+        TreeItem(data), m_index(index), m_field(field), m_displayValid(false)
     {}
     FieldTreeItem(int index, const QVariant &data, UAVObjectField *field) :
-        TreeItem(data), m_index(index), m_field(field)
+        TreeItem(data), m_index(index), m_field(field), m_displayValid(false)
     {}
 
     bool isEditable() const
@@ -70,26 +71,42 @@ public:
     virtual QVariant getEditorValue(QWidget *editor) const = 0;
     virtual void setEditorValue(QWidget *editor, QVariant value) const = 0;
 
+    QVariant displayData(int column) const
+    {
+        if (column != DATA_COLUMN) {
+            return data(column);
+        }
+        // formatted once per value change rather than on every repaint
+        if (!m_displayValid) {
+            m_displayData  = toDisplayData(data());
+            m_displayValid = true;
+        }
+        return m_displayData;
+    }
+
     void setData(QVariant value, int column)
     {
         QVariant currentValue = fieldToData();
 
         setChanged(currentValue != value);
         TreeItem::setData(value, column);
+        m_displayValid = false;
     }
 
-    void update(const QTime &ts)
+    void update(const QTime &ts, QList<TreeItem *> &updated)
     {
-        bool updated = false;
+        bool valueUpdated = false;
 
         if (!changed()) {
             QVariant currentValue = fieldToData();
             if (data() != currentValue) {
-                updated = true;
+                valueUpdated = true;
                 TreeItem::setData(currentValue);
+                m_displayValid = false;
+                updated.append(this);
             }
         }
-        if (changed() || updated) {
+        if (changed() || valueUpdated) {
             setHighlighted(true, ts);
         }
     }
@@ -104,8 +121,17 @@ protected:
     virtual QVariant fieldToData() const = 0;
     virtual QVariant dataToField() const = 0;
 
+    virtual QVariant toDisplayData(const QVariant &value) const
+    {
+        return value;
+    }
+
     int m_index;
     UAVObjectField *m_field;
+
+private:
+    mutable QVariant m_displayData;
+    mutable bool m_displayValid;
 };
 
 class EnumFieldTreeItem : public FieldTreeItem {
@@ -118,7 +144,7 @@ public:
         FieldTreeItem(index, data, field), m_enumOptions(field->getOptions())
     {}
 
-    QString enumOptions(int index)
+    QString enumOptions(int index) const
     {
         if ((index < 0) || (index >= m_enumOptions.length())) {
             return QString("Invalid Value (") + QString().setNum(index) + QString(")");
@@ -143,6 +169,11 @@ public:
         return options[value];
     }
 
+    QVariant toDisplayData(const QVariant &value) const
+    {
+        return enumOptions(value.toInt());
+    }
+
     QWidget *createEditor(QWidget *parent) const
     {
         QComboBox *editor = new QComboBox(parent);
@@ -229,6 +260,11 @@ public:
         return data().toInt();
     }
 
+    QVariant toDisplayData(const QVariant &value) const
+    {
+        return QLocale().toString(value.toInt());
+    }
+
     QWidget *createEditor(QWidget *parent) const
     {
         QSpinBox *editor = new QSpinBox(parent);
@@ -271,6 +307,12 @@ public:
         return m_field->getValue(m_index).toDouble();
     }
 
+    QVariant toDisplayData(const QVariant &value) const
+    {
+        // same text as the item delegate would produce for a double
+        return QLocale().toString(value.toDouble());
+    }
+
     QVariant dataToField() const
     {
         return data().toDouble();
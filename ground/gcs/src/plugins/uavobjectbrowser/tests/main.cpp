@@ -0,0 +1,253 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Replays a telemetry log into the browser model and reports what the updates cost
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: treemodelbenchmark <log.opl> [--expand none|objects|all] [--speed <factor>]
+ *
+ * The object updates of an OPL log file are fed into a UAVObjectTreeModel shown
+ * in a tree view, at the pace they were recorded divided by the speed factor
+ * (0 replays as fast as possible). The CPU time used and the number of
+ * dataChanged signals seen by the view are printed at the end.
+ * Run with QT_QPA_PLATFORM=offscreen when no display is available.
+ */
+
+#include "uavobjecttreemodel.h"
+#include "uavobjectmanager.h"
+#include "uavdataobject.h"
+#include "uavobjectsinit.h"
+#include <utils/crc.h>
+#include <extensionsystem/pluginmanager.h>
+
+#include <QApplication>
+#include <QSortFilterProxyModel>
+#include <QTreeView>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QFile>
+#include <QVector>
+#include <QtEndian>
+#include <QTextStream>
+
+#include <ctime>
+
+struct Record {
+    quint32    timeStamp;
+    UAVObject  *obj;
+    QByteArray data;
+};
+
+// UAVTalk packet layout: sync(1), type(1), size(2), object ID(4), instance ID(2), data, checksum(1)
+static const quint8 SYNC_VAL     = 0x3C;
+static const quint8 TYPE_OBJ     = 0x20;
+static const quint8 TYPE_OBJ_ACK = 0x22;
+static const int HEADER_LENGTH   = 10;
+static const qint64 MAX_PACKET_LENGTH = 1024 * 1024;
+
+static UAVObject *getObject(UAVObjectManager *objManager, quint32 objId, quint16 instId)
+{
+    UAVObject *obj = objManager->getObject(objId, instId);
+
+    if (!obj) {
+        // register missing instances up front, like the telemetry does when they first show up
+        UAVDataObject *typeObj = qobject_cast<UAVDataObject *>(objManager->getObject(objId));
+        if (typeObj) {
+            UAVDataObject *instObj = typeObj->clone(instId);
+            if (objManager->registerObject(instObj)) {
+                obj = instObj;
+            }
+        }
+    }
+    return obj;
+}
+
+static bool readLog(const QString &fileName, UAVObjectManager *objManager, QVector<Record> &records)
+{
+    QFile logFile(fileName);
+
+    if (!logFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    quint32 timeStamp;
+    qint64 dataSize;
+
+    while (logFile.read((char *)&timeStamp, sizeof(timeStamp)) == sizeof(timeStamp)
+           && logFile.read((char *)&dataSize, sizeof(dataSize)) == sizeof(dataSize)) {
+        if (dataSize < 1 || dataSize > MAX_PACKET_LENGTH) {
+            break;
+        }
+        QByteArray packet = logFile.read(dataSize);
+        if (packet.size() != dataSize) {
+            break;
+        }
+
+        const quint8 *data = (const quint8 *)packet.constData();
+        if (dataSize < HEADER_LENGTH + 1 || data[0] != SYNC_VAL) {
+            continue;
+        }
+        quint8 type    = data[1];
+        quint16 length = qFromLittleEndian<quint16>(&data[2]);
+        if (length < HEADER_LENGTH || length + 1 > dataSize
+            || Utils::Crc::updateCRC(0, data, length) != data[length]
+            || (type != TYPE_OBJ && type != TYPE_OBJ_ACK)) {
+            continue;
+        }
+
+        quint32 objId  = qFromLittleEndian<quint32>(&data[4]);
+        quint16 instId = qFromLittleEndian<quint16>(&data[8]);
+        UAVObject *obj = getObject(objManager, objId, instId);
+        if (!obj || obj->getNumBytes() != (quint32)(length - HEADER_LENGTH)) {
+            continue;
+        }
+
+        Record record;
+        record.timeStamp = timeStamp;
+        record.obj  = obj;
+        record.data = packet.mid(HEADER_LENGTH, length - HEADER_LENGTH);
+        records.append(record);
+    }
+    return true;
+}
+
+// tells the model what the view shows, as UAVObjectBrowserWidget does
+static void updateExpandedState(QTreeView *view, QSortFilterProxyModel *proxy, UAVObjectTreeModel *model, const QModelIndex &parent)
+{
+    for (int row = 0; row < proxy->rowCount(parent); ++row) {
+        QModelIndex index = proxy->index(row, 0, parent);
+        if (proxy->hasChildren(index)) {
+            model->setExpanded(proxy->mapToSource(index), view->isExpanded(index));
+            updateExpandedState(view, proxy, model, index);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QStringList args = app.arguments();
+    QString expand   = "objects";
+    double speed     = 10.0;
+
+    args.removeFirst();
+    if (args.indexOf("--expand") >= 0 && args.indexOf("--expand") + 1 < args.count()) {
+        int i = args.indexOf("--expand");
+        expand = args.at(i + 1);
+        args.removeAt(i + 1);
+        args.removeAt(i);
+    }
+    if (args.indexOf("--speed") >= 0 && args.indexOf("--speed") + 1 < args.count()) {
+        int i = args.indexOf("--speed");
+        speed = args.at(i + 1).toDouble();
+        args.removeAt(i + 1);
+        args.removeAt(i);
+    }
+    if (args.count() != 1) {
+        out << "usage: treemodelbenchmark <log.opl> [--expand none|objects|all] [--speed <factor>]" << endl;
+        return 1;
+    }
+
+    ExtensionSystem::PluginManager pluginManager;
+    UAVObjectManager *objManager = new UAVObjectManager();
+    UAVObjectsInitialize(objManager);
+    pluginManager.addObject(objManager);
+
+    QVector<Record> records;
+    if (!readLog(args.first(), objManager, records) || records.isEmpty()) {
+        out << "no object updates in " << args.first() << endl;
+        return 1;
+    }
+
+    // the model looks the object manager up when it is created
+    UAVObjectTreeModel model(0);
+    QSortFilterProxyModel proxy;
+    proxy.setSourceModel(&model);
+    proxy.setDynamicSortFilter(true);
+
+    QTreeView view;
+    view.setModel(&proxy);
+    view.resize(800, 1200);
+    view.show();
+
+    if (expand == "all") {
+        view.expandAll();
+    } else if (expand == "objects") {
+        view.expandToDepth(0);
+    }
+    updateExpandedState(&view, &proxy, &model, QModelIndex());
+
+    int dataChangedCount = 0;
+    QObject::connect(&proxy, &QAbstractItemModel::dataChanged, [&dataChangedCount]() {
+        dataChangedCount++;
+    });
+
+    app.processEvents();
+
+    QElapsedTimer wallTime;
+    wallTime.start();
+    std::clock_t cpuStart = std::clock();
+
+    quint32 firstTimeStamp = records.first().timeStamp;
+    foreach(const Record &record, records) {
+        if (speed > 0) {
+            qint64 due = (qint64)((record.timeStamp - firstTimeStamp) / speed);
+            while (wallTime.elapsed() < due) {
+                app.processEvents();
+                QThread::msleep(1);
+            }
+        } else {
+            app.processEvents();
+        }
+        record.obj->unpack((const quint8 *)record.data.constData());
+    }
+
+    // let the last updates and highlights settle
+    QElapsedTimer settle;
+    settle.start();
+    while (settle.elapsed() < 1000) {
+        app.processEvents();
+        QThread::msleep(1);
+    }
+
+    double cpuMs  = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    qint64 wallMs = wallTime.elapsed();
+
+    out << "updates replayed:  " << records.count() << " (" << (records.last().timeStamp - firstTimeStamp) << " ms of telemetry)" << endl;
+    out << "expanded:          " << expand << endl;
+    out << "wall time:         " << wallMs << " ms" << endl;
+    out << "cpu time:          " << cpuMs << " ms (" << 100.0 * cpuMs / wallMs << " %)" << endl;
+    out << "cpu per update:    " << 1000.0 * cpuMs / records.count() << " us" << endl;
+    out << "dataChanged seen:  " << dataChangedCount << endl;
+
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
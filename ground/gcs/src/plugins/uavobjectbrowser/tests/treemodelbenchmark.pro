@@ -0,0 +1,23 @@
+# Replays a telemetry log into the UAVObject browser model, see main.cpp
+TEMPLATE = app
+TARGET = treemodelbenchmark
+QT += widgets
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../gcs.pri)
+include(../uavobjectbrowser_dependencies.pri)
+
+isEmpty(PROVIDER):PROVIDER = "$$ORG_BIG_NAME"
+LIBS += -L$$GCS_PLUGIN_PATH/$$PROVIDER
+INCLUDEPATH += $$GCS_SOURCE_TREE/src/plugins ..
+
+HEADERS += \
+    ../treeitem.h \
+    ../fieldtreeitem.h \
+    ../uavobjecttreemodel.h
+
+SOURCES += \
+    main.cpp \
+    ../treeitem.cpp \
+    ../uavobjecttreemodel.cpp
@@ -162,6 +162,7 @@ TreeItem::TreeItem(const QList<QVariant> &data) :
     m_itemData(data),
     m_parentItem(0),
     m_changed(false),
+    m_expanded(false),
     m_highlighted(false),
     m_highlightManager(0)
 {}
@@ -169,6 +170,7 @@ TreeItem::TreeItem(const QList<QVariant> &data) :
 TreeItem::TreeItem(const QVariant &data) :
     m_parentItem(0),
     m_changed(false),
+    m_expanded(false),
     m_highlighted(false),
     m_highlightManager(0)
 {
@@ -255,10 +257,10 @@ void TreeItem::setData(QVariant value, int column)
     m_itemData.replace(column, value);
 }
 
-void TreeItem::update(const QTime &ts)
+void TreeItem::update(const QTime &ts, QList<TreeItem *> &updated)
 {
     foreach(TreeItem * child, children()) {
-        child->update(ts);
+        child->update(ts, updated);
     }
 }
 
@@ -132,6 +132,12 @@ public:
 
     virtual QVariant data(int column = 1) const;
 
+    // what the view shows, derived from data()
+    virtual QVariant displayData(int column) const
+    {
+        return data(column);
+    }
+
     virtual void setData(QVariant value, int column = 1);
 
     int row() const;
@@ -141,7 +147,8 @@ public:
         return false;
     }
 
-    virtual void update(const QTime &ts);
+    // brings the item up to date with its object, items whose value changed are appended to updated
+    virtual void update(const QTime &ts, QList<TreeItem *> &updated);
     virtual void apply();
 
     bool changed() const
@@ -172,6 +179,16 @@ public:
 
     void setHighlightManager(HighlightManager *mgr);
 
+    bool isExpanded() const
+    {
+        return m_expanded;
+    }
+
+    void setExpanded(bool expanded)
+    {
+        m_expanded = expanded;
+    }
+
     virtual bool isKnown() const
     {
         if (m_parentItem) {
@@ -200,6 +217,8 @@ private:
 
     bool m_changed;
 
+    bool m_expanded;
+
     bool m_highlighted;
     QTime m_highlightExpires;
     HighlightManager *m_highlightManager;
@@ -277,13 +296,13 @@ public:
         }
     }
 
-    virtual void update(const QTime &ts)
+    virtual void update(const QTime &ts, QList<TreeItem *> &updated)
     {
         foreach(TreeItem * child, children()) {
             MetaObjectTreeItem *metaChild = dynamic_cast<MetaObjectTreeItem *>(child);
 
             if (!metaChild) {
-                child->update(ts);
+                child->update(ts, updated);
             }
         }
     }
@@ -303,9 +322,9 @@ public:
         DataObjectTreeItem(object, data)
     {}
 
-    virtual void update(const QTime &ts)
+    virtual void update(const QTime &ts, QList<TreeItem *> &updated)
     {
-        TreeItem::update(ts);
+        TreeItem::update(ts, updated);
     }
 
     virtual void apply()
@@ -325,6 +344,17 @@ public:
 
     QVariant data(int column) const;
 
+    void update(const QTime &ts, QList<TreeItem *> &updated)
+    {
+        int count = updated.count();
+
+        TreeItem::update(ts, updated);
+        // the value column of char and hex arrays shows all elements
+        if (updated.count() > count) {
+            updated.append(this);
+        }
+    }
+
 private:
     UAVObjectField *m_field;
 };
@@ -69,6 +69,8 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent) : QWidget(parent
 
     connect(m_browser->treeView->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)),
             this, SLOT(currentChanged(QModelIndex, QModelIndex)), Qt::UniqueConnection);
+    connect(m_browser->treeView, SIGNAL(expanded(QModelIndex)), this, SLOT(itemExpanded(QModelIndex)));
+    connect(m_browser->treeView, SIGNAL(collapsed(QModelIndex)), this, SLOT(itemCollapsed(QModelIndex)));
     connect(m_browser->saveSDButton, SIGNAL(clicked()), this, SLOT(saveObject()));
     connect(m_browser->readSDButton, SIGNAL(clicked()), this, SLOT(loadObject()));
     connect(m_browser->sendButton, SIGNAL(clicked()), this, SLOT(sendUpdate()));
@@ -420,6 +422,32 @@ void UAVObjectBrowserWidget::searchLineChanged(QString searchText)
     } else {
         m_browser->treeView->collapseAll();
     }
+    // expandToDepth() and collapseAll() don't emit expanded() or collapsed()
+    updateExpandedState(QModelIndex());
+}
+
+void UAVObjectBrowserWidget::itemExpanded(const QModelIndex &index)
+{
+    m_model->setExpanded(m_modelProxy->mapToSource(index), true);
+}
+
+void UAVObjectBrowserWidget::itemCollapsed(const QModelIndex &index)
+{
+    m_model->setExpanded(m_modelProxy->mapToSource(index), false);
+}
+
+/**
+ * @brief UAVObjectBrowserWidget::updateExpandedState Tells the model which of the children of parent are expanded
+ */
+void UAVObjectBrowserWidget::updateExpandedState(const QModelIndex &parent)
+{
+    for (int row = 0; row < m_modelProxy->rowCount(parent); ++row) {
+        QModelIndex index = m_modelProxy->index(row, 0, parent);
+        if (m_modelProxy->hasChildren(index)) {
+            m_model->setExpanded(m_modelProxy->mapToSource(index), m_browser->treeView->isExpanded(index));
+            updateExpandedState(index);
+        }
+    }
 }
 
 QString UAVObjectBrowserWidget::indexToPath(const QModelIndex &index) const
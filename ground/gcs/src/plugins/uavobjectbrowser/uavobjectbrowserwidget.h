@@ -114,6 +114,8 @@ private slots:
     void searchLineChanged(QString searchText);
     void searchTextCleared();
     void splitterMoved();
+    void itemExpanded(const QModelIndex &index);
+    void itemCollapsed(const QModelIndex &index);
     QString createObjectDescription(UAVObject *object);
 
 signals:
@@ -139,6 +141,7 @@ private:
     void updateObjectPersistence(ObjectPersistence::OperationOptions op, UAVObject *obj);
     void enableSendRequest(bool enable);
     void updateDescription();
+    void updateExpandedState(const QModelIndex &parent);
     ObjectTreeItem *findCurrentObjectTreeItem();
     QString loadFileIntoString(QString fileName);
 };
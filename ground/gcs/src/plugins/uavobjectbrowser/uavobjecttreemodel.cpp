@@ -35,9 +35,24 @@
 #include "extensionsystem/pluginmanager.h"
 
 #include <QColor>
+#include <QTimer>
 
-UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent) : QAbstractItemModel(parent)
+#include <algorithm>
+
+UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent) : QAbstractItemModel(parent),
+    m_checkStaleObjects(false)
 {
+    m_onlyHighlightChangedValues = m_settings.value("onlyHighlightChangedValues", false).toBool();
+    m_highlightTopTreeItems = m_settings.value("highlightTopTreeItems", false).toBool();
+    m_unknownObjectColor    = m_settings.value("unknownObjectColor", QColor(Qt::gray)).value<QColor>();
+    m_recentlyUpdatedColor  = m_settings.value("recentlyUpdatedColor", QColor(255, 230, 230)).value<QColor>();
+    m_manuallyChangedColor  = m_settings.value("manuallyChangedColor", QColor(230, 230, 255)).value<QColor>();
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &UAVObjectTreeModel::flushUpdates);
+
     m_highlightManager = new HighlightManager();
     connect(m_highlightManager, &HighlightManager::updateHighlight, this, &UAVObjectTreeModel::refreshHighlight);
 
@@ -92,31 +107,34 @@ void UAVObjectTreeModel::setUseScientificNotation(bool useScientificNotation)
 
 QColor UAVObjectTreeModel::unknownObjectColor() const
 {
-    return m_settings.value("unknownObjectColor", QColor(Qt::gray)).value<QColor>();
+    return m_unknownObjectColor;
 }
 
 void UAVObjectTreeModel::setUnknownObjectColor(QColor color)
 {
+    m_unknownObjectColor = color;
     m_settings.setValue("unknownObjectColor", color);
 }
 
 QColor UAVObjectTreeModel::recentlyUpdatedColor() const
 {
-    return m_settings.value("recentlyUpdatedColor", QColor(255, 230, 230)).value<QColor>();
+    return m_recentlyUpdatedColor;
 }
 
 void UAVObjectTreeModel::setRecentlyUpdatedColor(QColor color)
 {
+    m_recentlyUpdatedColor = color;
     m_settings.setValue("recentlyUpdatedColor", color);
 }
 
 QColor UAVObjectTreeModel::manuallyChangedColor() const
 {
-    return m_settings.value("manuallyChangedColor", QColor(230, 230, 255)).value<QColor>();
+    return m_manuallyChangedColor;
 }
 
 void UAVObjectTreeModel::setManuallyChangedColor(QColor color)
 {
+    m_manuallyChangedColor = color;
     m_settings.setValue("manuallyChangedColor", color);
 }
 
@@ -133,30 +151,48 @@ void UAVObjectTreeModel::setRecentlyUpdatedTimeout(int timeout)
 
 bool UAVObjectTreeModel::onlyHighlightChangedValues() const
 {
-    return m_settings.value("onlyHighlightChangedValues", false).toBool();
+    return m_onlyHighlightChangedValues;
 }
 
 void UAVObjectTreeModel::setOnlyHighlightChangedValues(bool highlight)
 {
+    m_onlyHighlightChangedValues = highlight;
     m_settings.setValue("onlyHighlightChangedValues", highlight);
 }
 
 bool UAVObjectTreeModel::highlightTopTreeItems() const
 {
-    return m_settings.value("highlightTopTreeItems", false).toBool();
+    return m_highlightTopTreeItems;
 }
 
 void UAVObjectTreeModel::setHighlightTopTreeItems(bool highlight)
 {
+    m_highlightTopTreeItems = highlight;
     m_settings.setValue("highlightTopTreeItems", highlight);
 }
 
+void UAVObjectTreeModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+    if (!index.isValid()) {
+        return;
+    }
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
+    item->setExpanded(expanded);
+    if (expanded && !m_staleObjects.isEmpty()) {
+        // bring the fields that just became visible up to date
+        m_checkStaleObjects = true;
+        scheduleFlush();
+    }
+}
+
 void UAVObjectTreeModel::setupModelData()
 {
     QList<QVariant> rootData;
     rootData << tr("Property") << tr("Value") << tr("Unit");
     m_rootItem        = new TreeItem(rootData);
     m_rootItem->setHighlightManager(m_highlightManager);
+    // the top level items are always shown
+    m_rootItem->setExpanded(true);
 
     m_settingsTree    = new TopTreeItem(tr("Settings"));
     m_settingsTree->setHighlightManager(m_highlightManager);
@@ -187,6 +223,11 @@ void UAVObjectTreeModel::resetModelData()
 {
     m_highlightManager->reset();
 
+    m_flushTimer->stop();
+    m_dirtyObjects.clear();
+    m_staleObjects.clear();
+    m_dirtyItems.clear();
+
     emit beginResetModel();
 
     delete m_rootItem;
@@ -447,6 +488,7 @@ void UAVObjectTreeModel::toggleCategoryItems()
                     TreeItem *tmp = item;
                     item = item->parentItem();
                     removeItem(tmp->parentItem(), tmp);
+                    m_dirtyItems.remove(tmp);
                     delete tmp;
                 }
             }
@@ -559,14 +601,7 @@ QVariant UAVObjectTreeModel::data(const QModelIndex &index, int role) const
 
     switch (role) {
     case Qt::DisplayRole:
-        if (index.column() == TreeItem::DATA_COLUMN) {
-            EnumFieldTreeItem *fieldItem = dynamic_cast<EnumFieldTreeItem *>(item);
-            if (fieldItem) {
-                int enumIndex = fieldItem->data(index.column()).toInt();
-                return fieldItem->enumOptions(enumIndex);
-            }
-        }
-        return item->data(index.column());
+        return item->displayData(index.column());
 
     case Qt::EditRole:
         if (index.column() == TreeItem::DATA_COLUMN) {
@@ -579,7 +614,7 @@ QVariant UAVObjectTreeModel::data(const QModelIndex &index, int role) const
 
     case Qt::ForegroundRole:
         if (!dynamic_cast<TopTreeItem *>(item) && !item->isKnown()) {
-            return unknownObjectColor();
+            return m_unknownObjectColor;
         }
         return QVariant();
 
@@ -588,17 +623,19 @@ QVariant UAVObjectTreeModel::data(const QModelIndex &index, int role) const
             // TODO filtering here on highlightTopTreeItems() should not be necessary
             // top tree items should not be highlighted at all in the first place
             // when highlightTopTreeItems() is false
-            bool highlight = (highlightTopTreeItems() || !dynamic_cast<TopTreeItem *>(item));
-            if (highlight && item->isHighlighted()) {
-                return recentlyUpdatedColor();
+            if (item->isHighlighted() && (m_highlightTopTreeItems || !dynamic_cast<TopTreeItem *>(item))) {
+                return m_recentlyUpdatedColor;
             }
         } else if (index.column() == TreeItem::DATA_COLUMN) {
+            if (!item->isHighlighted() && !item->changed()) {
+                return QVariant();
+            }
             FieldTreeItem *fieldItem = dynamic_cast<FieldTreeItem *>(item);
             if (fieldItem && fieldItem->isHighlighted()) {
-                return recentlyUpdatedColor();
+                return m_recentlyUpdatedColor;
             }
             if (fieldItem && fieldItem->changed()) {
-                return manuallyChangedColor();
+                return m_manuallyChangedColor;
             }
         }
         return QVariant();
@@ -651,38 +688,128 @@ void UAVObjectTreeModel::updateObject(UAVObject *obj)
     Q_ASSERT(obj);
     ObjectTreeItem *item = findObjectTreeItem(obj->getObjID());
     Q_ASSERT(item);
-    // TODO don't update meta object if they are not shown
-    QTime ts = QTime::currentTime();
-    item->update(ts);
-    if (!onlyHighlightChangedValues()) {
-        item->setHighlighted(true, ts);
+    // the fields are compared on the next flush, however often the object gets updated until then
+    m_dirtyObjects.insert(item);
+    scheduleFlush();
+}
+
+void UAVObjectTreeModel::scheduleFlush()
+{
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
     }
 }
 
-void UAVObjectTreeModel::updateIsKnown(UAVObject *object)
+/**
+ * Returns true if the children of item are shown, that is if item and all its ancestors are expanded.
+ * Items that are not part of the tree, like hidden meta data, have no visible children.
+ */
+bool UAVObjectTreeModel::childrenVisible(const TreeItem *item) const
 {
-    DataObjectTreeItem *item = findDataObjectTreeItem(object);
+    while (item != m_rootItem) {
+        if (!item || !item->isExpanded()) {
+            return false;
+        }
+        item = item->parentItem();
+    }
+    return true;
+}
 
-    if (item) {
-        refreshIsKnown(item);
+void UAVObjectTreeModel::flushUpdates()
+{
+    // a single time stamp for all highlights of this flush
+    QTime ts = QTime::currentTime();
+    QList<TreeItem *> updated;
+
+    if (m_checkStaleObjects) {
+        m_checkStaleObjects = false;
+        QMutableSetIterator<ObjectTreeItem *> iter(m_staleObjects);
+        while (iter.hasNext()) {
+            ObjectTreeItem *item = iter.next();
+            if (childrenVisible(item)) {
+                iter.remove();
+                item->update(ts, updated);
+            }
+        }
     }
+
+    foreach(ObjectTreeItem * item, m_dirtyObjects) {
+        // with onlyHighlightChangedValues the highlight of the object depends on its fields
+        if (m_onlyHighlightChangedValues || childrenVisible(item)) {
+            m_staleObjects.remove(item);
+            item->update(ts, updated);
+        } else {
+            m_staleObjects.insert(item);
+        }
+        if (!m_onlyHighlightChangedValues) {
+            item->setHighlighted(true, ts);
+        }
+    }
+    m_dirtyObjects.clear();
+
+    foreach(TreeItem * item, updated) {
+        m_dirtyItems.insert(item);
+    }
+    emitDataChanged();
+
+    // highlights set above have been repainted already
+    m_flushTimer->stop();
 }
 
-void UAVObjectTreeModel::refreshHighlight(TreeItem *item)
+void UAVObjectTreeModel::emitDataChanged()
 {
     // performance note: here we emit data changes column by column
     // emitting a dataChanged that spans multiple columns kills performance (CPU shoots up)
     // this is probably caused by the sort/filter proxy...
+    // rows are instead grouped by parent and adjacent rows are signaled together
 
-    QModelIndex itemIndex;
+    QHash<TreeItem *, QList<int> > rowsByParent;
 
-    itemIndex = index(item, TreeItem::TITLE_COLUMN);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex);
+    foreach(TreeItem * item, m_dirtyItems) {
+        TreeItem *parentItem = item->parentItem();
+        if (childrenVisible(parentItem)) {
+            rowsByParent[parentItem].append(item->row());
+        }
+    }
+    m_dirtyItems.clear();
 
-    itemIndex = index(item, TreeItem::DATA_COLUMN);
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex);
+    QHashIterator<TreeItem *, QList<int> > iter(rowsByParent);
+    while (iter.hasNext()) {
+        iter.next();
+        TreeItem *parentItem = iter.key();
+        QList<int> rows = iter.value();
+        std::sort(rows.begin(), rows.end());
+
+        int first = 0;
+        while (first < rows.count()) {
+            int last = first;
+            while (last + 1 < rows.count() && rows[last + 1] == rows[last] + 1) {
+                last++;
+            }
+            for (int column = TreeItem::TITLE_COLUMN; column <= TreeItem::DATA_COLUMN; column++) {
+                QModelIndex topLeft     = createIndex(rows[first], column, parentItem->child(rows[first]));
+                QModelIndex bottomRight = createIndex(rows[last], column, parentItem->child(rows[last]));
+                emit dataChanged(topLeft, bottomRight);
+            }
+            first = last + 1;
+        }
+    }
+}
+
+void UAVObjectTreeModel::updateIsKnown(UAVObject *object)
+{
+    DataObjectTreeItem *item = findDataObjectTreeItem(object);
+
+    if (item) {
+        refreshIsKnown(item);
+    }
+}
+
+void UAVObjectTreeModel::refreshHighlight(TreeItem *item)
+{
+    // repainted on the next flush together with the value changes
+    m_dirtyItems.insert(item);
+    scheduleFlush();
 }
 
 void UAVObjectTreeModel::refreshIsKnown(TreeItem *item)
@@ -33,6 +33,7 @@
 #include <QAbstractItemModel>
 #include <QMap>
 #include <QList>
+#include <QSet>
 #include <QColor>
 #include <QSettings>
 
@@ -91,16 +92,39 @@ public:
     bool highlightTopTreeItems() const;
     void setHighlightTopTreeItems(bool highlight);
 
+    // the view reports which items are expanded, fields that are not shown are not kept up to date
+    void setExpanded(const QModelIndex &index, bool expanded);
+
 private slots:
     void newObject(UAVObject *obj);
     void updateObject(UAVObject *obj);
     void updateIsKnown(UAVObject *obj);
     void refreshHighlight(TreeItem *item);
     void refreshIsKnown(TreeItem *item);
+    void flushUpdates();
 
 private:
+    // object updates are coalesced and applied at most once per frame
+    static const int FLUSH_INTERVAL_MS = 40;
+
     QSettings m_settings;
 
+    // copies of the settings used on every update and repaint
+    bool m_onlyHighlightChangedValues;
+    bool m_highlightTopTreeItems;
+    QColor m_unknownObjectColor;
+    QColor m_recentlyUpdatedColor;
+    QColor m_manuallyChangedColor;
+
+    QTimer *m_flushTimer;
+    // objects updated since the last flush
+    QSet<ObjectTreeItem *> m_dirtyObjects;
+    // objects whose fields were hidden when they got updated
+    QSet<ObjectTreeItem *> m_staleObjects;
+    bool m_checkStaleObjects;
+    // items to repaint on the next flush
+    QSet<TreeItem *> m_dirtyItems;
+
     HighlightManager *m_highlightManager;
 
     TreeItem *m_rootItem;
@@ -111,6 +135,10 @@ private:
 
     QModelIndex index(TreeItem *item, int column = 0) const;
 
+    bool childrenVisible(const TreeItem *item) const;
+    void scheduleFlush();
+    void emitDataChanged();
+
     void setupModelData();
     void resetModelData();
 
@@ -0,0 +1,200 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Benchmark of the generated UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectsinit.h"
+#include "uavobjectmanager.h"
+#include "uavobjectarena.h"
+#include "notificationcounter.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaMethod>
+#include <QVector>
+#include <QtEndian>
+#include <QtMath>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#define BENCHMARK_ITERATIONS 1000
+
+/**
+ * Resident memory of the process in kB, 0 where it is not known
+ */
+static quint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> pages = statm.readAll().split(' ');
+        if (pages.size() > 1) {
+            return pages.at(1).toULongLong() * sysconf(_SC_PAGESIZE) / 1024;
+        }
+    }
+#endif
+    return 0;
+}
+
+/**
+ * Register all objects from the arena as the plugin does, and report
+ * the time and the memory it takes.
+ */
+static void benchmarkRegistration(UAVObjectManager *objMngr)
+{
+    QElapsedTimer timer;
+    quint64 resident = residentMemory();
+
+    timer.start();
+    {
+        UAVObjectArena::Scope arena;
+        UAVObjectsInitialize(objMngr);
+    }
+    qDebug() << "registered" << objMngr->getObjects().size() << "objects in" << timer.elapsed() << "ms,"
+             << UAVObjectArena::bytesUsed() / 1024 << "kB in the arena," << residentMemory() - resident << "kB resident";
+}
+
+/**
+ * Time the packing of all objects with their generated layout
+ * against packing them field by field, and check both agree.
+ */
+static bool benchmarkPacking(UAVObjectManager *objMngr)
+{
+    QList<UAVObject *> objects;
+    quint32 totalBytes = 0;
+
+    foreach(QList<UAVObject *> instances, objMngr->getObjects()) {
+        objects.append(instances.first());
+        totalBytes += instances.first()->getNumBytes();
+    }
+
+    QVector<quint8> generated(totalBytes);
+    QVector<quint8> byField(totalBytes);
+    QElapsedTimer timer;
+    qint64 generatedTime = 0;
+    qint64 byFieldTime   = 0;
+
+    for (int iteration = 0; iteration < BENCHMARK_ITERATIONS; ++iteration) {
+        timer.start();
+        quint32 offset = 0;
+        foreach(UAVObject * obj, objects) {
+            obj->blockSignals(true);
+            obj->pack(&generated[offset]);
+            obj->unpack(&generated[offset]);
+            obj->blockSignals(false);
+            offset += obj->getNumBytes();
+        }
+        generatedTime += timer.nsecsElapsed();
+
+        timer.start();
+        offset = 0;
+        foreach(UAVObject * obj, objects) {
+            quint32 fieldOffset = offset;
+            foreach(UAVObjectField * field, obj->getFields()) {
+                field->pack(&byField[fieldOffset]);
+                field->unpack(&byField[fieldOffset]);
+                fieldOffset += field->getNumBytes();
+            }
+            offset += obj->getNumBytes();
+        }
+        byFieldTime += timer.nsecsElapsed();
+    }
+
+    qDebug() << "pack/unpack of" << objects.size() << "objects (" << totalBytes << "bytes):"
+             << generatedTime / BENCHMARK_ITERATIONS / 1000 << "us generated,"
+             << byFieldTime / BENCHMARK_ITERATIONS / 1000 << "us by field";
+
+    if (generated != byField) {
+        qWarning() << "generated packing does not match the field packing";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Feed a 50Hz AttitudeState stream and count the property notifications,
+ * when flying (all fields change) and at rest (nothing changes).
+ */
+static void benchmarkNotifications(UAVObjectManager *objMngr)
+{
+    UAVObject *obj = objMngr->getObject(QString("AttitudeState"));
+
+    if (!obj) {
+        return;
+    }
+
+    // listen to all property change signals, like QML bindings would
+    NotificationCounter counter;
+    QMetaMethod notified = counter.metaObject()->method(counter.metaObject()->indexOfSlot("notified()"));
+    const QMetaObject *metaObject = obj->metaObject();
+    int signalCount = 0;
+    for (int n = metaObject->methodOffset(); n < metaObject->methodCount(); ++n) {
+        QMetaMethod method = metaObject->method(n);
+        if (method.methodType() == QMetaMethod::Signal && method.name().endsWith("Changed")) {
+            QObject::connect(obj, method, &counter, notified);
+            ++signalCount;
+        }
+    }
+
+    const int updates = 50 * 10;
+    QVector<quint8> packet(obj->getNumBytes());
+    for (int scenario = 0; scenario < 2; ++scenario) {
+        bool flying = (scenario == 0);
+        QElapsedTimer timer;
+        counter.count = 0;
+        timer.start();
+        for (int n = 0; n < updates; ++n) {
+            float t = flying ? n * 0.02f : 0.0f;
+            for (quint32 offset = 0; offset + sizeof(float) <= (quint32)packet.size(); offset += sizeof(float)) {
+                float value = qSin(t + offset);
+                quint32 raw;
+                memcpy(&raw, &value, sizeof(raw));
+                qToLittleEndian<quint32>(raw, &packet[offset]);
+            }
+            obj->unpack(packet.constData());
+        }
+        qDebug() << (flying ? "flying:" : "at rest:") << updates << "AttitudeState updates,"
+                 << counter.count << "notifications (" << updates * signalCount << "without change detection ),"
+                 << timer.nsecsElapsed() / updates / 1000.0 << "us per update";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    UAVObjectManager objMngr;
+
+    benchmarkRegistration(&objMngr);
+
+    bool ok = benchmarkPacking(&objMngr);
+    benchmarkNotifications(&objMngr);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+/**
+ ******************************************************************************
+ *
+ * @file       notificationcounter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Counts the property notifications of an object
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef NOTIFICATIONCOUNTER_H
+#define NOTIFICATIONCOUNTER_H
+
+#include <QObject>
+
+class NotificationCounter : public QObject {
+    Q_OBJECT
+
+public:
+    NotificationCounter() : count(0) {}
+    int count;
+
+public slots:
+    void notified()
+    {
+        ++count;
+    }
+};
+
+#endif // NOTIFICATIONCOUNTER_H
@@ -0,0 +1,23 @@
+# -------------------------------------------------
+# Benchmark of the generated UAVObjects, not part of the GCS build.
+# Build the GCS first, then qmake and make this project in its shadow tree.
+# -------------------------------------------------
+TEMPLATE = app
+TARGET = uavobjectsbenchmark
+QT -= gui
+QT += qml
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../../../../gcs.pri)
+
+LIBS += -L$$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+include(../uavobjects.pri)
+
+linux-* {
+    QMAKE_RPATHDIR += $$GCS_PLUGIN_PATH/$$ORG_BIG_NAME
+    QMAKE_RPATHDIR += $$GCS_LIBRARY_PATH
+}
+
+HEADERS += notificationcounter.h
+SOURCES += main.cpp
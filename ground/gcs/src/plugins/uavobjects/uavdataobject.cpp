@@ -27,6 +27,10 @@
  */
 #include "uavdataobject.h"
 
+#include <QTimer>
+
+int UAVDataObject::s_notificationInterval = 0;
+
 /**
  * Constructor
  */
@@ -35,6 +39,50 @@ UAVDataObject::UAVDataObject(quint32 objID, bool isSingleInst, bool isSettings,
 {
     m_metaObject = NULL;
     this->m_isSettings = isSettings;
+    m_notificationPending = false;
+
+    connect(this, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(scheduleNotifications()));
+}
+
+/**
+ * Set the minimum interval in ms between two property notifications of an object.
+ * Updates received in between are coalesced, for instance to notify at most once
+ * per display frame. Zero notifies on every update.
+ */
+void UAVDataObject::setNotificationInterval(int interval)
+{
+    s_notificationInterval = interval;
+}
+
+int UAVDataObject::notificationInterval()
+{
+    return s_notificationInterval;
+}
+
+void UAVDataObject::scheduleNotifications()
+{
+    if (s_notificationInterval <= 0) {
+        emitNotifications();
+        return;
+    }
+    if (m_notificationPending) {
+        return;
+    }
+
+    qint64 elapsed = m_lastNotification.isValid() ? m_lastNotification.elapsed() : s_notificationInterval;
+    if (elapsed >= s_notificationInterval) {
+        deliverNotifications();
+    } else {
+        m_notificationPending = true;
+        QTimer::singleShot(s_notificationInterval - elapsed, this, SLOT(deliverNotifications()));
+    }
+}
+
+void UAVDataObject::deliverNotifications()
+{
+    m_notificationPending = false;
+    m_lastNotification.start();
+    emitNotifications();
 }
 
 /**
@@ -33,6 +33,7 @@
 #include "uavobjectfield.h"
 #include "uavmetaobject.h"
 #include <QList>
+#include <QElapsedTimer>
 
 class UAVOBJECTS_EXPORT UAVDataObject : public UAVObject {
     Q_OBJECT
@@ -50,9 +51,24 @@ public:
     bool isSettingsObject();
     bool isDataObject();
 
+    static void setNotificationInterval(int interval);
+    static int notificationInterval();
+
+protected:
+    // emits the property change signals, implemented by the generated objects
+    virtual void emitNotifications() {}
+
+private slots:
+    void scheduleNotifications();
+    void deliverNotifications();
+
 private:
     UAVMetaObject *m_metaObject;
     bool m_isSettings;
+    bool m_notificationPending;
+    QElapsedTimer m_lastNotification;
+
+    static int s_notificationInterval;
 };
 
 #endif // UAVDATAOBJECT_H
@@ -65,6 +65,7 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->name         = name;
     this->data         = 0;
     this->numBytes     = 0;
+    this->layout       = NULL;
     this->mutex        = new QMutex(QMutex::Recursive);
     m_isKnown = false;
 }
@@ -84,17 +85,22 @@ void UAVObject::initialize(quint32 instID)
  * @param fields List of fields held by the object
  * @param data Pointer to that actual object data, this is needed by the fields to access the data
  * @param numBytes Number of bytes in the object (total, including all fields)
+ * @param layout Generated data layout, the fields are packed one by one if NULL
  */
-void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes)
+void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes, const DataLayout *layout)
 {
     QMutexLocker locker(mutex);
 
     this->numBytes = numBytes;
     this->data     = data;
     this->fields   = fields;
+    this->layout   = layout;
     // Initialize fields
     quint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n) {
+        if (layout) {
+            offset = layout->fieldOffsets[n];
+        }
         fields[n]->initialize(data, offset, this);
         offset += fields[n]->getNumBytes();
         connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
@@ -303,8 +309,13 @@ UAVObjectField *UAVObject::getField(const QString & name)
 qint32 UAVObject::pack(quint8 *dataOut)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
+    if (layout) {
+        layout->pack(data, dataOut);
+        return numBytes;
+    }
+
+    qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->pack(&dataOut[offset]);
         offset += fields[n]->getNumBytes();
@@ -319,11 +330,15 @@ qint32 UAVObject::pack(quint8 *dataOut)
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
-    for (int n = 0; n < fields.length(); ++n) {
-        fields[n]->unpack(&dataIn[offset]);
-        offset += fields[n]->getNumBytes();
+    if (layout) {
+        layout->unpack(dataIn, data);
+    } else {
+        qint32 offset = 0;
+        for (int n = 0; n < fields.length(); ++n) {
+            fields[n]->unpack(&dataIn[offset]);
+            offset += fields[n]->getNumBytes();
+        }
     }
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
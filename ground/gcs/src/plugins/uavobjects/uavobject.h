@@ -36,8 +36,11 @@
 #include <QString>
 #include <QList>
 #include <QFile>
+#include <QtEndian>
 #include <stdint.h>
+#include <string.h>
 
+#include "uavobjectarena.h"
 #include "uavobjectfield.h"
 
 #define UAVOBJ_ACCESS_SHIFT                    0
@@ -103,6 +106,54 @@ public:
     } __attribute__((packed)) Metadata;
 
 
+    /**
+     * Data layout generated along with the object, replaces the field
+     * offsets computed at runtime and the per field packing
+     */
+    typedef struct {
+        const quint32 *fieldOffsets; /** Offset of each field in the packed data */
+        void (*pack)(const quint8 *data, quint8 *dataOut);
+        void (*unpack)(const quint8 *dataIn, quint8 *data);
+    } DataLayout;
+
+    /**
+     * Little endian packing of field elements, used by the generated code
+     */
+    template<typename T>
+    static inline void packElements(const quint8 *data, quint8 *dataOut, quint32 numElements)
+    {
+        for (quint32 index = 0; index < numElements; ++index) {
+            T value;
+            memcpy(&value, &data[sizeof(T) * index], sizeof(T));
+            qToLittleEndian<T>(value, &dataOut[sizeof(T) * index]);
+        }
+    }
+
+    template<typename T>
+    static inline void unpackElements(const quint8 *dataIn, quint8 *data, quint32 numElements)
+    {
+        for (quint32 index = 0; index < numElements; ++index) {
+            T value = qFromLittleEndian<T>(&dataIn[sizeof(T) * index]);
+            memcpy(&data[sizeof(T) * index], &value, sizeof(T));
+        }
+    }
+
+    static void *operator new(size_t size)
+    {
+        return UAVObjectArena::allocate(size);
+    }
+    static void operator delete(void *ptr)
+    {
+        UAVObjectArena::release(ptr);
+    }
+    // placement new, used by QML to construct the registered types
+    static void *operator new(size_t, void *ptr)
+    {
+        return ptr;
+    }
+    static void operator delete(void *, void *)
+    {}
+
     UAVObject(quint32 objID, bool isSingleInst, const QString & name);
     void initialize(quint32 instID);
     quint32 getObjID();
@@ -194,8 +245,9 @@ protected:
     QMutex *mutex;
     quint8 *data;
     QList<UAVObjectField *> fields;
+    const DataLayout *layout;
 
-    void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes);
+    void initializeFields(QList<UAVObjectField *> & fields, quint8 *data, quint32 numBytes, const DataLayout *layout = NULL);
     void setDescription(const QString & description);
     void setCategory(const QString & category);
 
@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectarena.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Allocation arena for the UAVObjects registered at startup
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectarena.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#define ARENA_BLOCK_SIZE  (256 * 1024)
+#define ARENA_ALIGNMENT   16
+// larger allocations are left to the heap
+#define ARENA_MAX_ALLOC   (ARENA_BLOCK_SIZE / 16)
+
+namespace {
+struct Arena {
+    Arena() : owner(NULL), next(NULL), end(NULL), used(0) {}
+    QMutex  mutex;
+    QThread *owner; // thread of the open scope
+    QList<char *> blocks;
+    char    *next;
+    char    *end;
+    quint64 used;
+};
+}
+
+static Arena &arena()
+{
+    static Arena instance;
+
+    return instance;
+}
+
+UAVObjectArena::Scope::Scope()
+{
+    QMutexLocker locker(&arena().mutex);
+
+    Q_ASSERT(arena().owner == NULL);
+    arena().owner = QThread::currentThread();
+}
+
+UAVObjectArena::Scope::~Scope()
+{
+    QMutexLocker locker(&arena().mutex);
+
+    arena().owner = NULL;
+}
+
+void *UAVObjectArena::allocate(size_t size)
+{
+    Arena &a = arena();
+    QMutexLocker locker(&a.mutex);
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (a.owner != QThread::currentThread() || size > ARENA_MAX_ALLOC) {
+        return ::operator new(size);
+    }
+    if (size > (size_t)(a.end - a.next)) {
+        // the rest of the current block is given up
+        a.next = static_cast<char *>(::operator new(ARENA_BLOCK_SIZE));
+        a.end  = a.next + ARENA_BLOCK_SIZE;
+        a.blocks.append(a.next);
+    }
+    void *ptr = a.next;
+    a.next += size;
+    a.used += size;
+    return ptr;
+}
+
+void UAVObjectArena::release(void *ptr)
+{
+    Arena &a = arena();
+    QMutexLocker locker(&a.mutex);
+
+    foreach(char *block, a.blocks) {
+        if (static_cast<char *>(ptr) >= block && static_cast<char *>(ptr) < block + ARENA_BLOCK_SIZE) {
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+quint64 UAVObjectArena::bytesUsed()
+{
+    QMutexLocker locker(&arena().mutex);
+
+    return arena().used;
+}
+
+quint64 UAVObjectArena::bytesReserved()
+{
+    QMutexLocker locker(&arena().mutex);
+
+    return (quint64)arena().blocks.size() * ARENA_BLOCK_SIZE;
+}
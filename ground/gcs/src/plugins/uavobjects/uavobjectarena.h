@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectarena.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Allocation arena for the UAVObjects registered at startup
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTARENA_H
+#define UAVOBJECTARENA_H
+
+#include "uavobjects_global.h"
+#include <QtGlobal>
+#include <stddef.h>
+
+/**
+ * Bump allocator for the objects and fields created while a Scope is open,
+ * so that registering all UAVObjects at startup does a few large allocations
+ * instead of thousands of small ones and keeps each object next to its fields.
+ *
+ * The registered objects live as long as the GCS, so arena memory is never
+ * reused. Allocations from other threads, or once the scope is closed, go to
+ * the heap as usual.
+ */
+class UAVOBJECTS_EXPORT UAVObjectArena {
+public:
+    class UAVOBJECTS_EXPORT Scope {
+public:
+        Scope();
+        ~Scope();
+    };
+
+    static void *allocate(size_t size);
+    static void release(void *ptr);
+    static quint64 bytesUsed();
+    static quint64 bytesReserved();
+};
+
+#endif // UAVOBJECTARENA_H
@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectcolumnarwriter.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streams UAVObject updates into a columnar log file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavobjectcolumnarwriter.h"
+
+#include <QtEndian>
+#include <QDebug>
+
+#define ROW_HEADER_SIZE (sizeof(quint32) + sizeof(quint16))
+
+static ColumnarLog::ColumnType columnType(UAVObjectField::FieldType type)
+{
+    switch (type) {
+    case UAVObjectField::INT8:
+        return ColumnarLog::INT8;
+
+    case UAVObjectField::INT16:
+        return ColumnarLog::INT16;
+
+    case UAVObjectField::INT32:
+        return ColumnarLog::INT32;
+
+    case UAVObjectField::UINT16:
+        return ColumnarLog::UINT16;
+
+    case UAVObjectField::UINT32:
+        return ColumnarLog::UINT32;
+
+    case UAVObjectField::FLOAT32:
+        return ColumnarLog::FLOAT32;
+
+    default:
+        // UINT8, ENUM, BITFIELD and STRING are byte sized
+        return ColumnarLog::UINT8;
+    }
+}
+
+UAVObjectColumnarWriter::UAVObjectColumnarWriter(UAVObjectManager *objMngr) :
+    m_objMngr(objMngr)
+{}
+
+UAVObjectColumnarWriter::~UAVObjectColumnarWriter()
+{
+    close();
+}
+
+bool UAVObjectColumnarWriter::open(const QString &fileName, bool compress)
+{
+    m_tables.clear();
+    m_writer.setCompression(compress);
+    return m_writer.open(fileName);
+}
+
+bool UAVObjectColumnarWriter::close()
+{
+    return m_writer.close();
+}
+
+int UAVObjectColumnarWriter::tableFor(UAVObject *obj)
+{
+    QHash<quint32, int>::const_iterator it = m_tables.constFind(obj->getObjID());
+
+    if (it != m_tables.constEnd()) {
+        return it.value();
+    }
+
+    int table = m_writer.addTable(obj->getName(), obj->getObjID());
+    m_writer.addColumn(table, "Timestamp", ColumnarLog::UINT32, "ms");
+    m_writer.addColumn(table, "Instance", ColumnarLog::UINT16);
+
+    foreach(UAVObjectField * field, obj->getFields()) {
+        ColumnarLog::ColumnType type = columnType(field->getType());
+
+        if (field->getType() == UAVObjectField::BITFIELD) {
+            quint32 bytes = field->getNumBytes();
+            for (quint32 n = 0; n < bytes; n++) {
+                m_writer.addColumn(table, QString("%1.%2").arg(field->getName()).arg(n), type, field->getUnits());
+            }
+        } else if (field->getNumElements() == 1) {
+            m_writer.addColumn(table, field->getName(), type, field->getUnits());
+        } else {
+            foreach(const QString &element, field->getElementNames()) {
+                m_writer.addColumn(table, QString("%1.%2").arg(field->getName(), element), type, field->getUnits());
+            }
+        }
+    }
+
+    Q_ASSERT(m_writer.rowSize(table) == (int)(ROW_HEADER_SIZE + obj->getNumBytes()));
+    m_tables.insert(obj->getObjID(), table);
+    return table;
+}
+
+bool UAVObjectColumnarWriter::writePacked(quint32 objId, quint16 instId, const quint8 *data, quint32 length, quint32 timeStamp)
+{
+    if (!m_writer.isOpen()) {
+        return false;
+    }
+
+    UAVObject *obj = m_objMngr->getObject(objId);
+    if (!obj || obj->getNumBytes() != length) {
+        // Unknown object or mismatched definition, we can't map it to columns
+        return false;
+    }
+
+    int table = tableFor(obj);
+
+    m_row.resize(ROW_HEADER_SIZE + length);
+    qToLittleEndian<quint32>(timeStamp, &m_row[0]);
+    qToLittleEndian<quint16>(instId, &m_row[sizeof(quint32)]);
+    memcpy(&m_row[ROW_HEADER_SIZE], data, length);
+
+    return m_writer.appendRow(table, m_row.constData());
+}
+
+bool UAVObjectColumnarWriter::writeObject(UAVObject *obj, quint32 timeStamp)
+{
+    QVector<quint8> data(obj->getNumBytes());
+
+    obj->pack(data.data());
+    return writePacked(obj->getObjID(), obj->getInstID(), data.constData(), data.size(), timeStamp);
+}
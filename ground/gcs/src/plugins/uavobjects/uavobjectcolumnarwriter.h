@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectcolumnarwriter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      Streams UAVObject updates into a columnar log file
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVOBJECTCOLUMNARWRITER_H
+#define UAVOBJECTCOLUMNARWRITER_H
+
+#include "uavobjects_global.h"
+#include "uavobjectmanager.h"
+
+#include <utils/columnarlog.h>
+
+#include <QHash>
+#include <QVector>
+
+/**
+ * Writes UAVObject updates to a ColumnarLog file.
+ * Each object type becomes a table whose first two columns are the time stamp (ms)
+ * and the instance id, followed by one column per field element (bitfields get one
+ * column per packed byte). The column layout matches the packed object layout, so
+ * a UAVTalk payload is stored without being unpacked.
+ */
+class UAVOBJECTS_EXPORT UAVObjectColumnarWriter {
+public:
+    UAVObjectColumnarWriter(UAVObjectManager *objMngr);
+    ~UAVObjectColumnarWriter();
+
+    bool open(const QString &fileName, bool compress = true);
+    bool close();
+    bool isOpen() const
+    {
+        return m_writer.isOpen();
+    }
+
+    bool writeObject(UAVObject *obj, quint32 timeStamp);
+    bool writePacked(quint32 objId, quint16 instId, const quint8 *data, quint32 length, quint32 timeStamp);
+
+private:
+    ColumnarLogWriter m_writer;
+    UAVObjectManager *m_objMngr;
+    QHash<quint32, int> m_tables;
+    QVector<quint8> m_row;
+
+    int tableFor(UAVObject *obj);
+};
+
+#endif // UAVOBJECTCOLUMNARWRITER_H
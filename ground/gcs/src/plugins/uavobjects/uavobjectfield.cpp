@@ -34,24 +34,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 
-UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
-{
-    QStringList elementNames;
-
-    // Set element names
-    for (quint32 n = 0; n < numElements; ++n) {
-        elementNames.append(QString("%1").arg(n));
-    }
-    // Initialize
-    constructorInitialize(name, description, units, type, elementNames, options, limits);
-}
-
-UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
-{
-    constructorInitialize(name, description, units, type, elementNames, options, limits);
-}
-
-void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+UAVObjectField::Descriptor::Descriptor(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
 {
     // Copy params
     this->name         = name;
@@ -60,9 +43,6 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     this->type         = type;
     this->options      = options;
     this->numElements  = elementNames.length();
-    this->offset       = 0;
-    this->data         = NULL;
-    this->obj = NULL;
     this->elementNames = elementNames;
     // Set field size
     switch (type) {
@@ -92,7 +72,7 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
         break;
     case BITFIELD:
         numBytesPerElement = sizeof(quint8);
-        this->options = QStringList() << tr("0") << tr("1");
+        this->options = QStringList() << UAVObjectField::tr("0") << UAVObjectField::tr("1");
         break;
     case STRING:
         numBytesPerElement = sizeof(quint8);
@@ -103,7 +83,46 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     limitsInitialize(limits);
 }
 
-void UAVObjectField::limitsInitialize(const QString &limits)
+UAVObjectField::UAVObjectField(const Descriptor & descriptor)
+{
+    constructorInitialize(descriptor);
+}
+
+UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString &limits)
+{
+    QStringList elementNames;
+
+    // Set element names
+    for (quint32 n = 0; n < numElements; ++n) {
+        elementNames.append(QString("%1").arg(n));
+    }
+    // Initialize
+    constructorInitialize(Descriptor(name, description, units, type, elementNames, options, limits));
+}
+
+UAVObjectField::UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+{
+    constructorInitialize(Descriptor(name, description, units, type, elementNames, options, limits));
+}
+
+void UAVObjectField::constructorInitialize(const Descriptor & descriptor)
+{
+    // The strings, lists and limits are implicitly shared with the descriptor
+    this->name               = descriptor.name;
+    this->description        = descriptor.description;
+    this->units              = descriptor.units;
+    this->type               = descriptor.type;
+    this->options            = descriptor.options;
+    this->numElements        = descriptor.numElements;
+    this->numBytesPerElement = descriptor.numBytesPerElement;
+    this->elementNames       = descriptor.elementNames;
+    this->elementLimits      = descriptor.elementLimits;
+    this->offset             = 0;
+    this->data               = NULL;
+    this->obj                = NULL;
+}
+
+void UAVObjectField::Descriptor::limitsInitialize(const QString &limits)
 {
     // Limit string format:
     // %        - start char
@@ -30,6 +30,7 @@
 
 #include "uavobjects_global.h"
 #include "uavobject.h"
+#include "uavobjectarena.h"
 
 #include <QStringList>
 #include <QVariant>
@@ -54,6 +55,38 @@ public:
         int board;
     } LimitStruct;
 
+    /**
+     * Everything about a field that does not change between instances. The
+     * generated objects build it once per field and share it between all
+     * their instances, which saves building the strings and parsing the
+     * limits every time an object is created.
+     */
+    struct UAVOBJECTS_EXPORT Descriptor {
+        Descriptor(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+
+        QString name;
+        QString description;
+        QString units;
+        FieldType type;
+        QStringList elementNames;
+        QStringList options;
+        quint32 numElements;
+        quint32 numBytesPerElement;
+        QMap<quint32, QList<LimitStruct> > elementLimits;
+private:
+        void limitsInitialize(const QString &limits);
+    };
+
+    static void *operator new(size_t size)
+    {
+        return UAVObjectArena::allocate(size);
+    }
+    static void operator delete(void *ptr)
+    {
+        UAVObjectArena::release(ptr);
+    }
+
+    explicit UAVObjectField(const Descriptor & descriptor);
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
@@ -108,8 +141,7 @@ protected:
     quint8 *data;
     UAVObject *obj;
     QMap<quint32, QList<LimitStruct> > elementLimits;
-    void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
-    void limitsInitialize(const QString &limits);
+    void constructorInitialize(const Descriptor & descriptor);
 };
 
 #endif // UAVOBJECTFIELD_H
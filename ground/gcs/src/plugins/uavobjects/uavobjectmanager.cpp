@@ -43,6 +43,21 @@ UAVObjectManager::~UAVObjectManager()
     delete mutex;
 }
 
+/**
+ * Minimum interval in ms between two property notifications of a data object,
+ * updates received in between are coalesced. Zero (the default) notifies on
+ * every update, 16 would notify at most once per frame at 60 fps.
+ */
+int UAVObjectManager::notificationInterval() const
+{
+    return UAVDataObject::notificationInterval();
+}
+
+void UAVObjectManager::setNotificationInterval(int interval)
+{
+    UAVDataObject::setNotificationInterval(interval);
+}
+
 /**
  * Register an object with the manager. This function must be called for all newly created instances.
  * A new instance can be created directly by instantiating a new object or by calling clone() of
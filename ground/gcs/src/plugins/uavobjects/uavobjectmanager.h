@@ -38,7 +38,7 @@
 #include <QJsonObject>
 
 class UAVOBJECTS_EXPORT UAVObjectManager : public QObject {
-    Q_OBJECT
+    Q_OBJECT Q_PROPERTY(int notificationInterval READ notificationInterval WRITE setNotificationInterval)
 
 public:
     enum JSON_EXPORT_OPTION { JSON_EXPORT_ALL, JSON_EXPORT_METADATA, JSON_EXPORT_SETTINGS, JSON_EXPORT_DATA };
@@ -56,6 +56,9 @@ public:
     qint32 getNumInstances(const QString & name);
     qint32 getNumInstances(quint32 objId);
 
+    int notificationInterval() const;
+    void setNotificationInterval(int interval);
+
     void toJson(QJsonObject &jsonObject, JSON_EXPORT_OPTION what = JSON_EXPORT_ALL);
     void toJson(QJsonObject &jsonObject, const QList<QString> &objectsToExport);
     void toJson(QJsonObject &jsonObject, const QList<UAVObject *> &objectsToExport);
@@ -15,7 +15,9 @@ HEADERS += \
     uavobjectmanager.h \
     uavdataobject.h \
     uavobjectfield.h \
+    uavobjectarena.h \
     uavobjectsinit.h \
+    uavobjectcolumnarwriter.h \
     uavobjectsplugin.h
 
 SOURCES += \
@@ -24,6 +26,8 @@ SOURCES += \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
+    uavobjectarena.cpp \
+    uavobjectcolumnarwriter.cpp \
     uavobjectsplugin.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
@@ -28,6 +28,7 @@
 #include "uavobjectsplugin.h"
 #include "uavobjectsinit.h"
 #include "uavobjectmanager.h"
+#include "uavobjectarena.h"
 
 UAVObjectsPlugin::UAVObjectsPlugin()
 {}
@@ -44,8 +45,11 @@ bool UAVObjectsPlugin::initialize(const QStringList & arguments, QString *errorS
     UAVObjectManager *objMngr = new UAVObjectManager();
 
     addAutoReleasedObject(objMngr);
-    // Initialize UAVObjects
-    UAVObjectsInitialize(objMngr);
+    // Initialize UAVObjects, allocating them from the arena
+    {
+        UAVObjectArena::Scope arena;
+        UAVObjectsInitialize(objMngr);
+    }
     // Done
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
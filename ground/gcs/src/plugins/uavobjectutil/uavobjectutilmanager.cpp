@@ -39,6 +39,7 @@
 #include <QDebug>
 #include <QEventLoop>
 #include <QTimer>
+#include <QElapsedTimer>
 
 // ******************************
 // constructor/destructor
@@ -231,6 +232,157 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
     }
 }
 
+// ******************************
+// Settings transactions
+//
+
+/**
+ * Upload a set of objects and save the settings among them in one settings
+ * transaction: the board stages the settings as they arrive and writes them
+ * to flash together on commit, instead of one save request and one flash
+ * write per object. Blocks until done, saveCompleted() is emitted for every
+ * object as with saveObjectToSD().
+ * @return true if every object was uploaded and saved
+ */
+bool UAVObjectUtilManager::saveObjectsToSD(const QList<UAVObject *> &objects)
+{
+    QElapsedTimer timer;
+
+    timer.start();
+
+    if (!beginSettingsTransaction()) {
+        qDebug() << "Could not start a settings transaction";
+        foreach(UAVObject * obj, objects) {
+            emit saveCompleted(obj->getObjID(), false);
+        }
+        return false;
+    }
+
+    bool success = true;
+    QList<UAVObject *> staged;
+    foreach(UAVObject * obj, objects) {
+        bool uploaded = false;
+        for (int i = 0; i < 3 && !uploaded; ++i) {
+            uploaded = waitForTransaction(obj, 3000);
+        }
+        if (uploaded) {
+            staged.append(obj);
+        } else {
+            qDebug() << "Upload of" << obj->getName() << "failed after 3 tries.";
+            success = false;
+            emit saveCompleted(obj->getObjID(), false);
+        }
+    }
+
+    bool committed = commitSettingsTransaction();
+    foreach(UAVObject * obj, staged) {
+        emit saveCompleted(obj->getObjID(), committed);
+    }
+
+    qDebug() << "Settings transaction of" << objects.size() << "objects took" << timer.elapsed() << "ms";
+    return success && committed;
+}
+
+/**
+ * Start a settings transaction on the board. Settings objects sent from now
+ * on are staged by the board until commitSettingsTransaction().
+ * @return false if the board did not confirm, or a single object save is in progress
+ */
+bool UAVObjectUtilManager::beginSettingsTransaction()
+{
+    return settingsTransactionOperation(ObjectPersistence::OPERATION_BEGINTRANSACTION);
+}
+
+/**
+ * Save everything staged since beginSettingsTransaction() to flash in one go.
+ * Retried up to three times, the board keeps the transaction open on failure.
+ * @return true if the board saved the staged settings
+ */
+bool UAVObjectUtilManager::commitSettingsTransaction()
+{
+    for (int i = 0; i < 3; ++i) {
+        if (settingsTransactionOperation(ObjectPersistence::OPERATION_COMMITTRANSACTION)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Send an ObjectPersistence operation and wait for the board to report it completed.
+ * Not mixed with the saveObjectToSD() queue, both are answered through ObjectPersistence.
+ */
+bool UAVObjectUtilManager::settingsTransactionOperation(quint8 operation)
+{
+    if (saveState != IDLE || !queue.isEmpty()) {
+        return false;
+    }
+
+    ObjectPersistence *objper = ObjectPersistence::GetInstance(getObjectManager());
+    Q_ASSERT(objper);
+
+    ObjectPersistence::DataFields data = objper->getData();
+    data.Operation  = operation;
+    data.Selection  = ObjectPersistence::SELECTION_ALLSETTINGS;
+    data.ObjectID   = 0;
+    data.InstanceID = 0;
+    objper->setData(data);
+
+    // The result comes back as an update of ObjectPersistence, which can
+    // arrive before the ack, so wait for both in one loop
+    QEventLoop loop;
+    QTimer timer;
+    bool acked    = false;
+    bool answered = false;
+    bool result   = false;
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    connect(objper, &UAVObject::objectUpdated, &loop, [&](UAVObject *) {
+        ObjectPersistence::DataFields data = objper->getData();
+        if (data.Operation == ObjectPersistence::OPERATION_COMPLETED || data.Operation == ObjectPersistence::OPERATION_ERROR) {
+            result   = (data.Operation == ObjectPersistence::OPERATION_COMPLETED);
+            answered = true;
+            if (acked) {
+                loop.quit();
+            }
+        }
+    });
+    connect(objper, &UAVObject::transactionCompleted, &loop, [&](UAVObject *, bool success) {
+        acked = success;
+        if (!success || answered) {
+            loop.quit();
+        }
+    });
+    objper->updated();
+    // committing a full configuration takes a while on external flash
+    timer.start(8000);
+    loop.exec();
+
+    return acked && answered && result;
+}
+
+/**
+ * Send an object and wait for the telemetry ack.
+ */
+bool UAVObjectUtilManager::waitForTransaction(UAVObject *obj, int timeout)
+{
+    QEventLoop loop;
+    QTimer timer;
+    bool result = false;
+
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+    connect(obj, &UAVObject::transactionCompleted, &loop, [&](UAVObject *, bool success) {
+        result = success;
+        loop.quit();
+    });
+    obj->updated();
+    timer.start(timeout);
+    loop.exec();
+
+    return result;
+}
+
 /**
  * Helper function that makes sure FirmwareIAP is updated and then returns the data
  */
@@ -68,6 +68,9 @@ public:
     static bool descriptionToStructure(QByteArray desc, deviceDescriptorStruct & struc);
     UAVObjectManager *getObjectManager();
     void saveObjectToSD(UAVObject *obj);
+    bool saveObjectsToSD(const QList<UAVObject *> &objects);
+    bool beginSettingsTransaction();
+    bool commitSettingsTransaction();
 protected:
     FirmwareIAPObj::DataFields getFirmwareIap();
 
@@ -81,6 +84,10 @@ private:
     void saveNextObject();
     QTimer failureTimer;
 
+    // synchronous settings transactions, each wait runs its own event loop
+    bool waitForTransaction(UAVObject *obj, int timeout);
+    bool settingsTransactionOperation(quint8 operation);
+
     ExtensionSystem::PluginManager *pm;
     UAVObjectManager *obm;
     UAVObjectUtilManager *obum;
@@ -27,6 +27,8 @@
 #include "smartsavebutton.h"
 #include "configtaskwidget.h"
 
+#include <QElapsedTimer>
+
 SmartSaveButton::SmartSaveButton(ConfigTaskWidget *configTaskWidget) : configWidget(configTaskWidget)
 {}
 
@@ -70,6 +72,13 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
     bool error = false;
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectUtilManager *utilMngr     = pm->getObject<UAVObjectUtilManager>();
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // Have the board stage the settings and write them to flash all at once,
+    // falls back to saving them one by one if that can't be started.
+    bool transaction = save && utilMngr->beginSettingsTransaction();
+
     foreach(UAVDataObject * obj, objects) {
         if (!obj) {
             continue;
@@ -112,7 +121,7 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
 
         sv_result = false;
         current_objectID = obj->getObjID();
-        if (save && (obj->isSettingsObject())) {
+        if (save && !transaction && (obj->isSettingsObject())) {
             for (int i = 0; i < 3; ++i) {
                 qDebug() << "Saving" << obj->getName() << "to board.";
                 connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this, SLOT(saving_finished(int, bool)));
@@ -139,6 +148,15 @@ void SmartSaveButton::processOperation(QPushButton *button, bool save)
             }
         }
     }
+    if (transaction) {
+        if (utilMngr->commitSettingsTransaction()) {
+            qDebug() << "Saving settings to board successful.";
+        } else {
+            qDebug() << "Saving settings to board failed.";
+            error = true;
+        }
+    }
+    qDebug() << (save ? "Saving" : "Applying") << objects.size() << "objects took" << elapsed.elapsed() << "ms";
     emit endOp();
     if (!error) {
         emit saveSuccessful();
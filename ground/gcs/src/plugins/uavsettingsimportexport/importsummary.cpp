@@ -120,18 +120,20 @@ void ImportSummaryDialog::doTheSaving()
     }
     ui->progressBar->setMaximum(itemCount + 1);
     ui->progressBar->setValue(1);
+    ui->saveToFlash->setEnabled(false);
+    ui->closeButton->setEnabled(false);
+
+    QList<UAVObject *> objects;
     for (int i = 0; i < ui->importSummaryList->rowCount(); i++) {
         QString uavObjectName = ui->importSummaryList->item(i, 1)->text();
         QCheckBox *box = dynamic_cast<QCheckBox *>(ui->importSummaryList->cellWidget(i, 0));
         if (box->isChecked()) {
-            UAVObject *obj = objManager->getObject(uavObjectName);
-            utilManager->saveObjectToSD(obj);
-            this->repaint();
+            objects.append(objManager->getObject(uavObjectName));
         }
     }
 
-    ui->saveToFlash->setEnabled(false);
-    ui->closeButton->setEnabled(false);
+    // Uploaded again and saved in one settings transaction, saveCompleted() updates the progress
+    utilManager->saveObjectsToSD(objects);
 }
 
 
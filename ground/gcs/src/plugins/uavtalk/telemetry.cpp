@@ -243,6 +243,14 @@ void Telemetry::transactionCompleted(UAVObject *obj, bool success)
     ObjectTransactionInfo *transInfo = findTransaction(obj);
 
     if (transInfo) {
+        TelemetryProfiler *profiler = utalk->getProfiler();
+        if (profiler && transInfo->sentTime.isValid()) {
+            if (success) {
+                profiler->acked(obj->getObjID(), transInfo->sentTime.nsecsElapsed() / 1000);
+            } else {
+                profiler->txDropped(obj->getObjID());
+            }
+        }
         if (success) {
             // We now know that the flight side knows of this object.
             obj->setIsKnown(true);
@@ -279,6 +287,9 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
 #endif
         ++txRetries;
         --transInfo->retriesRemaining;
+        if (utalk->getProfiler()) {
+            utalk->getProfiler()->retried(transInfo->obj->getObjID());
+        }
 
         // Retry the transaction
         processObjectTransaction(transInfo);
@@ -286,6 +297,9 @@ void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
         qWarning().nospace() << "Telemetry - !!! transaction timed out for object " << transInfo->obj->toStringBrief();
 
         ++txErrors;
+        if (utalk->getProfiler()) {
+            utalk->getProfiler()->txDropped(transInfo->obj->getObjID());
+        }
 
         // Terminate transaction
         utalk->cancelTransaction(transInfo->obj);
@@ -326,6 +340,7 @@ void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
         if (sent) {
             // Start timer if a response is expected
             transInfo->timer->start(REQ_TIMEOUT_MS);
+            transInfo->sentTime.start();
         } else {
             // message was not sent, the transaction will not complete and will timeout
             // there is no need to wait to close the transaction and notify of completion failure
@@ -353,6 +368,9 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
             objPriorityQueue.enqueue(objInfo);
         } else {
             ++txErrors;
+            if (utalk->getProfiler()) {
+                utalk->getProfiler()->txDropped(obj->getObjID());
+            }
             qWarning().nospace() << "Telemetry - !!! priority event queue is full, event lost " << obj->toStringBrief();
             obj->emitTransactionCompleted(false);
         }
@@ -361,6 +379,9 @@ void Telemetry::processObjectUpdates(UAVObject *obj, EventMask event, bool allIn
             objQueue.enqueue(objInfo);
         } else {
             ++txErrors;
+            if (utalk->getProfiler()) {
+                utalk->getProfiler()->txDropped(obj->getObjID());
+            }
             qWarning().nospace() << "Telemetry - !!! event queue is full, event lost " << obj->toStringBrief();
             obj->emitTransactionCompleted(false);
         }
@@ -526,6 +547,13 @@ Telemetry::TelemetryStats Telemetry::getStats()
     stats.rxSyncErrors  = utalkStats.rxSyncErrors;
     stats.rxCrcErrors   = utalkStats.rxCrcErrors;
 
+    stats.rxDispatched           = utalkStats.rxDispatched;
+    stats.rxSuperseded           = utalkStats.rxSuperseded;
+    stats.rxDispatchOverflows    = utalkStats.rxDispatchOverflows;
+    stats.rxDispatchBatches      = utalkStats.rxDispatchBatches;
+    stats.rxDispatchLatencyUs    = utalkStats.rxDispatchLatencyUs;
+    stats.rxDispatchMaxLatencyUs = utalkStats.rxDispatchMaxLatencyUs;
+
     // Done
     return stats;
 }
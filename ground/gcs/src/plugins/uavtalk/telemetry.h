@@ -34,6 +34,7 @@
 #include <QMutex>
 #include <QMutexLocker>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QQueue>
 #include <QMap>
 
@@ -50,6 +51,7 @@ public:
     bool acked;
     QPointer<class Telemetry>telem;
     QTimer *timer;
+    QElapsedTimer sentTime; /** Last (re)transmission, for the round-trip time */
 private slots:
     void timeout();
 };
@@ -71,8 +73,18 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+
+        quint32 rxDispatched;
+        quint32 rxSuperseded;
+        quint32 rxDispatchOverflows;
+        quint32 rxDispatchBatches;
+        quint64 rxDispatchLatencyUs;
+        quint32 rxDispatchMaxLatencyUs;
     } TelemetryStats;
 
+    // Time an object request waits for its answer before it is retried
+    static const int REQ_TIMEOUT_MS = 250;
+
     Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr);
     ~Telemetry();
     TelemetryStats getStats();
@@ -81,7 +93,6 @@ public:
 
 private:
     // Constants
-    static const int REQ_TIMEOUT_MS = 250;
     static const int MAX_RETRIES    = 2;
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
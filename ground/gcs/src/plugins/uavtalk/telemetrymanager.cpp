@@ -59,6 +59,25 @@ TelemetryManager::ConnectionState TelemetryManager::connectionState() const
     return m_connectionState;
 }
 
+/**
+ * Get the traffic of each object since the last reset, can be called from any thread
+ */
+TelemetryProfile TelemetryManager::getProfile() const
+{
+    TelemetryProfile profile = m_profiler.profile();
+
+    for (QMap<quint32, TelemetryProfile::Counters>::iterator it = profile.objects.begin(); it != profile.objects.end(); ++it) {
+        UAVObject *obj = m_uavobjectManager->getObject(it.key());
+        it.value().name = obj ? obj->getName() : QString::number(it.key(), 16).toUpper();
+    }
+    return profile;
+}
+
+void TelemetryManager::resetProfile()
+{
+    m_profiler.reset();
+}
+
 void TelemetryManager::start(QIODevice *dev)
 {
     m_connectionState = TELEMETRY_CONNECTING;
@@ -77,6 +96,7 @@ void TelemetryManager::start(QIODevice *dev)
 void TelemetryManager::onStart()
 {
     m_uavTalk = new UAVTalk(m_telemetryDevice, m_uavobjectManager);
+    m_uavTalk->setProfiler(&m_profiler);
     if (false) {
         // UAVTalk must be thread safe and for that:
         // 1- all public methods must lock a mutex
@@ -104,6 +124,9 @@ void TelemetryManager::onStart()
     connect(m_telemetryMonitor, SIGNAL(connected()), this, SLOT(onConnect()));
     connect(m_telemetryMonitor, SIGNAL(disconnected()), this, SLOT(onDisconnect()));
     connect(m_telemetryMonitor, SIGNAL(telemetryUpdated(double, double)), this, SLOT(onTelemetryUpdate(double, double)));
+    connect(m_telemetryMonitor, SIGNAL(dispatchUpdated(double, double, double, double)),
+            this, SIGNAL(dispatchUpdated(double, double, double, double)));
+    connect(m_telemetryMonitor, SIGNAL(objectsRetrieved(int, int, int)), this, SIGNAL(objectsRetrieved(int, int, int)));
 }
 
 void TelemetryManager::stop()
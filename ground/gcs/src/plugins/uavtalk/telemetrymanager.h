@@ -31,6 +31,7 @@
 
 #include "uavtalk_global.h"
 #include "uavtalk.h"
+#include "telemetryprofiler.h"
 #include "uavobjectmanager.h"
 #include <QIODevice>
 #include <QObject>
@@ -57,12 +58,17 @@ public:
     bool isConnected() const;
     ConnectionState connectionState() const;
 
+    TelemetryProfile getProfile() const;
+    void resetProfile();
+
 signals:
     void connecting();
     void connected();
     void disconnecting();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    void dispatchUpdated(double updateRate, double supersededRate, double meanLatencyMs, double maxLatencyMs);
+    void objectsRetrieved(int objects, int failed, int elapsedMs);
     void myStart();
     void myStop();
 
@@ -81,6 +87,7 @@ private:
     QIODevice *m_telemetryDevice;
     ConnectionState m_connectionState;
     QThread m_telemetryReaderThread;
+    TelemetryProfiler m_profiler;
 };
 
 
@@ -40,7 +40,11 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel) :
     flightStatsObj(FlightTelemetryStats::GetInstance(objMngr)),
     firmwareIAPObj(FirmwareIAPObj::GetInstance(objMngr)),
     statsTimer(new QTimer(this)),
-    objPending(NULL),
+    objsRetrieved(0),
+    objsFailed(0),
+    retrieveWindow(RETRIEVE_WINDOW_MIN),
+    retrieveWindowShrunk(0),
+    retrieveMaxRtt(0),
     mutex(new QMutex(QMutex::Recursive)),
     connectionTimer(new QTime())
 {
@@ -67,8 +71,14 @@ TelemetryMonitor::~TelemetryMonitor()
  */
 void TelemetryMonitor::startRetrievingObjects()
 {
-    // Clear object queue
-    queue.clear();
+    // Clear object queue and forget requests left over from a previous connection
+    stopRetrievingObjects();
+    objsRetrieved = 0;
+    objsFailed    = 0;
+    retrieveWindow       = RETRIEVE_WINDOW_MIN;
+    retrieveWindowShrunk = 0;
+    retrieveMaxRtt       = 0;
+    retrieveTimer.start();
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the queue
     QList< QList<UAVObject *> > objs = objMngr->getObjects();
     for (int n = 0; n < objs.length(); ++n) {
@@ -90,7 +100,7 @@ void TelemetryMonitor::startRetrievingObjects()
     }
     // Start retrieving
     qDebug() << "TelemetryMonitor::startRetrievingObjects - retrieving" << queue.length() << "objects";
-    retrieveNextObject();
+    retrieveNextObjects();
 }
 
 /**
@@ -98,18 +108,29 @@ void TelemetryMonitor::startRetrievingObjects()
  */
 void TelemetryMonitor::stopRetrievingObjects()
 {
-    qDebug() << "TelemetryMonitor::stopRetrievingObjects - object retrieval has been cancelled";
+    if (!queue.isEmpty() || !objsPending.isEmpty()) {
+        qDebug() << "TelemetryMonitor::stopRetrievingObjects - object retrieval has been cancelled";
+    }
     queue.clear();
+    foreach(UAVObject * obj, objsPending.keys()) {
+        obj->disconnect(this);
+    }
+    objsPending.clear();
 }
 
 /**
- * Retrieve the next object in the queue
+ * Request objects from the queue until retrieveWindow requests are in flight.
+ * Waiting for each object before requesting the next one costs a round trip
+ * per object, which adds up to tens of seconds over a slow radio link.
  */
-void TelemetryMonitor::retrieveNextObject()
+void TelemetryMonitor::retrieveNextObjects()
 {
-    // If queue is empty return
-    if (queue.isEmpty()) {
-        qDebug() << "TelemetryMonitor::retrieveNextObject - object retrieval completed";
+    // If the queue is empty and all requests are answered we are done
+    if (queue.isEmpty() && objsPending.isEmpty()) {
+        int elapsedMs = retrieveTimer.elapsed();
+        qDebug() << "TelemetryMonitor::retrieveNextObjects - object retrieval completed," << objsRetrieved << "objects in"
+                 << elapsedMs << "ms," << objsFailed << "failed, max round trip" << retrieveMaxRtt << "ms, window" << retrieveWindow;
+        emit objectsRetrieved(objsRetrieved, objsFailed, elapsedMs);
         if (firmwareIAPObj->getBoardType()) {
             emit connected();
         } else {
@@ -118,16 +139,18 @@ void TelemetryMonitor::retrieveNextObject()
         return;
     }
 
-    // Get next object from the queue
-    UAVObject *obj = queue.dequeue();
-    // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
+    while (!queue.isEmpty() && objsPending.size() < retrieveWindow) {
+        // Get next object from the queue
+        UAVObject *obj = queue.dequeue();
+        // qDebug( tr("Retrieving object: %1").arg(obj->getName()) );
 
-    // Connect to object
-    connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
+        // Connect to object
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this, SLOT(transactionCompleted(UAVObject *, bool)));
 
-    // Request update
-    obj->requestUpdate();
-    objPending = obj;
+        // Request update, the transaction may complete (and fail) right away
+        objsPending.insert(obj, retrieveTimer.elapsed());
+        obj->requestUpdate();
+    }
 }
 
 /**
@@ -135,23 +158,49 @@ void TelemetryMonitor::retrieveNextObject()
  */
 void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
 {
-    Q_UNUSED(success);
     QMutexLocker locker(mutex);
 
-    if (obj == objPending) {
+    if (objsPending.contains(obj)) {
         // Disconnect from sending object
         obj->disconnect(this);
-        objPending = NULL;
+        ++objsRetrieved;
+        if (!success) {
+            ++objsFailed;
+        }
+        adaptRetrieveWindow(success, objsPending.take(obj));
 
-        // Process next object if telemetry is still available
+        // Process next objects if telemetry is still available
         GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
         if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
-            retrieveNextObject();
+            retrieveNextObjects();
         } else {
             stopRetrievingObjects();
         }
     } else {
-        qCritical() << "TelemetryMonitor::retrieveNextObject - unexpected object" << obj;
+        qCritical() << "TelemetryMonitor::transactionCompleted - unexpected object" << obj;
+    }
+}
+
+/**
+ * Size the window from the round trip of the answered request. The answers of a
+ * window come back one after the other, so a window too large for the link shows
+ * as round trips growing towards the request timeout, and then as retries. Grow
+ * by one on a quick answer, halve on a slow or failed one, at most once for the
+ * requests sent before the last decrease.
+ */
+void TelemetryMonitor::adaptRetrieveWindow(bool success, qint64 requestTime)
+{
+    qint64 now = retrieveTimer.elapsed();
+    qint64 rtt = now - requestTime;
+
+    retrieveMaxRtt = qMax(retrieveMaxRtt, rtt);
+    if (!success || rtt > RETRIEVE_RTT_LIMIT_MS) {
+        if (requestTime >= retrieveWindowShrunk) {
+            retrieveWindow = qMax(RETRIEVE_WINDOW_MIN, retrieveWindow / 2);
+            retrieveWindowShrunk = now;
+        }
+    } else if (retrieveWindow < RETRIEVE_WINDOW_MAX) {
+        ++retrieveWindow;
     }
 }
 
@@ -242,6 +291,17 @@ void TelemetryMonitor::processStatsUpdates()
 
     emit telemetryUpdated((double)gcsStats.TxDataRate, (double)gcsStats.RxDataRate);
 
+    // Hand-over of the received updates to the GUI thread
+    double period = (double)statsTimer->interval() / 1000.0;
+    quint32 dispatchedUpdates = telStats.rxDispatched - telStats.rxSuperseded;
+    double meanLatencyMs = dispatchedUpdates ? (double)telStats.rxDispatchLatencyUs / dispatchedUpdates / 1000.0 : 0.0;
+    emit dispatchUpdated((double)telStats.rxDispatched / period, (double)telStats.rxSuperseded / period,
+                         meanLatencyMs, (double)telStats.rxDispatchMaxLatencyUs / 1000.0);
+    if (telStats.rxDispatchOverflows > 0) {
+        qDebug() << "TelemetryMonitor::processStatsUpdates -" << telStats.rxDispatchOverflows
+                 << "updates unpacked by the telemetry thread, the GUI thread fell behind";
+    }
+
     // Set data
     gcsStatsObj->setData(gcsStats);
 
@@ -260,6 +320,7 @@ void TelemetryMonitor::processStatsUpdates()
     if (gcsStats.Status == GCSTelemetryStats::STATUS_DISCONNECTED && gcsStats.Status != oldStatus) {
         statsTimer->setInterval(STATS_CONNECT_PERIOD_MS);
         qDebug() << "TelemetryMonitor::processStatsUpdates - connection with the autopilot lost";
+        stopRetrievingObjects();
         emit disconnected();
     }
 }
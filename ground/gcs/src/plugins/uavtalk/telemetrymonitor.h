@@ -30,8 +30,10 @@
 
 #include <QObject>
 #include <QQueue>
+#include <QHash>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QMutexLocker>
 #include "uavobjectmanager.h"
@@ -52,6 +54,8 @@ signals:
     void connected();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    void dispatchUpdated(double updateRate, double supersededRate, double meanLatencyMs, double maxLatencyMs);
+    void objectsRetrieved(int objects, int failed, int elapsedMs);
 
 public slots:
     void transactionCompleted(UAVObject *obj, bool success);
@@ -63,6 +67,11 @@ private:
     static const int STATS_UPDATE_PERIOD_MS  = 4000;
     static const int STATS_CONNECT_PERIOD_MS = 2000;
     static const int CONNECTION_TIMEOUT_MS   = 8000;
+    // Bounds of the number of object requests kept in flight while retrieving the objects on connect
+    static const int RETRIEVE_WINDOW_MIN = 1;
+    static const int RETRIEVE_WINDOW_MAX = 8;
+    // An answer slower than this shrinks the window, the answers queued behind it would time out
+    static const int RETRIEVE_RTT_LIMIT_MS = Telemetry::REQ_TIMEOUT_MS / 2;
 
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -71,13 +80,20 @@ private:
     FlightTelemetryStats *flightStatsObj;
     FirmwareIAPObj *firmwareIAPObj;
     QTimer *statsTimer;
-    UAVObject *objPending;
+    QHash<UAVObject *, qint64> objsPending; // request time on retrieveTimer
+    int objsRetrieved;
+    int objsFailed;
+    int retrieveWindow;
+    qint64 retrieveWindowShrunk;
+    qint64 retrieveMaxRtt;
+    QElapsedTimer retrieveTimer;
     QMutex *mutex;
     QTime *connectionTimer;
 
     void startRetrievingObjects();
-    void retrieveNextObject();
+    void retrieveNextObjects();
     void stopRetrievingObjects();
+    void adaptRetrieveWindow(bool success, qint64 requestTime);
 };
 
 #endif // TELEMETRYMONITOR_H
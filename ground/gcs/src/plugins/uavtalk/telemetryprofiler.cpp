@@ -0,0 +1,214 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryprofiler.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Per object telemetry bandwidth counters
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "telemetryprofiler.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+
+TelemetryProfile::TelemetryProfile() : durationMs(0)
+{}
+
+/**
+ * Save the profile as JSON
+ */
+bool TelemetryProfile::save(const QString &fileName, QString *errorString) const
+{
+    QJsonArray jsonObjects;
+
+    for (QMap<quint32, Counters>::const_iterator it = objects.constBegin(); it != objects.constEnd(); ++it) {
+        const Counters &c = it.value();
+        QJsonObject jsonObject;
+        jsonObject["id"]           = QString::number(it.key(), 16).toUpper();
+        jsonObject["name"]         = c.name;
+        jsonObject["txBytes"]      = (double)c.txBytes;
+        jsonObject["txPackets"]    = (double)c.txPackets;
+        jsonObject["txDrops"]      = (double)c.txDrops;
+        jsonObject["rxBytes"]      = (double)c.rxBytes;
+        jsonObject["rxPackets"]    = (double)c.rxPackets;
+        jsonObject["rxDrops"]      = (double)c.rxDrops;
+        jsonObject["retries"]      = (double)c.retries;
+        jsonObject["acks"]         = (double)c.acks;
+        jsonObject["ackTimeUs"]    = (double)c.ackTimeUs;
+        jsonObject["maxAckTimeUs"] = (double)c.maxAckTimeUs;
+        jsonObjects.append(jsonObject);
+    }
+
+    QJsonObject json;
+    json["durationMs"] = (double)durationMs;
+    json["objects"]    = jsonObjects;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return true;
+}
+
+/**
+ * Load a profile saved with save()
+ */
+bool TelemetryProfile::load(const QString &fileName, QString *errorString)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject()) {
+        if (errorString) {
+            *errorString = parseError.errorString();
+        }
+        return false;
+    }
+
+    QJsonObject json = document.object();
+    durationMs = (qint64)json["durationMs"].toDouble();
+    objects.clear();
+    foreach(QJsonValue value, json["objects"].toArray()) {
+        QJsonObject jsonObject = value.toObject();
+        Counters c;
+        c.name         = jsonObject["name"].toString();
+        c.txBytes      = (quint64)jsonObject["txBytes"].toDouble();
+        c.txPackets    = (quint32)jsonObject["txPackets"].toDouble();
+        c.txDrops      = (quint32)jsonObject["txDrops"].toDouble();
+        c.rxBytes      = (quint64)jsonObject["rxBytes"].toDouble();
+        c.rxPackets    = (quint32)jsonObject["rxPackets"].toDouble();
+        c.rxDrops      = (quint32)jsonObject["rxDrops"].toDouble();
+        c.retries      = (quint32)jsonObject["retries"].toDouble();
+        c.acks         = (quint32)jsonObject["acks"].toDouble();
+        c.ackTimeUs    = (quint64)jsonObject["ackTimeUs"].toDouble();
+        c.maxAckTimeUs = (quint32)jsonObject["maxAckTimeUs"].toDouble();
+        objects.insert(jsonObject["id"].toString().toUInt(0, 16), c);
+    }
+    return true;
+}
+
+TelemetryProfiler::TelemetryProfiler()
+{
+    clock.start();
+}
+
+TelemetryProfile::Counters &TelemetryProfiler::counters(quint32 objId)
+{
+    QMap<quint32, TelemetryProfile::Counters>::iterator it = objects.find(objId);
+
+    if (it == objects.end()) {
+        it = objects.insert(objId, TelemetryProfile::Counters());
+    }
+    return it.value();
+}
+
+/**
+ * A packet of the object has been sent
+ */
+void TelemetryProfiler::transmitted(quint32 objId, quint32 bytes)
+{
+    QMutexLocker locker(&mutex);
+    TelemetryProfile::Counters &c = counters(objId);
+
+    c.txBytes += bytes;
+    ++c.txPackets;
+}
+
+/**
+ * A valid packet of the object has been received
+ */
+void TelemetryProfiler::received(quint32 objId, quint32 bytes)
+{
+    QMutexLocker locker(&mutex);
+    TelemetryProfile::Counters &c = counters(objId);
+
+    c.rxBytes += bytes;
+    ++c.rxPackets;
+}
+
+void TelemetryProfiler::txDropped(quint32 objId)
+{
+    QMutexLocker locker(&mutex);
+
+    ++counters(objId).txDrops;
+}
+
+void TelemetryProfiler::rxDropped(quint32 objId)
+{
+    QMutexLocker locker(&mutex);
+
+    ++counters(objId).rxDrops;
+}
+
+void TelemetryProfiler::retried(quint32 objId)
+{
+    QMutexLocker locker(&mutex);
+
+    ++counters(objId).retries;
+}
+
+/**
+ * A transaction on the object completed after roundTripUs
+ */
+void TelemetryProfiler::acked(quint32 objId, qint64 roundTripUs)
+{
+    QMutexLocker locker(&mutex);
+    TelemetryProfile::Counters &c = counters(objId);
+
+    ++c.acks;
+    c.ackTimeUs   += roundTripUs;
+    c.maxAckTimeUs = qMax(c.maxAckTimeUs, (quint32)roundTripUs);
+}
+
+/**
+ * Get the counters collected since the last reset, without the object names
+ */
+TelemetryProfile TelemetryProfiler::profile() const
+{
+    QMutexLocker locker(&mutex);
+    TelemetryProfile profile;
+
+    profile.durationMs = clock.elapsed();
+    profile.objects    = objects;
+    return profile;
+}
+
+void TelemetryProfiler::reset()
+{
+    QMutexLocker locker(&mutex);
+
+    objects.clear();
+    clock.restart();
+}
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryprofiler.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Per object telemetry bandwidth counters
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TELEMETRYPROFILER_H
+#define TELEMETRYPROFILER_H
+
+#include "uavtalk_global.h"
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/**
+ * Telemetry counters of each object over a period of time, as taken from
+ * the TelemetryProfiler or loaded from a file.
+ */
+class UAVTALK_EXPORT TelemetryProfile {
+public:
+    typedef struct {
+        QString name;
+        quint64 txBytes;
+        quint32 txPackets;
+        quint32 txDrops; /** Updates not sent: link busy, queue full or transaction given up */
+        quint64 rxBytes;
+        quint32 rxPackets;
+        quint32 rxDrops; /** Frames of the object discarded for CRC or length errors */
+        quint32 retries;
+        quint32 acks; /** Completed transactions, acked updates and answered requests */
+        quint64 ackTimeUs; /** Sum of the round-trip times of the completed transactions */
+        quint32 maxAckTimeUs;
+    } Counters;
+
+    TelemetryProfile();
+
+    qint64 durationMs;
+    QMap<quint32, Counters> objects; /** By object ID */
+
+    bool save(const QString &fileName, QString *errorString = 0) const;
+    bool load(const QString &fileName, QString *errorString = 0);
+};
+
+/**
+ * Collects the per object, per direction counters of a telemetry link. The
+ * UAVTalk and Telemetry instances of a connection record into it from the
+ * telemetry thread, and it can be read from any thread.
+ */
+class UAVTALK_EXPORT TelemetryProfiler {
+public:
+    TelemetryProfiler();
+
+    void transmitted(quint32 objId, quint32 bytes);
+    void received(quint32 objId, quint32 bytes);
+    void txDropped(quint32 objId);
+    void rxDropped(quint32 objId);
+    void retried(quint32 objId);
+    void acked(quint32 objId, qint64 roundTripUs);
+
+    TelemetryProfile profile() const;
+    void reset();
+
+private:
+    TelemetryProfile::Counters &counters(quint32 objId);
+
+    mutable QMutex mutex;
+    QElapsedTimer clock;
+    QMap<quint32, TelemetryProfile::Counters> objects;
+};
+
+#endif // TELEMETRYPROFILER_H
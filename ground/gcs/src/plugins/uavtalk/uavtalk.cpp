@@ -49,13 +49,15 @@ using namespace Utils;
 /**
  * Constructor
  */
-UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive)
+UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr) : io(iodev), objMngr(objMngr), mutex(QMutex::Recursive), profiler(NULL)
 {
     rxState = STATE_SYNC;
     rxPacketLength = 0;
 
     memset(&stats, 0, sizeof(ComStats));
 
+    dispatcher = new UAVTalkDispatcher();
+
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     Core::Internal::GeneralSettings *settings = pm->getObject<Core::Internal::GeneralSettings>();
     useUDPMirror = settings->useUDPMirror();
@@ -78,6 +80,9 @@ UAVTalk::~UAVTalk()
     // disconnect(io, SIGNAL(readyRead()), worker, SLOT(processInputStream()));
 
     closeAllTransactions();
+
+    // the dispatcher lives in the GUI thread
+    dispatcher->deleteLater();
 }
 
 /**
@@ -88,6 +93,7 @@ void UAVTalk::resetStats()
     QMutexLocker locker(&mutex);
 
     memset(&stats, 0, sizeof(ComStats));
+    dispatcher->resetStats();
 }
 
 /**
@@ -97,7 +103,33 @@ UAVTalk::ComStats UAVTalk::getStats()
 {
     QMutexLocker locker(&mutex);
 
-    return stats;
+    UAVTalkDispatcher::Stats dispatchStats = dispatcher->getStats();
+    ComStats comStats = stats;
+
+    comStats.rxDispatched           = dispatchStats.updates + dispatchStats.superseded;
+    comStats.rxSuperseded           = dispatchStats.superseded;
+    comStats.rxDispatchOverflows    = dispatchStats.overflows;
+    comStats.rxDispatchBatches      = dispatchStats.batches;
+    comStats.rxDispatchLatencyUs    = dispatchStats.latencyUs;
+    comStats.rxDispatchMaxLatencyUs = dispatchStats.maxLatencyUs;
+    return comStats;
+}
+
+/**
+ * Set the profiler that counts the traffic of each object, NULL for none
+ */
+void UAVTalk::setProfiler(TelemetryProfiler *profiler)
+{
+    QMutexLocker locker(&mutex);
+
+    this->profiler = profiler;
+}
+
+TelemetryProfiler *UAVTalk::getProfiler()
+{
+    QMutexLocker locker(&mutex);
+
+    return profiler;
 }
 
 void UAVTalk::dummyUDPRead()
@@ -222,6 +254,9 @@ void UAVTalk::processInputStream()
             }
             if (rxState == STATE_COMPLETE) {
                 mutex.lock();
+                if (profiler) {
+                    profiler->received(rxObjId, rxPacketLength);
+                }
                 if (receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength)) {
                     stats.rxObjectBytes += rxLength;
                     stats.rxObjects++;
@@ -396,6 +431,9 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
                 // packet error - mismatched packet size
                 qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(rxObjId, 16).toUpper();
                 stats.rxErrors++;
+                if (profiler) {
+                    profiler->rxDropped(rxObjId);
+                }
                 rxState = STATE_ERROR;
                 break;
             }
@@ -432,6 +470,9 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             // packet error - faulty CRC
             qWarning().noquote() << "UAVTalk - error : failed CRC check" << QString::number(rxObjId, 16).toUpper();
             stats.rxCrcErrors++;
+            if (profiler) {
+                profiler->rxDropped(rxObjId);
+            }
             rxState = STATE_ERROR;
             break;
         }
@@ -440,6 +481,9 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             // packet error - mismatched packet size
             qWarning().noquote() << "UAVTalk - error : mismatched packet size" << QString::number(rxObjId, 16).toUpper();
             stats.rxErrors++;
+            if (profiler) {
+                profiler->rxDropped(rxObjId);
+            }
             rxState = STATE_ERROR;
             break;
         }
@@ -476,8 +520,6 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
  */
 bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *data, qint32 length)
 {
-    Q_UNUSED(length);
-
     UAVObject *obj    = NULL;
     bool error        = false;
     bool allInstances = (instId == ALL_INSTANCES);
@@ -487,6 +529,13 @@ bool UAVTalk::receiveObject(quint8 type, quint32 objId, quint16 instId, quint8 *
     case TYPE_OBJ:
         // All instances, not allowed for OBJ messages
         if (!allInstances) {
+            // Plain updates of existing objects that no transaction waits for are unpacked by the GUI thread
+            if (findTransaction(objId, instId) == NULL) {
+                obj = objMngr->getObject(objId, instId);
+                if (obj != NULL && dispatcher->post(obj, data, length)) {
+                    break;
+                }
+            }
             // Get object and update its data
             obj = updateObject(objId, instId, data);
 #ifdef VERBOSE_UAVTALK
@@ -630,6 +679,7 @@ UAVObject *UAVTalk::updateObject(quint32 objId, quint16 instId, quint8 *data)
     } else {
         // Unpack data into object instance
         obj->unpack(data);
+        dispatcher->unpacked(obj);
         return obj;
     }
 }
@@ -769,6 +819,9 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     if (length >= MAX_PAYLOAD_LENGTH) {
         qWarning() << "UAVTalk - error transmitting : object exceeds max payload length" << obj->toStringBrief();
         ++stats.txErrors;
+        if (profiler) {
+            profiler->txDropped(objId);
+        }
         return false;
     }
 
@@ -777,6 +830,9 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
         if (!obj->pack(&txBuffer[HEADER_LENGTH])) {
             qWarning() << "UAVTalk - error transmitting : failed to pack object" << obj->toStringBrief();
             ++stats.txErrors;
+            if (profiler) {
+                profiler->txDropped(objId);
+            }
             return false;
         }
     }
@@ -797,11 +853,17 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
         } else {
             qWarning() << "UAVTalk - error transmitting : io device full";
             ++stats.txErrors;
+            if (profiler) {
+                profiler->txDropped(objId);
+            }
             return false;
         }
     } else {
         qWarning() << "UAVTalk - error transmitting : io device not writable";
         ++stats.txErrors;
+        if (profiler) {
+            profiler->txDropped(objId);
+        }
         return false;
     }
 
@@ -809,6 +871,9 @@ bool UAVTalk::transmitSingleObject(quint8 type, quint32 objId, quint16 instId, U
     ++stats.txObjects;
     stats.txObjectBytes += length;
     stats.txBytes += HEADER_LENGTH + length + CHECKSUM_LENGTH;
+    if (profiler) {
+        profiler->transmitted(objId, HEADER_LENGTH + length + CHECKSUM_LENGTH);
+    }
 
     // Done
     return true;
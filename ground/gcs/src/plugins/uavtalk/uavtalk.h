@@ -29,6 +29,8 @@
 
 #include "uavobjectmanager.h"
 #include "uavtalk_global.h"
+#include "uavtalkdispatcher.h"
+#include "telemetryprofiler.h"
 
 #include <QtCore>
 #include <QIODevice>
@@ -58,6 +60,13 @@ public:
         quint32 rxErrors;
         quint32 rxSyncErrors;
         quint32 rxCrcErrors;
+
+        quint32 rxDispatched; /** Object updates handed over to the GUI thread */
+        quint32 rxSuperseded; /** Of these, dropped as a newer update of the object followed */
+        quint32 rxDispatchOverflows; /** Object updates applied on the UAVTalk thread as the GUI thread fell behind */
+        quint32 rxDispatchBatches;
+        quint64 rxDispatchLatencyUs; /** Sum of the hand-over latencies */
+        quint32 rxDispatchMaxLatencyUs;
     } ComStats;
 
     UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr);
@@ -70,6 +79,9 @@ public:
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
     void cancelTransaction(UAVObject *obj);
 
+    void setProfiler(TelemetryProfiler *profiler);
+    TelemetryProfiler *getProfiler();
+
 signals:
     void transactionCompleted(UAVObject *obj, bool success);
 
@@ -121,6 +133,10 @@ private:
 
     QMap<quint32, QMap<quint32, Transaction *> *> transMap;
 
+    UAVTalkDispatcher *dispatcher;
+
+    TelemetryProfiler *profiler;
+
     quint8 rxBuffer[MAX_PACKET_LENGTH];
 
     quint8 txBuffer[MAX_PACKET_LENGTH];
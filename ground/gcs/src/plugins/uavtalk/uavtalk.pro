@@ -14,6 +14,8 @@ include(uavtalk_dependencies.pri)
 HEADERS += \
     uavtalk_global.h \
     uavtalk.h \
+    uavtalkdispatcher.h \
+    telemetryprofiler.h \
     telemetry.h \
     telemetrymonitor.h \
     telemetrymanager.h \
@@ -22,6 +24,8 @@ HEADERS += \
 
 SOURCES += \
     uavtalk.cpp \
+    uavtalkdispatcher.cpp \
+    telemetryprofiler.cpp \
     telemetry.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
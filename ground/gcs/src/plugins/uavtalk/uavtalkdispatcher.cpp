@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkdispatcher.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Hands the received object updates over to the GUI thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "uavtalkdispatcher.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+
+QAtomicInt UAVTalkDispatcher::keepAllUpdates(0);
+
+/**
+ * Constructor, the dispatcher moves itself to the GUI thread
+ */
+UAVTalkDispatcher::UAVTalkDispatcher() : head(0), tail(0), scheduled(0)
+{
+    memset(&stats, 0, sizeof(Stats));
+    clock.start();
+    moveToThread(QCoreApplication::instance()->thread());
+}
+
+/**
+ * Queue an object update, called from the UAVTalk thread only.
+ * \param[in] obj Object instance to update
+ * \param[in] data Payload, validated against the object size
+ * \param[in] length Payload length
+ * \return False if the queue is full, the update must then be applied by the caller
+ */
+bool UAVTalkDispatcher::post(UAVObject *obj, const quint8 *data, qint32 length)
+{
+    int h = head.load();
+
+    if (length > MAX_DATA_LENGTH) {
+        return false;
+    }
+    if (h - tail.loadAcquire() >= QUEUE_SIZE) {
+        QMutexLocker locker(&mutex);
+        ++stats.overflows;
+        return false;
+    }
+
+    Update &update = queue[h & (QUEUE_SIZE - 1)];
+    update.obj      = obj;
+    update.postedUs = clock.nsecsElapsed() / 1000;
+    // no lock needed, only this thread modifies the sequences
+    update.sequence = unpackSequence.value(obj, 0);
+    memcpy(update.data, data, length);
+    head.storeRelease(h + 1);
+
+    // one dispatch per event loop iteration picks up everything posted until then
+    if (scheduled.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, "dispatch", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+/**
+ * Record that the UAVTalk thread has unpacked an update of an object
+ * itself, the older updates of the object still in the queue are dropped.
+ */
+void UAVTalkDispatcher::unpacked(UAVObject *obj)
+{
+    QMutexLocker locker(&mutex);
+
+    ++unpackSequence[obj];
+}
+
+/**
+ * Unpack the queued updates
+ */
+void UAVTalkDispatcher::dispatch()
+{
+    // updates posted from now on need another dispatch
+    scheduled.fetchAndStoreOrdered(0);
+
+    int t = tail.load();
+    int h = head.loadAcquire();
+
+    if (t == h) {
+        return;
+    }
+
+    // newest queued update of each object instance
+    bool coalesce = (keepAllUpdates.loadAcquire() == 0);
+    QHash<UAVObject *, int> newest;
+    if (coalesce) {
+        for (int n = t; n != h; ++n) {
+            newest.insert(queue[n & (QUEUE_SIZE - 1)].obj, n);
+        }
+    }
+
+    quint32 superseded   = 0;
+    quint64 latencyUs    = 0;
+    quint32 maxLatencyUs = 0;
+    for (int n = t; n != h; ++n) {
+        Update &update = queue[n & (QUEUE_SIZE - 1)];
+        if (coalesce && newest.value(update.obj) != n) {
+            ++superseded;
+            continue;
+        }
+        mutex.lock();
+        bool stale = unpackSequence.value(update.obj, 0) != update.sequence;
+        mutex.unlock();
+        if (stale) {
+            ++superseded;
+            continue;
+        }
+        update.obj->unpack(update.data);
+        quint32 latency = clock.nsecsElapsed() / 1000 - update.postedUs;
+        latencyUs   += latency;
+        maxLatencyUs = qMax(maxLatencyUs, latency);
+    }
+    // the entries can be reused once they have been unpacked
+    tail.storeRelease(h);
+
+    QMutexLocker locker(&mutex);
+    stats.updates     += (h - t) - superseded;
+    stats.superseded  += superseded;
+    stats.latencyUs   += latencyUs;
+    stats.maxLatencyUs = qMax(stats.maxLatencyUs, maxLatencyUs);
+    ++stats.batches;
+}
+
+/**
+ * Unpack every queued update instead of only the newest of each object
+ * instance, so that each one emits objectUpdated. Calls are counted,
+ * coalescing resumes once every setKeepAllUpdates(true) has been undone.
+ * Updates older than one the UAVTalk thread unpacked itself on a queue
+ * overflow are still dropped, they are counted in the overflows.
+ */
+void UAVTalkDispatcher::setKeepAllUpdates(bool keep)
+{
+    if (keep) {
+        keepAllUpdates.ref();
+    } else {
+        keepAllUpdates.deref();
+    }
+}
+
+/**
+ * Get the statistics counters
+ */
+UAVTalkDispatcher::Stats UAVTalkDispatcher::getStats()
+{
+    QMutexLocker locker(&mutex);
+
+    return stats;
+}
+
+/**
+ * Reset the statistics counters
+ */
+void UAVTalkDispatcher::resetStats()
+{
+    QMutexLocker locker(&mutex);
+
+    memset(&stats, 0, sizeof(Stats));
+}
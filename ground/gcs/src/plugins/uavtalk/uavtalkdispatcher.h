@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavtalkdispatcher.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2018.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Hands the received object updates over to the GUI thread
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef UAVTALKDISPATCHER_H
+#define UAVTALKDISPATCHER_H
+
+#include "uavtalk_global.h"
+#include "uavobject.h"
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+
+/**
+ * Single producer, single consumer queue of object updates. The UAVTalk
+ * thread posts the payloads it has parsed and validated, and they are
+ * unpacked on the thread the dispatcher lives in (the GUI thread), in one
+ * batch per event loop iteration, so that the object signals are emitted
+ * where most of their consumers live. Of several updates of the same object
+ * instance in a batch only the newest is unpacked, unless a consumer which
+ * records every update (the logger) asked for all of them.
+ */
+class UAVTALK_EXPORT UAVTalkDispatcher : public QObject {
+    Q_OBJECT
+
+public:
+    typedef struct {
+        quint32 updates; /** Updates unpacked */
+        quint32 superseded; /** Updates dropped as a newer one of the same object was queued */
+        quint32 overflows; /** Updates the UAVTalk thread had to unpack itself as the queue was full */
+        quint32 batches; /** Batches unpacked */
+        quint64 latencyUs; /** Sum of the times from posting to unpacking */
+        quint32 maxLatencyUs; /** Longest time from posting to unpacking */
+    } Stats;
+
+    UAVTalkDispatcher();
+
+    bool post(UAVObject *obj, const quint8 *data, qint32 length);
+    void unpacked(UAVObject *obj);
+    Stats getStats();
+    void resetStats();
+
+    static void setKeepAllUpdates(bool keep);
+
+private slots:
+    void dispatch();
+
+private:
+    static const int QUEUE_SIZE = 128; // must be a power of 2
+    static const int MAX_DATA_LENGTH = 256;
+
+    typedef struct {
+        UAVObject *obj;
+        qint64    postedUs;
+        quint32   sequence; // unpackSequence of the object when posted
+        quint8    data[MAX_DATA_LENGTH];
+    } Update;
+
+    Update queue[QUEUE_SIZE];
+    // only the UAVTalk thread writes head, and only the dispatching thread writes tail
+    QAtomicInt head;
+    QAtomicInt tail;
+    QAtomicInt scheduled;
+    // number of setKeepAllUpdates(true) calls not yet undone, shared by all dispatchers
+    static QAtomicInt keepAllUpdates;
+    QElapsedTimer clock;
+
+    // guards stats and unpackSequence
+    QMutex mutex;
+    Stats stats;
+    // number of updates of an object the UAVTalk thread has unpacked itself,
+    // written by the UAVTalk thread only
+    QHash<UAVObject *, quint32> unpackSequence;
+};
+
+#endif // UAVTALKDISPATCHER_H
@@ -28,6 +28,8 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <stdint.h>
+
 enum DecodeState {
     decode_len1_e = 0,
     decode_seqNo_e,
@@ -42,4 +44,15 @@ enum ReceiveState {
     state_unescaped_e
 };
 
+// selective repeat window, negotiated during ssp_Synchronise()
+#define SSP_WINDOW_MAX 8 // upper limit on packets in flight, must stay well below half the sequence space
+// bytes of window storage needed for 'window' packets with up to 'bufSize' data bytes each
+#define SSP_WINDOW_BUF_SIZE(window, bufSize) ((window) * ((bufSize) + 4))
+
+struct WindowSlot {
+    uint32_t timeout; // when this slot times out
+    uint8_t  retryCount; // how many times the slot has been sent
+    uint8_t  full; // tx: sent and not yet acked, rx: received out of order and not yet delivered
+};
+
 #endif // COMMON_H
@@ -32,6 +32,11 @@
 
 port::port(QString name, bool debug) : mstatus(port::closed), debug(debug)
 {
+    // no window unless the user of the port sets one up
+    windowSize  = 0;
+    txWindowBuf = NULL;
+    rxWindowBuf = NULL;
+    txCount     = 0;
     timer.start();
     sport = new QSerialPort(name, this);
     if (sport->open(QIODevice::ReadWrite)) {
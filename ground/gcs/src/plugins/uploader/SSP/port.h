@@ -76,6 +76,17 @@ public:
     uint32_t RxError;
     uint32_t TxError;
     uint16_t flags;
+    // selective repeat state, only used when both ends offered a window during synchronisation
+    uint8_t windowSize; // configured number of window slots, 0 = never offer a window
+    uint8_t *txWindowBuf; // SSP_WINDOW_BUF_SIZE(windowSize, txBufSize) bytes, NULL = send stop and wait
+    uint8_t *rxWindowBuf; // SSP_WINDOW_BUF_SIZE(windowSize, rxBufSize) bytes, NULL = receive stop and wait
+    uint8_t txWindow; // negotiated send window, 1 = stop and wait
+    uint8_t rxWindow; // active receive window, 1 = stop and wait
+    uint8_t txCount; // packets in flight
+    uint8_t txBaseSlot; // slot of the oldest packet in flight
+    uint8_t rxBaseSlot; // slot of the next packet to deliver
+    WindowSlot txSlots[SSP_WINDOW_MAX];
+    WindowSlot rxSlots[SSP_WINDOW_MAX];
 
 private:
     portstatus mstatus;
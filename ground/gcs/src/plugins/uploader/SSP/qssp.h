@@ -96,11 +96,22 @@ private:
     int16_t     sf_ReceiveState(uint8_t c);
 
     void        sf_SendPacket();
-    void        sf_SendAckPacket(uint8_t seqNumber);
+    void        sf_WritePacket(const uint8_t *packet);
+    void        sf_SendAckPacket(uint8_t seqNumber, const uint8_t *data, uint16_t length);
     void        sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length, uint8_t seqNo);
     int16_t     sf_ReceivePacket();
     uint16_t    ssp_SendDataBlock(uint8_t *data, uint16_t length);
 
+    uint8_t     sf_NextSeqNo(uint8_t seqNo);
+    uint8_t     sf_SeqDistance(uint8_t from, uint8_t to);
+    uint8_t     sf_OfferedWindow();
+    void        sf_StartWindow(uint8_t peerWindow);
+    void        sf_StopWindow();
+    int16_t     sf_WindowSendData(const uint8_t *data, uint16_t length);
+    int16_t     sf_WindowSendProcess();
+    void        sf_WindowAck(uint8_t seqNo);
+    int16_t     sf_WindowReceive();
+
 public:
     qssp(port *info, bool debug);
 
@@ -111,6 +122,7 @@ public:
     void        ssp_Init(const PortConfig_t *const info);
     int16_t     ssp_ReceiveByte();
     uint16_t    ssp_Synchronise();
+    bool        ssp_Windowed(); // true once a send window was negotiated
 
     virtual void pfCallBack(uint8_t *, uint16_t); // call back function that is called when a full packet has been received
 };
@@ -45,14 +45,20 @@ void qsspt::run()
     while (!endthread) {
         receivestatus = ssp_ReceiveProcess();
         sendstatus    = ssp_SendProcess();
+        bool queued = false;
         sendbufmutex.lock();
         if (datapending && receivestatus == SSP_TX_IDLE) {
-            ssp_SendData(mbuf, msize);
-            datapending = false;
+            if (ssp_SendData(mbuf, msize) != SSP_TX_BUSY) {
+                datapending = false;
+                queued = true;
+            }
         }
         sendbufmutex.unlock();
-        if (sendstatus == SSP_TX_ACKED) {
+        // with a window the caller can go on as soon as the packet is in it, otherwise once it is ACKed
+        if (ssp_Windowed() ? queued : (sendstatus == SSP_TX_ACKED)) {
+            msendwait.lock();
             sendwait.wakeAll();
+            msendwait.unlock();
         }
     }
 }
@@ -66,6 +72,8 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     if (datapending) {
         return false;
     }
+    // hold msendwait from here so the wake up can not come before the wait
+    msendwait.lock();
     sendbufmutex.lock();
     datapending = true;
     mbuf  = buf;
@@ -73,7 +81,7 @@ bool qsspt::sendData(uint8_t *buf, uint16_t size)
     sendbufmutex.unlock();
     // TODO why do we wait 10 seconds ? why do we then ignore the timeout ?
     // There is a ssp_SendDataBlock method...
-    msendwait.lock();
+    // With a window this only waits for a free slot, not for the ACK
     sendwait.wait(&msendwait, 10000);
     msendwait.unlock();
     return true;
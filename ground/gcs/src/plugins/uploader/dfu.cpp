@@ -37,6 +37,7 @@
 #include <QEventLoop>
 #include <QFile>
 #include <QTimer>
+#include <QVector>
 #include <QDebug>
 
 #include <iostream>
@@ -45,6 +46,11 @@
 using namespace std;
 using namespace DFU;
 
+static quint32 toUInt32(const char *buf)
+{
+    return (quint32)(quint8)buf[0] << 24 | (quint32)(quint8)buf[1] << 16 | (quint32)(quint8)buf[2] << 8 | (quint8)buf[3];
+}
+
 DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
     debug(_debug), use_serial(_use_serial), mready(true)
 {
@@ -62,6 +68,10 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
         info->txBufSize  = MAX_PACKET_DATA_LEN;
         info->max_retry  = 10;
         info->timeoutLen = 1000;
+        // bootloaders that know about it agree on a window in ssp_Synchronise(), replies are
+        // one at a time so there is no receive window
+        info->windowSize  = SSP_WINDOW_MAX;
+        info->txWindowBuf = sspTxWindowBuf;
         if (info->status() != port::open) {
             cout << "Could not open serial port\n";
             mready = false;
@@ -231,7 +241,10 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     }
 
     int result = sendData(buf, BUF_LEN);
-    QThread::msleep(1000);
+    if (type == DFU::FW) {
+        // only a full firmware transfer erases the partition up front
+        QThread::msleep(1000);
+    }
 
     if (debug) {
         qDebug() << result << " bytes sent";
@@ -677,6 +690,7 @@ bool DFUObject::findDevices()
             devices[x].ID = devices[x].ID << 8 | (quint8)buf[15];
             devices[x].BL_Version = buf[7];
             devices[x].SizeOfDesc = buf[8];
+            devices[x].Differential = buf[16] & CAPABILITY_DIFFERENTIAL;
 
             quint32 aux;
             aux = (quint8)buf[10];
@@ -704,6 +718,7 @@ bool DFUObject::findDevices()
                 qDebug() << "Device SizeOfDesc=" << devices[x].SizeOfDesc;
                 qDebug() << "BL Version=" << devices[x].BL_Version;
                 qDebug() << "FW CRC=" << devices[x].FW_CRC;
+                qDebug() << "Differential upload=" << devices[x].Differential;
             }
         }
     }
@@ -792,6 +807,48 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
+    ret = DFU::abort;
+    if (devices[device].Differential) {
+        ret = UploadDifferentialT(arr, crc, device);
+        if (ret != DFU::Last_operation_Success) {
+            if (debug) {
+                qDebug() << "Differential upload returned:" << StatusToString(ret) << ", uploading the whole image";
+            }
+            AbortOperation();
+        }
+    }
+    if (ret != DFU::Last_operation_Success) {
+        ret = UploadFullT(arr, crc);
+        if (ret != DFU::Last_operation_Success) {
+            return ret;
+        }
+    }
+
+    if (verify) {
+        emit operationProgress("Verifying firmware");
+        cout << "Starting code verification\n";
+        QByteArray arr2;
+        StartDownloadT(&arr2, arr.length(), DFU::FW);
+        if (arr != arr2) {
+            cout << "Verify:FAILED\n";
+            return DFU::abort;
+        }
+    }
+
+    if (debug) {
+        qDebug() << "Status=" << ret;
+    }
+    cout << "Firmware Uploading succeeded\n";
+    return ret;
+}
+
+/**
+   Erases the whole partition and writes the image
+ */
+DFU::Status DFUObject::UploadFullT(QByteArray &arr, quint32 crc)
+{
+    DFU::Status ret;
+
     if (!StartUpload(arr.length(), DFU::FW, crc)) {
         ret = StatusRequest();
         if (debug) {
@@ -841,27 +898,186 @@ DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &verify,
         }
         return ret;
     }
+    return StatusRequest();
+}
+
+/**
+   Only erases and writes the sectors that differ from the image
+
+   The bootloader reports the CRC of every sector of the partition. The
+   changed sectors are erased one after the other, then their packets are
+   streamed without waiting on each other. The bootloader leaves out the words
+   that already hold their value, so packets crossing into an unchanged sector
+   and the 0xFF words of an erased one do no harm, and all 0xFF packets are
+   not sent at all. The CRC of the whole partition is checked at the end as
+   for a full upload.
+
+   The sector holding the description is always rewritten, as the description
+   is uploaded separately afterwards and cannot be written over old flash.
+ */
+DFU::Status DFUObject::UploadDifferentialT(QByteArray &arr, quint32 crc, int device)
+{
+    DFU::Status ret;
+    QList<flashSector> sectors;
+
+    emit operationProgress("Comparing firmware");
+    if (!ReadSectorCrcs(sectors)) {
+        if (debug) {
+            qDebug() << "Reading the sector CRCs failed";
+        }
+        return DFU::abort;
+    }
+
+    // the partition contents as the CRC check sees them
+    quint32 sizeOfCode = devices[device].SizeOfCode;
+    QByteArray image   = arr;
+    image.append(QByteArray(sizeOfCode - arr.length(), (char)255));
+
+    qint32 numberOfPackets = (arr.length() + 14 * 4 - 1) / (14 * 4);
+    QVector<bool> sendPacket(numberOfPackets, false);
+    QList<flashSector> changed;
+    foreach(const flashSector &sector, sectors) {
+        if ((sector.offset + sector.size <= sizeOfCode)
+            && (DFUObject::CRCFromQBArray(image.mid(sector.offset, sector.size), sector.size) == sector.crc)) {
+            continue;
+        }
+        changed << sector;
+        qint32 first = sector.offset / (14 * 4);
+        qint32 end   = qMin((sector.offset + sector.size + 14 * 4 - 1) / (14 * 4), (quint32)numberOfPackets);
+        for (qint32 packet = first; packet < end; ++packet) {
+            sendPacket[packet] = (image.mid(packet * 14 * 4, 14 * 4) != QByteArray(14 * 4, (char)255));
+        }
+    }
+    if (debug) {
+        qDebug() << changed.length() << "of" << sectors.length() << "sectors differ";
+    }
+
+    if (!StartUpload(arr.length(), DFU::FW_Differential, crc)) {
+        return StatusRequest();
+    }
     ret = StatusRequest();
-    if (ret != DFU::Last_operation_Success) {
+    if (ret != DFU::uploading) {
         return ret;
     }
 
-    if (verify) {
-        emit operationProgress("Verifying firmware");
-        cout << "Starting code verification\n";
-        QByteArray arr2;
-        StartDownloadT(&arr2, arr.length(), DFU::FW);
-        if (arr != arr2) {
-            cout << "Verify:FAILED\n";
+    emit operationProgress("Erasing changed sectors");
+    for (int x = 0; x < changed.length(); ++x) {
+        printProgBar((x + 1) * 100 / changed.length(), "ERASING");
+        if (!EraseSector(changed[x].offset)) {
             return DFU::abort;
         }
+        // the status reply comes once the sector is erased
+        ret = StatusRequest();
+        if (ret != DFU::uploading) {
+            return ret;
+        }
     }
 
+    emit operationProgress("Uploading changed sectors");
+    int lastPacketCount = (arr.length() - (numberOfPackets - 1) * 14 * 4) / 4;
+    int packetsToSend   = sendPacket.count(true);
+    int packetsSent     = 0;
+    char buf[BUF_LEN];
+    buf[0] = 0x02; // reportID
+    buf[1] = DFU::Upload; // DFU Command
+    for (qint32 packetcount = 0; packetcount < numberOfPackets; ++packetcount) {
+        if (!sendPacket[packetcount]) {
+            continue;
+        }
+        buf[2] = packetcount >> 24; // DFU Count
+        buf[3] = packetcount >> 16; // DFU Count
+        buf[4] = packetcount >> 8; // DFU Count
+        buf[5] = packetcount; // DFU Count
+        int packetsize = (packetcount == numberOfPackets - 1) ? lastPacketCount : 14;
+        CopyWords(image.data() + packetcount * 14 * 4, buf + 6, packetsize * 4);
+        if (sendData(buf, BUF_LEN) < 1) {
+            return DFU::abort;
+        }
+        ++packetsSent;
+        printProgBar(packetsSent * 100 / packetsToSend, "UPLOADING");
+    }
     if (debug) {
-        qDebug() << "Status=" << ret;
+        qDebug() << "Sent" << packetsSent << "of" << numberOfPackets << "packets";
     }
-    cout << "Firmware Uploading succeeded\n";
-    return ret;
+
+    if (!EndOperation()) {
+        return DFU::abort;
+    }
+    return StatusRequest();
+}
+
+/**
+   Asks the bootloader for the size and CRC of all sectors of the firmware partition
+ */
+bool DFUObject::ReadSectorCrcs(QList<flashSector> & sectors)
+{
+    quint32 offset = 0;
+
+    sectors.clear();
+    while (true) {
+        char buf[BUF_LEN];
+        buf[0] = 0x02; // reportID
+        buf[1] = DFU::Req_SectorCrc; // DFU Command
+        buf[2] = offset >> 24; // DFU Count
+        buf[3] = offset >> 16; // DFU Count
+        buf[4] = offset >> 8; // DFU Count
+        buf[5] = offset; // DFU Count
+        buf[6] = 0;
+        buf[7] = 0;
+        buf[8] = 0;
+        buf[9] = 0;
+
+        if (sendData(buf, BUF_LEN) < 1) {
+            return false;
+        }
+        if ((receiveData(buf, BUF_LEN) < 1) || (buf[1] != DFU::Rep_SectorCrc)) {
+            return false;
+        }
+        int entries = (quint8)buf[6];
+        if (entries == 0) {
+            break;
+        }
+        if (toUInt32(buf + 2) != offset) {
+            return false;
+        }
+        for (int x = 0; x < entries; ++x) {
+            flashSector sector;
+            sector.offset = offset;
+            sector.size   = toUInt32(buf + 7 + x * 8);
+            sector.crc    = toUInt32(buf + 11 + x * 8);
+            if (sector.size == 0) {
+                return false;
+            }
+            sectors << sector;
+            offset += sector.size;
+        }
+    }
+    return !sectors.isEmpty();
+}
+
+/**
+   Erases the sector at offset of the firmware partition, during a differential upload
+ */
+bool DFUObject::EraseSector(quint32 offset)
+{
+    char buf[BUF_LEN];
+
+    buf[0] = 0x02; // reportID
+    buf[1] = DFU::Erase_Sector; // DFU Command
+    buf[2] = offset >> 24; // DFU Count
+    buf[3] = offset >> 16; // DFU Count
+    buf[4] = offset >> 8; // DFU Count
+    buf[5] = offset; // DFU Count
+    buf[6] = 0;
+    buf[7] = 0;
+    buf[8] = 0;
+    buf[9] = 0;
+
+    int result = sendData(buf, BUF_LEN);
+    if (debug) {
+        qDebug() << "EraseSector:" << offset << result << " bytes sent";
+    }
+    return result > 0;
 }
 
 DFU::Status DFUObject::CompareFirmware(const QString &sfile, const CompareType &type, int device)
@@ -34,11 +34,16 @@
 #include <QList>
 #include <QVariant>
 
+#include "SSP/common.h"
+
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
 
 #define BUF_LEN             64
 
+// Rep_Capabilities device flags
+#define CAPABILITY_DIFFERENTIAL 0x01
+
 // serial
 class qsspt;
 
@@ -51,7 +56,8 @@ Q_NAMESPACE
 #endif
 enum TransferTypes {
     FW,
-    Descript
+    Descript,
+    FW_Differential
 };
 
 enum CompareType {
@@ -104,6 +110,9 @@ enum Commands {
     Download, // 10
     Status_Request, // 11
     Status_Rep, // 12
+    Req_SectorCrc, // 13
+    Rep_SectorCrc, // 14
+    Erase_Sector, // 15
 };
 
 enum eBoardType {
@@ -124,6 +133,14 @@ struct device {
     quint32 SizeOfCode;
     bool    Readable;
     bool    Writable;
+    bool    Differential; // can report sector CRCs and erase single sectors
+};
+
+// A flash sector of the firmware partition, offset from its start
+struct flashSector {
+    quint32 offset;
+    quint32 size;
+    quint32 crc;
 };
 
 class DFUObject : public QThread {
@@ -201,6 +218,8 @@ private:
     int receiveData(void *data, int size);
     uint8_t sspTxBuf[MAX_PACKET_BUF_SIZE];
     uint8_t sspRxBuf[MAX_PACKET_BUF_SIZE];
+    // packets kept for resending while the next ones are already on the way to the bootloader
+    uint8_t sspTxWindowBuf[SSP_WINDOW_BUF_SIZE(SSP_WINDOW_MAX, MAX_PACKET_DATA_LEN)];
 
     int setStartBit(int command)
     {
@@ -211,11 +230,15 @@ private:
     void printProgBar(int const & percent, QString const & label);
     bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
     bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+    bool ReadSectorCrcs(QList<flashSector> & sectors);
+    bool EraseSector(quint32 offset);
 
     // Thread management:
     // Same as startDownload except that we store in an external array:
     bool StartDownloadT(QByteArray *fw, qint32 const & numberOfBytes, TransferTypes const & type);
     DFU::Status UploadFirmwareT(const QString &sfile, const bool &verify, int device);
+    DFU::Status UploadFullT(QByteArray &arr, quint32 crc);
+    DFU::Status UploadDifferentialT(QByteArray &arr, quint32 crc, int device);
     QMutex mutex;
     DFU::Commands requestedOperation;
     qint32 requestSize;
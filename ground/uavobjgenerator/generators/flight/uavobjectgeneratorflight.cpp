@@ -166,8 +166,23 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     outInclude.replace(QString("$(DATASTRUCTURES)"), dataStructures);
     // Replace the $(DATAFIELDINFO) tag
     QString enums;
+    QString offsetChecks;
+    int offset = 0;
     for (int n = 0; n < info->fields.length(); ++n) {
         enums.append(QString("/* Field %1 information */\n").arg(info->fields[n]->name));
+
+        // Offset of the field in the packed data, known at generation time
+        enums.append(QString("#define %1_%2_OFFSET %3\n")
+                     .arg(info->name.toUpper())
+                     .arg(info->fields[n]->name.toUpper())
+                     .arg(offset));
+        offsetChecks.append(QString("    PIOS_STATIC_ASSERT(offsetof(%1DataPacked, %2) == %3_%4_OFFSET);\n")
+                            .arg(info->name)
+                            .arg(info->fields[n]->name)
+                            .arg(info->name.toUpper())
+                            .arg(info->fields[n]->name.toUpper()));
+        offset += info->fields[n]->numBytes * info->fields[n]->numElements;
+
         // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM) {
             if (info->fields[n]->parentObjectName.length() > 0) {
@@ -254,6 +269,8 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo *info)
     }
 
     outInclude.replace(QString("$(DATAFIELDINFO)"), enums);
+    outInclude.replace(QString("$(PACKEDSIZE)"), QString::number(offset));
+    outCode.replace(QString("$(FIELDOFFSETCHECKS)"), offsetChecks);
     outInclude.replace(QString("$(INCLUDE)"), includes);
 
     // Replace the $(INITFIELDS) tag
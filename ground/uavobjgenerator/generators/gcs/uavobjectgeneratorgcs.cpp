@@ -70,6 +70,12 @@ struct Context {
     // implementation
     QString fieldsInit;
     QString fieldsDefault;
+    QString fieldsOffsets;
+    QString fieldsOffsetChecks;
+    QString fieldsPack;
+    QString fieldsUnpack;
+    // offset of the next field in the packed data
+    int     dataOffset;
     QString propertiesImpl;
     QString notificationsImpl;
 };
@@ -82,6 +88,8 @@ struct FieldContext {
     // field
     QString   fieldName;
     QString   fieldType;
+    // member of the data fields holding the property value
+    QString   dataRef;
     // property
     QString   propName;
     QString   ucPropName;
@@ -106,6 +114,15 @@ QString fieldTypeStrCPP(int type)
     return fieldTypeStrCPP[type];
 }
 
+QString fieldTypeStrPack(int type)
+{
+    QStringList fieldTypeStrPack;
+
+    // integer type of the same size, used to swap bytes
+    fieldTypeStrPack << "quint8" << "quint16" << "quint32" << "quint8" << "quint16" << "quint32" << "quint32" << "quint8";
+    return fieldTypeStrPack[type];
+}
+
 QString fieldTypeStrCPPClass(int type)
 {
     QStringList fieldTypeStrCPPClass;
@@ -227,12 +244,14 @@ QString generate(Context &ctxt, FieldContext &fieldCtxt, const QString &fragment
     str.replace(":propRefType", fieldCtxt.propRefType);
 
     str.replace(":fieldName", fieldCtxt.fieldName);
+    str.replace(":dataRef", fieldCtxt.dataRef);
     str.replace(":fieldType", fieldCtxt.fieldType);
     str.replace(":fieldDesc", fieldCtxt.field->description);
     str.replace(":fieldUnits", fieldCtxt.field->units);
     str.replace(":fieldLimitValues", fieldCtxt.field->limitValues);
 
     str.replace(":elementCount", QString::number(fieldCtxt.field->numElements));
+    str.replace(":fieldOffsetName", fieldCtxt.field->name.toUpper() + "_OFFSET");
     str.replace(":enumCount", QString::number(fieldCtxt.field->numOptions));
 
     str.replace(":parentFieldName", fieldCtxt.parentFieldName);
@@ -290,36 +309,60 @@ void generateFieldInfo(Context &ctxt, FieldContext &fieldCtxt)
         ctxt.fieldsInfo += generate(ctxt, fieldCtxt, "    static const quint32 %1_NUMELEM = :elementCount;\n")
                            .arg(fieldCtxt.field->name.toUpper());
     }
+
+    // Generate the offset in the packed data
+    ctxt.fieldsInfo += generate(ctxt, fieldCtxt, "    static const quint32 :fieldOffsetName = %1;\n").arg(ctxt.dataOffset);
 }
 
-void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
+void generateFieldPack(Context &ctxt, FieldContext &fieldCtxt)
 {
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    // :fieldName\n");
+    ctxt.fieldsOffsets      += generate(ctxt, fieldCtxt, "    :ClassName:::fieldOffsetName,\n");
+    ctxt.fieldsOffsetChecks += generate(ctxt, fieldCtxt,
+                                        "Q_STATIC_ASSERT(offsetof(:ClassName::DataFields, :fieldName) == :ClassName:::fieldOffsetName);\n");
+
+    if (fieldCtxt.field->numBytes == 1) {
+        // no byte order to care about
+        ctxt.fieldsPack   += generate(ctxt, fieldCtxt,
+                                      "    memcpy(&dataOut[:ClassName:::fieldOffsetName], &data[:ClassName:::fieldOffsetName], :elementCount);\n");
+        ctxt.fieldsUnpack += generate(ctxt, fieldCtxt,
+                                      "    memcpy(&data[:ClassName:::fieldOffsetName], &dataIn[:ClassName:::fieldOffsetName], :elementCount);\n");
+    } else {
+        QString packType = fieldTypeStrPack(fieldCtxt.field->type);
+        ctxt.fieldsPack   += generate(ctxt, fieldCtxt,
+                                      "    UAVObject::packElements<%1>(&data[:ClassName:::fieldOffsetName], &dataOut[:ClassName:::fieldOffsetName], :elementCount);\n")
+                             .arg(packType);
+        ctxt.fieldsUnpack += generate(ctxt, fieldCtxt,
+                                      "    UAVObject::unpackElements<%1>(&dataIn[:ClassName:::fieldOffsetName], &data[:ClassName:::fieldOffsetName], :elementCount);\n")
+                             .arg(packType);
+    }
 
-    // Setup element names
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameElemNames;\n");
+    ctxt.dataOffset += fieldCtxt.field->numBytes * fieldCtxt.field->numElements;
+}
+
+void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
+{
+    // Descriptor of the field, built once and shared by all instances
     QStringList elemNames = fieldCtxt.field->elementNames;
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameElemNames");
+    QString elemNamesInit = "QStringList()";
+
     for (int m = 0; m < elemNames.length(); ++m) {
-        ctxt.fieldsInit += QString(" << \"%1\"").arg(elemNames[m]);
+        elemNamesInit += QString(" << \"%1\"").arg(elemNames[m]);
     }
-    ctxt.fieldsInit += ";\n";
 
+    QString optionsInit = "QStringList()";
     if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameEnumOptions;\n");
         QStringList options = fieldCtxt.field->options;
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameEnumOptions");
         for (int m = 0; m < options.length(); ++m) {
-            ctxt.fieldsInit += QString(" << \"%1\"").arg(options[m]);
+            optionsInit += QString(" << \"%1\"").arg(options[m]);
         }
-        ctxt.fieldsInit += ";\n";
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::ENUM, :fieldNameElemNames, :fieldNameEnumOptions, \":fieldLimitValues\"));\n");
-    } else {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::%1, :fieldNameElemNames, QStringList(), \":fieldLimitValues\"));\n")
-                           .arg(fieldTypeStrCPPClass(fieldCtxt.field->type));
     }
+
+    // no QString::arg() here, the descriptions and limits may contain '%'
+    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "        UAVObjectField::Descriptor(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::")
+                       + fieldTypeStrCPPClass(fieldCtxt.field->type) + ",\n"
+                       + "                                   " + elemNamesInit + ",\n"
+                       + "                                   " + optionsInit
+                       + generate(ctxt, fieldCtxt, ", \":fieldLimitValues\"),\n");
 }
 
 void generateFieldDefault(Context &ctxt, FieldContext &fieldCtxt)
@@ -371,6 +414,7 @@ void generateField(Context &ctxt, FieldContext &fieldCtxt)
         ctxt.fields += generate(ctxt, fieldCtxt, "        :fieldType :fieldName;\n");
     }
     generateFieldInfo(ctxt, fieldCtxt);
+    generateFieldPack(ctxt, fieldCtxt);
     generateFieldInit(ctxt, fieldCtxt);
     generateFieldDefault(ctxt, fieldCtxt);
 }
@@ -408,7 +452,11 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
     ctxt.setters           += generate(ctxt, fieldCtxt, "    void set:PropName(const :propRefType value);\n");
 
     ctxt.notifications     += generate(ctxt, fieldCtxt, "    void :propNameChanged(const :propRefType value);\n");
-    ctxt.notificationsImpl += generate(ctxt, fieldCtxt, "    emit :propNameChanged(:propName());\n");
+
+    // only notify the properties whose value changed since the last notification
+    ctxt.notificationsImpl += generate(ctxt, fieldCtxt,
+                                       "    if (memcmp(&data.:dataRef, &last.:dataRef, sizeof(data.:dataRef))) {\n"
+                                       "        emit :propNameChanged(static_cast<:propType>(data.:dataRef));\n");
 
     if (DEPRECATED) {
         // generate deprecated property for retro compatibility
@@ -429,9 +477,11 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
                                                "    /*DEPRECATED*/ void :fieldNameChanged(:fieldType value);\n");
 
             ctxt.notificationsImpl += generate(ctxt, fieldCtxt,
-                                               "    /*DEPRECATED*/ emit :fieldNameChanged(get:fieldName());\n");
+                                               "        /*DEPRECATED*/ emit :fieldNameChanged(static_cast<:fieldType>(data.:dataRef));\n");
         }
     }
+
+    ctxt.notificationsImpl += "    }\n";
 }
 
 void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
@@ -465,6 +515,7 @@ void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
                                     "   mutex->lock();\n"
                                     "   bool changed = (data_.:fieldName != static_cast<:fieldType>(value));\n"
                                     "   data_.:fieldName = static_cast<:fieldType>(value);\n"
+                                    "   notified_.:fieldName = data_.:fieldName;\n"
                                     "   mutex->unlock();\n"
                                     "   if (changed) { %1 }\n"
                                     "}\n\n").arg(emitters);
@@ -503,6 +554,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
                                     "   mutex->lock();\n"
                                     "   bool changed = (data_.:fieldName[index] != static_cast<:fieldType>(value));\n"
                                     "   data_.:fieldName[index] = static_cast<:fieldType>(value);\n"
+                                    "   notified_.:fieldName[index] = data_.:fieldName[index];\n"
                                     "   mutex->unlock();\n"
                                     "   if (changed) { %1 }\n"
                                     "}\n\n").arg(emitters);
@@ -537,6 +589,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
 
         FieldContext elementCtxt(fieldCtxt);
         elementCtxt.fieldName  = fieldCtxt.fieldName + "_" + elementName;
+        elementCtxt.dataRef    = QString("%1[%2]").arg(fieldCtxt.dataRef).arg(elementIndex);
         elementCtxt.propName   = fieldCtxt.propName + sep + elementName;
         elementCtxt.ucPropName = fieldCtxt.ucPropName + sep + elementName;
         // deprecation
@@ -629,6 +682,7 @@ FieldContext::FieldContext(FieldInfo *fieldInfo, ObjectInfo *object)
     // field properties
     fieldName = field->name;
     fieldType = fieldTypeStrCPP(field->type);
+    dataRef   = field->name;
 
     parentClassName  = field->parentObjectName;
     parentFieldName  = field->parentFieldName;
@@ -684,7 +738,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
     reservedProperties << "Description" << "Metadata";
 
     Context ctxt;
-    ctxt.object = object;
+    ctxt.object     = object;
+    ctxt.dataOffset = 0;
 
     ctxt.registerImpl += ::generate(ctxt,
                                     "    qmlRegisterType<:ClassName>(\"%1.:ClassName\", 1, 0, \":ClassName\");\n").arg("UAVTalk");
@@ -726,6 +781,10 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
 
     outCode.replace("$(FIELDSINIT)", ctxt.fieldsInit);
     outCode.replace("$(FIELDSDEFAULT)", ctxt.fieldsDefault);
+    outCode.replace("$(FIELDSOFFSETS)", ctxt.fieldsOffsets);
+    outCode.replace("$(FIELDSOFFSETCHECKS)", ctxt.fieldsOffsetChecks);
+    outCode.replace("$(FIELDSPACK)", ctxt.fieldsPack);
+    outCode.replace("$(FIELDSUNPACK)", ctxt.fieldsUnpack);
     outCode.replace("$(PROPERTIES_IMPL)", ctxt.propertiesImpl);
     outCode.replace("$(NOTIFY_PROPERTIES_CHANGED)", ctxt.notificationsImpl);
     outCode.replace("$(REGISTER_QML_TYPES)", ctxt.registerImpl);
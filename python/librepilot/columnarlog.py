@@ -0,0 +1,187 @@
+##
+##############################################################################
+#
+# @file       columnarlog.py
+# @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2026.
+# @brief      Reader for the columnar log files (*.oplc) exported by the GCS
+#
+# @see        The GNU Public License (GPL) Version 3
+#
+#############################################################################/
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+# or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+# for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+#
+
+# The file layout is documented in ground/gcs/src/libs/utils/columnarlog.h.
+# The file is memory mapped and only the blocks of the requested columns
+# are touched. Column values are returned as numpy arrays when numpy is
+# available, as array.array otherwise.
+
+import array
+import mmap
+import struct
+import sys
+import zlib
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+MAGIC = b"OPLC"
+VERSION = 1
+
+# Column type -> (struct format, array typecode)
+COLUMN_TYPES = {
+    0: ("b", "b"),  # INT8
+    1: ("h", "h"),  # INT16
+    2: ("i", "i"),  # INT32
+    3: ("B", "B"),  # UINT8
+    4: ("H", "H"),  # UINT16
+    5: ("I", "I"),  # UINT32
+    6: ("f", "f"),  # FLOAT32
+}
+
+
+class Block(object):
+    def __init__(self, offset, storedSize, rawSize, min, max):
+        self.offset = offset
+        self.storedSize = storedSize
+        self.rawSize = rawSize
+        self.min = min
+        self.max = max
+
+    def isCompressed(self):
+        return self.storedSize != self.rawSize
+
+
+class Chunk(object):
+    def __init__(self, rows, blocks):
+        self.rows = rows
+        self.blocks = blocks
+
+
+class Column(object):
+    def __init__(self, name, type, units):
+        self.name = name
+        self.type = type
+        self.units = units
+
+
+class Table(object):
+    def __init__(self, name, id):
+        self.name = name
+        self.id = id
+        self.columns = []
+        self.chunks = []
+
+    def columnIndex(self, name):
+        for n, column in enumerate(self.columns):
+            if column.name == name:
+                return n
+        raise KeyError("no column %s in table %s" % (name, self.name))
+
+
+class ColumnarLog(object):
+    def __init__(self, filename):
+        self.file = open(filename, "rb")
+        self.map = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        self.tables = {}
+        self._readFooter()
+
+    def close(self):
+        self.map.close()
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def _unpack(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.map, self.pos)
+        self.pos += struct.calcsize("<" + fmt)
+        return values
+
+    def _readString(self):
+        (length,) = self._unpack("I")
+        value = self.map[self.pos:self.pos + length].decode("utf-8")
+        self.pos += length
+        return value
+
+    def _readFooter(self):
+        if self.map[0:4] != MAGIC or struct.unpack_from("<I", self.map, 4)[0] != VERSION:
+            raise IOError("not a columnar log file or unsupported version")
+        if self.map[-4:] != MAGIC:
+            raise IOError("file was not closed properly, footer is missing")
+
+        (self.pos,) = struct.unpack_from("<Q", self.map, len(self.map) - 12)
+        (tableCount,) = self._unpack("I")
+        for t in range(tableCount):
+            table = Table(self._readString(), self._unpack("I")[0])
+            (columnCount,) = self._unpack("I")
+            for c in range(columnCount):
+                name = self._readString()
+                (type,) = self._unpack("B")
+                if type not in COLUMN_TYPES:
+                    raise IOError("unknown type %d of column %s" % (type, name))
+                table.columns.append(Column(name, type, self._readString()))
+            (chunkCount,) = self._unpack("I")
+            for k in range(chunkCount):
+                (rows,) = self._unpack("I")
+                blocks = [Block(*self._unpack("QIIdd")) for c in range(columnCount)]
+                table.chunks.append(Chunk(rows, blocks))
+            self.tables[table.name] = table
+
+    def readBlock(self, block):
+        data = self.map[block.offset:block.offset + block.storedSize]
+        if block.isCompressed():
+            # Blocks are compressed with qCompress(): big endian size followed by a zlib stream
+            data = zlib.decompress(data[4:])
+        return data
+
+    def column(self, tableName, columnName, chunks=None):
+        """
+        Returns the values of a column. Optionally restricted to a list of chunk
+        indices, for example the ones returned by selectChunks().
+        """
+        table = self.tables[tableName]
+        index = table.columnIndex(columnName)
+        fmt, typecode = COLUMN_TYPES[table.columns[index].type]
+        if chunks is None:
+            chunks = range(len(table.chunks))
+
+        data = b"".join(self.readBlock(table.chunks[k].blocks[index]) for k in chunks)
+        if numpy is not None:
+            return numpy.frombuffer(data, dtype="<" + fmt)
+        values = array.array(typecode)
+        if sys.version_info[0] >= 3:
+            values.frombytes(data)
+        else:
+            values.fromstring(data)
+        if sys.byteorder != "little":
+            values.byteswap()
+        return values
+
+    def selectChunks(self, tableName, columnName, min, max):
+        """
+        Returns the indices of the chunks whose values for a column may fall in [min, max],
+        using the per chunk statistics only.
+        """
+        table = self.tables[tableName]
+        index = table.columnIndex(columnName)
+        return [k for k, chunk in enumerate(table.chunks)
+                if chunk.blocks[index].max >= min and chunk.blocks[index].min <= max]